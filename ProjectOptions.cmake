@@ -4,6 +4,11 @@ else()
     option(MyProject_ENABLE_CACHE "Enable ccache" ON)
 endif()
 
+option(MyProject_ENABLE_STATS "Count rays, intersection tests and scatter events while rendering" OFF)
+option(MyProject_USE_FLOAT "Trace rays and shade in single instead of double precision" OFF)
+option(MyProject_SIMD_VEC3 "Back Vec3 with the vector extensions of GCC instead of scalar components" OFF)
+option(MyProject_BUILD_BENCHMARKS "Build the microbenchmarks of the hot kernels" OFF)
+
 if(NOT PROJECT_IS_TOP_LEVEL)
     mark_as_advanced(MyProject_ENABLE_CACHE)
 endif()
@@ -0,0 +1,152 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Bvh.hpp"
+
+#include "Camera.hpp"
+#include "Dispatch.hpp"
+#include "Packet.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace rt::bvh {
+
+namespace {
+
+/// Describe the spheres of randomScene(): a large ground sphere, a grid of small spheres and three large ones
+scene::Description makeRandomScene()
+{
+  scene::Description scene;
+  scene.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+  scene.spheres.push_back(scene::SphereData {.centre = {0, -1000, 0}, .radius = 1000});
+
+  for (int a = -11; a < 11; ++a) {
+    for (int b = -11; b < 11; ++b) {
+      auto const centre = std::array<double, 3> {a + 0.9 * getRandomDouble(), 0.2, b + 0.9 * getRandomDouble()};
+      scene.spheres.push_back(scene::SphereData {.centre = centre, .radius = 0.2});
+    }
+  }
+
+  scene.spheres.push_back(scene::SphereData {.centre = {0, 1, 0}, .radius = 1});
+  scene.spheres.push_back(scene::SphereData {.centre = {-4, 1, 0}, .radius = 1});
+  scene.spheres.push_back(scene::SphereData {.centre = {4, 1, 0}, .radius = 1});
+
+  return scene;
+}
+
+}   // namespace
+
+TEST_CASE("Primary visibility", "[!benchmark][Bvh]")
+{
+  seedRandom(1);
+
+  // The kernels run as they do in the application, compiled for the widest instruction set the processor supports
+  dispatch::selectIsa(dispatch::detectIsa());
+
+  auto const scene = makeRandomScene();
+  auto const tree = build(scene.spheres);
+  auto const materials = scene::MaterialTable(scene.materials);
+  auto const bvh = SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials());
+
+  // The camera rays of every 4 x 4 block of pixels of a 400 x 224 image, lane 4 * y + x being pixel (x, y) of the
+  // block, so that the smaller packets are its 4 x 2 halves and 2 x 2 quarters
+  static constexpr std::size_t width = 400;
+  static constexpr std::size_t height = 224;
+  auto const camera =
+    camera::Camera(ray::Point3(13, 2, 3), ray::Point3(0, 0, 0), vec3::Vec3(0, 1, 0), 20, 16.0 / 9.0, 0.1, 10.0);
+  std::vector<std::array<ray::Ray, 16>> blocks;
+
+  for (std::size_t j0 = 0; j0 < height; j0 += 4) {
+    for (std::size_t i0 = 0; i0 < width; i0 += 4) {
+      auto& block = blocks.emplace_back();
+
+      for (std::size_t lane = 0; lane < 16; ++lane) {
+        auto const u = (static_cast<double>(i0 + (lane % 4)) + getRandomDouble()) / static_cast<double>(width - 1);
+        auto const v = (static_cast<double>(j0 + (lane / 4)) + getRandomDouble()) / static_cast<double>(height - 1);
+        block[lane] = camera.getRay(u, v);
+      }
+    }
+  }
+
+  std::size_t next = 0;
+  std::array<hittable::HitRecord, packet::maxSize> records;
+  std::array<Scalar, packet::maxSize> bounds;
+  bounds.fill(rt::infinity);
+
+  // Every benchmark traces the 16 rays of one block
+  BENCHMARK("SphereBvh::hit 16 single rays")
+  {
+    auto const& block = blocks[next++ % blocks.size()];
+    bool any = false;
+
+    for (std::size_t lane = 0; lane < 16; ++lane) {
+      any |= bvh.hit(block[lane], 0.001, rt::infinity, records[lane]);
+    }
+
+    return any;
+  };
+
+  BENCHMARK("SphereBvh::hitStream 16 rays")
+  {
+    auto const& block = blocks[next++ % blocks.size()];
+
+    return bvh.hitStream(block, 0.001, std::span(bounds).first(block.size()), records);
+  };
+
+  for (std::size_t const size : {4, 8, 16}) {
+    auto packet = packet::RayPacket();
+    packet.size = size;
+
+    BENCHMARK("SphereBvh::hitPacket 16 rays in " + std::to_string(size) + "-ray packets")
+    {
+      auto const& block = blocks[next++ % blocks.size()];
+      packet::Mask hits = 0;
+
+      for (std::size_t first = 0; first < 16; first += size) {
+        packet.active = 0;
+
+        for (std::size_t lane = 0; lane < size; ++lane) {
+          packet.set(lane, block[first + lane]);
+        }
+
+        hits |= bvh.hitPacket(packet, 0.001, rt::infinity, records);
+      }
+
+      return hits;
+    };
+  }
+
+  dispatch::selectIsa(dispatch::Isa::generic);
+}
+
+}   // namespace rt::bvh
@@ -0,0 +1,50 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Camera.hpp"
+
+#include "Ray.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace rt::camera {
+
+TEST_CASE("Camera::getRay", "[!benchmark][Camera]")
+{
+  seedRandom(1);
+
+  auto const camera =
+    Camera(ray::Point3(13, 2, 3), ray::Point3(0, 0, 0), vec3::Vec3(0, 1, 0), 20, 16.0 / 9.0, 0.1, 10.0);
+  auto const u = getRandomDouble();
+  auto const v = getRandomDouble();
+
+  BENCHMARK("Camera::getRay")
+  {
+    return camera.getRay(u, v);
+  };
+}
+
+}   // namespace rt::camera
@@ -0,0 +1,80 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Colour.hpp"
+
+#include "Utilities.hpp"
+#include <array>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <ostream>
+#include <streambuf>
+
+namespace rt::colour {
+
+namespace {
+
+/// A stream buffer that throws away everything written to it, so that only formatting is measured
+class DiscardingBuffer final : public std::streambuf
+{
+public:
+  DiscardingBuffer() noexcept
+  {
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+  }
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    return traits_type::not_eof(c);
+  }
+
+private:
+  std::array<char, 4096> m_buffer {};
+};
+
+}   // namespace
+
+TEST_CASE("Colour output", "[!benchmark][Colour]")
+{
+  seedRandom(1);
+
+  auto buffer = DiscardingBuffer();
+  auto out = std::ostream(&buffer);
+  auto const colour = Colour::getRandomColour(0, 100);
+  auto const pixel = mapToByteRange(colour, 100);
+
+  BENCHMARK("mapToByteRange")
+  {
+    return mapToByteRange(colour, 100);
+  };
+
+  BENCHMARK("writeColour")
+  {
+    writeColour(out, pixel);
+  };
+}
+
+}   // namespace rt::colour
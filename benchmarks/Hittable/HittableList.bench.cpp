@@ -0,0 +1,119 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "HittableList.hpp"
+
+#include "Colour.hpp"
+#include "Hittable.hpp"
+#include "Lambertian.hpp"
+#include "Ray.hpp"
+#include "Sphere.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rt::hittable {
+
+namespace {
+
+/// Fill a cube with the given number of small spheres
+HittableList makeWorld(std::size_t sphereCount)
+{
+  HittableList world;
+
+  for (std::size_t i = 0; i < sphereCount; ++i) {
+    auto const centre = vec3::Vec3::createRandomVecInRange(-10, 10);
+    world.add(new sphere::Sphere(centre, 0.2, new material::Lambertian(colour::Colour(0.5, 0.5, 0.5))));
+  }
+
+  return world;
+}
+
+}   // namespace
+
+TEST_CASE("HittableList::hit", "[!benchmark][HittableList]")
+{
+  seedRandom(1);
+
+  // Rays from the faces of the cube through its interior, so that some hit and some miss
+  std::vector<ray::Ray> rays;
+
+  for (int i = 0; i < 256; ++i) {
+    auto const origin = vec3::Vec3::createRandomVecInRange(-10, 10) + vec3::Vec3(0, 0, 20);
+    rays.emplace_back(origin, vec3::Vec3::createRandomVecInRange(-1, 1) - vec3::Vec3(0, 0, 2));
+  }
+
+  for (std::size_t const sphereCount : {10, 100, 1000}) {
+    auto const world = makeWorld(sphereCount);
+    std::size_t next = 0;
+    HitRecord record;
+
+    BENCHMARK("HittableList::hit " + std::to_string(sphereCount) + " spheres")
+    {
+      auto const& ray = rays[next++ % rays.size()];
+      return world.hit(ray, 0.001, rt::infinity, record);
+    };
+  }
+}
+
+TEST_CASE("HittableList::hitStream", "[!benchmark][HittableList]")
+{
+  seedRandom(1);
+
+  std::vector<ray::Ray> rays;
+
+  for (int i = 0; i < 256; ++i) {
+    auto const origin = vec3::Vec3::createRandomVecInRange(-10, 10) + vec3::Vec3(0, 0, 20);
+    rays.emplace_back(origin, vec3::Vec3::createRandomVecInRange(-1, 1) - vec3::Vec3(0, 0, 2));
+  }
+
+  // Both benchmarks trace all 256 rays, one at a time or as one stream
+  for (std::size_t const sphereCount : {10, 100, 1000}) {
+    auto const world = makeWorld(sphereCount);
+    std::vector<HitRecord> records(rays.size());
+    std::vector<Scalar> const bounds(rays.size(), rt::infinity);
+
+    BENCHMARK("HittableList::hit 256 single rays " + std::to_string(sphereCount) + " spheres")
+    {
+      std::size_t hits = 0;
+
+      for (std::size_t i = 0; i < rays.size(); ++i) {
+        hits += world.hit(rays[i], 0.001, rt::infinity, records[i]) ? 1 : 0;
+      }
+
+      return hits;
+    };
+
+    BENCHMARK("HittableList::hitStream 256 rays " + std::to_string(sphereCount) + " spheres")
+    {
+      return world.hitStream(rays, 0.001, bounds, records);
+    };
+  }
+}
+
+}   // namespace rt::hittable
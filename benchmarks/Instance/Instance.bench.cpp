@@ -0,0 +1,107 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Instance.hpp"
+
+#include "Bvh.hpp"
+#include "Dispatch.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace rt::instance {
+
+TEST_CASE("Instanced clusters", "[!benchmark][Instance]")
+{
+  seedRandom(1);
+
+  dispatch::selectIsa(dispatch::detectIsa());
+
+  // A cluster of 64 spheres, repeated on a 32 x 32 grid with a turn of its own for every copy
+  scene::Description cluster;
+  cluster.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+
+  for (int i = 0; i < 64; ++i) {
+    auto const centre = std::array<double, 3> {
+      getRandomDoubleInRange(-1, 1), getRandomDoubleInRange(0, 2), getRandomDoubleInRange(-1, 1)};
+    cluster.spheres.push_back(scene::SphereData {.centre = centre, .radius = 0.1});
+  }
+
+  auto const geometry = std::make_shared<SphereGeometry const>(cluster);
+  std::vector<Instance> instances;
+  scene::Description flattened;
+  flattened.materials = cluster.materials;
+
+  for (int a = -16; a < 16; ++a) {
+    for (int b = -16; b < 16; ++b) {
+      auto const transform = Transform::translate(vec3::Vec3(3 * a, 0, 3 * b))
+                           * Transform::rotate(vec3::Vec3(0, 1, 0), getRandomDouble() * 360);
+      instances.emplace_back(geometry, geometry->getBounds(), transform);
+
+      for (auto sphere : cluster.spheres) {
+        auto const centre = transform.applyToPoint(ray::Point3(sphere.centre[0], sphere.centre[1], sphere.centre[2]));
+        sphere.centre = {centre.x(), centre.y(), centre.z()};
+        flattened.spheres.push_back(sphere);
+      }
+    }
+  }
+
+  auto const instanced = InstanceBvh(std::move(instances));
+  auto const tree = bvh::build(flattened.spheres);
+  auto const materials = scene::MaterialTable(flattened.materials);
+  auto const spheres = bvh::SphereBvh(flattened.spheres, tree.nodes, tree.indices, materials.getMaterials());
+
+  // Rays from above the grid down into it at an angle
+  std::vector<ray::Ray> rays;
+
+  for (int i = 0; i < 4096; ++i) {
+    auto const origin = ray::Point3(getRandomDoubleInRange(-50, 50), 20, getRandomDoubleInRange(-50, 50));
+    auto const target = ray::Point3(getRandomDoubleInRange(-48, 48), 0, getRandomDoubleInRange(-48, 48));
+    rays.emplace_back(origin, target - origin);
+  }
+
+  std::size_t next = 0;
+  hittable::HitRecord record;
+
+  BENCHMARK("SphereBvh::hit 65536 spheres")
+  {
+    return spheres.hit(rays[next++ % rays.size()], 0.001, rt::infinity, record);
+  };
+
+  BENCHMARK("InstanceBvh::hit 1024 instances of 64 spheres")
+  {
+    return instanced.hit(rays[next++ % rays.size()], 0.001, rt::infinity, record);
+  };
+
+  dispatch::selectIsa(dispatch::Isa::generic);
+}
+
+}   // namespace rt::instance
@@ -0,0 +1,79 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Material.hpp"
+
+#include "Colour.hpp"
+#include "Dielectric.hpp"
+#include "Hittable.hpp"
+#include "Lambertian.hpp"
+#include "Metal.hpp"
+#include "Ray.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace rt::material {
+
+TEST_CASE("Material::scatter", "[!benchmark][Material]")
+{
+  seedRandom(1);
+
+  auto const rayIn = ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0.1, -0.2, -1));
+
+  hittable::HitRecord record;
+  record.t = 1.0;
+  record.point = rayIn.at(record.t);
+  record.setFaceNormal(rayIn, vec3::getUnitVector(vec3::Vec3(0.2, 0.1, 1)));
+
+  auto const lambertian = Lambertian(colour::Colour(0.5, 0.5, 0.5));
+  auto const metal = Metal(colour::Colour(0.7, 0.6, 0.5), 0.3);
+  auto const dielectric = Dielectric(1.5);
+
+  auto attenuation = colour::Colour();
+  auto scattered = ray::Ray();
+
+  // Call through the base class, as rayColour does
+  Material const& lambertianMaterial = lambertian;
+  Material const& metalMaterial = metal;
+  Material const& dielectricMaterial = dielectric;
+
+  BENCHMARK("Lambertian::scatter")
+  {
+    return lambertianMaterial.scatter(rayIn, record, attenuation, scattered);
+  };
+
+  BENCHMARK("Metal::scatter")
+  {
+    return metalMaterial.scatter(rayIn, record, attenuation, scattered);
+  };
+
+  BENCHMARK("Dielectric::scatter")
+  {
+    return dielectricMaterial.scatter(rayIn, record, attenuation, scattered);
+  };
+}
+
+}   // namespace rt::material
@@ -0,0 +1,107 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Mesh.hpp"
+
+#include "Colour.hpp"
+#include "Dispatch.hpp"
+#include "Lambertian.hpp"
+#include "Ray.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <string>
+#include <vector>
+
+namespace rt::mesh {
+
+namespace {
+
+/// Tessellate a unit sphere into a grid of latitude and longitude bands, two triangles per cell
+MeshData makeSphere(std::uint32_t bands)
+{
+  MeshData sphere;
+
+  for (std::uint32_t i = 0; i <= bands; ++i) {
+    auto const theta = std::numbers::pi * i / bands;
+
+    for (std::uint32_t j = 0; j <= bands; ++j) {
+      auto const phi = 2 * std::numbers::pi * j / bands;
+      sphere.positions.push_back({static_cast<float>(std::sin(theta) * std::cos(phi)),
+                                  static_cast<float>(std::cos(theta)),
+                                  static_cast<float>(std::sin(theta) * std::sin(phi))});
+    }
+  }
+
+  for (std::uint32_t i = 0; i < bands; ++i) {
+    for (std::uint32_t j = 0; j < bands; ++j) {
+      auto const corner = (i * (bands + 1)) + j;
+      sphere.triangles.push_back({corner, corner + bands + 1, corner + 1});
+      sphere.triangles.push_back({corner + 1, corner + bands + 1, corner + bands + 2});
+    }
+  }
+
+  return sphere;
+}
+
+}   // namespace
+
+TEST_CASE("Tessellated sphere", "[!benchmark][Mesh]")
+{
+  seedRandom(1);
+
+  dispatch::selectIsa(dispatch::detectIsa());
+
+  auto material = material::Lambertian(colour::Colour(0.5, 0.5, 0.5));
+
+  // Rays from a ring around the sphere towards points near its centre, so that most hit
+  std::vector<ray::Ray> rays;
+
+  for (int i = 0; i < 4096; ++i) {
+    auto const angle = getRandomDoubleInRange(0, 2 * std::numbers::pi);
+    auto const origin = ray::Point3(4 * std::cos(angle), getRandomDoubleInRange(-2, 2), 4 * std::sin(angle));
+    rays.emplace_back(origin, vec3::Vec3::createRandomVecInRange(-0.8, 0.8) - origin);
+  }
+
+  for (std::uint32_t const bands : {32, 256, 724}) {
+    auto const mesh = TriangleMesh(makeSphere(bands), &material);
+    std::size_t next = 0;
+    hittable::HitRecord record;
+
+    BENCHMARK("TriangleMesh::hit " + std::to_string(mesh.getTriangleCount()) + " triangles, "
+              + std::to_string(mesh.getMemoryUsage() >> 20) + " MiB")
+    {
+      return mesh.hit(rays[next++ % rays.size()], 0.001, rt::infinity, record);
+    };
+  }
+
+  dispatch::selectIsa(dispatch::Isa::generic);
+}
+
+}   // namespace rt::mesh
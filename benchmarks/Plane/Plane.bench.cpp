@@ -0,0 +1,111 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Plane.hpp"
+
+#include "Bvh.hpp"
+#include "Camera.hpp"
+#include "Dispatch.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rt::plane {
+
+TEST_CASE("Ground", "[!benchmark][Plane]")
+{
+  seedRandom(1);
+
+  dispatch::selectIsa(dispatch::detectIsa());
+
+  // The grid of small spheres and three large ones of randomScene(), standing on either a ground sphere in their
+  // hierarchy or a ground plane kept out of it
+  scene::Description scene;
+  scene.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+
+  for (int a = -11; a < 11; ++a) {
+    for (int b = -11; b < 11; ++b) {
+      auto const centre = std::array<double, 3> {a + 0.9 * getRandomDouble(), 0.2, b + 0.9 * getRandomDouble()};
+      scene.spheres.push_back(scene::SphereData {.centre = centre, .radius = 0.2});
+    }
+  }
+
+  scene.spheres.push_back(scene::SphereData {.centre = {0, 1, 0}, .radius = 1});
+  scene.spheres.push_back(scene::SphereData {.centre = {-4, 1, 0}, .radius = 1});
+  scene.spheres.push_back(scene::SphereData {.centre = {4, 1, 0}, .radius = 1});
+
+  auto withSphere = scene.spheres;
+  withSphere.push_back(scene::SphereData {.centre = {0, -1000, 0}, .radius = 1000});
+  auto const ground = std::array {scene::ShapeData {.type = scene::ShapeType::plane, .vector = {0, 1, 0}}};
+
+  auto const materials = scene::MaterialTable(scene.materials);
+  auto const sphereTree = bvh::build(withSphere);
+  auto const sphereGround = bvh::SphereBvh(withSphere, sphereTree.nodes, sphereTree.indices, materials.getMaterials());
+  auto const tree = bvh::build(scene.spheres);
+  auto const spheres = bvh::SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials());
+  auto const planeGround = ShapeList(ground, materials.getMaterials(), spheres, scene.spheres.size());
+
+  // The camera rays of randomScene() and rays bounced off the ground in random directions
+  auto const camera =
+    camera::Camera(ray::Point3(13, 2, 3), ray::Point3(0, 0, 0), vec3::Vec3(0, 1, 0), 20, 16.0 / 9.0, 0.1, 10.0);
+  std::vector<ray::Ray> cameraRays;
+  std::vector<ray::Ray> bounces;
+
+  for (int i = 0; i < 4096; ++i) {
+    cameraRays.push_back(camera.getRay(getRandomDouble(), getRandomDouble()));
+
+    auto const origin = ray::Point3(getRandomDoubleInRange(-12, 12), 0, getRandomDoubleInRange(-12, 12));
+    auto direction = vec3::Vec3::createRandomVecInRange(-1, 1);
+    direction[1] = std::abs(direction[1]);
+    bounces.emplace_back(origin, direction);
+  }
+
+  for (auto const* const rays : {&cameraRays, &bounces}) {
+    auto const name = rays == &cameraRays ? " camera rays" : " bounced rays";
+    std::size_t next = 0;
+    hittable::HitRecord record;
+
+    BENCHMARK(std::string("ground sphere in the BVH") + name)
+    {
+      return sphereGround.hit((*rays)[next++ % rays->size()], 0.001, rt::infinity, record);
+    };
+
+    BENCHMARK(std::string("ground plane before the BVH") + name)
+    {
+      return planeGround.hit((*rays)[next++ % rays->size()], 0.001, rt::infinity, record);
+    };
+  }
+
+  dispatch::selectIsa(dispatch::Isa::generic);
+}
+
+}   // namespace rt::plane
@@ -0,0 +1,502 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Colour.hpp"
+#include "Main.hpp"
+#include "Ray.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) or defined(__APPLE__)
+  #include <sys/resource.h>
+#endif
+
+namespace rt::benchmarks {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// A scene the benchmark renders
+struct Scenario
+{
+  std::string name;
+  std::function<scene::Description()> describe;
+};
+
+/// The measurements of the fastest repetition of a scenario
+struct Result
+{
+  std::string name;
+  double buildSeconds {};
+  double traceSeconds {};
+  double tonemapSeconds {};
+  double writeSeconds {};
+  std::uint64_t rays {};
+
+  double getWallSeconds() const noexcept
+  {
+    return buildSeconds + traceSeconds + tonemapSeconds + writeSeconds;
+  }
+
+  double getMraysPerSecond() const noexcept
+  {
+    return traceSeconds > 0 ? static_cast<double>(rays) / traceSeconds / 1e6 : 0.0;
+  }
+};
+
+/// The measurements a run is compared against
+struct Baseline
+{
+  std::string settings;
+  std::map<std::string, Result, std::less<>> results;
+};
+
+/// Command line settings of the benchmark
+struct Arguments
+{
+  render::Settings settings;
+  std::size_t repetitions {3};
+  double tolerance {0.05};
+  std::string baselinePath;
+  std::string writeBaselinePath;
+};
+
+/// Describe a variant of describeRandomScene with a differently sized grid of small spheres and a different material
+/// mix
+/// \param[in] extent The grid spans [-extent, extent) along both horizontal axes
+/// \param[in] diffuse The fraction of small spheres that are diffuse
+/// \param[in] metal The fraction of small spheres that are metallic. The rest are glass
+scene::Description describeStressScene(int extent, double diffuse, double metal)
+{
+  using colour::Colour;
+  using ray::Point3;
+  using scene::MaterialType;
+
+  scene::Description description;
+
+  auto const addSphere = [&description](Point3 const& centre, double radius, scene::MaterialData const& material) {
+    description.materials.push_back(material);
+    description.spheres.push_back(scene::SphereData {
+      .centre = {centre.x(), centre.y(), centre.z()},
+      .radius = radius,
+      .material = static_cast<std::uint32_t>(description.materials.size() - 1)});
+  };
+  auto const lambertian = [](Colour const& albedo) {
+    return scene::MaterialData {.type = MaterialType::lambertian, .albedo = {albedo.r(), albedo.g(), albedo.b()}};
+  };
+  auto const metallic = [](Colour const& albedo, double fuzz) {
+    return scene::MaterialData {
+      .type = MaterialType::metal, .albedo = {albedo.r(), albedo.g(), albedo.b()}, .parameter = fuzz};
+  };
+  auto const glass = scene::MaterialData {.type = MaterialType::dielectric, .parameter = 1.5};
+
+  description.materials.push_back(lambertian(Colour(0.5, 0.5, 0.5)));
+  description.shapes.push_back(scene::ShapeData {.type = scene::ShapeType::plane, .vector = {0, 1, 0}});
+
+  for (int a = -extent; a < extent; ++a) {
+    for (int b = -extent; b < extent; ++b) {
+      auto const chooseMaterial = getRandomDouble();
+      auto const centre = Point3(a + 0.9 * getRandomDouble(), 0.2, b + 0.9 * getRandomDouble());
+
+      if ((centre - Point3(4, 0.2, 0)).length() <= 0.9) {
+        continue;
+      }
+
+      if (chooseMaterial < diffuse) {
+        addSphere(centre, 0.2, lambertian(Colour::getRandomColour() * Colour::getRandomColour()));
+      }
+      else if (chooseMaterial < diffuse + metal) {
+        auto const albedo = Colour::getRandomColour(0.5, 1);
+        auto const fuzz = getRandomDoubleInRange(0, 0.5);
+        addSphere(centre, 0.2, metallic(albedo, fuzz));
+      }
+      else {
+        addSphere(centre, 0.2, glass);
+      }
+    }
+  }
+
+  addSphere(Point3(0, 1, 0), 1.0, glass);
+  addSphere(Point3(-4, 1, 0), 1.0, lambertian(Colour(0.4, 0.2, 0.1)));
+  addSphere(Point3(4, 1, 0), 1.0, metallic(Colour(0.7, 0.6, 0.5), 0.0));
+
+  return description;
+}
+
+double getSeconds(Clock::time_point start, Clock::time_point end) noexcept
+{
+  return std::chrono::duration<double>(end - start).count();
+}
+
+/// Render a scenario once and measure every phase
+/// \details The scene is prepared by world::World as the application prepares it, so the render goes through the
+/// hierarchy over the spheres and the shapes kept out of it. The BVH cache is left out so that the build is measured
+Result runOnce(Scenario const& scenario, render::Settings const& settings)
+{
+  Result result {scenario.name};
+
+  // The scene is generated from the same seed every time so that every repetition traces the same rays
+  seedRandom(settings.seed);
+  auto description = scenario.describe();
+  description.imgWidth = settings.imgWidth;
+  description.imgHeight = settings.imgHeight;
+  auto const camera = scene::buildCamera(description);
+
+  auto const buildStart = Clock::now();
+  auto const prepared = world::World(std::move(description), {});
+  auto const traceStart = Clock::now();
+
+  stats::reset();
+  auto const framebuffer = render::render(prepared.getHittable(), camera, settings);
+  auto const tonemapStart = Clock::now();
+  auto const image = render::tonemap(framebuffer, settings.samplesPerPixel);
+  auto const writeStart = Clock::now();
+
+  std::ostringstream out;
+  render::writePpm(out, image, settings.imgWidth, settings.imgHeight);
+  auto const end = Clock::now();
+
+  auto const snapshot = stats::collect();
+  result.rays = snapshot[static_cast<std::size_t>(stats::Counter::cameraRays)]
+              + snapshot[static_cast<std::size_t>(stats::Counter::secondaryRays)];
+  result.buildSeconds = getSeconds(buildStart, traceStart);
+  result.traceSeconds = getSeconds(traceStart, tonemapStart);
+  result.tonemapSeconds = getSeconds(tonemapStart, writeStart);
+  result.writeSeconds = getSeconds(writeStart, end);
+
+  return result;
+}
+
+/// Get the peak resident set size of the process in MiB, or zero if it is unknown
+double getPeakRssMiB() noexcept
+{
+#if defined(__APPLE__)
+  rusage usage {};
+  return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0) : 0.0;
+#elif defined(__unix__)
+  rusage usage {};
+  return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<double>(usage.ru_maxrss) / 1024.0 : 0.0;
+#else
+  return 0.0;
+#endif
+}
+
+/// Describe the settings that make results comparable
+std::string describeSettings(render::Settings const& settings)
+{
+  std::ostringstream out;
+  out << settings.imgWidth << 'x' << settings.imgHeight << ' ' << settings.samplesPerPixel << "spp depth"
+      << settings.maxDepth << " seed" << settings.seed;
+
+  if (settings.integrator == render::Integrator::wavefront) {
+    out << " wavefront";
+  }
+
+  if (settings.packetSize != 0) {
+    out << " packet" << settings.packetSize;
+  }
+
+  // Rounding differently, a float build traces different rays
+  if constexpr (std::is_same_v<Scalar, float>) {
+    out << " float";
+  }
+
+  return out.str();
+}
+
+/// Read a baseline written by writeBaseline
+/// \throws std::runtime_error if the file cannot be read
+Baseline readBaseline(std::string const& path)
+{
+  std::ifstream file(path);
+
+  if (not file) {
+    throw std::runtime_error("cannot open baseline " + path);
+  }
+
+  Baseline baseline;
+  std::string line;
+
+  while (std::getline(file, line)) {
+    if (line.starts_with("# settings: ")) {
+      baseline.settings = line.substr(12);
+      continue;
+    }
+
+    if (line.empty() or line.starts_with('#')) {
+      continue;
+    }
+
+    std::istringstream fields(line);
+    Result result;
+    double mraysPerSecond {};
+    fields >> result.name >> result.rays >> mraysPerSecond;
+
+    if (not fields) {
+      throw std::runtime_error("malformed baseline line: " + line);
+    }
+
+    result.traceSeconds = static_cast<double>(result.rays) / (mraysPerSecond * 1e6);
+    baseline.results.emplace(result.name, result);
+  }
+
+  return baseline;
+}
+
+/// Store the results of a run as the baseline of future runs
+void writeBaseline(std::string const& path, render::Settings const& settings, std::vector<Result> const& results)
+{
+  std::ofstream file(path);
+
+  if (not file) {
+    throw std::runtime_error("cannot open baseline " + path + " for writing");
+  }
+
+  file << "# Baseline of renderbench. Its Mrays/s only hold on the machine that recorded it, so regenerate it on\n";
+  file << "# every benchmark machine with renderbench --write-baseline <path>\n";
+  file << "# settings: " << describeSettings(settings) << '\n';
+  file << "# scene rays Mrays/s\n";
+
+  for (auto const& result : results) {
+    file << result.name << ' ' << result.rays << ' ' << std::fixed << std::setprecision(4)
+         << result.getMraysPerSecond() << '\n';
+  }
+}
+
+/// Parse a numeric command line value
+template<typename T>
+T parseNumber(std::string_view flag, std::string_view value)
+{
+  T number {};
+  auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+
+  if (error != std::errc() or end != value.data() + value.size()) {
+    throw std::invalid_argument("invalid value for " + std::string(flag) + ": " + std::string(value));
+  }
+
+  return number;
+}
+
+Arguments parseArguments(std::vector<std::string_view> const& args)
+{
+  Arguments arguments;
+  arguments.settings.imgWidth = 200;
+  arguments.settings.imgHeight = 112;
+  arguments.settings.samplesPerPixel = 16;
+  arguments.settings.maxDepth = 50;
+  arguments.settings.seed = 1;
+  arguments.settings.showProgress = false;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    auto const flag = args[i];
+
+    if (i + 1 >= args.size()) {
+      throw std::invalid_argument("missing value for " + std::string(flag));
+    }
+
+    auto const value = args[++i];
+
+    if (flag == "--baseline") {
+      arguments.baselinePath = value;
+    }
+    else if (flag == "--write-baseline") {
+      arguments.writeBaselinePath = value;
+    }
+    else if (flag == "--tolerance") {
+      arguments.tolerance = parseNumber<double>(flag, value);
+    }
+    else if (flag == "--threads") {
+      arguments.settings.threads = parseNumber<std::size_t>(flag, value);
+    }
+    else if (flag == "--spp") {
+      arguments.settings.samplesPerPixel = std::max<std::size_t>(parseNumber<std::size_t>(flag, value), 1);
+    }
+    else if (flag == "--integrator") {
+      arguments.settings.integrator = render::parseIntegrator(value);
+    }
+    else if (flag == "--packet") {
+      arguments.settings.packetSize = parseNumber<std::size_t>(flag, value);
+    }
+    else if (flag == "--repetitions") {
+      arguments.repetitions = std::max<std::size_t>(parseNumber<std::size_t>(flag, value), 1);
+    }
+    else {
+      throw std::invalid_argument("unknown argument " + std::string(flag));
+    }
+  }
+
+  return arguments;
+}
+
+constexpr std::string_view usage =
+  "usage: renderbench [options]\n"
+  "  --baseline <path>        Compare against a baseline recorded on this machine and fail on regressions or\n"
+  "                           changed ray counts\n"
+  "  --write-baseline <path>  Store the results as the new baseline\n"
+  "  --tolerance <fraction>   The allowed drop in Mrays/s before a run fails. Defaults to 0.05\n"
+  "  --threads <count>        The number of render threads. Defaults to one per core\n"
+  "  --repetitions <count>    Render every scene this many times and keep the fastest. Defaults to 3\n"
+  "  --spp <count>            The number of samples per pixel. Defaults to 16\n"
+  "  --integrator <name>      Trace with the path or the wavefront integrator. Defaults to path\n"
+  "  --packet <size>          Trace the camera rays of the path integrator as packets of this many rays\n";
+
+}   // namespace
+
+/// Render every scenario, report the measurements and compare them against the baseline
+/// \returns EXIT_FAILURE if the throughput of any scenario regressed beyond the tolerance or any scenario traced a
+/// different number of rays than the baseline
+int run(Arguments const& arguments)
+{
+  auto const scenarios = std::vector<Scenario> {
+    {"randomScene", [] { return describeRandomScene(); }              },
+    {"dense",       [] { return describeStressScene(22, 0.8, 0.15); } },
+    {"glass",       [] { return describeStressScene(11, 0.1, 0.1); }  },
+  };
+
+  std::vector<Result> results;
+
+  for (auto const& scenario : scenarios) {
+    auto best = runOnce(scenario, arguments.settings);
+
+    for (std::size_t r = 1; r < arguments.repetitions; ++r) {
+      auto const result = runOnce(scenario, arguments.settings);
+
+      if (result.getWallSeconds() < best.getWallSeconds()) {
+        best = result;
+      }
+    }
+
+    results.push_back(best);
+  }
+
+  std::optional<Baseline> baseline;
+
+  if (not arguments.baselinePath.empty()) {
+    baseline = readBaseline(arguments.baselinePath);
+
+    if (baseline->settings != describeSettings(arguments.settings)) {
+      throw std::runtime_error("the baseline was recorded with different settings (" + baseline->settings + ")");
+    }
+  }
+
+  std::cout << "renderbench " << describeSettings(arguments.settings) << ", best of " << arguments.repetitions
+            << "\n\n";
+  std::cout << std::left << std::setw(14) << "scene" << std::right << std::setw(10) << "wall s" << std::setw(11)
+            << "build ms" << std::setw(11) << "trace ms" << std::setw(12) << "tonemap ms" << std::setw(11)
+            << "write ms" << std::setw(12) << "rays" << std::setw(10) << "Mrays/s" << std::setw(11) << "baseline"
+            << std::setw(9) << "change" << '\n';
+
+  bool regressed = false;
+  bool changed = false;
+
+  for (auto const& result : results) {
+    std::cout << std::left << std::setw(14) << result.name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << result.getWallSeconds() << std::setprecision(1) << std::setw(11)
+              << 1e3 * result.buildSeconds << std::setw(11) << 1e3 * result.traceSeconds << std::setw(12)
+              << 1e3 * result.tonemapSeconds << std::setw(11) << 1e3 * result.writeSeconds << std::setw(12)
+              << result.rays << std::setprecision(3) << std::setw(10) << result.getMraysPerSecond();
+
+    if (baseline) {
+      auto const expected = baseline->results.find(result.name);
+
+      if (expected == baseline->results.end()) {
+        std::cout << std::setw(11) << "-" << std::setw(9) << "new";
+      }
+      else {
+        auto const reference = expected->second.getMraysPerSecond();
+        auto const change = reference > 0 ? result.getMraysPerSecond() / reference - 1 : 0.0;
+
+        std::cout << std::setw(11) << reference << std::setprecision(1) << std::setw(8) << 100 * change << '%';
+
+        if (change < -arguments.tolerance) {
+          std::cout << "  REGRESSION";
+          regressed = true;
+        }
+
+        // The renders are seeded, so a different number of rays means the renderer now does different work
+        if (expected->second.rays != result.rays) {
+          std::cout << "  ray count changed from " << expected->second.rays;
+          changed = true;
+        }
+      }
+    }
+
+    std::cout << '\n' << std::defaultfloat;
+  }
+
+  std::cout << "\npeak RSS " << std::fixed << std::setprecision(1) << getPeakRssMiB() << " MiB\n" << std::defaultfloat;
+
+  if (not arguments.writeBaselinePath.empty()) {
+    writeBaseline(arguments.writeBaselinePath, arguments.settings, results);
+  }
+
+  if (regressed) {
+    std::cout << "Throughput regressed by more than " << 100 * arguments.tolerance << "%\n";
+  }
+
+  if (changed) {
+    std::cout << "The renders traced different rays than the baseline, so the Mrays/s are not comparable. Regenerate\n"
+                 "the baseline if the renderer is meant to do different work now\n";
+  }
+
+  return regressed or changed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}   // namespace rt::benchmarks
+
+int main(int argc, char* argv[])
+{
+  try {
+    std::vector<std::string_view> const args(argv + 1, argv + argc);
+    return rt::benchmarks::run(rt::benchmarks::parseArguments(args));
+  }
+  catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << '\n' << rt::benchmarks::usage;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,103 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Scene.hpp"
+
+#include "BinaryScene.hpp"
+#include "Bvh.hpp"
+#include "Utilities.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+namespace rt::scene {
+
+namespace {
+
+/// Describe a cube filled with small spheres, each with a random material of its own
+Description makeScene(std::size_t sphereCount)
+{
+  Description scene;
+
+  for (std::size_t i = 0; i < sphereCount; ++i) {
+    auto const type = static_cast<MaterialType>(i % 3);
+    auto const albedo = std::array<double, 3> {getRandomDouble(), getRandomDouble(), getRandomDouble()};
+    auto const parameter = type == MaterialType::dielectric ? 1.5 : getRandomDouble();
+    scene.materials.push_back(MaterialData {.type = type, .albedo = albedo, .parameter = parameter});
+
+    auto const centre = std::array<double, 3> {
+      getRandomDoubleInRange(-100, 100), getRandomDoubleInRange(-100, 100), getRandomDoubleInRange(-100, 100)};
+    auto const radius = getRandomDoubleInRange(0.1, 0.5);
+    scene.spheres.push_back(
+      SphereData {.centre = centre, .radius = radius, .material = static_cast<std::uint32_t>(i)});
+  }
+
+  return scene;
+}
+
+}   // namespace
+
+TEST_CASE("parseScene", "[!benchmark][Scene]")
+{
+  seedRandom(1);
+
+  // Every sphere of the text comes with its own material, as in randomScene()
+  static constexpr std::size_t sphereCount = 100'000;
+  std::ostringstream out;
+  writeScene(out, makeScene(sphereCount));
+  auto const text = out.str();
+
+  BENCHMARK("parseScene " + std::to_string(sphereCount) + " spheres, " + std::to_string(text.size() >> 20) + " MiB")
+  {
+    return parseScene(text);
+  };
+
+  auto const scene = parseScene(text);
+
+  BENCHMARK("buildWorld " + std::to_string(sphereCount) + " spheres")
+  {
+    return buildWorld(scene);
+  };
+
+  BENCHMARK("bvh::build " + std::to_string(sphereCount) + " spheres")
+  {
+    return bvh::build(scene.spheres);
+  };
+
+  // Mapping the binary form of the same scene replaces both parsing and building the hierarchy
+  auto const path = std::filesystem::temp_directory_path() / "rt-scene-benchmark.rtscene";
+  auto const tree = bvh::build(scene.spheres);
+  binaryscene::writeScene(path, scene, &tree);
+
+  BENCHMARK("MappedScene " + std::to_string(sphereCount) + " spheres")
+  {
+    return binaryscene::MappedScene(path).getSpheres().size();
+  };
+
+  std::filesystem::remove(path);
+}
+
+}   // namespace rt::scene
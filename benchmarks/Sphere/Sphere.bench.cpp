@@ -0,0 +1,84 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Sphere.hpp"
+
+#include "Colour.hpp"
+#include "Hittable.hpp"
+#include "Lambertian.hpp"
+#include "Ray.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace rt::sphere {
+
+TEST_CASE("Sphere::hit", "[!benchmark][Sphere]")
+{
+  seedRandom(1);
+
+  auto const sphere = Sphere(ray::Point3(0, 0, -1), 0.5, new material::Lambertian(colour::Colour(0.5, 0.5, 0.5)));
+
+  // Jitter the rays so that the compiler cannot fold the intersection away
+  auto const jitter = 0.01 * vec3::Vec3::createRandomVecInRange(-1, 1);
+  auto const towards = ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0, 0, -1) + jitter);
+  auto const away = ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0, 1, 0) + jitter);
+  hittable::HitRecord record;
+
+  BENCHMARK("Sphere::hit hit")
+  {
+    return sphere.hit(towards, 0.001, rt::infinity, record);
+  };
+
+  BENCHMARK("Sphere::hit miss")
+  {
+    return sphere.hit(away, 0.001, rt::infinity, record);
+  };
+}
+
+TEST_CASE("hitSphere precision", "[!benchmark][Sphere]")
+{
+  seedRandom(1);
+
+  auto const jitter = 0.01 * vec3::BasicVec3<double>::createRandomVecInRange(-1, 1);
+  auto const doubleRay =
+    ray::BasicRay<double>(ray::BasicPoint3<double>(0, 0, 0), vec3::BasicVec3<double>(0, 0, -1) + jitter);
+  auto const floatRay = ray::BasicRay<float>(ray::BasicPoint3<float>(0, 0, 0),
+                                             vec3::BasicVec3<float>(jitter.x(), jitter.y(), jitter.z() - 1));
+  hittable::BasicHitRecord<double> doubleRecord;
+  hittable::BasicHitRecord<float> floatRecord;
+
+  BENCHMARK("hitSphere double")
+  {
+    return hitSphere(ray::BasicPoint3<double>(0, 0, -1), 0.5, doubleRay, 0.001, 1e30, doubleRecord);
+  };
+
+  BENCHMARK("hitSphere float")
+  {
+    return hitSphere(ray::BasicPoint3<float>(0, 0, -1), 0.5, floatRay, 0.001, 1e30, floatRecord);
+  };
+}
+
+}   // namespace rt::sphere
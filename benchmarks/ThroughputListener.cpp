@@ -0,0 +1,82 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace rt::benchmarks {
+
+/// Print a table of the mean time per operation of every benchmark and the throughput it implies
+/// \details Every benchmark in this target measures exactly one operation per invocation. The table is printed once
+/// the run has finished so that it does not interleave with the output of the reporter
+class ThroughputListener final : public Catch::EventListenerBase
+{
+public:
+  using Catch::EventListenerBase::EventListenerBase;
+
+  void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override
+  {
+    m_results.push_back(Result {stats.info.name, stats.mean.point.count(), stats.standardDeviation.point.count()});
+  }
+
+  void testRunEnded(Catch::TestRunStats const& /*stats*/) override
+  {
+    if (m_results.empty()) {
+      return;
+    }
+
+    std::cout << '\n'
+              << std::left << std::setw(48) << "benchmark" << std::right << std::setw(12) << "ns/op" << std::setw(12)
+              << "Mops/s" << std::setw(10) << "sd %" << '\n';
+
+    for (auto const& result : m_results) {
+      auto const perSecond = result.nanoseconds > 0 ? 1e3 / result.nanoseconds : 0.0;
+      auto const deviation = result.nanoseconds > 0 ? 100 * result.deviation / result.nanoseconds : 0.0;
+
+      std::cout << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(2)
+                << std::setw(12) << result.nanoseconds << std::setw(12) << perSecond << std::setw(10) << deviation
+                << '\n'
+                << std::defaultfloat;
+    }
+  }
+
+private:
+  struct Result
+  {
+    std::string name;
+    double nanoseconds;
+    double deviation;
+  };
+
+  std::vector<Result> m_results;
+};
+
+CATCH_REGISTER_LISTENER(ThroughputListener)
+
+}   // namespace rt::benchmarks
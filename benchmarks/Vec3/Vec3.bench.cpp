@@ -0,0 +1,86 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Vec3.hpp"
+
+#include "Utilities.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace rt::vec3 {
+
+TEST_CASE("Vec3 arithmetic", "[!benchmark][Vec3]")
+{
+  seedRandom(1);
+
+  auto const u = Vec3::createRandomVecInRange(-1, 1);
+  auto const v = Vec3::createRandomVecInRange(-1, 1);
+
+  BENCHMARK("Vec3 operator+")
+  {
+    return u + v;
+  };
+
+  BENCHMARK("Vec3 operator* (scalar)")
+  {
+    return 1.5 * u;
+  };
+
+  BENCHMARK("Vec3 operator/ (scalar)")
+  {
+    return u / 1.5;
+  };
+
+  BENCHMARK("getDotProduct")
+  {
+    return getDotProduct(u, v);
+  };
+
+  BENCHMARK("getCrossProduct")
+  {
+    return getCrossProduct(u, v);
+  };
+
+  BENCHMARK("Vec3::length")
+  {
+    return u.length();
+  };
+
+  BENCHMARK("getUnitVector")
+  {
+    return getUnitVector(u);
+  };
+
+  BENCHMARK("getReflectedRay")
+  {
+    return getReflectedRay(u, v);
+  };
+
+  BENCHMARK("getRandomUnitVector")
+  {
+    return getRandomUnitVector();
+  };
+}
+
+}   // namespace rt::vec3
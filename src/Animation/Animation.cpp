@@ -0,0 +1,201 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Animation.hpp"
+
+#include "Colour.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rt::animation {
+
+namespace {
+
+/// Evaluate a cubic Hermite segment
+/// \param[in] p1 The value at the start of the segment
+/// \param[in] m1 The tangent at the start, scaled to the length of the segment
+/// \param[in] p2 The value at the end of the segment
+/// \param[in] m2 The tangent at the end, scaled to the length of the segment
+/// \param[in] t How far along the segment, from 0 to 1
+template <typename T>
+T hermite(T const& p1, T const& m1, T const& p2, T const& m2, double t) noexcept
+{
+  auto const t2 = t * t;
+  auto const t3 = t2 * t;
+
+  return (2 * t3 - 3 * t2 + 1) * p1 + (t3 - 2 * t2 + t) * m1 + (-2 * t3 + 3 * t2) * p2 + (t3 - t2) * m2;
+}
+
+/// Get the Catmull-Rom tangent at a keyframe, scaled to the length of the segment it is used for
+/// \details The tangent is the slope between the neighbouring keyframes, so keyframes that are not evenly spaced in
+/// time do not make the camera speed up or slow down as it passes them
+template <typename T>
+T getTangent(T const& previous, double previousFrame, T const& next, double nextFrame, double segmentLength) noexcept
+{
+  return (segmentLength / (nextFrame - previousFrame)) * (next - previous);
+}
+
+}   // namespace
+
+/// Get the camera of a frame of a camera path
+/// \param[in] keyframes The keyframes, in increasing frame order. There must be at least one
+/// \param[in] camera The camera whose view up vector, field of view and aperture every frame keeps
+/// \param[in] frame The frame
+/// \returns The camera of the frame
+scene::CameraData getCamera(std::span<scene::Keyframe const> keyframes, scene::CameraData camera, double frame)
+{
+  auto const set = [&camera](scene::Keyframe const& keyframe) {
+    camera.lookFrom = keyframe.lookFrom;
+    camera.lookAt = keyframe.lookAt;
+    camera.focusDistance = keyframe.focusDistance;
+    return camera;
+  };
+
+  if (frame <= static_cast<double>(keyframes.front().frame)) {
+    return set(keyframes.front());
+  }
+
+  if (frame >= static_cast<double>(keyframes.back().frame)) {
+    return set(keyframes.back());
+  }
+
+  // The segment holding the frame runs from keyframe k to k + 1. The keyframes beyond its ends are repeated at the
+  // ends of the path
+  auto const next = std::upper_bound(keyframes.begin(), keyframes.end(), frame, [](double f, auto const& keyframe) {
+    return f < static_cast<double>(keyframe.frame);
+  });
+  auto const k = static_cast<std::size_t>(next - keyframes.begin()) - 1;
+
+  auto const& k0 = keyframes[k == 0 ? 0 : k - 1];
+  auto const& k1 = keyframes[k];
+  auto const& k2 = keyframes[k + 1];
+  auto const& k3 = keyframes[std::min(k + 2, keyframes.size() - 1)];
+
+  auto const f0 = static_cast<double>(k0.frame);
+  auto const f1 = static_cast<double>(k1.frame);
+  auto const f2 = static_cast<double>(k2.frame);
+  auto const f3 = static_cast<double>(k3.frame);
+  auto const length = f2 - f1;
+  auto const t = (frame - f1) / length;
+
+  auto const interpolate = [&](auto const& p0, auto const& p1, auto const& p2, auto const& p3) {
+    return hermite(p1, getTangent(p0, f0, p2, f2, length), p2, getTangent(p1, f1, p3, f3, length), t);
+  };
+
+  camera.lookFrom = interpolate(k0.lookFrom, k1.lookFrom, k2.lookFrom, k3.lookFrom);
+  camera.lookAt = interpolate(k0.lookAt, k1.lookAt, k2.lookAt, k3.lookAt);
+  camera.focusDistance = interpolate(k0.focusDistance, k1.focusDistance, k2.focusDistance, k3.focusDistance);
+
+  return camera;
+}
+
+/// Get the path a frame of an animation is written to
+/// \param[in] prefix The path prefix of every frame
+/// \param[in] frame The frame
+/// \returns The path <prefix>.<frame>.ppm, with the frame number padded to four digits so the frames sort in order
+std::filesystem::path getFramePath(std::filesystem::path const& prefix, std::size_t frame)
+{
+  char number[24];
+  std::snprintf(number, sizeof(number), ".%04zu.ppm", frame);
+
+  auto path = prefix;
+  path += number;
+
+  return path;
+}
+
+/// Render every frame from the first keyframe of a camera path to the last and write them as PPM images
+/// \param[in] pool The threads to render on
+/// \param[in] world The scene, whose camera supplies what the keyframes leave out
+/// \param[in] keyframes The keyframes, in increasing frame order. There must be at least one
+/// \param[in] settings The resolution and sampling of every frame
+/// \param[in] prefix The path prefix of the frames, which are written to getFramePath
+/// \returns The number of frames written
+/// \throws std::runtime_error if a frame cannot be written
+std::size_t renderAnimation(threadpool::ThreadPool& pool, world::World const& world,
+                            std::span<scene::Keyframe const> keyframes, render::Settings const& settings,
+                            std::filesystem::path const& prefix)
+{
+  auto const first = keyframes.front().frame;
+  auto const last = keyframes.back().frame;
+
+  auto description = scene::getSettings(world.getDescription());
+  description.imgWidth = settings.imgWidth;
+  description.imgHeight = settings.imgHeight;
+
+  // Progress is reported per frame rather than per tile
+  auto frameSettings = settings;
+  frameSettings.showProgress = false;
+
+  std::future<void> writing;
+
+  for (auto frame = first; frame <= last; ++frame) {
+    if (settings.showProgress) {
+      std::clog << "\rFrame " << frame - first + 1 << " of " << last - first + 1 << ' ' << std::flush;
+    }
+
+    description.camera = getCamera(keyframes, world.getDescription().camera, static_cast<double>(frame));
+    auto framebuffer = [&] {
+      auto const span = trace::Span("frame", "animation", static_cast<std::int64_t>(frame));
+      return render::render(pool, world.getHittable(), scene::buildCamera(description), frameSettings);
+    }();
+
+    // The previous frame is finished before this one is handed over, so at most one frame waits to be written
+    if (writing.valid()) {
+      writing.get();
+    }
+
+    auto const path = getFramePath(prefix, frame);
+    writing = std::async(std::launch::async, [framebuffer = std::move(framebuffer), &settings, path] {
+      auto const span = trace::Span("writeFrame", "animation");
+      std::ofstream file(path, std::ios::binary);
+
+      if (not file) {
+        throw std::runtime_error("cannot open " + path.string() + " for writing");
+      }
+
+      render::writePpm(file, render::tonemap(framebuffer, settings.samplesPerPixel), settings.imgWidth,
+                       settings.imgHeight);
+    });
+  }
+
+  if (writing.valid()) {
+    writing.get();
+  }
+
+  if (settings.showProgress) {
+    std::clog << "\rDone.            \n";
+  }
+
+  return last - first + 1;
+}
+
+}   // namespace rt::animation
@@ -0,0 +1,69 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace rt::animation {
+
+/// Get the camera of a frame of a camera path
+/// \details The camera position, target and focus distance follow a Catmull-Rom spline through the keyframes, which
+/// passes through every keyframe with no sudden change of speed. Frames before the first keyframe or after the last
+/// one hold still
+/// \param[in] keyframes The keyframes, in increasing frame order. There must be at least one
+/// \param[in] camera The camera whose view up vector, field of view and aperture every frame keeps
+/// \param[in] frame The frame
+/// \returns The camera of the frame
+scene::CameraData getCamera(std::span<scene::Keyframe const> keyframes, scene::CameraData camera, double frame);
+
+/// Get the path a frame of an animation is written to
+/// \param[in] prefix The path prefix of every frame
+/// \param[in] frame The frame
+/// \returns The path <prefix>.<frame>.ppm, with the frame number padded to four digits so the frames sort in order
+std::filesystem::path getFramePath(std::filesystem::path const& prefix, std::size_t frame);
+
+/// Render every frame from the first keyframe of a camera path to the last and write them as PPM images
+/// \details The scene and the threads are shared by every frame, and each frame is written while the next one is
+/// being traced
+/// \param[in] pool The threads to render on
+/// \param[in] world The scene, whose camera supplies what the keyframes leave out
+/// \param[in] keyframes The keyframes, in increasing frame order. There must be at least one
+/// \param[in] settings The resolution and sampling of every frame
+/// \param[in] prefix The path prefix of the frames, which are written to getFramePath
+/// \returns The number of frames written
+/// \throws std::runtime_error if a frame cannot be written
+std::size_t renderAnimation(threadpool::ThreadPool& pool, world::World const& world,
+                            std::span<scene::Keyframe const> keyframes, render::Settings const& settings,
+                            std::filesystem::path const& prefix);
+
+}   // namespace rt::animation
+
+#endif
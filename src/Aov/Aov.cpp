@@ -0,0 +1,202 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Aov.hpp"
+
+#include "Material.hpp"
+#include "Utilities.hpp"
+#include <array>
+#include <bit>
+#include <cassert>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace rt::aov {
+
+/// Create zeroed AOV buffers for an image of the given dimensions
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+AovBuffers::AovBuffers(std::size_t width, std::size_t height)
+  : m_width(width)
+  , m_height(height)
+  , m_depthSum(width * height)
+  , m_depthCount(width * height)
+  , m_normalSum(width * height)
+  , m_albedoSum(width * height)
+  , m_objectId(width * height, -1)
+  , m_sampleCount(width * height)
+{
+}
+
+/// Accumulate one camera sample into the given pixel
+/// \param[in] i The column of the pixel
+/// \param[in] j The row of the pixel, counted from the bottom of the image
+/// \param[in] ray The camera ray of the sample
+/// \param[in] primaryHit The first intersection of the camera ray. Its t is infinity if the ray escaped
+void AovBuffers::addSample(std::size_t i, std::size_t j, ray::Ray const& ray,
+                           hittable::HitRecord const& primaryHit) noexcept
+{
+  auto const index = getIndex(i, j);
+  bool const isFirstSample = m_sampleCount[index]++ == 0;
+
+  if (primaryHit.t == rt::infinity) {
+    return;
+  }
+
+  m_depthSum[index] += primaryHit.t * ray.getDirection().length();
+  ++m_depthCount[index];
+  m_normalSum[index] += primaryHit.normal;
+  m_albedoSum[index] += primaryHit.materialPtr->getAlbedo();
+
+  if (isFirstSample) {
+    m_objectId[index] = static_cast<std::int64_t>(primaryHit.objectIndex);
+  }
+}
+
+/// Get the average distance from the camera to the first hit of the given pixel
+/// \returns The average depth, or infinity if no sample hit anything
+double AovBuffers::getDepth(std::size_t i, std::size_t j) const noexcept
+{
+  auto const index = getIndex(i, j);
+  return m_depthCount[index] == 0 ? rt::infinity : m_depthSum[index] / m_depthCount[index];
+}
+
+/// Get the average world-space normal at the first hit of the given pixel
+vec3::Vec3 AovBuffers::getNormal(std::size_t i, std::size_t j) const noexcept
+{
+  auto const index = getIndex(i, j);
+  return m_sampleCount[index] == 0 ? vec3::Vec3() : m_normalSum[index] / m_sampleCount[index];
+}
+
+/// Get the average material albedo at the first hit of the given pixel
+colour::Colour AovBuffers::getAlbedo(std::size_t i, std::size_t j) const noexcept
+{
+  auto const index = getIndex(i, j);
+  return m_sampleCount[index] == 0 ? colour::Colour() : (1.0 / m_sampleCount[index]) * m_albedoSum[index];
+}
+
+/// Get the index of the object seen by the first sample of the given pixel
+/// \returns The object index, or -1 if the first sample hit nothing
+std::int64_t AovBuffers::getObjectId(std::size_t i, std::size_t j) const noexcept
+{
+  return m_objectId[getIndex(i, j)];
+}
+
+/// Get the number of samples taken for the given pixel
+std::uint32_t AovBuffers::getSampleCount(std::size_t i, std::size_t j) const noexcept
+{
+  return m_sampleCount[getIndex(i, j)];
+}
+
+/// Write every AOV to its own PFM image named <prefix>.<aov>.pfm
+/// \param[in] prefix The path prefix of the images
+/// \throws std::runtime_error if a file cannot be written
+void AovBuffers::write(std::filesystem::path const& prefix) const
+{
+  auto const pixels = m_width * m_height;
+  std::vector<float> scalar(pixels);
+  std::vector<float> rgb(3 * pixels);
+
+  auto const writeFile = [&](std::string_view aov, std::size_t channels) {
+    auto path = prefix;
+    path += '.';
+    path += aov;
+    path += ".pfm";
+
+    std::ofstream file(path, std::ios::binary);
+
+    if (not file) {
+      throw std::runtime_error("cannot open " + path.string() + " for writing");
+    }
+
+    writePfm(file, m_width, m_height, channels, channels == 1 ? std::span<float const>(scalar) : rgb);
+  };
+
+  for (std::size_t j = 0; j < m_height; ++j) {
+    for (std::size_t i = 0; i < m_width; ++i) {
+      scalar[getIndex(i, j)] = static_cast<float>(getDepth(i, j));
+    }
+  }
+  writeFile("depth", 1);
+
+  for (std::size_t j = 0; j < m_height; ++j) {
+    for (std::size_t i = 0; i < m_width; ++i) {
+      auto const normal = getNormal(i, j);
+      auto const index = getIndex(i, j);
+
+      for (int c = 0; c < 3; ++c) {
+        rgb[3 * index + c] = static_cast<float>(normal[c]);
+      }
+    }
+  }
+  writeFile("normal", 3);
+
+  for (std::size_t j = 0; j < m_height; ++j) {
+    for (std::size_t i = 0; i < m_width; ++i) {
+      auto const albedo = getAlbedo(i, j);
+      auto const index = getIndex(i, j);
+
+      rgb[3 * index] = static_cast<float>(albedo.r());
+      rgb[3 * index + 1] = static_cast<float>(albedo.g());
+      rgb[3 * index + 2] = static_cast<float>(albedo.b());
+    }
+  }
+  writeFile("albedo", 3);
+
+  for (std::size_t index = 0; index < pixels; ++index) {
+    scalar[index] = static_cast<float>(m_objectId[index]);
+  }
+  writeFile("objectid", 1);
+
+  for (std::size_t index = 0; index < pixels; ++index) {
+    scalar[index] = static_cast<float>(m_sampleCount[index]);
+  }
+  writeFile("samples", 1);
+}
+
+/// Write an image of 32-bit floats in the Portable Float Map format
+/// \param[inout] out The binary output stream to write to
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+/// \param[in] channels The number of channels per pixel. Must be either 1 or 3
+/// \param[in] data The pixels of the image, bottom row first
+void writePfm(std::ostream& out, std::size_t width, std::size_t height, std::size_t channels,
+              std::span<float const> data)
+{
+  assert(channels == 1 or channels == 3);
+  assert(data.size() == width * height * channels);
+
+  // A negative scale marks the samples as little-endian
+  out << (channels == 1 ? "Pf" : "PF") << '\n' << width << ' ' << height << "\n-1.0\n";
+
+  for (auto const value : data) {
+    auto const bits = std::bit_cast<std::uint32_t>(value);
+    std::array<char, 4> const bytes {static_cast<char>(bits & 0xff), static_cast<char>((bits >> 8) & 0xff),
+                                     static_cast<char>((bits >> 16) & 0xff), static_cast<char>(bits >> 24)};
+    out.write(bytes.data(), bytes.size());
+  }
+}
+
+}   // namespace rt::aov
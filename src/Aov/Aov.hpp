@@ -0,0 +1,107 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef AOV_HPP
+#define AOV_HPP
+
+#include "Colour.hpp"
+#include "Hittable.hpp"
+#include "Ray.hpp"
+#include "Vec3.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+namespace rt::aov {
+
+/// Auxiliary per-pixel buffers captured from the first hit of every camera path
+/// \details Pixel (i, j) is stored at index j * width + i, with j = 0 being the bottom row of the image
+class AovBuffers
+{
+public:
+  /// Create zeroed AOV buffers for an image of the given dimensions
+  /// \param[in] width The width of the image in pixels
+  /// \param[in] height The height of the image in pixels
+  explicit AovBuffers(std::size_t width, std::size_t height);
+
+  /// Accumulate one camera sample into the given pixel
+  /// \param[in] i The column of the pixel
+  /// \param[in] j The row of the pixel, counted from the bottom of the image
+  /// \param[in] ray The camera ray of the sample
+  /// \param[in] primaryHit The first intersection of the camera ray. Its t is infinity if the ray escaped
+  void addSample(std::size_t i, std::size_t j, ray::Ray const& ray, hittable::HitRecord const& primaryHit) noexcept;
+
+  /// Get the average distance from the camera to the first hit of the given pixel
+  /// \returns The average depth, or infinity if no sample hit anything
+  double getDepth(std::size_t i, std::size_t j) const noexcept;
+
+  /// Get the average world-space normal at the first hit of the given pixel
+  vec3::Vec3 getNormal(std::size_t i, std::size_t j) const noexcept;
+
+  /// Get the average material albedo at the first hit of the given pixel
+  colour::Colour getAlbedo(std::size_t i, std::size_t j) const noexcept;
+
+  /// Get the index of the object seen by the first sample of the given pixel
+  /// \returns The object index, or -1 if the first sample hit nothing
+  std::int64_t getObjectId(std::size_t i, std::size_t j) const noexcept;
+
+  /// Get the number of samples taken for the given pixel
+  std::uint32_t getSampleCount(std::size_t i, std::size_t j) const noexcept;
+
+  /// Write every AOV to its own PFM image named <prefix>.<aov>.pfm
+  /// \param[in] prefix The path prefix of the images
+  /// \throws std::runtime_error if a file cannot be written
+  void write(std::filesystem::path const& prefix) const;
+
+private:
+  std::size_t m_width {};
+  std::size_t m_height {};
+  std::vector<double> m_depthSum;
+  std::vector<std::uint32_t> m_depthCount;
+  std::vector<vec3::Vec3> m_normalSum;
+  std::vector<colour::Colour> m_albedoSum;
+  std::vector<std::int64_t> m_objectId;
+  std::vector<std::uint32_t> m_sampleCount;
+
+  std::size_t getIndex(std::size_t i, std::size_t j) const noexcept
+  {
+    return j * m_width + i;
+  }
+};
+
+/// Write an image of 32-bit floats in the Portable Float Map format
+/// \param[inout] out The binary output stream to write to
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+/// \param[in] channels The number of channels per pixel. Must be either 1 or 3
+/// \param[in] data The pixels of the image, bottom row first
+void writePfm(std::ostream& out, std::size_t width, std::size_t height, std::size_t channels,
+              std::span<float const> data);
+
+}   // namespace rt::aov
+
+#endif
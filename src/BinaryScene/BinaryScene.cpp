@@ -0,0 +1,327 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "BinaryScene.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) or defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define RT_HAS_MMAP 1
+#endif
+
+namespace rt::binaryscene {
+
+namespace {
+
+/// Round an offset up to the start of the next section
+constexpr std::uint64_t alignSection(std::uint64_t offset) noexcept
+{
+  return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+/// Place an array after the end of the previous one
+/// \param[inout] end The end of the previous array. It is moved to the end of this array
+/// \param[in] count The number of elements in the array
+/// \param[in] size The size of an element
+Section placeSection(std::uint64_t& end, std::size_t count, std::size_t size) noexcept
+{
+  auto const section = Section {count == 0 ? 0 : alignSection(end), count};
+
+  if (count != 0) {
+    end = section.offset + count * size;
+  }
+
+  return section;
+}
+
+/// Write an array at its place in the file, padding the file up to it with zeros
+template <typename T>
+void writeSection(std::ofstream& file, Section const& section, std::span<T const> values)
+{
+  if (section.count == 0) {
+    return;
+  }
+
+  static constexpr std::array<char, sectionAlignment> zeros {};
+  auto const position = static_cast<std::uint64_t>(file.tellp());
+  file.write(zeros.data(), static_cast<std::streamsize>(section.offset - position));
+  file.write(reinterpret_cast<char const*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+}
+
+/// Get a typed view of an array of the file
+/// \throws std::runtime_error if the array does not lie within the file
+template <typename T>
+std::span<T const> getSection(void const* data, std::size_t size, Section const& section, char const* name)
+{
+  if (section.count == 0) {
+    return {};
+  }
+
+  if (section.offset % alignof(T) != 0 or section.offset > size
+      or section.count > (size - section.offset) / sizeof(T)) {
+    throw std::runtime_error(std::string("the ") + name + " of the binary scene lie outside of the file");
+  }
+
+  // The arrays were written from objects of the same types, which have no padding and no invariants of their own
+  auto const* const first = static_cast<std::byte const*>(data) + section.offset;
+  return {reinterpret_cast<T const*>(first), static_cast<std::size_t>(section.count)};
+}
+
+}   // namespace
+
+/// Write a scene as a binary scene file
+/// \param[in] path The path of the file to write
+/// \param[in] scene The settings, camera, materials, spheres and shapes of the scene
+/// \param[in] tree The hierarchy built over the spheres of the scene, or null to leave it out of the file
+/// \throws std::runtime_error if the file cannot be written, or the scene has meshes or instances, which the format
+/// cannot hold
+void writeScene(std::filesystem::path const& path, scene::Description const& scene, bvh::Tree const* tree)
+{
+  if (not scene.meshes.empty() or not scene.instances.empty()) {
+    throw std::runtime_error("a binary scene cannot hold meshes or instances");
+  }
+
+  auto const& camera = scene.camera;
+  auto header = Header {};
+  header.magic = magic;
+  header.version = version;
+  header.byteOrder = byteOrderMark;
+  header.imgWidth = scene.imgWidth;
+  header.imgHeight = scene.imgHeight;
+  header.samplesPerPixel = scene.samplesPerPixel;
+  header.maxDepth = scene.maxDepth;
+  header.camera = {
+    camera.lookFrom.x(), camera.lookFrom.y(), camera.lookFrom.z(),
+    camera.lookAt.x(),   camera.lookAt.y(),   camera.lookAt.z(),
+    camera.viewUp.x(),   camera.viewUp.y(),   camera.viewUp.z(),
+    camera.verticalFieldOfView, camera.aperture, camera.focusDistance,
+    camera.shutterOpen, camera.shutterClose,
+  };
+
+  auto const nodes = tree ? std::span<bvh::Node const>(tree->nodes) : std::span<bvh::Node const>();
+  auto const indices = tree ? std::span<std::uint32_t const>(tree->indices) : std::span<std::uint32_t const>();
+
+  std::uint64_t end = sizeof(Header);
+  header.materials = placeSection(end, scene.materials.size(), sizeof(scene::MaterialData));
+  header.spheres = placeSection(end, scene.spheres.size(), sizeof(scene::SphereData));
+  header.nodes = placeSection(end, nodes.size(), sizeof(bvh::Node));
+  header.indices = placeSection(end, indices.size(), sizeof(std::uint32_t));
+  header.shapes = placeSection(end, scene.shapes.size(), sizeof(scene::ShapeData));
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+  if (not file) {
+    throw std::runtime_error("cannot open " + path.string() + " for writing");
+  }
+
+  file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+  writeSection(file, header.materials, std::span<scene::MaterialData const>(scene.materials));
+  writeSection(file, header.spheres, std::span<scene::SphereData const>(scene.spheres));
+  writeSection(file, header.nodes, nodes);
+  writeSection(file, header.indices, indices);
+  writeSection(file, header.shapes, std::span<scene::ShapeData const>(scene.shapes));
+
+  if (not file.flush()) {
+    throw std::runtime_error("cannot write " + path.string());
+  }
+}
+
+/// Check whether a file starts like a binary scene file
+/// \param[in] path The path of the file
+/// \returns true if the file can be read and starts with the binary scene magic
+bool isBinaryScene(std::filesystem::path const& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::array<char, magic.size()> start {};
+
+  return file.read(start.data(), start.size()) and start == magic;
+}
+
+/// Map a binary scene file and check that it is well formed
+/// \param[in] path The path of the file
+/// \throws std::runtime_error if the file cannot be mapped, is from another version or machine, or refers to
+/// anything outside of its arrays
+MappedScene::MappedScene(std::filesystem::path const& path)
+{
+#ifdef RT_HAS_MMAP
+  auto const fd = ::open(path.c_str(), O_RDONLY);
+
+  if (fd == -1) {
+    throw std::runtime_error("cannot open " + path.string());
+  }
+
+  struct stat status {};
+
+  if (::fstat(fd, &status) != 0 or status.st_size < static_cast<off_t>(sizeof(Header))) {
+    ::close(fd);
+    throw std::runtime_error(path.string() + " is too small to be a binary scene");
+  }
+
+  m_size = static_cast<std::size_t>(status.st_size);
+  m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+
+  if (m_data == MAP_FAILED) {
+    m_data = nullptr;
+    throw std::runtime_error("cannot map " + path.string());
+  }
+#else
+  std::ifstream file(path, std::ios::binary);
+
+  if (not file) {
+    throw std::runtime_error("cannot open " + path.string());
+  }
+
+  m_size = static_cast<std::size_t>(std::filesystem::file_size(path));
+
+  if (m_size < sizeof(Header)) {
+    throw std::runtime_error(path.string() + " is too small to be a binary scene");
+  }
+
+  m_data = ::operator new(m_size, std::align_val_t {sectionAlignment});
+
+  if (not file.read(static_cast<char*>(m_data), static_cast<std::streamsize>(m_size))) {
+    ::operator delete(m_data, std::align_val_t {sectionAlignment});
+    m_data = nullptr;
+    throw std::runtime_error("cannot read " + path.string());
+  }
+#endif
+
+  try {
+    m_header = static_cast<Header const*>(m_data);
+
+    if (m_header->magic != magic) {
+      throw std::runtime_error("it is not a binary scene");
+    }
+
+    if (m_header->byteOrder != byteOrderMark) {
+      throw std::runtime_error("it was written on a machine with a different byte order");
+    }
+
+    if (m_header->version != version) {
+      throw std::runtime_error("it has version " + std::to_string(m_header->version) + " but version "
+                               + std::to_string(version) + " is expected");
+    }
+
+    if (m_header->imgWidth < 2 or m_header->imgHeight < 2 or m_header->maxDepth < 0
+        or m_header->maxDepth > std::numeric_limits<int>::max()) {
+      throw std::runtime_error("its image settings are invalid");
+    }
+
+    auto const& camera = m_header->camera;
+
+    if (not(0 <= camera[12] and camera[12] <= camera[13] and camera[13] <= 1)) {
+      throw std::runtime_error("its shutter interval is invalid");
+    }
+
+    m_materials = getSection<scene::MaterialData>(m_data, m_size, m_header->materials, "materials");
+    m_spheres = getSection<scene::SphereData>(m_data, m_size, m_header->spheres, "spheres");
+    m_nodes = getSection<bvh::Node>(m_data, m_size, m_header->nodes, "nodes");
+    m_indices = getSection<std::uint32_t>(m_data, m_size, m_header->indices, "indices");
+    m_shapes = getSection<scene::ShapeData>(m_data, m_size, m_header->shapes, "shapes");
+
+    auto const materialCount = m_materials.size();
+
+    if (std::any_of(m_materials.begin(), m_materials.end(), [](scene::MaterialData const& material) {
+          return material.type > scene::MaterialType::dielectric;
+        })) {
+      throw std::runtime_error("it has a material of an unknown type");
+    }
+
+    if (std::any_of(m_spheres.begin(), m_spheres.end(),
+                    [materialCount](scene::SphereData const& sphere) { return sphere.material >= materialCount; })) {
+      throw std::runtime_error("a sphere refers to a material that does not exist");
+    }
+
+    if (std::any_of(m_shapes.begin(), m_shapes.end(), [materialCount](scene::ShapeData const& shape) {
+          return shape.type > scene::ShapeType::box or shape.material >= materialCount
+              or (shape.type != scene::ShapeType::box and shape.vector == std::array<double, 3> {});
+        })) {
+      throw std::runtime_error("a shape is of an unknown type, has no normal or refers to a material that does not "
+                               "exist");
+    }
+
+    if (not m_nodes.empty() and not bvh::isValid(m_nodes, m_indices, m_spheres.size())) {
+      throw std::runtime_error("its hierarchy refers to nodes or spheres that do not exist");
+    }
+  }
+  catch (std::runtime_error const& error) {
+    release();
+    throw std::runtime_error("cannot use " + path.string() + " as a binary scene: " + error.what());
+  }
+}
+
+MappedScene::~MappedScene()
+{
+  release();
+}
+
+/// Unmap the file
+void MappedScene::release() noexcept
+{
+  if (m_data == nullptr) {
+    return;
+  }
+
+#ifdef RT_HAS_MMAP
+  ::munmap(m_data, m_size);
+#else
+  ::operator delete(m_data, std::align_val_t {sectionAlignment});
+#endif
+
+  m_data = nullptr;
+}
+
+/// Get the settings and camera of the scene
+/// \returns A description without materials or objects
+scene::Description MappedScene::getSettings() const noexcept
+{
+  auto const& c = m_header->camera;
+  scene::Description description;
+
+  description.imgWidth = m_header->imgWidth;
+  description.imgHeight = m_header->imgHeight;
+  description.samplesPerPixel = m_header->samplesPerPixel;
+  description.maxDepth = static_cast<int>(m_header->maxDepth);
+  description.camera.lookFrom = ray::Point3(c[0], c[1], c[2]);
+  description.camera.lookAt = ray::Point3(c[3], c[4], c[5]);
+  description.camera.viewUp = vec3::Vec3(c[6], c[7], c[8]);
+  description.camera.verticalFieldOfView = c[9];
+  description.camera.aperture = c[10];
+  description.camera.focusDistance = c[11];
+  description.camera.shutterOpen = c[12];
+  description.camera.shutterClose = c[13];
+
+  return description;
+}
+
+}   // namespace rt::binaryscene
@@ -0,0 +1,161 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef BINARY_SCENE_HPP
+#define BINARY_SCENE_HPP
+
+#include "Bvh.hpp"
+#include "Scene.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+
+namespace rt::binaryscene {
+
+/// The first bytes of every binary scene file
+inline constexpr std::array<char, 8> magic {'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+
+/// The version of the layout written by writeScene
+inline constexpr std::uint32_t version = 3;
+
+/// Written in native byte order so that files from a machine of the other byte order are recognised
+inline constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+/// Every array starts at a multiple of this offset from the start of the file
+inline constexpr std::size_t sectionAlignment = 64;
+
+/// The position and length of an array in a binary scene file
+struct Section
+{
+  std::uint64_t offset;
+  std::uint64_t count;
+};
+
+/// The start of a binary scene file. The arrays of the scene follow it
+/// \details Everything is stored in the byte order and floating point format of the machine that wrote the file
+struct Header
+{
+  std::array<char, 8> magic;
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+
+  std::uint64_t imgWidth;
+  std::uint64_t imgHeight;
+  std::uint64_t samplesPerPixel;
+  std::int64_t maxDepth;
+
+  /// Look from, look at and view up, followed by the vertical field of view, aperture, focus distance and the times
+  /// the shutter opens and closes at
+  std::array<double, 14> camera;
+
+  /// An array of scene::MaterialData
+  Section materials;
+  /// An array of scene::SphereData
+  Section spheres;
+  /// An array of bvh::Node. Empty if the file has no prebuilt hierarchy
+  Section nodes;
+  /// The sphere indices of the hierarchy, as std::uint32_t
+  Section indices;
+  /// An array of scene::ShapeData
+  Section shapes;
+};
+
+static_assert(std::is_trivially_copyable_v<Header> and sizeof(Header) == 240);
+
+/// Write a scene as a binary scene file
+/// \param[in] path The path of the file to write
+/// \param[in] scene The settings, camera, materials, spheres and shapes of the scene
+/// \param[in] tree The hierarchy built over the spheres of the scene, or null to leave it out of the file
+/// \throws std::runtime_error if the file cannot be written, or the scene has meshes or instances, which the format
+/// cannot hold
+void writeScene(std::filesystem::path const& path, scene::Description const& scene, bvh::Tree const* tree);
+
+/// Check whether a file starts like a binary scene file
+/// \param[in] path The path of the file
+/// \returns true if the file can be read and starts with the binary scene magic
+bool isBinaryScene(std::filesystem::path const& path);
+
+/// A binary scene file mapped into memory. The arrays of the scene are used where they lie in the file
+class MappedScene
+{
+public:
+  /// Map a binary scene file and check that it is well formed
+  /// \param[in] path The path of the file
+  /// \throws std::runtime_error if the file cannot be mapped, is from another version or machine, or refers to
+  /// anything outside of its arrays
+  explicit MappedScene(std::filesystem::path const& path);
+  ~MappedScene();
+
+  MappedScene(MappedScene const&) = delete;
+  MappedScene& operator=(MappedScene const&) = delete;
+
+  /// Get the settings and camera of the scene
+  /// \returns A description without materials or objects
+  scene::Description getSettings() const noexcept;
+
+  std::span<scene::MaterialData const> getMaterials() const noexcept
+  {
+    return m_materials;
+  }
+
+  std::span<scene::SphereData const> getSpheres() const noexcept
+  {
+    return m_spheres;
+  }
+
+  std::span<scene::ShapeData const> getShapes() const noexcept
+  {
+    return m_shapes;
+  }
+
+  /// Get the nodes of the prebuilt hierarchy, which are empty if the file has none
+  std::span<bvh::Node const> getNodes() const noexcept
+  {
+    return m_nodes;
+  }
+
+  std::span<std::uint32_t const> getIndices() const noexcept
+  {
+    return m_indices;
+  }
+
+private:
+  /// Unmap the file
+  void release() noexcept;
+
+  void* m_data {nullptr};
+  std::size_t m_size {0};
+  Header const* m_header {nullptr};
+  std::span<scene::MaterialData const> m_materials;
+  std::span<scene::SphereData const> m_spheres;
+  std::span<bvh::Node const> m_nodes;
+  std::span<std::uint32_t const> m_indices;
+  std::span<scene::ShapeData const> m_shapes;
+};
+
+}   // namespace rt::binaryscene
+
+#endif
@@ -0,0 +1,926 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Bvh.hpp"
+
+#include "Dispatch.hpp"
+#include "Sphere.hpp"
+#include "Stats.hpp"
+#include "Vec3.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace rt::bvh {
+
+namespace {
+
+/// The most spheres a leaf is allowed to hold
+constexpr std::size_t maxLeafSize = 8;
+
+/// The number of buckets the centroids are binned into when looking for the cheapest split
+constexpr std::size_t binCount = 12;
+
+/// Below this depth splits are chosen by the surface area heuristic. Deeper nodes are split in half, which bounds the
+/// depth of the hierarchy and so the size of the traversal stack
+constexpr std::size_t maxHeuristicDepth = 48;
+
+/// The most spheres a dynamic hierarchy lets a leaf grow to before it builds itself again
+constexpr std::size_t maxDynamicLeafSize = 4 * maxLeafSize;
+
+/// Marks a sphere that is not in a dynamic hierarchy
+constexpr auto noLeaf = std::numeric_limits<std::uint32_t>::max();
+
+/// The packet kernels are written with the vector extension of GCC and Clang. Other compilers trace the lanes of a
+/// packet one at a time
+#if defined(__GNUC__) or defined(__clang__)
+  #define RT_LANE_VECTORS 1
+
+/// The lanes of a packet are traced this many at a time, as many doubles as an AVX2 register holds. Wider vectors of
+/// GCC's extension are not all lowered to whole registers
+constexpr std::size_t laneGroupSize = 4;
+
+/// A value of type T for each lane of a group. Arithmetic on these compiles to the registers of the instruction set the
+/// packet kernels run with, and comparisons give lanes of all ones or all zeros
+template <typename T>
+struct LaneGroup
+{
+  typedef T Type __attribute__((vector_size(laneGroupSize * sizeof(T))));
+};
+#endif
+
+/// Get the box a sphere stays within from time 0 to time 1
+Box getBounds(scene::SphereData const& sphere) noexcept
+{
+  auto const r = std::abs(sphere.radius);
+  auto const& c = sphere.centre;
+  auto const& v = sphere.velocity;
+  auto const e = std::array<double, 3> {c[0] + v[0], c[1] + v[1], c[2] + v[2]};
+
+  // The sphere moves in a straight line, so the boxes around both ends of its path bound the whole of it
+  auto bounds = Box {{c[0] - r, c[1] - r, c[2] - r}, {c[0] + r, c[1] + r, c[2] + r}};
+  bounds.grow(Box {{e[0] - r, e[1] - r, e[2] - r}, {e[0] + r, e[1] + r, e[2] + r}});
+
+  return bounds;
+}
+
+/// Get the point a sphere is binned by, which is the middle of its path
+std::array<double, 3> getCentroid(scene::SphereData const& sphere) noexcept
+{
+  auto const& c = sphere.centre;
+  auto const& v = sphere.velocity;
+
+  return {c[0] + 0.5 * v[0], c[1] + 0.5 * v[1], c[2] + 0.5 * v[2]};
+}
+
+/// The spheres a hierarchy is built over
+class SpherePrimitives
+{
+public:
+  explicit SpherePrimitives(std::span<scene::SphereData const> spheres) noexcept : m_spheres(spheres)
+  {
+  }
+
+  Box getBounds(std::uint32_t index) const noexcept
+  {
+    return bvh::getBounds(m_spheres[index]);
+  }
+
+  std::array<double, 3> getCentroid(std::uint32_t index) const noexcept
+  {
+    return bvh::getCentroid(m_spheres[index]);
+  }
+
+private:
+  std::span<scene::SphereData const> m_spheres;
+};
+
+/// The boxes a hierarchy is built over, binned by their middles
+class BoxPrimitives
+{
+public:
+  explicit BoxPrimitives(std::span<Box const> boxes) noexcept : m_boxes(boxes)
+  {
+  }
+
+  Box getBounds(std::uint32_t index) const noexcept
+  {
+    return m_boxes[index];
+  }
+
+  std::array<double, 3> getCentroid(std::uint32_t index) const noexcept
+  {
+    auto const& box = m_boxes[index];
+
+    return {0.5 * (box.lower[0] + box.upper[0]), 0.5 * (box.lower[1] + box.upper[1]),
+            0.5 * (box.lower[2] + box.upper[2])};
+  }
+
+private:
+  std::span<Box const> m_boxes;
+};
+
+/// Builds the nodes of a hierarchy depth first
+/// \tparam Primitives Gives the bounds and centroid of every primitive by its index
+template <typename Primitives>
+class Builder
+{
+public:
+  Builder(Primitives const& primitives, Tree& tree) noexcept : m_primitives(primitives), m_tree(tree)
+  {
+  }
+
+  /// Build the subtree over the primitives in [begin, end) of the index array
+  void build(std::size_t begin, std::size_t end, std::size_t depth)
+  {
+    auto const nodeIndex = m_tree.nodes.size();
+    m_tree.nodes.emplace_back();
+
+    Box bounds;
+    Box centroids;
+
+    for (auto i = begin; i < end; ++i) {
+      auto const index = m_tree.indices[i];
+      bounds.grow(m_primitives.getBounds(index));
+      centroids.grow(m_primitives.getCentroid(index));
+    }
+
+    auto const count = end - begin;
+    auto split = count <= 1 ? end : findSplit(begin, end, bounds, centroids, depth);
+    auto const axis = static_cast<std::uint16_t>(m_axis);
+
+    if (split == end) {
+      if (count <= std::numeric_limits<std::uint16_t>::max()) {
+        setNode(nodeIndex, bounds, static_cast<std::uint32_t>(begin), static_cast<std::uint16_t>(count), 0);
+        return;
+      }
+
+      // Too many primitives share a centroid to fit in one leaf, so split them in half regardless
+      split = begin + count / 2;
+    }
+
+    build(begin, split, depth + 1);
+    auto const secondChild = m_tree.nodes.size();
+    build(split, end, depth + 1);
+
+    setNode(nodeIndex, bounds, static_cast<std::uint32_t>(secondChild), 0, axis);
+  }
+
+private:
+  void setNode(std::size_t index, Box const& bounds, std::uint32_t offset, std::uint16_t count,
+               std::uint16_t axis) noexcept
+  {
+    m_tree.nodes[index] = Node {bounds.lower, bounds.upper, offset, count, axis};
+  }
+
+  /// Partition the primitives in [begin, end) into two children
+  /// \returns The position of the first primitive of the second child, or end if they should stay in one leaf
+  std::size_t findSplit(std::size_t begin, std::size_t end, Box const& bounds, Box const& centroids,
+                        std::size_t depth)
+  {
+    auto const count = end - begin;
+    auto const first = m_tree.indices.begin() + static_cast<std::ptrdiff_t>(begin);
+    auto const last = m_tree.indices.begin() + static_cast<std::ptrdiff_t>(end);
+
+    // Split along the axis the centroids spread furthest
+    std::size_t axis = 0;
+
+    for (std::size_t a = 1; a < 3; ++a) {
+      if (centroids.upper[a] - centroids.lower[a] > centroids.upper[axis] - centroids.lower[axis]) {
+        axis = a;
+      }
+    }
+
+    m_axis = axis;
+    auto const extent = centroids.upper[axis] - centroids.lower[axis];
+
+    if (extent <= 0) {
+      return end;
+    }
+
+    if (depth >= maxHeuristicDepth) {
+      auto const middle = first + static_cast<std::ptrdiff_t>(count / 2);
+      std::nth_element(first, middle, last, [this, axis](std::uint32_t a, std::uint32_t b) {
+        return m_primitives.getCentroid(a)[axis] < m_primitives.getCentroid(b)[axis];
+      });
+
+      return begin + count / 2;
+    }
+
+    auto const getBin = [&](std::uint32_t index) {
+      auto const t = (m_primitives.getCentroid(index)[axis] - centroids.lower[axis]) / extent;
+      return std::min(static_cast<std::size_t>(t * binCount), binCount - 1);
+    };
+
+    std::array<Box, binCount> binBounds;
+    std::array<std::size_t, binCount> binCounts {};
+
+    for (auto it = first; it != last; ++it) {
+      auto const bin = getBin(*it);
+      binBounds[bin].grow(m_primitives.getBounds(*it));
+      ++binCounts[bin];
+    }
+
+    // Sweep from the right to get the area and count of every right-hand side, then from the left to find the split
+    // with the lowest expected number of intersection tests
+    std::array<double, binCount> rightAreas {};
+    std::array<std::size_t, binCount> rightCounts {};
+    Box right;
+    std::size_t rightCount = 0;
+
+    for (auto bin = binCount - 1; bin > 0; --bin) {
+      right.grow(binBounds[bin]);
+      rightCount += binCounts[bin];
+      rightAreas[bin] = right.getSurfaceArea();
+      rightCounts[bin] = rightCount;
+    }
+
+    Box left;
+    std::size_t leftCount = 0;
+    auto bestCost = std::numeric_limits<double>::infinity();
+    std::size_t bestBin = 0;
+
+    for (std::size_t bin = 1; bin < binCount; ++bin) {
+      left.grow(binBounds[bin - 1]);
+      leftCount += binCounts[bin - 1];
+
+      auto const cost = left.getSurfaceArea() * static_cast<double>(leftCount)
+                      + rightAreas[bin] * static_cast<double>(rightCounts[bin]);
+
+      if (leftCount > 0 and rightCounts[bin] > 0 and cost < bestCost) {
+        bestCost = cost;
+        bestBin = bin;
+      }
+    }
+
+    // Visiting a node costs about as much as testing one sphere
+    auto const leafCost = static_cast<double>(count);
+    auto const splitCost = 1.0 + bestCost / bounds.getSurfaceArea();
+
+    if (bestBin == 0 or (count <= maxLeafSize and splitCost >= leafCost)) {
+      return count <= maxLeafSize ? end : begin + partitionInHalf(first, last, axis);
+    }
+
+    auto const middle = std::partition(first, last, [&](std::uint32_t index) { return getBin(index) < bestBin; });
+
+    return static_cast<std::size_t>(middle - m_tree.indices.begin());
+  }
+
+  /// Split primitives whose centroids all fall in one bin at their median
+  std::size_t partitionInHalf(std::vector<std::uint32_t>::iterator first, std::vector<std::uint32_t>::iterator last,
+                              std::size_t axis)
+  {
+    auto const half = (last - first) / 2;
+    std::nth_element(first, first + half, last, [this, axis](std::uint32_t a, std::uint32_t b) {
+      return m_primitives.getCentroid(a)[axis] < m_primitives.getCentroid(b)[axis];
+    });
+
+    return static_cast<std::size_t>(half);
+  }
+
+  Primitives const& m_primitives;
+  Tree& m_tree;
+  std::size_t m_axis {0};
+};
+
+}   // namespace
+
+/// Build a bounding volume hierarchy over a set of spheres with the surface area heuristic
+/// \param[in] spheres The spheres
+/// \returns The hierarchy. It has no nodes if there are no spheres
+Tree build(std::span<scene::SphereData const> spheres)
+{
+  std::vector<std::uint32_t> indices(spheres.size());
+  std::iota(indices.begin(), indices.end(), std::uint32_t {0});
+
+  return build(spheres, std::move(indices));
+}
+
+/// Build a bounding volume hierarchy over some of a set of spheres with the surface area heuristic
+/// \param[in] spheres The spheres
+/// \param[in] indices The indices of the spheres to build the hierarchy over
+/// \returns The hierarchy. It has no nodes if there are no indices
+Tree build(std::span<scene::SphereData const> spheres, std::vector<std::uint32_t> indices)
+{
+  Tree tree;
+
+  if (indices.empty()) {
+    return tree;
+  }
+
+  tree.indices = std::move(indices);
+  tree.nodes.reserve(2 * tree.indices.size());
+  Builder(SpherePrimitives(spheres), tree).build(0, tree.indices.size(), 0);
+  tree.nodes.shrink_to_fit();
+
+  return tree;
+}
+
+/// Build a bounding volume hierarchy over a set of boxes with the surface area heuristic
+/// \param[in] boxes The boxes. They are binned by their middles
+/// \returns The hierarchy, whose leaves refer to the boxes by their indices. It has no nodes if there are no boxes
+Tree buildOverBoxes(std::span<Box const> boxes)
+{
+  Tree tree;
+
+  if (boxes.empty()) {
+    return tree;
+  }
+
+  tree.indices.resize(boxes.size());
+  std::iota(tree.indices.begin(), tree.indices.end(), std::uint32_t {0});
+  tree.nodes.reserve(2 * tree.indices.size());
+  Builder(BoxPrimitives(boxes), tree).build(0, tree.indices.size(), 0);
+  tree.nodes.shrink_to_fit();
+
+  return tree;
+}
+
+/// Check that a hierarchy only refers to nodes and spheres that exist
+/// \param[in] nodes The nodes of the hierarchy
+/// \param[in] indices The sphere indices of the hierarchy
+/// \param[in] sphereCount The number of spheres the hierarchy was built over
+/// \returns true if every node and index is in range
+bool isValid(std::span<Node const> nodes, std::span<std::uint32_t const> indices, std::size_t sphereCount) noexcept
+{
+  if (nodes.empty() != (sphereCount == 0) or indices.size() != sphereCount) {
+    return false;
+  }
+
+  // Children always come after their parent, so the depth of every node is known by the time it is reached
+  std::vector<std::uint8_t> depths(nodes.size());
+
+  for (std::size_t n = 0; n < nodes.size(); ++n) {
+    auto const& node = nodes[n];
+
+    if (node.count > 0) {
+      if (std::size_t {node.offset} + node.count > indices.size()) {
+        return false;
+      }
+
+      continue;
+    }
+
+    if (n + 1 >= nodes.size() or node.offset <= n + 1 or node.offset >= nodes.size() or node.axis > 2
+        or depths[n] + 1u >= stackSize) {
+      return false;
+    }
+
+    auto const childDepth = static_cast<std::uint8_t>(depths[n] + 1);
+    depths[n + 1] = std::max(depths[n + 1], childDepth);
+    depths[node.offset] = std::max(depths[node.offset], childDepth);
+  }
+
+  return std::all_of(indices.begin(), indices.end(), [sphereCount](std::uint32_t i) { return i < sphereCount; });
+}
+
+/// Build a hierarchy over a set of spheres
+/// \param[in] spheres The spheres
+DynamicTree::DynamicTree(std::span<scene::SphereData const> spheres) : m_leaves(spheres.size(), 0)
+{
+  rebuild(spheres);
+}
+
+/// Refit the hierarchy to a sphere that moved or changed size
+/// \param[in] spheres The spheres, including the one that changed
+/// \param[in] sphere The index of the sphere that changed
+/// \pre The sphere is in the hierarchy
+void DynamicTree::update(std::span<scene::SphereData const> spheres, std::uint32_t sphere)
+{
+  refit(spheres, m_leaves[sphere]);
+  countEdit(spheres);
+}
+
+/// Add a sphere to the hierarchy
+/// \param[in] spheres The spheres, including the new one
+/// \param[in] sphere The index of the new sphere, which is one past that of every sphere added before it
+void DynamicTree::insert(std::span<scene::SphereData const> spheres, std::uint32_t sphere)
+{
+  m_leaves.resize(std::max<std::size_t>(m_leaves.size(), sphere + 1), noLeaf);
+  m_leaves[sphere] = 0;
+  ++m_sphereCount;
+
+  if (m_tree.nodes.empty()) {
+    rebuild(spheres);
+    return;
+  }
+
+  // Go down the side whose bounds grow the least to take the sphere in
+  auto const bounds = getBounds(spheres[sphere]);
+  std::uint32_t current = 0;
+
+  while (m_tree.nodes[current].count == 0) {
+    auto const getGrowth = [&](std::uint32_t node) {
+      auto grown = Box::of(m_tree.nodes[node]);
+      grown.grow(bounds);
+      return grown.getSurfaceArea() - Box::of(m_tree.nodes[node]).getSurfaceArea();
+    };
+
+    auto const first = current + 1;
+    auto const second = m_tree.nodes[current].offset;
+    current = getGrowth(second) < getGrowth(first) ? second : first;
+  }
+
+  auto& leaf = m_tree.nodes[current];
+
+  if (leaf.count >= maxDynamicLeafSize) {
+    rebuild(spheres);
+    return;
+  }
+
+  // A full leaf moves its indices to the end of the index array, where it has room to grow
+  if (leaf.count == m_capacities[current]) {
+    auto const offset = m_tree.indices.size();
+    m_tree.indices.resize(offset + 2 * std::size_t {leaf.count});
+    std::copy_n(m_tree.indices.begin() + static_cast<std::ptrdiff_t>(leaf.offset), leaf.count,
+                m_tree.indices.begin() + static_cast<std::ptrdiff_t>(offset));
+    leaf.offset = static_cast<std::uint32_t>(offset);
+    m_capacities[current] = 2 * std::uint32_t {leaf.count};
+  }
+
+  m_tree.indices[leaf.offset + leaf.count] = sphere;
+  ++leaf.count;
+  m_leaves[sphere] = current;
+  refit(spheres, current);
+  countEdit(spheres);
+}
+
+/// Take a sphere out of the hierarchy. Its index is not reused
+/// \param[in] spheres The spheres
+/// \param[in] sphere The index of the sphere
+/// \pre The sphere is in the hierarchy
+void DynamicTree::remove(std::span<scene::SphereData const> spheres, std::uint32_t sphere)
+{
+  auto const current = m_leaves[sphere];
+  auto& leaf = m_tree.nodes[current];
+  m_leaves[sphere] = noLeaf;
+  --m_sphereCount;
+
+  // A leaf cannot be left empty, as a node without spheres is an interior node
+  if (leaf.count == 1) {
+    rebuild(spheres);
+    return;
+  }
+
+  auto const first = m_tree.indices.begin() + static_cast<std::ptrdiff_t>(leaf.offset);
+  auto const last = first + leaf.count;
+  std::iter_swap(std::find(first, last, sphere), last - 1);
+  --leaf.count;
+  refit(spheres, current);
+  countEdit(spheres);
+}
+
+/// Check whether a sphere is in the hierarchy
+/// \param[in] sphere The index of the sphere
+/// \returns false if the sphere was removed or never added
+bool DynamicTree::contains(std::uint32_t sphere) const noexcept
+{
+  return sphere < m_leaves.size() and m_leaves[sphere] != noLeaf;
+}
+
+/// Build the hierarchy again over the spheres it holds
+void DynamicTree::rebuild(std::span<scene::SphereData const> spheres)
+{
+  std::vector<std::uint32_t> indices;
+  indices.reserve(m_sphereCount);
+
+  for (std::uint32_t i = 0; i < m_leaves.size(); ++i) {
+    if (m_leaves[i] != noLeaf) {
+      indices.push_back(i);
+    }
+  }
+
+  m_tree = build(spheres, std::move(indices));
+  m_sphereCount = m_tree.indices.size();
+  m_edits = 0;
+  m_parents.assign(m_tree.nodes.size(), 0);
+  m_capacities.assign(m_tree.nodes.size(), 0);
+
+  for (std::uint32_t n = 0; n < m_tree.nodes.size(); ++n) {
+    auto const& node = m_tree.nodes[n];
+
+    if (node.count == 0) {
+      m_parents[n + 1] = n;
+      m_parents[node.offset] = n;
+      continue;
+    }
+
+    m_capacities[n] = node.count;
+
+    for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+      m_leaves[m_tree.indices[k]] = n;
+    }
+  }
+}
+
+/// Recompute the bounds of a node and of every node above it
+void DynamicTree::refit(std::span<scene::SphereData const> spheres, std::uint32_t node) noexcept
+{
+  while (true) {
+    auto& current = m_tree.nodes[node];
+    Box bounds;
+
+    if (current.count == 0) {
+      bounds = Box::of(m_tree.nodes[node + 1]);
+      bounds.grow(Box::of(m_tree.nodes[current.offset]));
+    }
+    else {
+      for (std::uint32_t k = current.offset; k < current.offset + current.count; ++k) {
+        bounds.grow(getBounds(spheres[m_tree.indices[k]]));
+      }
+    }
+
+    current.lower = bounds.lower;
+    current.upper = bounds.upper;
+
+    if (node == 0) {
+      return;
+    }
+
+    node = m_parents[node];
+  }
+}
+
+/// Count an edit, and build the hierarchy again once the edits may have loosened it
+void DynamicTree::countEdit(std::span<scene::SphereData const> spheres)
+{
+  // Rebuilding after a quarter as many edits as there are spheres keeps the cost of the rebuilds in proportion to
+  // that of the edits. Leaves that moved to the end of the index array leave their old entries unused, which the
+  // rebuild also reclaims
+  if (++m_edits > std::max<std::size_t>(64, m_sphereCount / 4) or m_tree.indices.size() > 2 * m_sphereCount + 64) {
+    rebuild(spheres);
+  }
+}
+
+/// Create a view of a set of spheres and their hierarchy
+/// \param[in] spheres The spheres
+/// \param[in] nodes The nodes of the hierarchy built over the spheres
+/// \param[in] indices The sphere indices of the hierarchy
+/// \param[in] materials The material objects the spheres refer to
+/// \pre The hierarchy and the material indices of the spheres are valid
+SphereBvh::SphereBvh(std::span<scene::SphereData const> spheres, std::span<Node const> nodes,
+                     std::span<std::uint32_t const> indices, std::span<material::Material* const> materials) noexcept
+  : m_spheres(spheres)
+  , m_nodes(nodes)
+  , m_indices(indices)
+  , m_materials(materials)
+{
+}
+
+/// Find the nearest sphere a ray hits
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection. Its object index is the index of the sphere
+/// \returns true if there was an intersection and false otherwise
+bool SphereBvh::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  if (m_nodes.empty()) {
+    return false;
+  }
+
+  return dispatch::run([&]() noexcept { return traverse(ray, tMin, tMax, record); });
+}
+
+/// Find the nearest sphere each ray of a stream hits
+/// \param[in] rays The rays
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+/// \param[out] records Receives the nearest intersection of every ray, at the index of the ray. Their object indices
+/// are the indices of the spheres, and the distance of the record of a ray that hits nothing is set to infinity
+/// \returns The number of rays that hit something
+/// \details The whole stream is traced in one call of the traversal compiled for the selected instruction set
+std::size_t SphereBvh::hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                                 std::span<hittable::HitRecord> records) const noexcept
+{
+  if (m_nodes.empty()) {
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      records[i].t = std::numeric_limits<Scalar>::infinity();
+    }
+
+    return 0;
+  }
+
+  return dispatch::run([&]() noexcept {
+    std::size_t hits = 0;
+
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      if (traverse(rays[i], tMin, tMax[i], records[i])) {
+        ++hits;
+      }
+      else {
+        records[i].t = std::numeric_limits<Scalar>::infinity();
+      }
+    }
+
+    return hits;
+  });
+}
+
+/// Get the box the spheres stay within from time 0 to time 1
+/// \returns The bounds of the root of the hierarchy, or an empty box if there are no spheres
+Box SphereBvh::getBounds() const noexcept
+{
+  return m_nodes.empty() ? Box {} : Box::of(m_nodes[0]);
+}
+
+/// Walk the hierarchy for the nearest sphere a ray hits. hit runs it compiled for the selected instruction set
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection. Its object index is the index of the sphere
+/// \returns true if there was an intersection and false otherwise
+/// \pre The hierarchy has at least one node
+bool SphereBvh::traverse(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  auto const time = ray.getTime();
+
+  return bvh::traverse(m_nodes, ray, tMin, tMax, [&](std::uint32_t offset, std::uint32_t count, Scalar& closest) {
+    bool found = false;
+
+    for (std::uint32_t k = offset; k < offset + count; ++k) {
+      auto const index = m_indices[k];
+      auto const& sphere = m_spheres[index];
+      auto const centre = ray::Point3(sphere.centre[0] + time * sphere.velocity[0],
+                                      sphere.centre[1] + time * sphere.velocity[1],
+                                      sphere.centre[2] + time * sphere.velocity[2]);
+
+      if (sphere::hitSphere(centre, sphere.radius, ray, tMin, closest, record)) {
+        found = true;
+        closest = record.t;
+        record.materialPtr = m_materials[sphere.material];
+        record.objectIndex = index;
+      }
+    }
+
+    return found;
+  });
+}
+
+/// Find the nearest sphere every active ray of a packet hits, walking the hierarchy once for the whole packet
+/// \param[in] packet The rays
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] records Receives the nearest intersection of every lane whose ray hits something, at the index of the
+/// lane. Their object indices are the indices of the spheres
+/// \returns The lanes whose rays hit something
+/// \details Every ray finds the intersection hit finds for it on its own
+packet::Mask SphereBvh::hitPacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                                  std::span<hittable::HitRecord> records) const noexcept
+{
+  if (m_nodes.empty() or packet.active == 0) {
+    return 0;
+  }
+
+  switch (packet.size) {
+    case 4:
+      return dispatch::run([&]() noexcept { return traversePacket<4>(packet, tMin, tMax, records); });
+    case 8:
+      return dispatch::run([&]() noexcept { return traversePacket<8>(packet, tMin, tMax, records); });
+    default:
+      return dispatch::run([&]() noexcept { return traversePacket<16>(packet, tMin, tMax, records); });
+  }
+}
+
+/// Walk the hierarchy once for all the rays of a packet. hitPacket runs it compiled for the selected instruction set
+/// \param[in] packet The rays
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] records Receives the nearest intersection of every lane whose ray hits something
+/// \returns The lanes whose rays hit something
+/// \tparam N The number of lanes of the packet
+/// \pre The hierarchy has at least one node
+#ifdef RT_LANE_VECTORS
+template <std::size_t N>
+packet::Mask SphereBvh::traversePacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                                       std::span<hittable::HitRecord> records) const noexcept
+{
+  using Lanes = LaneGroup<Scalar>::Type;
+  using WideLanes = LaneGroup<double>::Type;
+  using Mask = decltype(Lanes {} < Lanes {});
+  using WideMask = decltype(WideLanes {} < WideLanes {});
+
+  constexpr auto groupCount = N / laneGroupSize;
+
+  using LaneGroups = std::array<Lanes, groupCount>;
+  using WideGroups = std::array<WideLanes, groupCount>;
+  using MaskGroups = std::array<Mask, groupCount>;
+
+  // The lanes are copied in rather than returned, which would pass vectors wider than the baseline registers
+  auto o = std::array<LaneGroups, 3> {};
+  auto d = std::array<LaneGroups, 3> {};
+  auto times = WideGroups {};
+  auto lengthsSquared = LaneGroups {};
+  auto wideO = std::array<WideGroups, 3> {};
+  auto inverse = std::array<WideGroups, 3> {};
+  auto closest = LaneGroups {};
+  auto nearest = MaskGroups {};
+  auto found = MaskGroups {};
+  auto inBox = MaskGroups {};
+  auto const zero = Lanes {};
+
+  for (std::size_t group = 0; group < groupCount; ++group) {
+    auto const first = group * laneGroupSize;
+    auto time = Lanes {};
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      std::memcpy(&o[axis][group], &packet.origins[axis][first], sizeof(Lanes));
+      std::memcpy(&d[axis][group], &packet.directions[axis][first], sizeof(Lanes));
+      wideO[axis][group] = __builtin_convertvector(o[axis][group], WideLanes);
+      inverse[axis][group] = 1.0 / __builtin_convertvector(d[axis][group], WideLanes);
+    }
+
+    std::memcpy(&time, &packet.times[first], sizeof(Lanes));
+    times[group] = __builtin_convertvector(time, WideLanes);
+    lengthsSquared[group] = (d[0][group] * d[0][group]) + (d[1][group] * d[1][group]) + (d[2][group] * d[2][group]);
+
+    // An inactive lane starts with its nearest hit closer than tMin, which makes it miss every box and sphere
+    auto active = Mask {};
+
+    for (std::size_t lane = 0; lane < laneGroupSize; ++lane) {
+      active[lane] = packet.isActive(first + lane) ? -1 : 0;
+    }
+
+    closest[group] = active ? (zero + tMax) : (zero - std::numeric_limits<Scalar>::infinity());
+  }
+
+  // The children are visited in the order that suits the first active ray
+  auto const first = static_cast<std::size_t>(std::countr_zero(packet.active));
+  auto const firstGroup = first / laneGroupSize;
+  auto const firstLane = first % laneGroupSize;
+  auto const backwards = std::array<bool, 3> {inverse[0][firstGroup][firstLane] < 0,
+                                              inverse[1][firstGroup][firstLane] < 0,
+                                              inverse[2][firstGroup][firstLane] < 0};
+
+  std::array<std::uint32_t, stackSize> stack;
+  std::size_t stackTop = 0;
+  std::uint32_t current = 0;
+
+  while (true) {
+    auto const& node = m_nodes[current];
+    auto anyInBox = false;
+
+    for (std::size_t group = 0; group < groupCount; ++group) {
+      // The same comparisons as the slab test of a single ray, so that NaNs resolve the same way
+      auto tNear = WideLanes {} + static_cast<double>(tMin);
+      auto tFar = __builtin_convertvector(closest[group], WideLanes);
+
+      for (std::size_t axis = 0; axis < 3; ++axis) {
+        auto const t0 = (node.lower[axis] - wideO[axis][group]) * inverse[axis][group];
+        auto const t1 = (node.upper[axis] - wideO[axis][group]) * inverse[axis][group];
+        auto const smaller = (t1 < t0) ? t1 : t0;
+        auto const larger = (t0 < t1) ? t1 : t0;
+        tNear = (tNear < smaller) ? smaller : tNear;
+        tFar = (larger < tFar) ? larger : tFar;
+      }
+
+      inBox[group] = __builtin_convertvector(WideMask {tNear <= tFar}, Mask);
+
+      for (std::size_t lane = 0; lane < laneGroupSize; ++lane) {
+        anyInBox |= inBox[group][lane] != 0;
+      }
+    }
+
+    if (anyInBox) {
+      if (node.count == 0) {
+        auto const firstChild = current + 1;
+        auto const secondChild = node.offset;
+
+        if (backwards[node.axis]) {
+          stack[stackTop++] = firstChild;
+          current = secondChild;
+        }
+        else {
+          stack[stackTop++] = secondChild;
+          current = firstChild;
+        }
+
+        continue;
+      }
+
+      for (std::uint32_t k = node.offset; k < node.offset + node.count; ++k) {
+        auto const index = m_indices[k];
+        auto const& sphere = m_spheres[index];
+        auto const radius = static_cast<Scalar>(sphere.radius);
+
+        for (std::size_t group = 0; group < groupCount; ++group) {
+          // The same arithmetic as hitSphere, so that every ray finds the hit it finds alone
+          auto const& time = times[group];
+          auto const cx = __builtin_convertvector(sphere.centre[0] + time * sphere.velocity[0], Lanes);
+          auto const cy = __builtin_convertvector(sphere.centre[1] + time * sphere.velocity[1], Lanes);
+          auto const cz = __builtin_convertvector(sphere.centre[2] + time * sphere.velocity[2], Lanes);
+          auto const ocx = o[0][group] - cx;
+          auto const ocy = o[1][group] - cy;
+          auto const ocz = o[2][group] - cz;
+          auto const a = lengthsSquared[group];
+          auto const halfB = (ocx * d[0][group]) + (ocy * d[1][group]) + (ocz * d[2][group]);
+          auto const c = ((ocx * ocx) + (ocy * ocy) + (ocz * ocz)) - (radius * radius);
+          auto const discriminant = (halfB * halfB) - (a * c);
+          auto sqrtDiscriminant = (discriminant < 0) ? zero : discriminant;
+
+          for (std::size_t lane = 0; lane < laneGroupSize; ++lane) {
+            sqrtDiscriminant[lane] = std::sqrt(sqrtDiscriminant[lane]);
+          }
+
+          auto const near = (-halfB - sqrtDiscriminant) / a;
+          auto const far = (-halfB + sqrtDiscriminant) / a;
+          auto const nearInRange = ~((near < tMin) | (closest[group] < near));
+          auto const farInRange = ~((far < tMin) | (closest[group] < far));
+          auto const hit = inBox[group] & (discriminant >= 0) & (nearInRange | farInRange);
+
+          closest[group] = hit ? (nearInRange ? near : far) : closest[group];
+          nearest[group] = hit ? (Mask {} + index) : nearest[group];
+          found[group] |= hit;
+
+          if constexpr (stats::enabled) {
+            for (std::size_t lane = 0; lane < laneGroupSize; ++lane) {
+              if (inBox[group][lane] != 0) {
+                RT_COUNT(sphereTests);
+              }
+
+              if (hit[lane] != 0) {
+                RT_COUNT(sphereHits);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    if (stackTop == 0) {
+      break;
+    }
+
+    current = stack[--stackTop];
+  }
+
+  packet::Mask hits = 0;
+
+  for (std::size_t lane = 0; lane < N; ++lane) {
+    auto const group = lane / laneGroupSize;
+
+    if (found[group][lane % laneGroupSize] == 0) {
+      continue;
+    }
+
+    auto const index = static_cast<std::size_t>(nearest[group][lane % laneGroupSize]);
+    auto const& ray = packet.rays[lane];
+    auto const& sphere = m_spheres[index];
+    auto const time = ray.getTime();
+    auto const centre = ray::Point3(sphere.centre[0] + time * sphere.velocity[0],
+                                    sphere.centre[1] + time * sphere.velocity[1],
+                                    sphere.centre[2] + time * sphere.velocity[2]);
+    auto& record = records[lane];
+
+    record.t = closest[group][lane % laneGroupSize];
+    record.point = ray.at(record.t);
+    record.setFaceNormal(ray, (record.point - centre) / static_cast<Scalar>(sphere.radius));
+    record.materialPtr = m_materials[sphere.material];
+    record.objectIndex = index;
+    hits |= packet::Mask {1} << lane;
+  }
+
+  return hits;
+}
+#else
+template <std::size_t N>
+packet::Mask SphereBvh::traversePacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                                       std::span<hittable::HitRecord> records) const noexcept
+{
+  packet::Mask hits = 0;
+
+  // Without lane vectors every active lane walks the hierarchy on its own, which finds the same hits
+  for (std::size_t lane = 0; lane < N; ++lane) {
+    if (packet.isActive(lane) and traverse(packet.rays[lane], tMin, tMax, records[lane])) {
+      hits |= packet::Mask {1} << lane;
+    }
+  }
+
+  return hits;
+}
+#endif
+
+}   // namespace rt::bvh
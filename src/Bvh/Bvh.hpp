@@ -0,0 +1,352 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "Hittable.hpp"
+#include "Material.hpp"
+#include "Packet.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace rt::bvh {
+
+/// A node of a bounding volume hierarchy, laid out depth first
+/// \details The layout has no implicit padding, so that hierarchies can be written to and mapped from binary scene
+/// files
+struct Node
+{
+  std::array<double, 3> lower;
+  std::array<double, 3> upper;
+
+  /// For a leaf, the position of its first sphere in the index array. For an interior node, the index of its second
+  /// child. The first child of an interior node always directly follows it
+  std::uint32_t offset;
+
+  /// The number of spheres in a leaf, or 0 for an interior node
+  std::uint16_t count;
+
+  /// The axis the children of an interior node were split along
+  std::uint16_t axis;
+};
+
+static_assert(std::is_trivially_copyable_v<Node> and sizeof(Node) == 56);
+
+/// The most nodes a traversal can have waiting to be visited
+inline constexpr std::size_t stackSize = 96;
+
+/// An axis-aligned box. A default box is empty, and grows to take in whatever is added to it
+struct Box
+{
+  std::array<double, 3> lower {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::infinity()};
+  std::array<double, 3> upper {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                               -std::numeric_limits<double>::infinity()};
+
+  void grow(std::array<double, 3> const& point) noexcept
+  {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      lower[axis] = std::min(lower[axis], point[axis]);
+      upper[axis] = std::max(upper[axis], point[axis]);
+    }
+  }
+
+  void grow(Box const& box) noexcept
+  {
+    grow(box.lower);
+    grow(box.upper);
+  }
+
+  static Box of(Node const& node) noexcept
+  {
+    return Box {node.lower, node.upper};
+  }
+
+  bool isEmpty() const noexcept
+  {
+    return upper[0] < lower[0];
+  }
+
+  double getSurfaceArea() const noexcept
+  {
+    auto const x = upper[0] - lower[0];
+    auto const y = upper[1] - lower[1];
+    auto const z = upper[2] - lower[2];
+
+    return x < 0 ? 0.0 : 2.0 * (x * y + y * z + z * x);
+  }
+};
+
+/// A bounding volume hierarchy over a set of spheres
+struct Tree
+{
+  std::vector<Node> nodes;
+
+  /// The indices of the spheres, in the order the leaves refer to them
+  std::vector<std::uint32_t> indices;
+};
+
+/// Build a bounding volume hierarchy over a set of spheres with the surface area heuristic
+/// \param[in] spheres The spheres
+/// \returns The hierarchy. It has no nodes if there are no spheres
+Tree build(std::span<scene::SphereData const> spheres);
+
+/// Build a bounding volume hierarchy over some of a set of spheres with the surface area heuristic
+/// \param[in] spheres The spheres
+/// \param[in] indices The indices of the spheres to build the hierarchy over
+/// \returns The hierarchy. It has no nodes if there are no indices
+Tree build(std::span<scene::SphereData const> spheres, std::vector<std::uint32_t> indices);
+
+/// Build a bounding volume hierarchy over a set of boxes with the surface area heuristic
+/// \param[in] boxes The boxes. They are binned by their middles
+/// \returns The hierarchy, whose leaves refer to the boxes by their indices. It has no nodes if there are no boxes
+Tree buildOverBoxes(std::span<Box const> boxes);
+
+/// Walk a hierarchy for the nearest primitive a ray hits, visiting the nearer child of every node first
+/// \param[in] nodes The nodes of the hierarchy
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[in] intersect Called for every leaf the ray reaches with the position of its first primitive in the index
+/// array, its number of primitives and the distance of the nearest hit so far. It returns whether it found a nearer
+/// hit, and then lowers the distance to that of the hit
+/// \returns true if intersect found a hit
+/// \pre The hierarchy has at least one node
+template <typename Intersect>
+bool traverse(std::span<Node const> nodes, ray::Ray const& ray, Scalar tMin, Scalar tMax, Intersect&& intersect)
+{
+  auto const& origin = ray.getOrigin();
+  auto const& direction = ray.getDirection();
+  auto const o = std::array<double, 3> {origin.x(), origin.y(), origin.z()};
+  auto const inverse = std::array<double, 3> {1.0 / direction.x(), 1.0 / direction.y(), 1.0 / direction.z()};
+  auto const backwards = std::array<bool, 3> {inverse[0] < 0, inverse[1] < 0, inverse[2] < 0};
+
+  auto const hitsBox = [&](Node const& node, double closest) noexcept {
+    double tNear = tMin;
+    double tFar = closest;
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      auto const t0 = (node.lower[axis] - o[axis]) * inverse[axis];
+      auto const t1 = (node.upper[axis] - o[axis]) * inverse[axis];
+      tNear = std::max(tNear, std::min(t0, t1));
+      tFar = std::min(tFar, std::max(t0, t1));
+    }
+
+    return tNear <= tFar;
+  };
+
+  std::array<std::uint32_t, stackSize> stack;
+  std::size_t stackTop = 0;
+  std::uint32_t current = 0;
+  auto closest = tMax;
+  bool hitAnything = false;
+
+  while (true) {
+    auto const& node = nodes[current];
+
+    if (hitsBox(node, closest)) {
+      if (node.count == 0) {
+        auto const first = current + 1;
+        auto const second = node.offset;
+
+        if (backwards[node.axis]) {
+          stack[stackTop++] = first;
+          current = second;
+        }
+        else {
+          stack[stackTop++] = second;
+          current = first;
+        }
+
+        continue;
+      }
+
+      if (intersect(node.offset, node.count, closest)) {
+        hitAnything = true;
+      }
+    }
+
+    if (stackTop == 0) {
+      break;
+    }
+
+    current = stack[--stackTop];
+  }
+
+  return hitAnything;
+}
+
+/// Check that a hierarchy only refers to nodes and spheres that exist
+/// \param[in] nodes The nodes of the hierarchy
+/// \param[in] indices The sphere indices of the hierarchy
+/// \param[in] sphereCount The number of spheres the hierarchy was built over
+/// \returns true if every node and index is in range
+bool isValid(std::span<Node const> nodes, std::span<std::uint32_t const> indices, std::size_t sphereCount) noexcept;
+
+/// A bounding volume hierarchy that is updated in place as spheres are added, moved and removed
+/// \details Moving a sphere refits the bounds of the nodes above it. An added sphere goes into the leaf whose bounds
+/// grow the least, and a removed one is taken out of its leaf. The hierarchy is built again when a leaf would grow
+/// too large or lose its last sphere, and after enough edits that refitted bounds may have grown loose
+class DynamicTree
+{
+public:
+  /// Build a hierarchy over a set of spheres
+  /// \param[in] spheres The spheres
+  explicit DynamicTree(std::span<scene::SphereData const> spheres);
+
+  /// Get the hierarchy. Its arrays may move whenever it is updated
+  Tree const& getTree() const noexcept
+  {
+    return m_tree;
+  }
+
+  /// Refit the hierarchy to a sphere that moved or changed size
+  /// \param[in] spheres The spheres, including the one that changed
+  /// \param[in] sphere The index of the sphere that changed
+  /// \pre The sphere is in the hierarchy
+  void update(std::span<scene::SphereData const> spheres, std::uint32_t sphere);
+
+  /// Add a sphere to the hierarchy
+  /// \param[in] spheres The spheres, including the new one
+  /// \param[in] sphere The index of the new sphere, which is one past that of every sphere added before it
+  void insert(std::span<scene::SphereData const> spheres, std::uint32_t sphere);
+
+  /// Take a sphere out of the hierarchy. Its index is not reused
+  /// \param[in] spheres The spheres
+  /// \param[in] sphere The index of the sphere
+  /// \pre The sphere is in the hierarchy
+  void remove(std::span<scene::SphereData const> spheres, std::uint32_t sphere);
+
+  /// Check whether a sphere is in the hierarchy
+  /// \param[in] sphere The index of the sphere
+  /// \returns false if the sphere was removed or never added
+  bool contains(std::uint32_t sphere) const noexcept;
+
+private:
+  /// Build the hierarchy again over the spheres it holds
+  void rebuild(std::span<scene::SphereData const> spheres);
+
+  /// Recompute the bounds of a node and of every node above it
+  void refit(std::span<scene::SphereData const> spheres, std::uint32_t node) noexcept;
+
+  /// Count an edit, and build the hierarchy again once the edits may have loosened it
+  void countEdit(std::span<scene::SphereData const> spheres);
+
+  Tree m_tree;
+
+  /// The parent of every node. The root is its own parent
+  std::vector<std::uint32_t> m_parents;
+
+  /// The number of index entries every leaf can hold before it has to move to the end of the index array
+  std::vector<std::uint32_t> m_capacities;
+
+  /// The leaf holding every sphere, or noLeaf if it is not in the hierarchy
+  std::vector<std::uint32_t> m_leaves;
+
+  /// The number of spheres in the hierarchy
+  std::size_t m_sphereCount {0};
+
+  /// The number of edits since the hierarchy was last built
+  std::size_t m_edits {0};
+};
+
+/// The spheres of a scene, found through a bounding volume hierarchy
+/// \details Only views of the spheres, hierarchy and materials are kept, so they can live in a mapped file
+class SphereBvh final : public hittable::Hittable
+{
+public:
+  /// Create a view of a set of spheres and their hierarchy
+  /// \param[in] spheres The spheres
+  /// \param[in] nodes The nodes of the hierarchy built over the spheres
+  /// \param[in] indices The sphere indices of the hierarchy
+  /// \param[in] materials The material objects the spheres refer to
+  /// \pre The hierarchy and the material indices of the spheres are valid
+  explicit SphereBvh(std::span<scene::SphereData const> spheres, std::span<Node const> nodes,
+                     std::span<std::uint32_t const> indices,
+                     std::span<material::Material* const> materials) noexcept;
+
+  /// Find the nearest sphere a ray hits
+  /// \param[in] ray The ray
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[inout] record Receives the nearest intersection. Its object index is the index of the sphere
+  /// \returns true if there was an intersection and false otherwise
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+  /// Find the nearest sphere every active ray of a packet hits, walking the hierarchy once for the whole packet
+  /// \param[in] packet The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[out] records Receives the nearest intersection of every lane whose ray hits something, at the index of
+  /// the lane. Their object indices are the indices of the spheres
+  /// \returns The lanes whose rays hit something
+  /// \details Every ray finds the intersection hit finds for it on its own
+  packet::Mask hitPacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                         std::span<hittable::HitRecord> records) const noexcept override;
+
+  /// Find the nearest sphere each ray of a stream hits
+  /// \param[in] rays The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+  /// \param[out] records Receives the nearest intersection of every ray, at the index of the ray. Their object
+  /// indices are the indices of the spheres, and the distance of the record of a ray that hits nothing is set to
+  /// infinity
+  /// \returns The number of rays that hit something
+  /// \details The whole stream is traced in one call of the traversal compiled for the selected instruction set
+  std::size_t hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                        std::span<hittable::HitRecord> records) const noexcept override;
+
+  /// Get the box the spheres stay within from time 0 to time 1
+  /// \returns The bounds of the root of the hierarchy, or an empty box if there are no spheres
+  Box getBounds() const noexcept;
+
+private:
+  /// Walk the hierarchy for the nearest sphere a ray hits. hit runs it compiled for the selected instruction set
+  /// \pre The hierarchy has at least one node
+  bool traverse(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept;
+
+  /// Walk the hierarchy once for all the rays of a packet. hitPacket runs it compiled for the selected instruction set
+  /// \tparam N The number of lanes of the packet
+  /// \pre The hierarchy has at least one node
+  template <std::size_t N>
+  packet::Mask traversePacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                              std::span<hittable::HitRecord> records) const noexcept;
+
+  std::span<scene::SphereData const> m_spheres;
+  std::span<Node const> m_nodes;
+  std::span<std::uint32_t const> m_indices;
+  std::span<material::Material* const> m_materials;
+};
+
+}   // namespace rt::bvh
+
+#endif
@@ -0,0 +1,291 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "BvhCache.hpp"
+
+#include <bit>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) or defined(__APPLE__)
+  #include <unistd.h>
+#endif
+
+namespace rt::bvhcache {
+
+namespace {
+
+/// Scramble the bits of a 64-bit word
+constexpr std::uint64_t mix(std::uint64_t word) noexcept
+{
+  word ^= word >> 33;
+  word *= 0xff51afd7ed558ccdULL;
+  word ^= word >> 33;
+  word *= 0xc4ceb9fe1a85ec53ULL;
+  word ^= word >> 33;
+
+  return word;
+}
+
+/// Fold a word into a hash
+constexpr std::uint64_t combine(std::uint64_t hash, std::uint64_t word) noexcept
+{
+  return std::rotl(hash ^ mix(word), 27) * 0x9e3779b97f4a7c15ULL;
+}
+
+/// Read an array that directly follows the previous one
+template <typename T>
+bool readArray(std::ifstream& file, std::vector<T>& values, std::size_t count)
+{
+  values.resize(count);
+  auto const bytes = static_cast<std::streamsize>(count * sizeof(T));
+
+  return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), bytes));
+}
+
+/// Get a name for the temporary file a cache entry is written to that no other process uses at the same time
+std::string getTemporarySuffix()
+{
+#if defined(__unix__) or defined(__APPLE__)
+  return ".tmp." + std::to_string(::getpid());
+#else
+  return ".tmp";
+#endif
+}
+
+}   // namespace
+
+/// Hash the geometry of a set of spheres
+/// \param[in] spheres The spheres
+/// \returns A 64-bit hash of the centres, radii and velocities of the spheres, in order
+std::uint64_t hashGeometry(std::span<scene::SphereData const> spheres) noexcept
+{
+  auto hash = mix(spheres.size() + 0x9e3779b97f4a7c15ULL);
+
+  for (auto const& sphere : spheres) {
+    for (auto const value : {sphere.centre[0], sphere.centre[1], sphere.centre[2], sphere.radius, sphere.velocity[0],
+                             sphere.velocity[1], sphere.velocity[2]}) {
+      hash = combine(hash, std::bit_cast<std::uint64_t>(value));
+    }
+  }
+
+  return mix(hash);
+}
+
+/// Hash the contents of a triangle mesh
+/// \param[in] positions The positions of the vertices
+/// \param[in] triangles The indices of the vertices of every triangle
+/// \returns A 64-bit hash of the positions and the triangles, in order
+std::uint64_t hashMesh(std::span<std::array<float, 3> const> positions,
+                       std::span<std::array<std::uint32_t, 3> const> triangles) noexcept
+{
+  auto hash = combine(mix(positions.size()), triangles.size());
+
+  for (auto const& position : positions) {
+    for (auto const value : position) {
+      hash = combine(hash, std::bit_cast<std::uint32_t>(value));
+    }
+  }
+
+  for (auto const& triangle : triangles) {
+    for (auto const index : triangle) {
+      hash = combine(hash, index);
+    }
+  }
+
+  return mix(hash);
+}
+
+/// Hash a whole scene, for renderers on different machines to check that they hold the same scene
+/// \details Meshes and instances are hashed by their contents rather than by their paths, as every machine resolves
+/// the paths against the directory of its own copy of the scene
+/// \param[in] materials The material table
+/// \param[in] spheres The spheres
+/// \param[in] shapes The planes, disks and boxes
+/// \param[in] meshes The meshes
+/// \param[in] meshHashes The hash of the contents of every mesh, in the order of the meshes
+/// \param[in] instances The instances
+/// \param[in] instanceHashes The hash of the materials and spheres every instance copies, in the order of the
+/// instances
+/// \returns A 64-bit hash of the materials, the geometry and material of every sphere and shape, the contents and
+/// material of every mesh, and the contents and placement of every instance, in order
+std::uint64_t hashScene(std::span<scene::MaterialData const> materials, std::span<scene::SphereData const> spheres,
+                        std::span<scene::ShapeData const> shapes, std::span<scene::MeshReference const> meshes,
+                        std::span<std::uint64_t const> meshHashes,
+                        std::span<scene::InstanceReference const> instances,
+                        std::span<std::uint64_t const> instanceHashes) noexcept
+{
+  auto hash = combine(hashGeometry(spheres), materials.size());
+
+  for (auto const& material : materials) {
+    hash = combine(hash, static_cast<std::uint64_t>(material.type));
+
+    for (auto const value : {material.albedo[0], material.albedo[1], material.albedo[2], material.parameter}) {
+      hash = combine(hash, std::bit_cast<std::uint64_t>(value));
+    }
+  }
+
+  // The sphere hash leaves the materials out, so that the cached hierarchy survives a change of material
+  for (auto const& sphere : spheres) {
+    hash = combine(hash, sphere.material);
+  }
+
+  hash = combine(hash, shapes.size());
+
+  for (auto const& shape : shapes) {
+    hash = combine(hash, static_cast<std::uint64_t>(shape.type));
+    hash = combine(hash, shape.material);
+
+    for (auto const value : {shape.point[0], shape.point[1], shape.point[2], shape.vector[0], shape.vector[1],
+                             shape.vector[2], shape.radius}) {
+      hash = combine(hash, std::bit_cast<std::uint64_t>(value));
+    }
+  }
+
+  hash = combine(hash, meshes.size());
+
+  for (std::size_t i = 0; i < meshes.size(); ++i) {
+    hash = combine(hash, meshes[i].material);
+    hash = combine(hash, i < meshHashes.size() ? meshHashes[i] : 0);
+  }
+
+  hash = combine(hash, instances.size());
+
+  for (std::size_t i = 0; i < instances.size(); ++i) {
+    auto const& instance = instances[i];
+    hash = combine(hash, i < instanceHashes.size() ? instanceHashes[i] : 0);
+
+    for (auto const value : {instance.offset[0], instance.offset[1], instance.offset[2], instance.axis[0],
+                             instance.axis[1], instance.axis[2], instance.degrees, instance.scale}) {
+      hash = combine(hash, std::bit_cast<std::uint64_t>(value));
+    }
+  }
+
+  return mix(hash);
+}
+
+/// Get the directory hierarchies are cached in when none is given
+/// \returns $XDG_CACHE_HOME/raytracer/bvh, or ~/.cache/raytracer/bvh, or an empty path if neither can be found
+std::filesystem::path getDefaultDirectory()
+{
+  if (auto const* const cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome and *cacheHome) {
+    return std::filesystem::path(cacheHome) / "raytracer" / "bvh";
+  }
+
+  if (auto const* const home = std::getenv("HOME"); home and *home) {
+    return std::filesystem::path(home) / ".cache" / "raytracer" / "bvh";
+  }
+
+  return {};
+}
+
+/// Use the given directory as a cache. It is created when the first hierarchy is stored
+/// \param[in] directory The directory
+Cache::Cache(std::filesystem::path directory) : m_directory(std::move(directory))
+{
+}
+
+/// Get the path the hierarchy over a set of spheres is cached at
+/// \param[in] geometryHash The hash of the spheres, from hashGeometry
+/// \returns The path of the cache file
+std::filesystem::path Cache::getPath(std::uint64_t geometryHash) const
+{
+  std::array<char, 17> name {};
+  static constexpr auto digits = std::string_view("0123456789abcdef");
+
+  for (std::size_t i = 0; i < 16; ++i) {
+    name[i] = digits[(geometryHash >> (60 - 4 * i)) & 0xf];
+  }
+
+  return m_directory / (std::string(name.data(), 16) + ".bvh");
+}
+
+/// Read the cached hierarchy over a set of spheres
+/// \param[in] geometryHash The hash of the spheres, from hashGeometry
+/// \param[in] sphereCount The number of spheres
+/// \returns The hierarchy, or nothing if none is cached or the cached file is unusable
+std::optional<bvh::Tree> Cache::load(std::uint64_t geometryHash, std::size_t sphereCount) const
+{
+  std::ifstream file(getPath(geometryHash), std::ios::binary);
+  Header header {};
+
+  if (not file or not file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return std::nullopt;
+  }
+
+  // Anything unexpected is treated as a miss, and the entry is rebuilt and overwritten
+  if (header.magic != magic or header.version != version or header.byteOrder != byteOrderMark
+      or header.geometryHash != geometryHash or header.sphereCount != sphereCount
+      or header.nodeCount > 2 * sphereCount) {
+    return std::nullopt;
+  }
+
+  bvh::Tree tree;
+
+  if (not readArray(file, tree.nodes, header.nodeCount) or not readArray(file, tree.indices, sphereCount)
+      or not bvh::isValid(tree.nodes, tree.indices, sphereCount)) {
+    return std::nullopt;
+  }
+
+  return tree;
+}
+
+/// Cache a hierarchy. The file is written under a temporary name and then renamed, so that a concurrent load never
+/// sees it half written
+/// \param[in] geometryHash The hash of the spheres the hierarchy was built over, from hashGeometry
+/// \param[in] sphereCount The number of spheres
+/// \param[in] tree The hierarchy
+/// \throws std::runtime_error or std::filesystem::filesystem_error if the file cannot be written
+void Cache::store(std::uint64_t geometryHash, std::size_t sphereCount, bvh::Tree const& tree) const
+{
+  std::filesystem::create_directories(m_directory);
+
+  auto const path = getPath(geometryHash);
+  auto temporaryPath = path;
+  temporaryPath += getTemporarySuffix();
+
+  auto const header = Header {magic, version, byteOrderMark, geometryHash, sphereCount, tree.nodes.size()};
+
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    file.write(reinterpret_cast<char const*>(tree.nodes.data()),
+               static_cast<std::streamsize>(tree.nodes.size() * sizeof(bvh::Node)));
+    file.write(reinterpret_cast<char const*>(tree.indices.data()),
+               static_cast<std::streamsize>(tree.indices.size() * sizeof(std::uint32_t)));
+
+    if (not file.flush()) {
+      std::filesystem::remove(temporaryPath);
+      throw std::runtime_error("cannot write " + temporaryPath.string());
+    }
+  }
+
+  std::filesystem::rename(temporaryPath, path);
+}
+
+}   // namespace rt::bvhcache
@@ -0,0 +1,133 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef BVH_CACHE_HPP
+#define BVH_CACHE_HPP
+
+#include "Bvh.hpp"
+#include "Scene.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+namespace rt::bvhcache {
+
+/// The first bytes of every cached hierarchy
+inline constexpr std::array<char, 8> magic {'R', 'T', 'B', 'V', 'H', '\0', '\0', '\0'};
+
+/// The version of the cache files. Bump it whenever bvh::build or bvh::Node changes, so that hierarchies built by an
+/// older renderer are rebuilt rather than reused
+inline constexpr std::uint32_t version = 1;
+
+/// Written in native byte order so that files from a machine of the other byte order are not used
+inline constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+/// The start of a cached hierarchy. The nodes and then the sphere indices follow it
+struct Header
+{
+  std::array<char, 8> magic;
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+
+  /// The hash of the spheres the hierarchy was built over
+  std::uint64_t geometryHash;
+  std::uint64_t sphereCount;
+  std::uint64_t nodeCount;
+};
+
+static_assert(std::is_trivially_copyable_v<Header> and sizeof(Header) == 40);
+
+/// Hash the geometry of a set of spheres
+/// \details Only the centres and radii are hashed, so changing the materials of a scene keeps its hierarchy
+/// \param[in] spheres The spheres
+/// \returns A 64-bit hash of the centres, radii and velocities of the spheres, in order
+std::uint64_t hashGeometry(std::span<scene::SphereData const> spheres) noexcept;
+
+/// Hash the contents of a triangle mesh
+/// \param[in] positions The positions of the vertices
+/// \param[in] triangles The indices of the vertices of every triangle
+/// \returns A 64-bit hash of the positions and the triangles, in order
+std::uint64_t hashMesh(std::span<std::array<float, 3> const> positions,
+                       std::span<std::array<std::uint32_t, 3> const> triangles) noexcept;
+
+/// Hash a whole scene, for renderers on different machines to check that they hold the same scene
+/// \details Meshes and instances are hashed by their contents rather than by their paths, as every machine resolves
+/// the paths against the directory of its own copy of the scene
+/// \param[in] materials The material table
+/// \param[in] spheres The spheres
+/// \param[in] shapes The planes, disks and boxes
+/// \param[in] meshes The meshes
+/// \param[in] meshHashes The hash of the contents of every mesh, in the order of the meshes
+/// \param[in] instances The instances
+/// \param[in] instanceHashes The hash of the materials and spheres every instance copies, in the order of the
+/// instances
+/// \returns A 64-bit hash of the materials, the geometry and material of every sphere and shape, the contents and
+/// material of every mesh, and the contents and placement of every instance, in order
+std::uint64_t hashScene(std::span<scene::MaterialData const> materials, std::span<scene::SphereData const> spheres,
+                        std::span<scene::ShapeData const> shapes, std::span<scene::MeshReference const> meshes,
+                        std::span<std::uint64_t const> meshHashes,
+                        std::span<scene::InstanceReference const> instances = {},
+                        std::span<std::uint64_t const> instanceHashes = {}) noexcept;
+
+/// Get the directory hierarchies are cached in when none is given
+/// \returns $XDG_CACHE_HOME/raytracer/bvh, or ~/.cache/raytracer/bvh, or an empty path if neither can be found
+std::filesystem::path getDefaultDirectory();
+
+/// A directory of hierarchies, each stored in a file named after the hash of the geometry it was built over
+class Cache
+{
+public:
+  /// Use the given directory as a cache. It is created when the first hierarchy is stored
+  /// \param[in] directory The directory
+  explicit Cache(std::filesystem::path directory);
+
+  /// Get the path the hierarchy over a set of spheres is cached at
+  /// \param[in] geometryHash The hash of the spheres, from hashGeometry
+  /// \returns The path of the cache file
+  std::filesystem::path getPath(std::uint64_t geometryHash) const;
+
+  /// Read the cached hierarchy over a set of spheres
+  /// \param[in] geometryHash The hash of the spheres, from hashGeometry
+  /// \param[in] sphereCount The number of spheres
+  /// \returns The hierarchy, or nothing if none is cached or the cached file is unusable
+  std::optional<bvh::Tree> load(std::uint64_t geometryHash, std::size_t sphereCount) const;
+
+  /// Cache a hierarchy. The file is written under a temporary name and then renamed, so that a concurrent load never
+  /// sees it half written
+  /// \param[in] geometryHash The hash of the spheres the hierarchy was built over, from hashGeometry
+  /// \param[in] sphereCount The number of spheres
+  /// \param[in] tree The hierarchy
+  /// \throws std::runtime_error or std::filesystem::filesystem_error if the file cannot be written
+  void store(std::uint64_t geometryHash, std::size_t sphereCount, bvh::Tree const& tree) const;
+
+private:
+  std::filesystem::path m_directory;
+};
+
+}   // namespace rt::bvhcache
+
+#endif
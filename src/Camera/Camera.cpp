@@ -24,18 +24,55 @@
 
 #include "Camera.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace rt::camera {
 
 /// Create a ray travelling from the camera to the scene
 /// \param[in] u Horizontal offset vector used to move the ray across the scene
 /// \param[in] v Vertical offset vector used to move the ray along the scene
-/// \returns A ray from the camera to the scene
+/// \returns A ray from the camera to the scene, cast at a random time while the shutter is open
 ray::Ray Camera::getRay(double u, double v) const noexcept
 {
   auto const rd = m_lensRadius * vec3::getRandomVecInUnitDisk();
   auto const offset = m_u * rd.x() + m_v * rd.y();
 
-  return ray::Ray(m_origin + offset, m_lowerLeftCorner + (u * m_horizontal) + (v * m_vertical) - m_origin - offset);
+  // A shutter that opens and closes at once takes no random number, so still images render as they always have
+  auto const time = m_shutterClose > m_shutterOpen ? getRandomDoubleInRange(m_shutterOpen, m_shutterClose)
+                                                   : m_shutterOpen;
+
+  return ray::Ray(m_origin + offset, m_lowerLeftCorner + (u * m_horizontal) + (v * m_vertical) - m_origin - offset,
+                  time);
+}
+
+/// Check whether any ray the camera casts through a rectangle of the image can hit a sphere
+/// \param[in] centre The centre of the sphere
+/// \param[in] radius The radius of the sphere
+/// \param[in] u The horizontal offset of the middle of the rectangle
+/// \param[in] v The vertical offset of the middle of the rectangle
+/// \param[in] halfWidth Half of the horizontal offsets the rectangle spans
+/// \param[in] halfHeight Half of the vertical offsets the rectangle spans
+/// \returns false only if no ray getRay returns for offsets within the rectangle comes within the radius of the
+/// centre
+bool Camera::canReach(ray::Point3 const& centre, double radius, double u, double v, double halfWidth,
+                      double halfHeight) const noexcept
+{
+  // Every ray starts on the lens and passes through the rectangle on the focus plane, at s = 1 along the ray through
+  // the middle of both. At s, a ray is at most lens * |1 - s| + corner * s away from that middle ray
+  auto const direction = m_lowerLeftCorner + (u * m_horizontal) + (v * m_vertical) - m_origin;
+  auto const length = direction.length();
+  auto const corner = std::hypot(halfWidth * m_horizontal.length(), halfHeight * m_vertical.length());
+
+  auto const s = std::max<double>(0, vec3::getDotProduct(centre - m_origin, direction) / (length * length));
+  auto const distance = (m_origin + s * direction - centre).length();
+  auto const spread = m_lensRadius * std::abs(1 - s) + corner * s;
+
+  // Away from s the distance to the middle ray grows at least as fast as the spread can, once the slope of the spread
+  // is taken off
+  auto const slope = (m_lensRadius + corner) / length;
+
+  return slope >= 1 or distance * std::sqrt(1 - slope * slope) <= radius + spread;
 }
 
 }   // namespace rt::camera
@@ -43,10 +43,12 @@ public:
   /// \param[in] aspectRatio The aspect ratio of the camera
   /// \param[in] aperture How big the lens is
   /// \param[in] focusDistance The distance between the projection point and the image plane
+  /// \param[in] shutterOpen The time the shutter opens at
+  /// \param[in] shutterClose The time the shutter closes at. Rays are cast at times spread evenly over the interval
   constexpr explicit Camera(ray::Point3 const& lookFrom, ray::Point3 const& lookAt, vec3::Vec3 const& viewUp,
-                            double verticalFieldOfView, double aspectRatio, double aperture,
-                            double focusDistance) noexcept
-    : m_origin(lookFrom), m_lensRadius(aperture / 2)
+                            double verticalFieldOfView, double aspectRatio, double aperture, double focusDistance,
+                            double shutterOpen = 0, double shutterClose = 0) noexcept
+    : m_origin(lookFrom), m_lensRadius(aperture / 2), m_shutterOpen(shutterOpen), m_shutterClose(shutterClose)
   {
     auto const theta = degreesToRadians(verticalFieldOfView);
     auto const h = std::tan(theta / 2);
@@ -65,9 +67,21 @@ public:
   /// Create a ray travelling from the camera to the scene
   /// \param[in] u Horizontal offset vector used to move the ray across the scene
   /// \param[in] v Vertical offset vector used to move the ray along the scene
-  /// \returns A ray from the camera to the scene
+  /// \returns A ray from the camera to the scene, cast at a random time while the shutter is open
   ray::Ray getRay(double u, double v) const noexcept;
 
+  /// Check whether any ray the camera casts through a rectangle of the image can hit a sphere
+  /// \param[in] centre The centre of the sphere
+  /// \param[in] radius The radius of the sphere
+  /// \param[in] u The horizontal offset of the middle of the rectangle
+  /// \param[in] v The vertical offset of the middle of the rectangle
+  /// \param[in] halfWidth Half of the horizontal offsets the rectangle spans
+  /// \param[in] halfHeight Half of the vertical offsets the rectangle spans
+  /// \returns false only if no ray getRay returns for offsets within the rectangle comes within the radius of the
+  /// centre
+  bool canReach(ray::Point3 const& centre, double radius, double u, double v, double halfWidth,
+                double halfHeight) const noexcept;
+
 private:
   ray::Point3 m_origin {0, 0, 0};
   ray::Point3 m_lowerLeftCorner {};
@@ -77,6 +91,8 @@ private:
   vec3::Vec3 m_v {};
   vec3::Vec3 m_w {};
   double m_lensRadius {};
+  double m_shutterOpen {};
+  double m_shutterClose {};
 };
 
 }   // namespace rt::camera
@@ -24,25 +24,29 @@
 
 #include "Colour.hpp"
 
+#include "Dispatch.hpp"
 #include "Vec3.hpp"
 #include <algorithm>
+#include <cstddef>
 
 namespace rt::colour {
 
 /// Create a random Colour
 /// \returns A random Colour
-Colour Colour::getRandomColour()
+template <typename T>
+BasicColour<T> BasicColour<T>::getRandomColour()
 {
-  return Colour(vec3::Vec3::createRandomVec());
+  return BasicColour(vec3::BasicVec3<T>::createRandomVec());
 }
 
 /// Create a random Colour with colour values within the given range
 /// \param[in] min The minimum colour value
 /// \param[in] max The maximum colour value
 /// \returns A random Colour
-Colour Colour::getRandomColour(double min, double max)
+template <typename T>
+BasicColour<T> BasicColour<T>::getRandomColour(T min, T max)
 {
-  return Colour(vec3::Vec3::createRandomVecInRange(min, max));
+  return BasicColour(vec3::BasicVec3<T>::createRandomVecInRange(min, max));
 }
 
 /// \brief Map each individual colour component to the range [0, 255]
@@ -63,6 +67,21 @@ Colour Colour::getRandomColour(double min, double max)
                 static_cast<int>(256 * std::clamp(b, 0.0, 0.999)));
 }
 
+/// \brief Map the summed samples of every pixel to the range [0, 255]
+/// \param[in] sums The summed samples of every pixel
+/// \param[in] samplesPerPixel The number of samples of each pixel
+/// \param[out] pixels Receives the mapped colour of every pixel, in the same order as the sums
+/// \pre pixels is as long as sums
+/// \details Runs compiled for the instruction set selected with dispatch
+void mapToByteRange(std::span<Colour const> sums, int samplesPerPixel, std::span<Colour> pixels) noexcept
+{
+  dispatch::run([&]() noexcept {
+    for (std::size_t k = 0; k < sums.size(); ++k) {
+      pixels[k] = mapToByteRange(sums[k], samplesPerPixel);
+    }
+  });
+}
+
 /// @brief Write the value of each colour component to the given output stream
 /// @param[inout] out The output stream to write to
 /// @param[in] pixelColour The colour of a single pixel in RGB format
@@ -72,4 +91,7 @@ void writeColour(std::ostream& out, Colour const& pixelColour) noexcept
   out << pixelColour.r() << ' ' << pixelColour.g() << ' ' << pixelColour.b() << '\n';
 }
 
+template class BasicColour<float>;
+template class BasicColour<double>;
+
 }   // namespace rt::colour
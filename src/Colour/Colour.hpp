@@ -27,17 +27,20 @@
 
 #include "Vec3.hpp"
 #include <iostream>
+#include <span>
 
 namespace rt::colour {
 
-class Colour
+/// A colour whose components are of the scalar type T
+template <typename T>
+class BasicColour
 {
 public:
   /**
    * @brief Create a default Colour instance
    *
    */
-  explicit constexpr Colour() noexcept = default;
+  explicit constexpr BasicColour() noexcept = default;
 
   /**
    * @brief Create a Colour instance with the specified r, g, and b values
@@ -46,7 +49,7 @@ public:
    * @param[in] b The blue colour value
    * @param[in] g The green colour value
    */
-  explicit constexpr Colour(double r, double g, double b) noexcept : m_data {r, g, b}
+  explicit constexpr BasicColour(T r, T g, T b) noexcept : m_data {r, g, b}
   {
   }
 
@@ -54,7 +57,7 @@ public:
    * @brief Create a Colour object from a Vec3 object
    * @param[in] v The Vec3 object from which the Colour object is to be created
    */
-  constexpr explicit Colour(vec3::Vec3 const& v) noexcept : m_data(v)
+  constexpr explicit BasicColour(vec3::BasicVec3<T> const& v) noexcept : m_data(v)
   {
   }
 
@@ -63,7 +66,7 @@ public:
    *
    * @return The red Colour value
    */
-  constexpr double r() const noexcept
+  constexpr T r() const noexcept
   {
     return m_data.x();
   }
@@ -73,7 +76,7 @@ public:
    *
    * @return The green Colour value
    */
-  constexpr double g() const noexcept
+  constexpr T g() const noexcept
   {
     return m_data.y();
   }
@@ -83,7 +86,7 @@ public:
    *
    * @return The blue Colour value
    */
-  constexpr double b() const noexcept
+  constexpr T b() const noexcept
   {
     return m_data.z();
   }
@@ -94,7 +97,7 @@ public:
    * @param other The vector to be added to this vector
    * @return constexpr Colour& This vector with its fields updated
    */
-  constexpr Colour& operator+=(Colour const& other) noexcept
+  constexpr BasicColour& operator+=(BasicColour const& other) noexcept
   {
     m_data += other.m_data;
 
@@ -103,40 +106,40 @@ public:
 
   /// Create a random Colour
   /// \returns A random Colour
-  static Colour getRandomColour();
+  static BasicColour getRandomColour();
 
   /// Create a random Colour with colour values within the given range
   /// \param[in] min The minimum colour value
   /// \param[in] max The maximum colour value
   /// \returns A random Colour
-  static Colour getRandomColour(double min, double max);
+  static BasicColour getRandomColour(T min, T max);
 
 private:
-  vec3::Vec3 m_data {};
+  vec3::BasicVec3<T> m_data {};
 
   /// \brief Get the sum of two colours
   /// \param[in] first The first colour
   /// \param[in] second The second colour
   /// \returns A new colour from the sum of the two original colours
-  friend constexpr Colour operator+(Colour const& first, Colour const& second) noexcept
+  friend constexpr BasicColour operator+(BasicColour const& first, BasicColour const& second) noexcept
   {
-    return Colour(first.r() + second.r(), first.g() + second.g(), first.b() + second.b());
+    return BasicColour(first.r() + second.r(), first.g() + second.g(), first.b() + second.b());
   }
 
   /// \brief Get the scalar multiple of a given colour
   /// \param[in] scalar The scalar to be multiplied with the original colour
   /// \param[in] colour The initial colour
   /// \returns A new colour from the scalar multiple of the original colour
-  friend constexpr Colour operator*(double const scalar, Colour const& colour) noexcept
+  friend constexpr BasicColour operator*(T const scalar, BasicColour const& colour) noexcept
   {
-    return Colour(scalar * colour.r(), scalar * colour.g(), scalar * colour.b());
+    return BasicColour(scalar * colour.r(), scalar * colour.g(), scalar * colour.b());
   }
 
   /// \brief Determine whether two colours are equal or not
   /// \param[in] first The first colour
   /// \param[in] second The second colour
   /// \returns True if the colours are the same, and false otherwise
-  friend constexpr bool operator==(Colour const& first, Colour const& second) noexcept
+  friend constexpr bool operator==(BasicColour const& first, BasicColour const& second) noexcept
   {
     return (first.r() == second.r()) and (first.g() == second.g()) and (first.b() == second.b());
   }
@@ -145,18 +148,29 @@ private:
   /// \param[in] first The first colour
   /// \param[in] second The second colour
   /// \returns A new colour equal from the product of the two colours
-  friend constexpr Colour operator*(Colour const& first, Colour const& second) noexcept
+  friend constexpr BasicColour operator*(BasicColour const& first, BasicColour const& second) noexcept
   {
-    return Colour(first.m_data * second.m_data);
+    return BasicColour(first.m_data * second.m_data);
   }
 };
 
+/// The colour the renderer works with
+using Colour = BasicColour<Scalar>;
+
 /// \brief Map each individual colour component to the range [0, 255]
 /// \param[in] colour The colour to be mapped to the specified range
 /// \param[in] samplesPerPixel The number of samples of each pixel
 /// \returns A new colour whose colour components lie within the [0, 255] range
 [[nodiscard]] Colour mapToByteRange(Colour const& colour, int samplesPerPixel) noexcept;
 
+/// \brief Map the summed samples of every pixel to the range [0, 255]
+/// \param[in] sums The summed samples of every pixel
+/// \param[in] samplesPerPixel The number of samples of each pixel
+/// \param[out] pixels Receives the mapped colour of every pixel, in the same order as the sums
+/// \pre pixels is as long as sums
+/// \details Runs compiled for the instruction set selected with dispatch
+void mapToByteRange(std::span<Colour const> sums, int samplesPerPixel, std::span<Colour> pixels) noexcept;
+
 /// @brief Write the value of each colour component to the given output stream
 /// @param[inout] out The output stream to write to
 /// @param[in] pixelColour The colour of a single pixel in RGB format
@@ -0,0 +1,122 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Dispatch.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace rt::dispatch {
+
+namespace {
+
+/// The instruction sets with their names, widest last
+constexpr std::array<std::pair<Isa, std::string_view>, 3> isaNames {
+  {{Isa::generic, "generic"}, {Isa::avx2, "avx2"}, {Isa::avx512, "avx512"}}};
+
+}   // namespace
+
+/// Check whether the processor can run the kernels compiled for an instruction set
+/// \param[in] isa The instruction set
+/// \returns true if the processor reports every extension the variant is compiled with
+bool isSupported(Isa isa) noexcept
+{
+  switch (isa) {
+    case Isa::generic:
+      return true;
+#ifdef RT_DISPATCH_X86
+    case Isa::avx2:
+      return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+    case Isa::avx512:
+      return isSupported(Isa::avx2) and __builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512vl")
+             and __builtin_cpu_supports("avx512dq");
+#else
+    case Isa::avx2:
+    case Isa::avx512:
+      return false;
+#endif
+  }
+
+  return false;
+}
+
+/// Find the best instruction set the processor can run the kernels with
+/// \returns The widest supported instruction set
+Isa detectIsa() noexcept
+{
+  auto best = Isa::generic;
+
+  for (auto const& [isa, name] : isaNames) {
+    if (isSupported(isa)) {
+      best = isa;
+    }
+  }
+
+  return best;
+}
+
+/// Make the kernels run with an instruction set
+/// \param[in] isa The instruction set
+/// \throws std::runtime_error if the processor cannot run it
+void selectIsa(Isa isa)
+{
+  if (not isSupported(isa)) {
+    throw std::runtime_error("this processor does not support the " + std::string(getIsaName(isa))
+                             + " kernels");
+  }
+
+  selectedIsa.store(isa, std::memory_order_relaxed);
+}
+
+/// Get the name an instruction set is given on the command line and in the log
+/// \param[in] isa The instruction set
+/// \returns The name of the instruction set
+std::string_view getIsaName(Isa isa) noexcept
+{
+  for (auto const& [candidate, name] : isaNames) {
+    if (candidate == isa) {
+      return name;
+    }
+  }
+
+  return "unknown";
+}
+
+/// Find the instruction set with a name
+/// \param[in] name The name, as returned by getIsaName
+/// \returns The instruction set
+/// \throws std::invalid_argument if no instruction set has the name
+Isa parseIsa(std::string_view name)
+{
+  for (auto const& [isa, candidate] : isaNames) {
+    if (candidate == name) {
+      return isa;
+    }
+  }
+
+  throw std::invalid_argument("unknown instruction set " + std::string(name));
+}
+
+}   // namespace rt::dispatch
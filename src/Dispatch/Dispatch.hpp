@@ -0,0 +1,136 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef DISPATCH_HPP
+#define DISPATCH_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+/// Attributes that compile a function for AVX2 and for AVX-512
+/// \details Only GCC and Clang on x86 can compile single functions for other instruction sets. Elsewhere every variant
+/// is the generic one
+#if (defined(__x86_64__) or defined(__i386__)) and (defined(__GNUC__) or defined(__clang__))
+  #define RT_DISPATCH_X86 1
+  #define RT_TARGET_AVX2 gnu::target("avx2,fma")
+  #define RT_TARGET_AVX512 gnu::target("avx512f,avx512vl,avx512dq,avx2,fma")
+#else
+  #define RT_TARGET_AVX2
+  #define RT_TARGET_AVX512
+#endif
+
+namespace rt::dispatch {
+
+/// The instruction sets the hot kernels are compiled for
+enum class Isa : std::uint8_t
+{
+  generic,
+  avx2,
+  avx512
+};
+
+/// The instruction set the kernels run with. Kernels read it on every call, so it is a plain relaxed load
+inline std::atomic<Isa> selectedIsa {Isa::generic};
+
+/// Check whether the processor can run the kernels compiled for an instruction set
+/// \param[in] isa The instruction set
+/// \returns true if the processor reports every extension the variant is compiled with
+bool isSupported(Isa isa) noexcept;
+
+/// Find the best instruction set the processor can run the kernels with
+/// \returns The widest supported instruction set
+Isa detectIsa() noexcept;
+
+/// Make the kernels run with an instruction set
+/// \param[in] isa The instruction set
+/// \throws std::runtime_error if the processor cannot run it
+void selectIsa(Isa isa);
+
+/// Get the instruction set the kernels run with
+/// \returns The instruction set last selected, or the generic one if none was
+inline Isa getIsa() noexcept
+{
+  return selectedIsa.load(std::memory_order_relaxed);
+}
+
+/// Get the name an instruction set is given on the command line and in the log
+/// \param[in] isa The instruction set
+/// \returns The name of the instruction set
+std::string_view getIsaName(Isa isa) noexcept;
+
+/// Find the instruction set with a name
+/// \param[in] name The name, as returned by getIsaName
+/// \returns The instruction set
+/// \throws std::invalid_argument if no instruction set has the name
+Isa parseIsa(std::string_view name);
+
+namespace detail {
+
+// Every call in a kernel is inlined into the variant so that the whole kernel is compiled for its instruction set,
+// rather than the variant only calling into generic code
+
+template <typename Kernel>
+[[gnu::flatten]] decltype(auto) runGeneric(Kernel& kernel)
+{
+  return kernel();
+}
+
+template <typename Kernel>
+[[gnu::flatten, RT_TARGET_AVX2]] decltype(auto) runAvx2(Kernel& kernel)
+{
+  return kernel();
+}
+
+template <typename Kernel>
+[[gnu::flatten, RT_TARGET_AVX512]] decltype(auto) runAvx512(Kernel& kernel)
+{
+  return kernel();
+}
+
+}   // namespace detail
+
+/// Run a kernel compiled for the selected instruction set
+/// \param[in] kernel A callable taking no arguments. Each instantiation compiles it once for every instruction set
+/// \returns The result of the kernel
+/// \details Every variant is built with floating point contraction off, so they all give bit-identical results
+template <typename Kernel>
+decltype(auto) run(Kernel&& kernel)
+{
+  switch (getIsa()) {
+    case Isa::avx512:
+      return detail::runAvx512(kernel);
+    case Isa::avx2:
+      return detail::runAvx2(kernel);
+    case Isa::generic:
+      break;
+  }
+
+  return detail::runGeneric(kernel);
+}
+
+}   // namespace rt::dispatch
+
+#endif
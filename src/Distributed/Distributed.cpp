@@ -0,0 +1,488 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Distributed.hpp"
+
+#include "BvhCache.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace rt::distributed {
+
+namespace {
+
+/// The longest a worker may take to answer a request before its tiles are sent to the other workers
+constexpr int workerTimeoutSeconds = 120;
+
+/// The longest a worker waits for the next request of its coordinator
+constexpr int coordinatorTimeoutSeconds = 600;
+
+/// Every worker is given two tiles per render thread at a time, so its threads do not wait on the network
+constexpr std::size_t tilesPerThread = 2;
+
+/// The summed samples of a pixel are sent as three little-endian IEEE 754 doubles, whatever the machine
+constexpr std::size_t bytesPerSample = 8;
+constexpr std::size_t bytesPerPixel = 3 * bytesPerSample;
+
+static_assert(std::numeric_limits<double>::is_iec559 and sizeof(double) == bytesPerSample,
+              "tiles are sent as IEEE 754 doubles");
+
+/// Append a summed sample to a tile answer
+/// \param[in,out] bytes The answer
+/// \param[in] value The sample
+void appendSample(std::string& bytes, double value)
+{
+  auto bits = std::bit_cast<std::uint64_t>(value);
+
+  for (std::size_t i = 0; i < bytesPerSample; ++i, bits >>= 8) {
+    bytes.push_back(static_cast<char>(bits & 0xff));
+  }
+}
+
+/// Read a summed sample from a tile answer
+/// \param[in] bytes The bytesPerSample bytes of the sample
+/// \returns The sample
+double readSample(char const* bytes) noexcept
+{
+  std::uint64_t bits = 0;
+
+  for (std::size_t i = bytesPerSample; i-- > 0;) {
+    bits = bits << 8 | static_cast<unsigned char>(bytes[i]);
+  }
+
+  return std::bit_cast<double>(bits);
+}
+
+/// Read a line that should begin with ok
+/// \returns The rest of the line
+/// \throws std::runtime_error holding the error of the peer, or saying the peer disconnected
+std::string readAnswer(socket::Socket& peer)
+{
+  auto const line = peer.readLine();
+
+  if (not line) {
+    throw std::runtime_error("disconnected");
+  }
+
+  if (line->starts_with("ok ")) {
+    return line->substr(3);
+  }
+
+  throw std::runtime_error(line->starts_with("error ") ? line->substr(6) : "unexpected answer '" + *line + "'");
+}
+
+/// Shares the tiles of an image out between the threads talking to the workers
+class Dispatcher
+{
+public:
+  Dispatcher(std::size_t tileCount, std::size_t workerCount, bool showProgress)
+    : m_remaining(tileCount)
+    , m_activeWorkers(workerCount)
+    , m_showProgress(showProgress)
+  {
+    for (std::size_t t = 0; t < tileCount; ++t) {
+      m_pending.push_back(t);
+    }
+  }
+
+  /// Wait for tiles to render
+  /// \param[in] count The most tiles to take
+  /// \returns The tiles, or none once every tile has been rendered
+  std::vector<std::size_t> take(std::size_t count)
+  {
+    auto lock = std::unique_lock(m_mutex);
+    m_changed.wait(lock, [this] { return not m_pending.empty() or m_remaining == 0; });
+
+    auto const taken = std::min(count, m_pending.size());
+    auto batch = std::vector<std::size_t>(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(taken));
+    m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(taken));
+
+    return batch;
+  }
+
+  /// Record that tiles have been rendered
+  void finish(std::span<std::size_t const> batch)
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+    m_remaining -= batch.size();
+
+    if (m_showProgress) {
+      std::clog << "\rTiles remaining: " << m_remaining << ' ' << std::flush;
+    }
+
+    m_changed.notify_all();
+  }
+
+  /// Give tiles that could not be rendered to the other workers
+  void giveBack(std::span<std::size_t const> batch)
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+    m_pending.insert(m_pending.begin(), batch.begin(), batch.end());
+    m_changed.notify_all();
+  }
+
+  /// Record that a worker has stopped taking tiles
+  void leave()
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+    --m_activeWorkers;
+    m_changed.notify_all();
+  }
+
+  /// Wait until every tile has been rendered or every worker has left
+  /// \returns The number of tiles that were not rendered
+  std::size_t wait()
+  {
+    auto lock = std::unique_lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_remaining == 0 or m_activeWorkers == 0; });
+
+    return m_remaining;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<std::size_t> m_pending;
+  std::size_t m_remaining;
+  std::size_t m_activeWorkers;
+  bool m_showProgress;
+};
+
+/// Hash a scene, for the coordinator and its workers to check that they loaded the same one
+/// \param[in] world The scene
+/// \returns The hash of its materials, spheres, shapes, meshes and instances
+std::uint64_t hashWorld(world::World const& world) noexcept
+{
+  return bvhcache::hashScene(world.getMaterials(), world.getSpheres(), world.getShapes(),
+                             world.getDescription().meshes, world.getMeshHashes(), world.getDescription().instances,
+                             world.getInstanceHashes());
+}
+
+}   // namespace
+
+/// Start listening for coordinators
+/// \param[in] address A Unix domain socket path, or host:port for TCP
+/// \param[in] threads The number of render threads. Zero selects one per hardware thread
+/// \param[in] loadScene Prepares the scenes frames name
+/// \throws std::system_error if the socket cannot be created
+Worker::Worker(std::string const& address, std::size_t threads, world::Loader loadScene)
+  : m_listener(socket::listenAt(address))
+  , m_address(socket::getLocalAddress(m_listener))
+  , m_loadScene(std::move(loadScene))
+  , m_pool(threads)
+{
+}
+
+/// Remove the socket of a worker listening on a Unix domain socket
+Worker::~Worker()
+{
+  if (m_address.find('/') != std::string::npos) {
+    std::error_code error;
+    std::filesystem::remove(m_address, error);
+  }
+}
+
+/// Serve coordinators until the worker is stopped
+void Worker::run()
+{
+  while (auto coordinator = socket::acceptUnlessInterrupted(m_listener, m_interrupter)) {
+    try {
+      serve(*coordinator);
+    }
+    catch (std::exception const& error) {
+      // A coordinator that goes away only ends its own connection
+      std::clog << "Coordinator disconnected: " << error.what() << '\n';
+    }
+  }
+}
+
+/// Make run return once the coordinator being served disconnects. Can be called from any thread
+void Worker::stop() noexcept
+{
+  m_interrupter.interrupt();
+}
+
+/// Render the tiles a coordinator asks for until it disconnects
+/// \param[inout] coordinator The connection of the coordinator
+void Worker::serve(socket::Socket& coordinator)
+{
+  coordinator.setReadTimeout(coordinatorTimeoutSeconds);
+
+  auto const header = coordinator.readLine();
+
+  if (not header) {
+    return;
+  }
+
+  Scene const* scene = nullptr;
+  auto description = scene::Description();
+  auto settings = render::Settings();
+  settings.showProgress = false;
+
+  try {
+    auto words = std::istringstream(*header);
+    std::string keyword;
+    std::string name;
+
+    if (not(words >> keyword >> name >> settings.tileSize >> settings.seed) or keyword != "frame"
+        or settings.tileSize == 0) {
+      throw std::runtime_error("expected frame <scene> <tile size> <seed>, got '" + *header + "'");
+    }
+
+    std::string statements;
+
+    for (auto line = coordinator.readLine(); line != "end"; line = coordinator.readLine()) {
+      if (not line) {
+        return;
+      }
+
+      statements += *line;
+      statements += '\n';
+    }
+
+    scene = &getScene(name);
+    description = scene::getSettings(scene->world->getDescription());
+    scene::parseSettings(statements, description);
+  }
+  catch (std::exception const& error) {
+    coordinator.writeAll(std::string("error ") + error.what() + '\n');
+    return;
+  }
+
+  settings.imgWidth = description.imgWidth;
+  settings.imgHeight = description.imgHeight;
+  settings.samplesPerPixel = description.samplesPerPixel;
+  settings.maxDepth = description.maxDepth;
+
+  auto const camera = scene::buildCamera(description);
+  auto const tiles = render::makeTiles(settings.imgWidth, settings.imgHeight, settings.tileSize);
+
+  coordinator.writeAll("ok " + std::to_string(scene->sceneHash) + ' ' + std::to_string(m_pool.getThreadCount())
+                       + '\n');
+
+  while (auto const request = coordinator.readLine()) {
+    std::vector<std::size_t> indices;
+    auto words = std::istringstream(*request);
+    std::string keyword;
+    words >> keyword;
+
+    for (std::size_t index = 0; words >> index;) {
+      indices.push_back(index);
+    }
+
+    if (keyword != "tiles" or not words.eof() or indices.empty()) {
+      coordinator.writeAll("error expected tiles <index>..., got '" + *request + "'\n");
+      return;
+    }
+
+    std::vector<colour::Colour> framebuffer;
+
+    try {
+      framebuffer = render::renderTiles(m_pool, scene->world->getHittable(), camera, settings, indices);
+    }
+    catch (std::exception const& error) {
+      coordinator.writeAll(std::string("error ") + error.what() + '\n');
+      return;
+    }
+
+    std::string pixels;
+
+    for (auto const t : indices) {
+      auto const& tile = tiles[t];
+
+      for (auto j = tile.y0; j < tile.y1; ++j) {
+        for (auto i = tile.x0; i < tile.x1; ++i) {
+          auto const& pixel = framebuffer[j * settings.imgWidth + i];
+          appendSample(pixels, pixel.r());
+          appendSample(pixels, pixel.g());
+          appendSample(pixels, pixel.b());
+        }
+      }
+    }
+
+    // The answer is sent with a single write, so that it is not held back waiting for an acknowledgement
+    coordinator.writeAll("ok " + std::to_string(pixels.size()) + '\n' + pixels);
+  }
+}
+
+/// Get a scene that has been loaded, or load it
+/// \param[in] name The name of the scene
+/// \returns The scene
+/// \throws std::exception if the scene cannot be loaded
+Worker::Scene const& Worker::getScene(std::string const& name)
+{
+  if (auto const scene = m_scenes.find(name); scene != m_scenes.end()) {
+    return scene->second;
+  }
+
+  auto world = m_loadScene(name);
+  auto const sceneHash = hashWorld(*world);
+
+  return m_scenes.emplace(name, Scene {std::move(world), sceneHash}).first->second;
+}
+
+/// Render an image by sharing its tiles out between workers
+/// \param[in] workers The addresses of the workers
+/// \param[in] sceneName The name of the scene, as the workers load it
+/// \param[in] world The scene, whose camera is used and whose geometry the workers must have
+/// \param[in] settings The resolution, sampling, tile size and seed of the image
+/// \returns The sum of the samples of every pixel, as render::render returns it
+/// \throws std::runtime_error if every worker failed before the image was finished
+/// \throws std::invalid_argument if there are no workers or the scene name holds whitespace
+std::vector<colour::Colour> renderOnWorkers(std::span<std::string const> workers, std::string const& sceneName,
+                                            world::World const& world, render::Settings const& settings)
+{
+  if (workers.empty()) {
+    throw std::invalid_argument("no workers to render on");
+  }
+
+  if (sceneName.empty() or sceneName.find_first_of(" \t\r\n") != std::string::npos) {
+    throw std::invalid_argument("scene name '" + sceneName + "' cannot be sent to workers");
+  }
+
+  auto view = scene::getSettings(world.getDescription());
+  view.imgWidth = settings.imgWidth;
+  view.imgHeight = settings.imgHeight;
+  view.samplesPerPixel = settings.samplesPerPixel;
+  view.maxDepth = settings.maxDepth;
+
+  std::ostringstream frameStream;
+  frameStream << "frame " << sceneName << ' ' << settings.tileSize << ' ' << settings.seed << '\n';
+  scene::writeScene(frameStream, view);
+  frameStream << "end\n";
+  auto const frame = frameStream.str();
+
+  auto const sceneHash = std::to_string(hashWorld(world));
+  auto const tiles = render::makeTiles(settings.imgWidth, settings.imgHeight, settings.tileSize);
+  std::vector<colour::Colour> framebuffer(settings.imgWidth * settings.imgHeight);
+  auto dispatcher = Dispatcher(tiles.size(), workers.size(), settings.showProgress);
+
+  auto const renderOn = [&](std::string const& address) {
+    try {
+      auto worker = socket::connectTo(address);
+      worker.setReadTimeout(workerTimeoutSeconds);
+      worker.writeAll(frame);
+
+      auto words = std::istringstream(readAnswer(worker));
+      std::string hash;
+      std::size_t threads = 0;
+
+      if (not(words >> hash >> threads) or threads == 0) {
+        throw std::runtime_error("unexpected answer to the frame");
+      }
+
+      if (hash != sceneHash) {
+        throw std::runtime_error("the worker loaded a different scene");
+      }
+
+      while (true) {
+        auto const batch = dispatcher.take(threads * tilesPerThread);
+
+        if (batch.empty()) {
+          break;
+        }
+
+        try {
+          std::string request = "tiles";
+          std::size_t bytes = 0;
+
+          for (auto const t : batch) {
+            request += ' ' + std::to_string(t);
+            bytes += (tiles[t].x1 - tiles[t].x0) * (tiles[t].y1 - tiles[t].y0) * bytesPerPixel;
+          }
+
+          worker.writeAll(request + '\n');
+
+          if (readAnswer(worker) != std::to_string(bytes)) {
+            throw std::runtime_error("unexpected amount of pixel data");
+          }
+
+          auto const pixels = worker.readExactly(bytes);
+          auto const* data = pixels.data();
+
+          for (auto const t : batch) {
+            auto const& tile = tiles[t];
+
+            for (auto j = tile.y0; j < tile.y1; ++j) {
+              for (auto i = tile.x0; i < tile.x1; ++i) {
+                framebuffer[j * settings.imgWidth + i] = colour::Colour(
+                  readSample(data), readSample(data + bytesPerSample), readSample(data + 2 * bytesPerSample));
+                data += bytesPerPixel;
+              }
+            }
+          }
+        }
+        catch (...) {
+          dispatcher.giveBack(batch);
+          throw;
+        }
+
+        dispatcher.finish(batch);
+      }
+    }
+    catch (std::exception const& error) {
+      // One write per message keeps the messages of workers that fail together apart
+      std::clog << ("Worker " + address + " failed: " + error.what() + ". The other workers render its tiles.\n");
+    }
+
+    dispatcher.leave();
+  };
+
+  std::size_t missing = 0;
+
+  {
+    std::vector<std::jthread> threads;
+
+    for (auto const& address : workers) {
+      threads.emplace_back(renderOn, std::cref(address));
+    }
+
+    missing = dispatcher.wait();
+  }
+
+  if (missing != 0) {
+    throw std::runtime_error("every worker failed with " + std::to_string(missing) + " tiles left to render");
+  }
+
+  if (settings.showProgress) {
+    std::clog << "\rDone.            \n";
+  }
+
+  return framebuffer;
+}
+
+}   // namespace rt::distributed
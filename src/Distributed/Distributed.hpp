@@ -0,0 +1,120 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include "Colour.hpp"
+#include "Render.hpp"
+#include "Socket.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace rt::distributed {
+
+/// Renders the tiles of the frames a coordinator sends it
+/// \details A coordinator connects, describes the frame and then asks for tiles until it is done:
+///
+///     frame <scene> <tile size> <seed>    followed by image, samples, depth and camera statements, then a line
+///                                         holding end. Answered with ok <scene hash> <render threads>
+///     tiles <index>...                    answered with ok <byte count> and the summed samples of every pixel of
+///                                         the tiles, in the order asked for, each tile row by row from its bottom
+///                                         row, as three little-endian IEEE 754 doubles
+///
+/// Failures are answered with error <message>. The scene hash lets the coordinator check that the worker loaded the
+/// same materials, spheres, shapes and mesh contents it did. Tiles are seeded by their index, so a tile rendered by a
+/// worker is the same as the tile rendered locally. A worker serves one coordinator at a time and keeps the scenes it
+/// has loaded
+class Worker
+{
+public:
+  /// Start listening for coordinators
+  /// \param[in] address A Unix domain socket path, or host:port for TCP
+  /// \param[in] threads The number of render threads. Zero selects one per hardware thread
+  /// \param[in] loadScene Prepares the scenes frames name
+  /// \throws std::system_error if the socket cannot be created
+  Worker(std::string const& address, std::size_t threads, world::Loader loadScene);
+
+  /// Remove the socket of a worker listening on a Unix domain socket
+  ~Worker();
+
+  Worker(Worker const&) = delete;
+  Worker& operator=(Worker const&) = delete;
+
+  /// Get the address the worker listens on, with the port the system chose if port 0 was asked for
+  std::string const& getAddress() const noexcept
+  {
+    return m_address;
+  }
+
+  /// Serve coordinators until the worker is stopped
+  void run();
+
+  /// Make run return once the coordinator being served disconnects. Can be called from any thread
+  void stop() noexcept;
+
+private:
+  /// A loaded scene and its hash
+  struct Scene
+  {
+    std::unique_ptr<world::World> world;
+    std::uint64_t sceneHash {0};
+  };
+
+  /// Render the tiles a coordinator asks for until it disconnects
+  void serve(socket::Socket& coordinator);
+
+  /// Get a scene that has been loaded, or load it
+  Scene const& getScene(std::string const& name);
+
+  socket::Socket m_listener;
+  std::string m_address;
+  socket::Interrupter m_interrupter;
+  world::Loader m_loadScene;
+  threadpool::ThreadPool m_pool;
+  std::map<std::string, Scene> m_scenes;
+};
+
+/// Render an image by sharing its tiles out between workers
+/// \details Every worker is sent batches of tiles until none are left. The tiles of a worker that cannot be reached,
+/// has a different scene, fails or stops answering are sent to the other workers
+/// \param[in] workers The addresses of the workers
+/// \param[in] sceneName The name of the scene, as the workers load it
+/// \param[in] world The scene, whose camera is used and whose geometry the workers must have
+/// \param[in] settings The resolution, sampling, tile size and seed of the image
+/// \returns The sum of the samples of every pixel, as render::render returns it
+/// \throws std::runtime_error if every worker failed before the image was finished
+/// \throws std::invalid_argument if there are no workers or the scene name holds whitespace
+std::vector<colour::Colour> renderOnWorkers(std::span<std::string const> workers, std::string const& sceneName,
+                                            world::World const& world, render::Settings const& settings);
+
+}   // namespace rt::distributed
+
+#endif
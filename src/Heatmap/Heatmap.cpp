@@ -0,0 +1,156 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Heatmap.hpp"
+
+#include "Render.hpp"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+
+namespace rt::heatmap {
+
+/// Create zeroed cost buffers for an image of the given dimensions
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+CostBuffers::CostBuffers(std::size_t width, std::size_t height)
+  : m_width(width)
+  , m_height(height)
+  , m_seconds(width * height)
+  , m_intersectionTests(width * height)
+  , m_pathDepths(width * height)
+{
+}
+
+/// Record the cost of rendering a pixel
+/// \param[in] i The column of the pixel
+/// \param[in] j The row of the pixel, counted from the bottom of the image
+/// \param[in] seconds The wall time spent on all samples of the pixel
+/// \param[in] intersectionTests The number of ray-object intersection tests performed for the pixel
+/// \param[in] averagePathDepth The average number of rays traced per sample of the pixel
+void CostBuffers::record(std::size_t i, std::size_t j, double seconds, std::uint64_t intersectionTests,
+                         double averagePathDepth) noexcept
+{
+  auto const index = j * m_width + i;
+  m_seconds[index] = seconds;
+  m_intersectionTests[index] = static_cast<double>(intersectionTests);
+  m_pathDepths[index] = averagePathDepth;
+}
+
+/// Write every cost as a false-colour PPM image named <prefix>.<cost>.ppm and print its range to the given stream
+/// \param[in] prefix The path prefix of the images
+/// \param[in] withCounters Whether intersection tests and path depths were recorded. They require the RT_COUNT
+/// counters to be compiled in
+/// \param[inout] summary The stream the range of every cost is printed to
+/// \throws std::runtime_error if a file cannot be written
+void CostBuffers::write(std::filesystem::path const& prefix, bool withCounters, std::ostream& summary) const
+{
+  // An image without pixels has no range to print, and nothing to write
+  if (m_seconds.empty()) {
+    summary << "Per-pixel cost: the image has no pixels\n";
+    return;
+  }
+
+  auto const writeFile = [&](std::string_view cost, std::span<double const> values) {
+    auto path = prefix;
+    path += '.';
+    path += cost;
+    path += ".ppm";
+
+    std::ofstream file(path);
+
+    if (not file) {
+      throw std::runtime_error("cannot open " + path.string() + " for writing");
+    }
+
+    render::writePpm(file, toFalseColour(values), m_width, m_height);
+
+    auto const [min, max] = std::minmax_element(values.begin(), values.end());
+    auto const mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+    summary << "  " << cost << ": min " << *min << ", mean " << mean << ", max " << *max << '\n';
+  };
+
+  summary << "Per-pixel cost\n";
+  writeFile("time", m_seconds);
+
+  if (withCounters) {
+    writeFile("tests", m_intersectionTests);
+    writeFile("depth", m_pathDepths);
+  }
+}
+
+/// Map a value in [0, 1] to a colour on a perceptually ordered black-purple-orange-yellow scale
+/// \param[in] t The value to map. It is clamped to [0, 1]
+/// \returns The colour with each component in the range [0, 255]
+colour::Colour getFalseColour(double t) noexcept
+{
+  // Stops sampled from the inferno colour map
+  static constexpr std::array<std::array<double, 3>, 5> stops {{
+    {0.00, 0.00, 0.02},
+    {0.34, 0.06, 0.43},
+    {0.73, 0.21, 0.33},
+    {0.98, 0.55, 0.04},
+    {0.99, 1.00, 0.64},
+  }};
+
+  auto const position = std::clamp(t, 0.0, 1.0) * (stops.size() - 1);
+  auto const lower = std::min(static_cast<std::size_t>(position), stops.size() - 2);
+  auto const f = position - static_cast<double>(lower);
+
+  auto const mix = [&](std::size_t c) {
+    return static_cast<int>(255.0 * ((1 - f) * stops[lower][c] + f * stops[lower + 1][c]));
+  };
+
+  return colour::Colour(mix(0), mix(1), mix(2));
+}
+
+/// Map every value of a cost to a false colour, scaling by the 99th percentile so that a few outliers do not wash
+/// out the rest of the image
+/// \param[in] values The costs of every pixel
+/// \returns The colours of every pixel, in the same order as the costs
+std::vector<colour::Colour> toFalseColour(std::span<double const> values)
+{
+  std::vector<colour::Colour> colours(values.size());
+
+  if (values.empty()) {
+    return colours;
+  }
+
+  std::vector<double> sorted(values.begin(), values.end());
+  auto const percentile = sorted.begin() + static_cast<std::ptrdiff_t>((sorted.size() - 1) * 99 / 100);
+  std::nth_element(sorted.begin(), percentile, sorted.end());
+  auto const scale = *percentile > 0 ? 1.0 / *percentile : 0.0;
+
+  for (std::size_t k = 0; k < values.size(); ++k) {
+    colours[k] = getFalseColour(values[k] * scale);
+  }
+
+  return colours;
+}
+
+}   // namespace rt::heatmap
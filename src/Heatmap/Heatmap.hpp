@@ -0,0 +1,101 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef HEATMAP_HPP
+#define HEATMAP_HPP
+
+#include "Colour.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+namespace rt::heatmap {
+
+/// The cost of rendering every pixel of an image
+/// \details Pixel (i, j) is stored at index j * width + i, with j = 0 being the bottom row of the image
+class CostBuffers
+{
+public:
+  /// Create zeroed cost buffers for an image of the given dimensions
+  /// \param[in] width The width of the image in pixels
+  /// \param[in] height The height of the image in pixels
+  explicit CostBuffers(std::size_t width, std::size_t height);
+
+  /// Record the cost of rendering a pixel
+  /// \param[in] i The column of the pixel
+  /// \param[in] j The row of the pixel, counted from the bottom of the image
+  /// \param[in] seconds The wall time spent on all samples of the pixel
+  /// \param[in] intersectionTests The number of ray-object intersection tests performed for the pixel
+  /// \param[in] averagePathDepth The average number of rays traced per sample of the pixel
+  void record(std::size_t i, std::size_t j, double seconds, std::uint64_t intersectionTests,
+              double averagePathDepth) noexcept;
+
+  std::span<double const> getSeconds() const noexcept
+  {
+    return m_seconds;
+  }
+
+  std::span<double const> getIntersectionTests() const noexcept
+  {
+    return m_intersectionTests;
+  }
+
+  std::span<double const> getPathDepths() const noexcept
+  {
+    return m_pathDepths;
+  }
+
+  /// Write every cost as a false-colour PPM image named <prefix>.<cost>.ppm and print its range to the given stream
+  /// \param[in] prefix The path prefix of the images
+  /// \param[in] withCounters Whether intersection tests and path depths were recorded. They require the RT_COUNT
+  /// counters to be compiled in
+  /// \param[inout] summary The stream the range of every cost is printed to
+  /// \throws std::runtime_error if a file cannot be written
+  void write(std::filesystem::path const& prefix, bool withCounters, std::ostream& summary) const;
+
+private:
+  std::size_t m_width {};
+  std::size_t m_height {};
+  std::vector<double> m_seconds;
+  std::vector<double> m_intersectionTests;
+  std::vector<double> m_pathDepths;
+};
+
+/// Map a value in [0, 1] to a colour on a perceptually ordered black-purple-orange-yellow scale
+/// \param[in] t The value to map. It is clamped to [0, 1]
+/// \returns The colour with each component in the range [0, 255]
+colour::Colour getFalseColour(double t) noexcept;
+
+/// Map every value of a cost to a false colour, scaling by the 99th percentile so that a few outliers do not wash
+/// out the rest of the image
+/// \param[in] values The costs of every pixel
+/// \returns The colours of every pixel, in the same order as the costs
+std::vector<colour::Colour> toFalseColour(std::span<double const> values);
+
+}   // namespace rt::heatmap
+
+#endif
@@ -25,8 +25,12 @@
 #ifndef HITTABLE_HPP
 #define HITTABLE_HPP
 
+#include "Packet.hpp"
 #include "Ray.hpp"
 #include "Vec3.hpp"
+#include <cstddef>
+#include <limits>
+#include <span>
 
 // Forward declaration
 namespace rt::material {
@@ -37,27 +41,80 @@ class Material;
 
 namespace rt::hittable {
 
-class HitRecord
+/// Where a ray meets a surface, in the scalar type T
+template <typename T>
+class BasicHitRecord
 {
 public:
-  ray::Point3 point;
-  vec3::Vec3 normal;
-  double t;
+  ray::BasicPoint3<T> point;
+  vec3::BasicVec3<T> normal;
+  T t;
   bool frontFace;
   material::Material* materialPtr;
+  std::size_t objectIndex;
 
-  constexpr void setFaceNormal(ray::Ray const& ray, vec3::Vec3 const& outwardNormal) noexcept
+  constexpr void setFaceNormal(ray::BasicRay<T> const& ray, vec3::BasicVec3<T> const& outwardNormal) noexcept
   {
     frontFace = vec3::getDotProduct(ray.getDirection(), outwardNormal) < 0;
     normal = frontFace ? outwardNormal : -outwardNormal;
   }
 };
 
+/// The intersection record the renderer works with
+using HitRecord = BasicHitRecord<Scalar>;
+
 class Hittable
 {
 public:
   virtual ~Hittable() = default;
-  virtual bool hit(ray::Ray const& ray, double tMin, double tMax, HitRecord& record) const = 0;
+  virtual bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, HitRecord& record) const = 0;
+
+  /// Find the nearest object every active ray of a packet hits
+  /// \param[in] packet The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[out] records Receives the nearest intersection of every lane whose ray hits something, at the index of
+  /// the lane. It has at least as many records as the packet has lanes
+  /// \returns The lanes whose rays hit something
+  /// \details Traces the rays one at a time unless an object can do better
+  virtual packet::Mask hitPacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                                 std::span<HitRecord> records) const
+  {
+    packet::Mask hits = 0;
+
+    for (std::size_t lane = 0; lane < packet.size; ++lane) {
+      if (packet.isActive(lane) and hit(packet.rays[lane], tMin, tMax, records[lane])) {
+        hits |= packet::Mask {1} << lane;
+      }
+    }
+
+    return hits;
+  }
+
+  /// Find the nearest object each ray of a stream hits
+  /// \param[in] rays The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+  /// \param[out] records Receives the nearest intersection of every ray, at the index of the ray. The distance of the
+  /// record of a ray that hits nothing is set to infinity. It has at least as many records as there are rays
+  /// \returns The number of rays that hit something
+  /// \details Traces the rays one at a time unless an object can do better
+  virtual std::size_t hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                                std::span<HitRecord> records) const
+  {
+    std::size_t hits = 0;
+
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      if (hit(rays[i], tMin, tMax[i], records[i])) {
+        ++hits;
+      }
+      else {
+        records[i].t = std::numeric_limits<Scalar>::infinity();
+      }
+    }
+
+    return hits;
+  }
 };
 
 }   // namespace rt::hittable
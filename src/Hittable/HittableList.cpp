@@ -25,16 +25,28 @@
 #include "HittableList.hpp"
 
 #include "Hittable.hpp"
+#include "Utilities.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
 
 namespace rt::hittable {
 
+namespace {
+
+/// The number of rays of a stream every object is tested against in turn
+constexpr std::size_t streamBlockSize = 64;
+
+}   // namespace
+
 /// Check if a ray has intersected any of the Hittable objects in the HittableList instance
 /// \param[in] ray The ray that intersects a Hittable object
 /// \param[in] tMin The lower bound of the distance between the ray and the object that counts as a valid intersection
 /// \param[in] tMax The upper bound of the distance between the ray and the object that counts as a valid intersection
-/// \param[inout] record
+/// \param[inout] record Receives the nearest intersection, with the object index the object that was hit gives it
 /// \returns true if there was an intersection and false otherwise
-bool HittableList::hit(ray::Ray const& ray, double tMin, double tMax, HitRecord& record) const noexcept
+bool HittableList::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, HitRecord& record) const noexcept
 {
   HitRecord tempRec;
   bool hitAnything = false;
@@ -51,4 +63,61 @@ bool HittableList::hit(ray::Ray const& ray, double tMin, double tMax, HitRecord&
   return hitAnything;
 }
 
+/// Find the nearest of the Hittable objects each ray of a stream hits
+/// \param[in] rays The rays
+/// \param[in] tMin The lower bound of the distance between a ray and an object that counts as a valid intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+/// \param[out] records Receives the nearest intersection of every ray, at the index of the ray. The distance of the
+/// record of a ray that hits nothing is set to infinity
+/// \returns The number of rays that hit something
+/// \details Every ray finds the intersection hit finds for it, with the same object index. The rays are taken a block
+/// at a time, and each object intersects the whole block as a stream of its own, so that there is one virtual call
+/// per object and block rather than per object and ray. Every ray is bounded by the nearest hit it has so far, as it
+/// is in hit
+std::size_t HittableList::hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                                    std::span<HitRecord> records) const noexcept
+{
+  std::size_t hits = 0;
+
+  for (std::size_t first = 0; first < rays.size(); first += streamBlockSize) {
+    auto const last = std::min(first + streamBlockSize, rays.size());
+
+    // The bound of every ray is its nearest hit so far, so a later object only hits it where it is nearer, or as near
+    auto const block = rays.subspan(first, last - first);
+    std::array<Scalar, streamBlockSize> bounds;
+    std::copy(tMax.begin() + static_cast<std::ptrdiff_t>(first), tMax.begin() + static_cast<std::ptrdiff_t>(last),
+              bounds.begin());
+
+    std::array<bool, streamBlockSize> found {};
+    std::array<HitRecord, streamBlockSize> tempRecs;
+
+    for (auto const& object : m_objects) {
+      if (object->hitStream(block, tMin, std::span(bounds).first(block.size()), tempRecs) == 0) {
+        continue;
+      }
+
+      for (std::size_t r = first; r < last; ++r) {
+        auto const& tempRec = tempRecs[r - first];
+
+        if (tempRec.t != rt::infinity) {
+          records[r] = tempRec;
+          bounds[r - first] = tempRec.t;
+          found[r - first] = true;
+        }
+      }
+    }
+
+    for (std::size_t r = first; r < last; ++r) {
+      if (not found[r - first]) {
+        records[r].t = rt::infinity;
+      }
+      else {
+        ++hits;
+      }
+    }
+  }
+
+  return hits;
+}
+
 }   // namespace rt::hittable
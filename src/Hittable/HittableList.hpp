@@ -26,7 +26,9 @@
 #define HITTABLE_LIST_HPP
 
 #include "Hittable.hpp"
+#include <cstddef>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace rt::hittable {
@@ -61,9 +63,23 @@ public:
   /// \param[in] ray The ray that intersects a Hittable object
   /// \param[in] tMin The lower bound of the distance between the ray and the object that counts as a valid intersection
   /// \param[in] tMax The upper bound of the distance between the ray and the object that counts as a valid intersection
-  /// \param[inout] record
+  /// \param[inout] record Receives the nearest intersection, with the object index the object that was hit gives it
   /// \returns true if there was an intersection and false otherwise
-  bool hit(ray::Ray const& ray, double tMin, double tMax, HitRecord& record) const noexcept override;
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, HitRecord& record) const noexcept override;
+
+  /// Find the nearest of the Hittable objects each ray of a stream hits
+  /// \param[in] rays The rays
+  /// \param[in] tMin The lower bound of the distance between a ray and an object that counts as a valid intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+  /// \param[out] records Receives the nearest intersection of every ray, at the index of the ray. The distance of the
+  /// record of a ray that hits nothing is set to infinity
+  /// \returns The number of rays that hit something
+  /// \details Every ray finds the intersection hit finds for it, with the same object index. The rays are taken a
+  /// block at a time, and each object intersects the whole block as a stream of its own, so that there is one virtual
+  /// call per object and block rather than per object and ray. Every ray is bounded by the nearest hit it has so far,
+  /// as it is in hit
+  std::size_t hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                        std::span<HitRecord> records) const noexcept override;
 
 private:
   std::vector<std::unique_ptr<Hittable>> m_objects;
@@ -0,0 +1,358 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Incremental.hpp"
+
+#include "Trace.hpp"
+#include "Vec3.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace rt::incremental {
+
+namespace {
+
+/// How far around itself a sphere that appears somewhere marks pixels dirty under Appearance::approximate, in radii.
+/// It is a guess at where the sphere changes the image the most, not a bound
+constexpr double reachInRadii = 3;
+
+/// Create the camera of a scene for a render
+camera::Camera makeCamera(scene::CameraData const& camera, render::Settings const& settings) noexcept
+{
+  auto view = scene::Description();
+  view.imgWidth = settings.imgWidth;
+  view.imgHeight = settings.imgHeight;
+  view.camera = camera;
+
+  return scene::buildCamera(view);
+}
+
+}   // namespace
+
+/// Prepare a scene for editing and rendering
+/// \param[in] description The scene. Its camera is used, and its image and sampling settings are replaced by those
+/// of the render settings
+/// \param[in] settings The resolution, sampling and tiling of every render
+/// \param[in] appearance How the pixels an added or moved sphere can have changed are found
+/// \throws std::out_of_range if a sphere or shape refers to a material that does not exist
+/// \throws std::invalid_argument if the scene has meshes or instances, which cannot be edited
+Session::Session(scene::Description description, render::Settings const& settings, Appearance appearance)
+  : m_description(std::move(description))
+  , m_settings(settings)
+  , m_appearance(appearance)
+  , m_camera(makeCamera(m_description.camera, settings))
+  , m_tree(m_description.spheres)
+  , m_firstIndex(static_cast<std::uint32_t>(std::numeric_limits<std::uint32_t>::max() - m_description.shapes.size()))
+  , m_touched(m_description.spheres.size())
+  , m_touchedShapes(m_description.shapes.size())
+  , m_framebuffer(settings.imgWidth * settings.imgHeight)
+  , m_touches(settings.imgWidth * settings.imgHeight)
+{
+  if (not m_description.meshes.empty() or not m_description.instances.empty()) {
+    throw std::invalid_argument("a scene with meshes or instances cannot be edited");
+  }
+
+  for (auto const& sphere : m_description.spheres) {
+    if (sphere.material >= m_description.materials.size()) {
+      throw std::out_of_range("a sphere refers to material " + std::to_string(sphere.material)
+                              + ", which does not exist");
+    }
+  }
+
+  for (auto const& shape : m_description.shapes) {
+    if (shape.material >= m_description.materials.size()) {
+      throw std::out_of_range("a shape refers to material " + std::to_string(shape.material)
+                              + ", which does not exist");
+    }
+  }
+
+  m_description.imgWidth = settings.imgWidth;
+  m_description.imgHeight = settings.imgHeight;
+  m_description.samplesPerPixel = settings.samplesPerPixel;
+  m_description.maxDepth = settings.maxDepth;
+  refresh();
+}
+
+/// Add a material that spheres can be set to
+/// \param[in] material The material
+/// \returns The index of the material
+std::uint32_t Session::addMaterial(scene::MaterialData const& material)
+{
+  m_description.materials.push_back(material);
+  refresh();
+
+  return static_cast<std::uint32_t>(m_description.materials.size() - 1);
+}
+
+/// Change a material, and so every sphere and shape made of it
+/// \param[in] material The index of the material
+/// \param[in] data The new material
+/// \throws std::out_of_range if there is no such material
+void Session::changeMaterial(std::uint32_t material, scene::MaterialData const& data)
+{
+  m_description.materials.at(material) = data;
+
+  for (std::uint32_t i = 0; i < m_description.spheres.size(); ++i) {
+    if (m_description.spheres[i].material == material) {
+      m_touched[i] = true;
+    }
+  }
+
+  for (std::size_t i = 0; i < m_description.shapes.size(); ++i) {
+    if (m_description.shapes[i].material == material) {
+      m_touchedShapes[i] = true;
+    }
+  }
+
+  refresh();
+}
+
+/// Add a sphere
+/// \param[in] sphere The sphere
+/// \returns The index of the sphere
+/// \throws std::out_of_range if the sphere refers to a material that does not exist
+/// \throws std::length_error if every index below those of the shapes has been given to a sphere
+std::uint32_t Session::addSphere(scene::SphereData const& sphere)
+{
+  if (sphere.material >= m_description.materials.size()) {
+    throw std::out_of_range("there is no material " + std::to_string(sphere.material));
+  }
+
+  if (m_description.spheres.size() >= m_firstIndex) {
+    throw std::length_error("the session cannot index any more spheres");
+  }
+
+  auto const index = static_cast<std::uint32_t>(m_description.spheres.size());
+  m_description.spheres.push_back(sphere);
+  m_touched.push_back(false);
+  m_appeared.push_back(index);
+  m_tree.insert(m_description.spheres, index);
+  refresh();
+
+  return index;
+}
+
+/// Move a sphere
+/// \param[in] sphere The index of the sphere
+/// \param[in] centre The new centre of the sphere at time 0
+/// \throws std::out_of_range if there is no such sphere
+void Session::moveSphere(std::uint32_t sphere, std::array<double, 3> const& centre)
+{
+  checkSphere(sphere);
+
+  // The pixels that saw the sphere where it was are dirty, and so are the ones that can hit it where it goes
+  m_touched[sphere] = true;
+  m_appeared.push_back(sphere);
+  m_description.spheres[sphere].centre = centre;
+  m_tree.update(m_description.spheres, sphere);
+  refresh();
+}
+
+/// Remove a sphere. Its index is not given to another sphere
+/// \param[in] sphere The index of the sphere
+/// \throws std::out_of_range if there is no such sphere
+void Session::removeSphere(std::uint32_t sphere)
+{
+  checkSphere(sphere);
+
+  m_touched[sphere] = true;
+  m_tree.remove(m_description.spheres, sphere);
+  refresh();
+}
+
+/// Make a sphere out of another material
+/// \param[in] sphere The index of the sphere
+/// \param[in] material The index of the material
+/// \throws std::out_of_range if there is no such sphere or material
+void Session::setMaterial(std::uint32_t sphere, std::uint32_t material)
+{
+  checkSphere(sphere);
+
+  if (material >= m_description.materials.size()) {
+    throw std::out_of_range("there is no material " + std::to_string(material));
+  }
+
+  // The hierarchy reads the material of a sphere when it is hit, so nothing has to be created again
+  m_touched[sphere] = true;
+  m_description.spheres[sphere].material = material;
+}
+
+/// Trace the pixels the edits since the last render may have changed, or every pixel on the first render
+/// \param[in] pool The threads to render on
+/// \returns The number of pixels that were traced
+std::size_t Session::render(threadpool::ThreadPool& pool)
+{
+  auto const width = m_settings.imgWidth;
+  auto const tiles = render::makeTiles(width, m_settings.imgHeight, m_settings.tileSize);
+  std::vector<std::size_t> tileIndices;
+
+  if (m_rendered) {
+    auto const dirty = [this] {
+      auto const span = trace::Span("findDirtyPixels", "render");
+      return findDirtyPixels();
+    }();
+
+    m_dirtyPixelCount = static_cast<std::size_t>(std::count(dirty.begin(), dirty.end(), char {1}));
+
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+      auto const& tile = tiles[t];
+      auto isDirty = false;
+
+      for (auto j = tile.y0; j < tile.y1 and not isDirty; ++j) {
+        isDirty = std::any_of(dirty.begin() + static_cast<std::ptrdiff_t>(j * width + tile.x0),
+                              dirty.begin() + static_cast<std::ptrdiff_t>(j * width + tile.x1),
+                              [](char flag) { return flag != 0; });
+      }
+
+      if (isDirty) {
+        tileIndices.push_back(t);
+      }
+    }
+  }
+  else {
+    m_dirtyPixelCount = m_framebuffer.size();
+    tileIndices.resize(tiles.size());
+    std::iota(tileIndices.begin(), tileIndices.end(), std::size_t {0});
+  }
+
+  auto const outputs = render::Outputs {.touches = &m_touches};
+  auto const& world = m_shapeList ? static_cast<hittable::Hittable const&>(*m_shapeList) : *m_bvh;
+  auto const framebuffer = render::renderTiles(pool, world, m_camera, m_settings, tileIndices, outputs);
+  std::size_t traced = 0;
+
+  for (auto const t : tileIndices) {
+    auto const& tile = tiles[t];
+
+    for (auto j = tile.y0; j < tile.y1; ++j) {
+      auto const first = framebuffer.begin() + static_cast<std::ptrdiff_t>(j * width);
+      std::copy(first + static_cast<std::ptrdiff_t>(tile.x0), first + static_cast<std::ptrdiff_t>(tile.x1),
+                m_framebuffer.begin() + static_cast<std::ptrdiff_t>(j * width + tile.x0));
+    }
+
+    traced += (tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+  }
+
+  std::fill(m_touched.begin(), m_touched.end(), false);
+  std::fill(m_touchedShapes.begin(), m_touchedShapes.end(), false);
+  m_appeared.clear();
+  m_rendered = true;
+
+  return traced;
+}
+
+/// Get the scene with every edit applied and the removed spheres left out. The shapes are those it started with
+scene::Description Session::getDescription() const
+{
+  auto description = scene::getSettings(m_description);
+  description.materials = m_description.materials;
+  description.shapes = m_description.shapes;
+
+  for (std::uint32_t i = 0; i < m_description.spheres.size(); ++i) {
+    if (m_tree.contains(i)) {
+      description.spheres.push_back(m_description.spheres[i]);
+    }
+  }
+
+  return description;
+}
+
+/// Check that a sphere exists and has not been removed
+/// \throws std::out_of_range if it does not
+void Session::checkSphere(std::uint32_t sphere) const
+{
+  if (not m_tree.contains(sphere)) {
+    throw std::out_of_range("there is no sphere " + std::to_string(sphere));
+  }
+}
+
+/// Find the pixels the edits since the last render may have changed
+/// \returns A flag for every pixel, at j * imgWidth + i
+std::vector<char> Session::findDirtyPixels() const
+{
+  auto const width = m_settings.imgWidth;
+  auto const height = m_settings.imgHeight;
+  std::vector<char> dirty(width * height);
+
+  for (std::size_t k = 0; k < dirty.size(); ++k) {
+    dirty[k] = std::any_of(m_touches[k].begin(), m_touches[k].end(), [this](std::uint32_t object) {
+      return object >= m_firstIndex ? m_touchedShapes[object - m_firstIndex] : m_touched[object];
+    });
+  }
+
+  auto const appeared = std::any_of(m_appeared.begin(), m_appeared.end(), [this](std::uint32_t index) {
+    return m_tree.contains(index);
+  });
+
+  if (appeared and m_appearance == Appearance::exact) {
+    std::fill(dirty.begin(), dirty.end(), char {1});
+    return dirty;
+  }
+
+  // A moving sphere is reached wherever a sphere around its whole path is
+  auto const halfWidth = 0.5 / static_cast<double>(width - 1);
+  auto const halfHeight = 0.5 / static_cast<double>(height - 1);
+
+  for (auto const index : m_appeared) {
+    if (not m_tree.contains(index)) {
+      continue;
+    }
+
+    auto const& sphere = m_description.spheres[index];
+    auto const& c = sphere.centre;
+    auto const velocity = vec3::Vec3(sphere.velocity[0], sphere.velocity[1], sphere.velocity[2]);
+    auto const centre = ray::Point3(c[0], c[1], c[2]) + 0.5 * velocity;
+    auto const reach = reachInRadii * std::abs(sphere.radius) + 0.5 * velocity.length();
+
+    for (std::size_t j = 0; j < height; ++j) {
+      for (std::size_t i = 0; i < width; ++i) {
+        auto const u = (static_cast<double>(i) + 0.5) / static_cast<double>(width - 1);
+        auto const v = (static_cast<double>(j) + 0.5) / static_cast<double>(height - 1);
+
+        if (not dirty[j * width + i] and m_camera.canReach(centre, reach, u, v, halfWidth, halfHeight)) {
+          dirty[j * width + i] = 1;
+        }
+      }
+    }
+  }
+
+  return dirty;
+}
+
+/// Create the objects the renders read from the description and the hierarchy again
+void Session::refresh()
+{
+  auto const& tree = m_tree.getTree();
+  m_materials.emplace(m_description.materials);
+  m_bvh.emplace(m_description.spheres, tree.nodes, tree.indices, m_materials->getMaterials());
+
+  if (not m_description.shapes.empty()) {
+    m_shapeList.emplace(m_description.shapes, m_materials->getMaterials(), *m_bvh, m_firstIndex);
+  }
+}
+
+}   // namespace rt::incremental
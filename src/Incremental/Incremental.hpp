@@ -0,0 +1,175 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include "Bvh.hpp"
+#include "Camera.hpp"
+#include "Colour.hpp"
+#include "Plane.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace rt::incremental {
+
+/// How a render after a sphere was added or moved finds the pixels the sphere can have changed
+enum class Appearance
+{
+  /// Trace every pixel again, as the path of any pixel may now hit the sphere, so the image is always the one a full
+  /// render gives
+  exact,
+
+  /// Only trace the pixels whose camera rays come within three radii of the sphere. Its reflections and refractions
+  /// in other objects, and the light it blocks from or bounces onto them, are left as they were outside that reach,
+  /// so the image can differ from a full render until every pixel is traced again
+  approximate
+};
+
+/// A scene that is edited between renders, where each render only traces again what the edits since the last one
+/// can have changed
+/// \details Every render records the spheres the paths of each pixel hit. A sphere that is removed or whose material
+/// changes can only change the pixels whose paths hit it, so those pixels are marked dirty. A sphere that appears
+/// somewhere, by being added or moved, can be hit by the path of any pixel, so it marks every pixel dirty unless the
+/// session was asked for Appearance::approximate. The tiles holding a dirty pixel are traced again. Every tile
+/// reseeds its random numbers, so a tile is traced the same as it would be by a full render of the edited scene. The
+/// planes, disks and boxes of the scene stay where they are, outside the hierarchy, and are recorded under object
+/// indices above those of every sphere, so the pixels that see one are traced again when its material changes
+class Session
+{
+public:
+  /// Prepare a scene for editing and rendering
+  /// \param[in] description The scene. Its camera is used, and its image and sampling settings are replaced by those
+  /// of the render settings
+  /// \param[in] settings The resolution, sampling and tiling of every render
+  /// \param[in] appearance How the pixels an added or moved sphere can have changed are found
+  /// \throws std::out_of_range if a sphere or shape refers to a material that does not exist
+  /// \throws std::invalid_argument if the scene has meshes or instances, which cannot be edited
+  explicit Session(scene::Description description, render::Settings const& settings,
+                   Appearance appearance = Appearance::exact);
+
+  Session(Session const&) = delete;
+  Session& operator=(Session const&) = delete;
+
+  /// Add a material that spheres can be set to
+  /// \param[in] material The material
+  /// \returns The index of the material
+  std::uint32_t addMaterial(scene::MaterialData const& material);
+
+  /// Change a material, and so every sphere and shape made of it
+  /// \param[in] material The index of the material
+  /// \param[in] data The new material
+  /// \throws std::out_of_range if there is no such material
+  void changeMaterial(std::uint32_t material, scene::MaterialData const& data);
+
+  /// Add a sphere
+  /// \param[in] sphere The sphere
+  /// \returns The index of the sphere
+  /// \throws std::out_of_range if the sphere refers to a material that does not exist
+  /// \throws std::length_error if every index below those of the shapes has been given to a sphere
+  std::uint32_t addSphere(scene::SphereData const& sphere);
+
+  /// Move a sphere
+  /// \param[in] sphere The index of the sphere
+  /// \param[in] centre The new centre of the sphere at time 0
+  /// \throws std::out_of_range if there is no such sphere
+  void moveSphere(std::uint32_t sphere, std::array<double, 3> const& centre);
+
+  /// Remove a sphere. Its index is not given to another sphere
+  /// \param[in] sphere The index of the sphere
+  /// \throws std::out_of_range if there is no such sphere
+  void removeSphere(std::uint32_t sphere);
+
+  /// Make a sphere out of another material
+  /// \param[in] sphere The index of the sphere
+  /// \param[in] material The index of the material
+  /// \throws std::out_of_range if there is no such sphere or material
+  void setMaterial(std::uint32_t sphere, std::uint32_t material);
+
+  /// Trace the pixels the edits since the last render may have changed, or every pixel on the first render
+  /// \param[in] pool The threads to render on
+  /// \returns The number of pixels that were traced
+  std::size_t render(threadpool::ThreadPool& pool);
+
+  /// Get the number of pixels the last render found dirty. The tiles it traced may hold more pixels
+  std::size_t getDirtyPixelCount() const noexcept
+  {
+    return m_dirtyPixelCount;
+  }
+
+  /// Get the sum of the samples of every pixel, as render::render returns it
+  std::span<colour::Colour const> getFramebuffer() const noexcept
+  {
+    return m_framebuffer;
+  }
+
+  /// Get the scene with every edit applied and the removed spheres left out. The shapes are those it started with
+  scene::Description getDescription() const;
+
+private:
+  /// Check that a sphere exists and has not been removed
+  /// \throws std::out_of_range if it does not
+  void checkSphere(std::uint32_t sphere) const;
+
+  /// Find the pixels the edits since the last render may have changed
+  /// \returns A flag for every pixel, at j * imgWidth + i
+  std::vector<char> findDirtyPixels() const;
+
+  /// Create the objects the renders read from the description and the hierarchy again
+  void refresh();
+
+  scene::Description m_description;
+  render::Settings m_settings;
+  Appearance m_appearance;
+  camera::Camera m_camera;
+  bvh::DynamicTree m_tree;
+  std::optional<scene::MaterialTable> m_materials;
+  std::optional<bvh::SphereBvh> m_bvh;
+
+  /// The shapes in front of the hierarchy, when the scene has any
+  std::optional<plane::ShapeList> m_shapeList;
+
+  /// The object index of the first shape. The indices of the spheres stay below it
+  std::uint32_t m_firstIndex;
+
+  /// The spheres and shapes whose pixels are dirty, and the spheres that appeared somewhere, since the last render
+  std::vector<bool> m_touched;
+  std::vector<bool> m_touchedShapes;
+  std::vector<std::uint32_t> m_appeared;
+
+  bool m_rendered {false};
+  std::size_t m_dirtyPixelCount {0};
+  std::vector<colour::Colour> m_framebuffer;
+  std::vector<std::vector<std::uint32_t>> m_touches;
+};
+
+}   // namespace rt::incremental
+
+#endif
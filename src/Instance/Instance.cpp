@@ -0,0 +1,299 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Instance.hpp"
+
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace rt::instance {
+
+/// Create a translation
+/// \param[in] offset How far points move
+/// \returns The transform
+Transform Transform::translate(vec3::Vec3 const& offset) noexcept
+{
+  auto transform = Transform();
+  transform.m_rows[0][3] = offset.x();
+  transform.m_rows[1][3] = offset.y();
+  transform.m_rows[2][3] = offset.z();
+
+  return transform;
+}
+
+/// Create a rotation about an axis through the origin
+/// \param[in] axis The direction of the axis. It does not need to be a unit vector
+/// \param[in] degrees The angle of the rotation, anticlockwise when looking down the axis
+/// \returns The transform
+Transform Transform::rotate(vec3::Vec3 const& axis, double degrees) noexcept
+{
+  auto const u = vec3::getUnitVector(axis);
+  auto const angle = degreesToRadians(degrees);
+  auto const c = static_cast<Scalar>(std::cos(angle));
+  auto const s = static_cast<Scalar>(std::sin(angle));
+  auto const k = 1 - c;
+  auto const x = u.x();
+  auto const y = u.y();
+  auto const z = u.z();
+
+  // Rodrigues' rotation formula
+  auto transform = Transform();
+  transform.m_rows[0] = {(k * x * x) + c, (k * x * y) - (s * z), (k * x * z) + (s * y), 0};
+  transform.m_rows[1] = {(k * x * y) + (s * z), (k * y * y) + c, (k * y * z) - (s * x), 0};
+  transform.m_rows[2] = {(k * x * z) - (s * y), (k * y * z) + (s * x), (k * z * z) + c, 0};
+
+  return transform;
+}
+
+/// Create a scaling along the axes
+/// \param[in] factors The factor of every axis
+/// \returns The transform
+Transform Transform::scale(vec3::Vec3 const& factors) noexcept
+{
+  auto transform = Transform();
+  transform.m_rows[0][0] = factors.x();
+  transform.m_rows[1][1] = factors.y();
+  transform.m_rows[2][2] = factors.z();
+
+  return transform;
+}
+
+/// Combine two transforms
+/// \param[in] other The transform applied first
+/// \returns The transform that applies other and then this one
+Transform Transform::operator*(Transform const& other) const noexcept
+{
+  auto product = Transform();
+
+  for (std::size_t row = 0; row < 3; ++row) {
+    for (std::size_t column = 0; column < 4; ++column) {
+      auto value = column == 3 ? m_rows[row][3] : Scalar {0};
+
+      for (std::size_t k = 0; k < 3; ++k) {
+        value += m_rows[row][k] * other.m_rows[k][column];
+      }
+
+      product.m_rows[row][column] = value;
+    }
+  }
+
+  return product;
+}
+
+/// Get the transform that undoes this one
+/// \returns The inverse
+/// \throws std::invalid_argument if the linear map is singular
+Transform Transform::getInverse() const
+{
+  auto const& m = m_rows;
+
+  // The inverse of the linear map is its adjugate over its determinant
+  auto const c00 = (m[1][1] * m[2][2]) - (m[1][2] * m[2][1]);
+  auto const c01 = (m[1][2] * m[2][0]) - (m[1][0] * m[2][2]);
+  auto const c02 = (m[1][0] * m[2][1]) - (m[1][1] * m[2][0]);
+  auto const determinant = (m[0][0] * c00) + (m[0][1] * c01) + (m[0][2] * c02);
+
+  if (determinant == 0 or not std::isfinite(determinant)) {
+    throw std::invalid_argument("the transform cannot be inverted");
+  }
+
+  auto const f = 1 / determinant;
+  auto inverse = Transform();
+  inverse.m_rows[0] = {c00 * f, ((m[0][2] * m[2][1]) - (m[0][1] * m[2][2])) * f,
+                       ((m[0][1] * m[1][2]) - (m[0][2] * m[1][1])) * f, 0};
+  inverse.m_rows[1] = {c01 * f, ((m[0][0] * m[2][2]) - (m[0][2] * m[2][0])) * f,
+                       ((m[0][2] * m[1][0]) - (m[0][0] * m[1][2])) * f, 0};
+  inverse.m_rows[2] = {c02 * f, ((m[0][1] * m[2][0]) - (m[0][0] * m[2][1])) * f,
+                       ((m[0][0] * m[1][1]) - (m[0][1] * m[1][0])) * f, 0};
+
+  // Undo the translation after the linear map has been undone
+  auto const offset = inverse.applyToVector(vec3::Vec3(m[0][3], m[1][3], m[2][3]));
+  inverse.m_rows[0][3] = -offset.x();
+  inverse.m_rows[1][3] = -offset.y();
+  inverse.m_rows[2][3] = -offset.z();
+
+  return inverse;
+}
+
+ray::Point3 Transform::applyToPoint(ray::Point3 const& point) const noexcept
+{
+  auto const& m = m_rows;
+
+  return ray::Point3((m[0][0] * point.x()) + (m[0][1] * point.y()) + (m[0][2] * point.z()) + m[0][3],
+                     (m[1][0] * point.x()) + (m[1][1] * point.y()) + (m[1][2] * point.z()) + m[1][3],
+                     (m[2][0] * point.x()) + (m[2][1] * point.y()) + (m[2][2] * point.z()) + m[2][3]);
+}
+
+/// Apply the linear map without the translation, as directions are transformed
+vec3::Vec3 Transform::applyToVector(vec3::Vec3 const& vector) const noexcept
+{
+  auto const& m = m_rows;
+
+  return vec3::Vec3((m[0][0] * vector.x()) + (m[0][1] * vector.y()) + (m[0][2] * vector.z()),
+                    (m[1][0] * vector.x()) + (m[1][1] * vector.y()) + (m[1][2] * vector.z()),
+                    (m[2][0] * vector.x()) + (m[2][1] * vector.y()) + (m[2][2] * vector.z()));
+}
+
+/// Apply the transpose of the linear map. The transpose of an inverse carries normals along with the surface
+vec3::Vec3 Transform::applyTransposeToVector(vec3::Vec3 const& vector) const noexcept
+{
+  auto const& m = m_rows;
+
+  return vec3::Vec3((m[0][0] * vector.x()) + (m[1][0] * vector.y()) + (m[2][0] * vector.z()),
+                    (m[0][1] * vector.x()) + (m[1][1] * vector.y()) + (m[2][1] * vector.z()),
+                    (m[0][2] * vector.x()) + (m[1][2] * vector.y()) + (m[2][2] * vector.z()));
+}
+
+/// Get the box that holds a box once it has been transformed
+bvh::Box Transform::applyToBox(bvh::Box const& box) const noexcept
+{
+  bvh::Box bounds;
+
+  if (box.isEmpty()) {
+    return bounds;
+  }
+
+  // An affine map takes the box to a parallelepiped, which lies within the box around its corners
+  for (std::size_t corner = 0; corner < 8; ++corner) {
+    auto const x = (corner & 1) != 0 ? box.upper[0] : box.lower[0];
+    auto const y = (corner & 2) != 0 ? box.upper[1] : box.lower[1];
+    auto const z = (corner & 4) != 0 ? box.upper[2] : box.lower[2];
+    auto const p = applyToPoint(ray::Point3(x, y, z));
+    bounds.grow(std::array<double, 3> {p.x(), p.y(), p.z()});
+  }
+
+  return bounds;
+}
+
+/// Place an object in the scene
+/// \param[in] object The object, in its own space
+/// \param[in] objectBounds The box the object lies within, in its own space
+/// \param[in] objectToWorld The transform from the space of the object to that of the scene
+/// \throws std::invalid_argument if the transform cannot be inverted
+Instance::Instance(std::shared_ptr<hittable::Hittable const> object, bvh::Box const& objectBounds,
+                   Transform const& objectToWorld)
+  : m_object(std::move(object))
+  , m_objectToWorld(objectToWorld)
+  , m_worldToObject(objectToWorld.getInverse())
+  , m_bounds(objectToWorld.applyToBox(objectBounds))
+{
+}
+
+/// Find where a ray hits the object
+/// \param[in] ray The ray, in the space of the scene
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the intersection, in the space of the scene. Its object index is the one the object
+/// gave it
+/// \returns true if there was an intersection and false otherwise
+/// \details The ray is carried into the space of the object. Its direction is not normalised, so distances along it
+/// are the same in both spaces
+bool Instance::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  RT_COUNT(instanceTests);
+
+  auto const objectRay = ray::Ray(m_worldToObject.applyToPoint(ray.getOrigin()),
+                                  m_worldToObject.applyToVector(ray.getDirection()), ray.getTime());
+
+  if (not m_object->hit(objectRay, tMin, tMax, record)) {
+    return false;
+  }
+
+  // The normal faces against the ray in the space of the object, and the inverse transpose keeps it facing against
+  // the ray in the space of the scene
+  record.point = ray.at(record.t);
+  record.normal = vec3::getUnitVector(m_worldToObject.applyTransposeToVector(record.normal));
+
+  return true;
+}
+
+/// Build the hierarchy over a set of instances
+/// \param[in] instances The instances
+/// \param[in] firstIndex The object index of the first instance
+InstanceBvh::InstanceBvh(std::vector<Instance> instances, std::size_t firstIndex)
+  : m_instances(std::move(instances))
+  , m_firstIndex(firstIndex)
+{
+  std::vector<bvh::Box> boxes;
+  boxes.reserve(m_instances.size());
+
+  for (auto const& instance : m_instances) {
+    boxes.push_back(instance.getBounds());
+  }
+
+  m_tree = bvh::buildOverBoxes(boxes);
+}
+
+/// Find the nearest instance a ray hits
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection. Its object index is the first index plus the index of the
+/// instance
+/// \returns true if there was an intersection and false otherwise
+bool InstanceBvh::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  if (m_tree.nodes.empty()) {
+    return false;
+  }
+
+  return bvh::traverse(m_tree.nodes, ray, tMin, tMax, [&](std::uint32_t first, std::uint32_t count, Scalar& closest) {
+    bool found = false;
+
+    for (auto k = first; k < first + count; ++k) {
+      auto const index = m_tree.indices[k];
+
+      if (m_instances[index].hit(ray, tMin, closest, record)) {
+        found = true;
+        closest = record.t;
+        record.objectIndex = m_firstIndex + index;
+      }
+    }
+
+    return found;
+  });
+}
+
+/// Build the hierarchy over the spheres of a scene
+/// \param[in] scene The scene. Only its materials and spheres are used
+/// \throws std::out_of_range if a sphere refers to a material that does not exist
+SphereGeometry::SphereGeometry(scene::Description const& scene)
+  : m_spheres(scene.spheres)
+  , m_tree(bvh::build(m_spheres))
+  , m_materials(scene.materials)
+  , m_bvh(m_spheres, m_tree.nodes, m_tree.indices, m_materials.getMaterials())
+{
+  for (auto const& sphere : m_spheres) {
+    if (sphere.material >= scene.materials.size()) {
+      throw std::out_of_range("a sphere refers to material " + std::to_string(sphere.material)
+                              + ", which does not exist");
+    }
+  }
+}
+
+}   // namespace rt::instance
@@ -0,0 +1,209 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef INSTANCE_HPP
+#define INSTANCE_HPP
+
+#include "Bvh.hpp"
+#include "Hittable.hpp"
+#include "Packet.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Vec3.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rt::instance {
+
+/// An affine transform: a linear map followed by a translation
+class Transform
+{
+public:
+  /// Create the identity transform
+  constexpr explicit Transform() noexcept = default;
+
+  /// Create a translation
+  /// \param[in] offset How far points move
+  /// \returns The transform
+  static Transform translate(vec3::Vec3 const& offset) noexcept;
+
+  /// Create a rotation about an axis through the origin
+  /// \param[in] axis The direction of the axis. It does not need to be a unit vector
+  /// \param[in] degrees The angle of the rotation, anticlockwise when looking down the axis
+  /// \returns The transform
+  static Transform rotate(vec3::Vec3 const& axis, double degrees) noexcept;
+
+  /// Create a scaling along the axes
+  /// \param[in] factors The factor of every axis
+  /// \returns The transform
+  static Transform scale(vec3::Vec3 const& factors) noexcept;
+
+  /// Combine two transforms
+  /// \param[in] other The transform applied first
+  /// \returns The transform that applies other and then this one
+  Transform operator*(Transform const& other) const noexcept;
+
+  /// Get the transform that undoes this one
+  /// \returns The inverse
+  /// \throws std::invalid_argument if the linear map is singular
+  Transform getInverse() const;
+
+  ray::Point3 applyToPoint(ray::Point3 const& point) const noexcept;
+
+  /// Apply the linear map without the translation, as directions are transformed
+  vec3::Vec3 applyToVector(vec3::Vec3 const& vector) const noexcept;
+
+  /// Apply the transpose of the linear map. The transpose of an inverse carries normals along with the surface
+  vec3::Vec3 applyTransposeToVector(vec3::Vec3 const& vector) const noexcept;
+
+  /// Get the box that holds a box once it has been transformed
+  bvh::Box applyToBox(bvh::Box const& box) const noexcept;
+
+private:
+  /// The rows of the matrix. The first three columns are the linear map and the fourth is the translation
+  std::array<std::array<Scalar, 4>, 3> m_rows {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}}};
+};
+
+/// A copy of an object placed in the scene by a transform. The object itself is shared with every other instance of
+/// it, so an instance only costs its transforms and bounds
+class Instance final : public hittable::Hittable
+{
+public:
+  /// Place an object in the scene
+  /// \param[in] object The object, in its own space
+  /// \param[in] objectBounds The box the object lies within, in its own space
+  /// \param[in] objectToWorld The transform from the space of the object to that of the scene
+  /// \throws std::invalid_argument if the transform cannot be inverted
+  explicit Instance(std::shared_ptr<hittable::Hittable const> object, bvh::Box const& objectBounds,
+                    Transform const& objectToWorld);
+
+  /// Find where a ray hits the object
+  /// \param[in] ray The ray, in the space of the scene
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[inout] record Receives the intersection, in the space of the scene. Its object index is the one the object
+  /// gave it
+  /// \returns true if there was an intersection and false otherwise
+  /// \details The ray is carried into the space of the object. Its direction is not normalised, so distances along it
+  /// are the same in both spaces
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+  /// Get the box the instance lies within, in the space of the scene
+  bvh::Box const& getBounds() const noexcept
+  {
+    return m_bounds;
+  }
+
+private:
+  std::shared_ptr<hittable::Hittable const> m_object;
+  Transform m_objectToWorld;
+  Transform m_worldToObject;
+  bvh::Box m_bounds;
+};
+
+/// The top level of a two-level hierarchy: a bounding volume hierarchy over instances, each of which holds the
+/// hierarchy of its own object
+class InstanceBvh final : public hittable::Hittable
+{
+public:
+  /// Build the hierarchy over a set of instances
+  /// \param[in] instances The instances
+  /// \param[in] firstIndex The object index of the first instance
+  explicit InstanceBvh(std::vector<Instance> instances, std::size_t firstIndex = 0);
+
+  /// Find the nearest instance a ray hits
+  /// \param[in] ray The ray
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[inout] record Receives the nearest intersection. Its object index is the first index plus the index of
+  /// the instance
+  /// \returns true if there was an intersection and false otherwise
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+  std::span<Instance const> getInstances() const noexcept
+  {
+    return m_instances;
+  }
+
+  bvh::Tree const& getTree() const noexcept
+  {
+    return m_tree;
+  }
+
+private:
+  std::vector<Instance> m_instances;
+  std::size_t m_firstIndex;
+  bvh::Tree m_tree;
+};
+
+/// A set of spheres with their own materials and hierarchy, held together so that instances can share them
+/// \details The hierarchy refers to the spheres and materials it holds, so the geometry can be neither copied nor
+/// moved
+class SphereGeometry final : public hittable::Hittable
+{
+public:
+  /// Build the hierarchy over the spheres of a scene
+  /// \param[in] scene The scene. Only its materials and spheres are used
+  /// \throws std::out_of_range if a sphere refers to a material that does not exist
+  explicit SphereGeometry(scene::Description const& scene);
+
+  SphereGeometry(SphereGeometry const&) = delete;
+  SphereGeometry& operator=(SphereGeometry const&) = delete;
+
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override
+  {
+    return m_bvh.hit(ray, tMin, tMax, record);
+  }
+
+  packet::Mask hitPacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                         std::span<hittable::HitRecord> records) const noexcept override
+  {
+    return m_bvh.hitPacket(packet, tMin, tMax, records);
+  }
+
+  std::size_t hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                        std::span<hittable::HitRecord> records) const noexcept override
+  {
+    return m_bvh.hitStream(rays, tMin, tMax, records);
+  }
+
+  /// Get the box the spheres stay within from time 0 to time 1
+  bvh::Box getBounds() const noexcept
+  {
+    return m_bvh.getBounds();
+  }
+
+private:
+  std::vector<scene::SphereData> m_spheres;
+  bvh::Tree m_tree;
+  scene::MaterialTable m_materials;
+  bvh::SphereBvh m_bvh;
+};
+
+}   // namespace rt::instance
+
+#endif
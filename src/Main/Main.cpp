@@ -24,20 +24,46 @@
 
 #include "Main.hpp"
 
+#include "Animation.hpp"
+#include "Aov.hpp"
+#include "BinaryScene.hpp"
+#include "Bvh.hpp"
+#include "BvhCache.hpp"
 #include "Camera.hpp"
 #include "Colour.hpp"
 #include "Dielectric.hpp"
+#include "Dispatch.hpp"
+#include "Distributed.hpp"
 #include "Hittable.hpp"
+#include "Heatmap.hpp"
 #include "HittableList.hpp"
 #include "Lambertian.hpp"
 #include "Material.hpp"
 #include "Metal.hpp"
+#include "Perf.hpp"
 #include "Ray.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "Server.hpp"
 #include "Sphere.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
 #include "Utilities.hpp"
 #include "Vec3.hpp"
+#include "World.hpp"
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace rt {
 
@@ -47,48 +73,36 @@ using namespace hittable;
 using namespace ray;
 using namespace material;
 
-/// \brief Produce a linear blend of white and blue colours
-/// \param[in] ray The ray whose colour is to be computed
-/// \returns A linear blend of white and blue colours
-Colour rayColour(Ray const& ray, Hittable const& world, int depthOfRecursion) noexcept
+/// Describe a random scene
+/// \returns A ground plane, a grid of small spheres with random materials, and three large spheres
+scene::Description describeRandomScene()
 {
-  HitRecord record;
-
-  if (depthOfRecursion <= 0) {
-    return Colour(0, 0, 0);
-  }
-
-  if (world.hit(ray, 0.001, rt::infinity, record)) {
-    auto scattered = Ray();
-    auto attenuation = Colour();
-
-    if (record.materialPtr->scatter(ray, record, attenuation, scattered)) {
-      return attenuation * rayColour(scattered, world, depthOfRecursion - 1);
-    }
-
-    return Colour(0, 0, 0);
-  }
-
-  auto const unitDirection = vec3::getUnitVector(ray.getDirection());
-  auto const t = 0.5 * (unitDirection.y() + 1.0);
-
-  // When t = 1.0, we'll have the colour blue
-  // When t = 0.0, we'll have the colour white
-  // In between, we'll have a blend of colours
-  // This produces a linear interpolation of the start and end colours
-  static constexpr auto start = Colour(1.0, 1.0, 1.0);
-  static constexpr auto end = Colour(0.5, 0.7, 1.0);
-
-  return (1.0 - t) * start + t * end;
-}
-
-/// Create a random scene
-/// \returns A HittableList instance containing random scene data
-hittable::HittableList randomScene()
-{
-  HittableList world;
-
-  world.add(new Sphere(Point3(0, -1000, 0), 1000, new Lambertian(Colour(0.5, 0.5, 0.5))));
+  using scene::MaterialType;
+
+  scene::Description description;
+
+  // Every sphere gets a material of its own, as randomScene() has always done
+  auto const addSphere = [&description](Point3 const& centre, double radius, scene::MaterialData const& material) {
+    description.materials.push_back(material);
+    description.spheres.push_back(scene::SphereData {
+      .centre = {centre.x(), centre.y(), centre.z()},
+      .radius = radius,
+      .material = static_cast<std::uint32_t>(description.materials.size() - 1)});
+  };
+  auto const lambertian = [](Colour const& albedo) {
+    return scene::MaterialData {.type = MaterialType::lambertian, .albedo = {albedo.r(), albedo.g(), albedo.b()}};
+  };
+  auto const metal = [](Colour const& albedo, double fuzz) {
+    return scene::MaterialData {
+      .type = MaterialType::metal, .albedo = {albedo.r(), albedo.g(), albedo.b()}, .parameter = fuzz};
+  };
+  auto const dielectric = [](double refractiveIndex) {
+    return scene::MaterialData {.type = MaterialType::dielectric, .parameter = refractiveIndex};
+  };
+
+  // The ground is a plane rather than a huge sphere, so that it stays out of the hierarchy over the spheres
+  description.materials.push_back(lambertian(Colour(0.5, 0.5, 0.5)));
+  description.shapes.push_back(scene::ShapeData {.type = scene::ShapeType::plane, .vector = {0, 1, 0}});
 
   for (int a = -11; a < 11; ++a) {
     for (int b = -11; b < 11; ++b) {
@@ -99,76 +113,317 @@ hittable::HittableList randomScene()
         // Diffuse
         if (chooseMaterial < 0.8) {
           auto const albedo = Colour::getRandomColour() * Colour::getRandomColour();
-          world.add(new Sphere(centre, 0.2, new Lambertian(albedo)));
+          addSphere(centre, 0.2, lambertian(albedo));
         }
         // Metal
         else if (chooseMaterial < 0.95) {
           auto const albedo = Colour::getRandomColour(0.5, 1);
           auto const fuzz = getRandomDoubleInRange(0, 0.5);
-          world.add(new Sphere(centre, 0.2, new Metal(albedo, fuzz)));
+          addSphere(centre, 0.2, metal(albedo, fuzz));
         }
         // Glass
         else {
-          world.add(new Sphere(centre, 0.2, new Dielectric(1.5)));
+          addSphere(centre, 0.2, dielectric(1.5));
         }
       }
     }
   }
 
-  world.add(new Sphere(Point3(0, 1, 0), 1.0, new Dielectric(1.5)));
-  world.add(new Sphere(Point3(-4, 1, 0), 1.0, new Lambertian(Colour(0.4, 0.2, 0.1))));
-  world.add(new Sphere(Point3(4, 1, 0), 1.0, new Metal(Colour(0.7, 0.6, 0.5), 0.0)));
+  addSphere(Point3(0, 1, 0), 1.0, dielectric(1.5));
+  addSphere(Point3(-4, 1, 0), 1.0, lambertian(Colour(0.4, 0.2, 0.1)));
+  addSphere(Point3(4, 1, 0), 1.0, metal(Colour(0.7, 0.6, 0.5), 0.0));
 
-  return world;
+  return description;
 }
 
-/// @brief Render a 256 px by 256 px PPM image
-void renderImage()
+/// Create a random scene
+/// \returns A HittableList instance containing random scene data
+hittable::HittableList randomScene()
 {
-  // Image
+  return scene::buildWorld(describeRandomScene());
+}
+
+namespace {
 
-  static constexpr auto aspectRatio {16.0 / 9.0};
-  static constexpr std::size_t imgWidth {400};
-  static constexpr std::size_t imgHeight {static_cast<size_t>(imgWidth / aspectRatio)};
-  static constexpr std::size_t samplesPerPixel = 100;
-  static constexpr int maxDepth = 50;
+/// Get the directory to cache BVHs in
+/// \param[in] options The options naming the cache directory or disabling the cache
+/// \returns The directory, or an empty path if nothing is to be cached
+std::filesystem::path getBvhCacheDirectory(options::Options const& options)
+{
+  if (not options.useBvhCache) {
+    return {};
+  }
 
-  // World
+  return options.bvhCacheDirectory.empty() ? bvhcache::getDefaultDirectory() : options.bvhCacheDirectory;
+}
 
-  HittableList world = randomScene();
+/// Prepare the scene given in the options, or a random scene, for rendering
+/// \param[in] options The options naming the scene and the BVH cache
+/// \returns The world
+std::unique_ptr<world::World> loadWorld(options::Options const& options)
+{
+  if (options.scenePath.empty()) {
+    auto description = [] {
+      auto const span = trace::Span("randomScene", "scene");
+      resetRandom();
+      return describeRandomScene();
+    }();
+
+    return std::make_unique<world::World>(std::move(description), getBvhCacheDirectory(options));
+  }
+
+  return world::World::load(options.scenePath, getBvhCacheDirectory(options));
+}
+
+/// Write the trace asked for in the options, if any
+/// \param[in] options The options naming the trace file
+/// \throws std::runtime_error if the trace file cannot be written
+void writeTrace(options::Options const& options)
+{
+  if (options.tracePath.empty()) {
+    return;
+  }
+
+  trace::stop();
+  std::ofstream file(options.tracePath);
+
+  if (not file) {
+    throw std::runtime_error("cannot open " + options.tracePath.string() + " for writing");
+  }
+
+  trace::writeChromeTrace(file);
+}
+
+/// Get the name workers load the scene given in the options by
+/// \param[in] options The options naming the scene
+/// \returns random for the random scene, or the absolute path of the scene file
+std::string getSceneName(options::Options const& options)
+{
+  return options.scenePath.empty() ? "random" : std::filesystem::absolute(options.scenePath).string();
+}
+
+/// Make the loader of the scenes that render jobs and frames name
+/// \param[in] options The options naming the BVH cache
+/// \returns A loader that loads the scene named random as the random scene and any other scene as a scene file
+world::Loader makeLoader(options::Options const& options)
+{
+  return [cacheDirectory = getBvhCacheDirectory(options)](std::string const& name) {
+    if (name == "random") {
+      // Rendering reseeds the generator of the calling thread, so it is reset to draw the same scene as a process that
+      // has rendered nothing
+      resetRandom();
+      auto description = describeRandomScene();
+      return std::make_unique<world::World>(std::move(description), cacheDirectory);
+    }
+
+    return world::World::load(name, cacheDirectory);
+  };
+}
+
+}   // namespace
+
+/// @brief Select the instruction set the hot kernels run with and log it
+/// @param[in] options The options naming the instruction set. The widest one the processor supports is used when
+/// they name none
+/// @throws std::runtime_error if the processor does not support the instruction set the options name
+void selectKernels(options::Options const& options)
+{
+  auto const detected = dispatch::detectIsa();
+  auto const isa = options.isa.value_or(detected);
+
+  dispatch::selectIsa(isa);
+
+  std::clog << "Using the " << dispatch::getIsaName(isa) << " kernels (" << dispatch::getIsaName(detected)
+            << " detected)\n";
+}
+
+/// @brief Serve render jobs on the Unix domain socket given in the options until asked to shut down
+/// @param[in] options The options naming the socket, the render threads and the BVH cache. The scene named random
+/// is the random scene, and any other scene is a scene file
+void serve(options::Options const& options)
+{
+  auto server = server::Server(options.servePath, options.threads, makeLoader(options));
+
+  std::clog << "Serving render jobs on " << options.servePath.string() << '\n';
+  server.run();
+}
+
+/// @brief Render tiles for coordinators on the address given in the options until the process is stopped
+/// @param[in] options The options naming the address, the render threads and the BVH cache. The scene named random
+/// is the random scene, and any other scene is a scene file
+void work(options::Options const& options)
+{
+  auto worker = distributed::Worker(options.workerAddress, options.threads, makeLoader(options));
+
+  std::clog << "Rendering tiles for coordinators on " << worker.getAddress() << '\n';
+  worker.run();
+}
+
+/// @brief Render a PPM image of the scene given in the options, or of a random scene
+/// @param[in] options The options controlling the scene and which auxiliary outputs are produced
+void renderImage(options::Options const& options)
+{
+  if (not options.tracePath.empty()) {
+    trace::start();
+    trace::setThreadName("main");
+  }
+
+  if (not options.workerAddresses.empty()
+      and (not options.aovPrefix.empty() or not options.heatmapPrefix.empty() or options.perfCounters)) {
+    throw std::invalid_argument("--aov, --heatmap and --perf-counters cannot be used with --workers");
+  }
+
+  // Workers trace single rays, and packets draw the random numbers of a tile in another order
+  if (not options.workerAddresses.empty() and options.packetSize != 0) {
+    throw std::invalid_argument("--packet cannot be used with --workers");
+  }
+
+  // Likewise the wavefront integrator, which scatters a bounce of every path of a tile before the next bounce
+  if (not options.workerAddresses.empty() and options.integrator != render::Integrator::path) {
+    throw std::invalid_argument("--integrator cannot be used with --workers");
+  }
+
+  if (options.packetSize != 0 and options.integrator != render::Integrator::path) {
+    throw std::invalid_argument("--packet cannot be used with --integrator wavefront");
+  }
+
+  if ((options.batchSize or options.sortRays) and options.integrator != render::Integrator::wavefront) {
+    throw std::invalid_argument("--batch and --sort-rays need --integrator wavefront");
+  }
+
+  if (not options.animationPath.empty()
+      and (not options.aovPrefix.empty() or not options.heatmapPrefix.empty() or options.perfCounters
+           or not options.workerAddresses.empty())) {
+    throw std::invalid_argument("--aov, --heatmap, --perf-counters and --workers cannot be used with --animation");
+  }
+
+  // Scene
+
+  auto const world = loadWorld(options);
+  auto const& description = world->getDescription();
+
+  // Converting a scene writes it with its hierarchy instead of rendering it
+
+  if (not options.convertPath.empty()) {
+    auto converted = description;
+    converted.materials.assign(world->getMaterials().begin(), world->getMaterials().end());
+    converted.spheres.assign(world->getSpheres().begin(), world->getSpheres().end());
+    converted.shapes.assign(world->getShapes().begin(), world->getShapes().end());
+    auto const hierarchy = bvh::Tree {{world->getNodes().begin(), world->getNodes().end()},
+                                      {world->getIndices().begin(), world->getIndices().end()}};
+
+    binaryscene::writeScene(options.convertPath, converted, &hierarchy);
+    return;
+  }
+
+  auto const imgWidth = description.imgWidth;
+  auto const imgHeight = description.imgHeight;
+  auto const samplesPerPixel = description.samplesPerPixel;
+
+  auto settings = render::Settings();
+  settings.imgWidth = imgWidth;
+  settings.imgHeight = imgHeight;
+  settings.samplesPerPixel = samplesPerPixel;
+  settings.maxDepth = description.maxDepth;
+  settings.threads = options.threads;
+  settings.packetSize = options.packetSize;
+  settings.integrator = options.integrator;
+  settings.batchSize = options.batchSize.value_or(settings.batchSize);
+  settings.sortRays = options.sortRays;
+
+  // An animation is rendered along its camera path instead of the camera of the scene
+
+  if (not options.animationPath.empty()) {
+    auto const keyframes = scene::loadCameraPath(options.animationPath);
+    auto pool = threadpool::ThreadPool(options.threads);
+
+    auto const start = std::chrono::steady_clock::now();
+    auto const frames = animation::renderAnimation(pool, *world, keyframes, settings, options.framePrefix);
+    auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::clog << "Rendered " << frames << " frames in " << seconds << " s, "
+              << static_cast<double>(frames) * 3600.0 / seconds << " frames per hour\n";
+    writeTrace(options);
+    return;
+  }
 
   // Camera
 
-  static constexpr auto lookFrom = Point3(13, 2, 3);
-  static constexpr auto lookAt = Point3(0, 0, 0);
-  static constexpr auto viewUp = vec3::Vec3(0, 1, 0);
-  auto const distanceToFocus = 10.0;
-  static constexpr auto aperture = 0.1;
+  auto const camera = scene::buildCamera(description);
+
+  // Auxiliary outputs
 
-  camera::Camera camera(lookFrom, lookAt, viewUp, 20, aspectRatio, aperture, distanceToFocus);
+  std::optional<aov::AovBuffers> aovs;
+  std::optional<heatmap::CostBuffers> costs;
+  std::optional<perf::Report> perfReport;
+
+  if (not options.aovPrefix.empty()) {
+    aovs.emplace(imgWidth, imgHeight);
+  }
+
+  if (not options.heatmapPrefix.empty()) {
+    costs.emplace(imgWidth, imgHeight);
+  }
+
+  if (options.perfCounters) {
+    perfReport.emplace();
+  }
+
+  auto outputs = render::Outputs();
+  outputs.aovs = aovs ? &*aovs : nullptr;
+  outputs.costs = costs ? &*costs : nullptr;
+  outputs.perf = perfReport ? &*perfReport : nullptr;
 
   // Render
 
-  std::cout << "P3\n" << imgWidth << ' ' << imgHeight << "\n255\n";
+  stats::reset();
+  auto const start = std::chrono::steady_clock::now();
+  auto const framebuffer = options.workerAddresses.empty()
+                           ? render::render(world->getHittable(), camera, settings, outputs)
+                           : distributed::renderOnWorkers(options.workerAddresses, getSceneName(options), *world,
+                                                          settings);
+  auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Output
+
+  render::writePpm(std::cout, render::tonemap(framebuffer, samplesPerPixel), imgWidth, imgHeight);
+
+  if (aovs) {
+    auto const span = trace::Span("writeAovs", "output");
+    aovs->write(options.aovPrefix);
+  }
+
+  if (costs) {
+    costs->write(options.heatmapPrefix, stats::enabled, std::clog);
 
-  for (std::size_t j = imgHeight - 1; j < imgHeight; --j) {
-    std::clog << "\rScanlines remaining: " << j << '\n' << std::flush;
+    if constexpr (not stats::enabled) {
+      std::clog << "Intersection test and path depth heatmaps need a build configured with "
+                   "-DMyProject_ENABLE_STATS=ON.\n";
+    }
+  }
+
+  if constexpr (stats::enabled) {
+    auto const snapshot = stats::collect();
+    stats::writeSummary(std::clog, snapshot, seconds);
 
-    for (std::size_t i = 0; i < imgWidth; ++i) {
-      Colour pixelColour(0, 0, 0);
+    if (not options.statsJsonPath.empty()) {
+      std::ofstream file(options.statsJsonPath);
 
-      for (std::size_t s = 0; s < samplesPerPixel; ++s) {
-        auto u = (static_cast<double>(i) + getRandomDouble()) / (imgWidth - 1);
-        auto v = (static_cast<double>(j) + getRandomDouble()) / (imgHeight - 1);
-        Ray ray = camera.getRay(u, v);
-        pixelColour += rayColour(ray, world, maxDepth);
+      if (not file) {
+        throw std::runtime_error("cannot open " + options.statsJsonPath.string() + " for writing");
       }
 
-      auto const colour = colour::mapToByteRange(pixelColour, samplesPerPixel);
-      colour::writeColour(std::cout, colour);
+      stats::writeJson(file, snapshot, seconds);
     }
   }
+  else if (not options.statsJsonPath.empty()) {
+    std::clog << "Statistics are compiled out. Configure with -DMyProject_ENABLE_STATS=ON to collect them.\n";
+  }
+
+  if (perfReport) {
+    perfReport->writeSummary(std::clog);
+  }
 
-  std::clog << "\rDone.            \n";
+  writeTrace(options);
 }
 }   // namespace rt
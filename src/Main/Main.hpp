@@ -28,7 +28,9 @@
 #include "Colour.hpp"
 #include "Hittable.hpp"
 #include "HittableList.hpp"
+#include "Options.hpp"
 #include "Ray.hpp"
+#include "Scene.hpp"
 
 namespace rt {
 
@@ -72,13 +74,29 @@ constexpr double rayHasHitSphere(ray::Point3 const& centre, double const radius,
   }
 }
 
-/// \brief Produce a linear blend of white and blue colours
-/// \param[in] ray The ray whose colour is to be computed
-/// \returns A linear blend of white and blue colours
-colour::Colour rayColour(ray::Ray const& ray, hittable::Hittable const& world, int depthOfRecursion) noexcept;
-
-/// \brief Render a 256 px by 256 px PPM image
-void renderImage();
+/// \brief Select the instruction set the hot kernels run with and log it
+/// \param[in] options The options naming the instruction set. The widest one the processor supports is used when
+/// they name none
+/// \throws std::runtime_error if the processor does not support the instruction set the options name
+void selectKernels(options::Options const& options);
+
+/// \brief Render a PPM image of the scene given in the options, or of a random scene
+/// \param[in] options The options controlling the scene and which auxiliary outputs are produced
+void renderImage(options::Options const& options = {});
+
+/// \brief Serve render jobs on the Unix domain socket given in the options until asked to shut down
+/// \param[in] options The options naming the socket, the render threads and the BVH cache. The scene named random
+/// is the random scene, and any other scene is a scene file
+void serve(options::Options const& options);
+
+/// \brief Render tiles for coordinators on the address given in the options until the process is stopped
+/// \param[in] options The options naming the address, the render threads and the BVH cache. The scene named random
+/// is the random scene, and any other scene is a scene file
+void work(options::Options const& options);
+
+/// Describe a random scene
+/// \returns A ground plane, a grid of small spheres with random materials, and three large spheres
+scene::Description describeRandomScene();
 
 /// Create a random scene
 /// \returns A HittableList instance containing random scene data
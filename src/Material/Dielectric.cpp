@@ -26,6 +26,7 @@
 
 #include "Colour.hpp"
 #include "Hittable.hpp"
+#include "Stats.hpp"
 #include "Utilities.hpp"
 #include "Vec3.hpp"
 
@@ -43,6 +44,8 @@ using ray::Ray;
 /// \returns True if the incidence ray is scattered, and false otherwise
 bool Dielectric::scatter(Ray const& rayIn, HitRecord const& record, Colour& attenuation, Ray& scattered) const noexcept
 {
+  RT_COUNT(dielectricScatters);
+
   attenuation = Colour(1.0, 1.0, 1.0);
   double const refractionRatio = record.frontFace ? (1.0 / m_refractiveIndex) : m_refractiveIndex;
 
@@ -60,7 +63,7 @@ bool Dielectric::scatter(Ray const& rayIn, HitRecord const& record, Colour& atte
     direction = vec3::getRefractedRay(unitDirection, record.normal, refractionRatio);
   }
 
-  scattered = Ray(record.point, direction);
+  scattered = Ray(record.point, direction, rayIn.getTime());
 
   return true;
 }
@@ -76,4 +79,18 @@ double Dielectric::getReflectance(double cosine, double refractiveIndex) noexcep
   return r0 + (1 - r0) * std::pow(1 - cosine, 5);
 }
 
+/// Get the fraction of light reflected by the dielectric material
+/// \returns The albedo of the material
+Colour Dielectric::getAlbedo() const noexcept
+{
+  return Colour(1.0, 1.0, 1.0);
+}
+
+/// Get which of the concrete materials the dielectric material is
+/// \returns Kind::dielectric
+Kind Dielectric::getKind() const noexcept
+{
+  return Kind::dielectric;
+}
+
 }   // namespace rt::material
@@ -47,6 +47,14 @@ public:
   bool scatter(ray::Ray const& rayIn, hittable::HitRecord const& record, colour::Colour& attenuation,
                ray::Ray& scattered) const noexcept override;
 
+  /// Get the fraction of light reflected by the dielectric material
+  /// \returns The albedo of the material
+  colour::Colour getAlbedo() const noexcept override;
+
+  /// Get which of the concrete materials the dielectric material is
+  /// \returns Kind::dielectric
+  Kind getKind() const noexcept override;
+
 private:
   double m_refractiveIndex {};
 
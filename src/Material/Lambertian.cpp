@@ -25,6 +25,7 @@
 #include "Lambertian.hpp"
 
 #include "Hittable.hpp"
+#include "Stats.hpp"
 #include "Vec3.hpp"
 
 namespace rt::material {
@@ -39,9 +40,10 @@ using ray::Ray;
 /// \param[out] attenuation How much the reflected ray is attenuated, if scattered
 /// \param[out] scattered The reflected ray, which might be scattered
 /// \returns True if the incidence ray is scattered, and false otherwise
-bool Lambertian::scatter([[maybe_unused]] Ray const& rayIn, HitRecord const& record, Colour& attenuation,
-                         Ray& scattered) const
+bool Lambertian::scatter(Ray const& rayIn, HitRecord const& record, Colour& attenuation, Ray& scattered) const
 {
+  RT_COUNT(lambertianScatters);
+
   auto scatterDirection = record.normal + vec3::getRandomUnitVector();
 
   // Catch degenerate scatter direction
@@ -49,10 +51,24 @@ bool Lambertian::scatter([[maybe_unused]] Ray const& rayIn, HitRecord const& rec
     scatterDirection = record.normal;
   }
 
-  scattered = Ray(record.point, scatterDirection);
+  scattered = Ray(record.point, scatterDirection, rayIn.getTime());
   attenuation = m_albedo;
 
   return true;
 }
 
+/// Get the fraction of light reflected by the lambertian material
+/// \returns The albedo of the material
+Colour Lambertian::getAlbedo() const noexcept
+{
+  return m_albedo;
+}
+
+/// Get which of the concrete materials the lambertian material is
+/// \returns Kind::lambertian
+Kind Lambertian::getKind() const noexcept
+{
+  return Kind::lambertian;
+}
+
 }   // namespace rt::material
@@ -47,6 +47,14 @@ public:
   bool scatter(ray::Ray const& rayIn, hittable::HitRecord const& record, colour::Colour& attenuation,
                ray::Ray& scattered) const override;
 
+  /// Get the fraction of light reflected by the lambertian material
+  /// \returns The albedo of the material
+  colour::Colour getAlbedo() const noexcept override;
+
+  /// Get which of the concrete materials the lambertian material is
+  /// \returns Kind::lambertian
+  Kind getKind() const noexcept override;
+
 private:
   colour::Colour m_albedo {};
 };
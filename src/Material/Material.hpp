@@ -25,31 +25,56 @@
 #ifndef MATERIAL_HPP
 #define MATERIAL_HPP
 
+#include "Vec3.hpp"
+#include <cstdint>
+
 // Forward declarations
 namespace rt {
 
 namespace hittable {
-class HitRecord;
-}
+template <typename T>
+class BasicHitRecord;
+using HitRecord = BasicHitRecord<Scalar>;
+}   // namespace hittable
 
 namespace ray {
-class Ray;
-}
+template <typename T>
+class BasicRay;
+using Ray = BasicRay<Scalar>;
+}   // namespace ray
 
 namespace colour {
-class Colour;
-}
+template <typename T>
+class BasicColour;
+using Colour = BasicColour<Scalar>;
+}   // namespace colour
 
 }   // namespace rt
 
 namespace rt::material {
 
+/// The concrete materials, which the wavefront integrator shades in separate queues
+enum class Kind : std::uint8_t
+{
+  lambertian,
+  metal,
+  dielectric
+};
+
 class Material
 {
 public:
   virtual ~Material() = default;
   virtual bool scatter(ray::Ray const& rayIn, hittable::HitRecord const& record, colour::Colour& attenuation,
                        ray::Ray& scattered) const = 0;
+
+  /// Get the fraction of light reflected by the material, independent of the incidence ray
+  /// \returns The albedo of the material
+  virtual colour::Colour getAlbedo() const noexcept = 0;
+
+  /// Get which of the concrete materials this is
+  /// \returns The kind of the material
+  virtual Kind getKind() const noexcept = 0;
 };
 
 }   // namespace rt::material
@@ -26,6 +26,7 @@
 
 #include "Colour.hpp"
 #include "Hittable.hpp"
+#include "Stats.hpp"
 #include "Vec3.hpp"
 
 namespace rt::material {
@@ -42,11 +43,27 @@ using ray::Ray;
 /// \returns True if the incidence ray is scattered, and false otherwise
 bool Metal::scatter(Ray const& rayIn, HitRecord const& record, Colour& attenuation, Ray& scattered) const noexcept
 {
+  RT_COUNT(metalScatters);
+
   auto const reflected = vec3::getReflectedRay(vec3::getUnitVector(rayIn.getDirection()), record.normal);
-  scattered = Ray(record.point, reflected + m_fuzz * vec3::getRandomVecInUnitSphere());
+  scattered = Ray(record.point, reflected + m_fuzz * vec3::getRandomVecInUnitSphere(), rayIn.getTime());
   attenuation = m_albedo;
 
   return (vec3::getDotProduct(scattered.getDirection(), record.normal) > 0);
 }
 
+/// Get the fraction of light reflected by the metallic material
+/// \returns The albedo of the material
+Colour Metal::getAlbedo() const noexcept
+{
+  return m_albedo;
+}
+
+/// Get which of the concrete materials the metallic material is
+/// \returns Kind::metal
+Kind Metal::getKind() const noexcept
+{
+  return Kind::metal;
+}
+
 }   // namespace rt::material
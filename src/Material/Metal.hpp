@@ -47,6 +47,14 @@ public:
   bool scatter(ray::Ray const& rayIn, hittable::HitRecord const& record, colour::Colour& attenuation,
                ray::Ray& scattered) const noexcept override;
 
+  /// Get the fraction of light reflected by the metallic material
+  /// \returns The albedo of the material
+  colour::Colour getAlbedo() const noexcept override;
+
+  /// Get which of the concrete materials the metallic material is
+  /// \returns Kind::metal
+  Kind getKind() const noexcept override;
+
 private:
   colour::Colour m_albedo {};
   double m_fuzz {};
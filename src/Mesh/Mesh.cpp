@@ -0,0 +1,878 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Mesh.hpp"
+
+#include "Dispatch.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) or defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define RT_HAS_MMAP 1
+#endif
+
+namespace rt::mesh {
+
+namespace {
+
+/// A file mapped into memory for reading, or read into memory where files cannot be mapped
+class MappedFile
+{
+public:
+  /// Map a file
+  /// \param[in] path The path of the file
+  /// \throws std::runtime_error if the file cannot be opened or mapped
+  explicit MappedFile(std::filesystem::path const& path)
+  {
+#ifdef RT_HAS_MMAP
+    auto const fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+      throw std::runtime_error("cannot open " + path.string());
+    }
+
+    struct stat status {};
+
+    if (::fstat(fd, &status) != 0) {
+      ::close(fd);
+      throw std::runtime_error("cannot read " + path.string());
+    }
+
+    m_size = static_cast<std::size_t>(status.st_size);
+
+    if (m_size > 0) {
+      m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    ::close(fd);
+
+    if (m_data == MAP_FAILED) {
+      m_data = nullptr;
+      throw std::runtime_error("cannot map " + path.string());
+    }
+
+    // The parsers read the file once from start to end
+    if (m_data != nullptr) {
+      ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+    }
+#else
+    std::ifstream file(path, std::ios::binary);
+
+    if (not file) {
+      throw std::runtime_error("cannot open " + path.string());
+    }
+
+    m_copy.resize(static_cast<std::size_t>(std::filesystem::file_size(path)));
+
+    if (not file.read(m_copy.data(), static_cast<std::streamsize>(m_copy.size()))) {
+      throw std::runtime_error("cannot read " + path.string());
+    }
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifdef RT_HAS_MMAP
+    if (m_data != nullptr) {
+      ::munmap(m_data, m_size);
+    }
+#endif
+  }
+
+  MappedFile(MappedFile const&) = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+
+  std::string_view getBytes() const noexcept
+  {
+#ifdef RT_HAS_MMAP
+    return m_data == nullptr ? std::string_view() : std::string_view(static_cast<char const*>(m_data), m_size);
+#else
+    return m_copy;
+#endif
+  }
+
+private:
+#ifdef RT_HAS_MMAP
+  void* m_data {nullptr};
+  std::size_t m_size {0};
+#else
+  std::string m_copy;
+#endif
+};
+
+constexpr bool isBlank(char c) noexcept
+{
+  return c == ' ' or c == '\t' or c == '\r';
+}
+
+/// Take the next token off the front of a line
+/// \param[inout] line The rest of the line, which loses the token and the blanks before it
+/// \returns The token, or an empty view at the end of the line
+std::string_view nextToken(std::string_view& line) noexcept
+{
+  std::size_t start = 0;
+
+  while (start < line.size() and isBlank(line[start])) {
+    ++start;
+  }
+
+  auto end = start;
+
+  while (end < line.size() and not isBlank(line[end])) {
+    ++end;
+  }
+
+  auto const token = line.substr(start, end - start);
+  line.remove_prefix(end);
+
+  return token;
+}
+
+/// Call a function with every line of a text and its number, without its comment
+template <typename Function>
+void forEachLine(std::string_view text, Function&& function)
+{
+  std::size_t number = 1;
+
+  while (not text.empty()) {
+    auto const end = std::min(text.find('\n'), text.size());
+    auto line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+
+    if (auto const comment = line.find('#'); comment != std::string_view::npos) {
+      line = line.substr(0, comment);
+    }
+
+    function(line, number++);
+  }
+}
+
+[[noreturn]] void fail(std::size_t line, std::string const& message)
+{
+  throw std::runtime_error("line " + std::to_string(line) + ": " + message);
+}
+
+/// Add the triangles of a fan around the first vertex of a polygon
+/// \param[in] polygon The vertex indices of the polygon
+/// \param[inout] triangles Receives the triangles
+void addFan(std::span<std::uint32_t const> polygon, std::vector<std::array<std::uint32_t, 3>>& triangles)
+{
+  for (std::size_t i = 2; i < polygon.size(); ++i) {
+    triangles.push_back({polygon[0], polygon[i - 1], polygon[i]});
+  }
+}
+
+/// The types the properties of a PLY file can have
+enum class PlyType : std::uint8_t
+{
+  int8,
+  uint8,
+  int16,
+  uint16,
+  int32,
+  uint32,
+  float32,
+  float64
+};
+
+PlyType parsePlyType(std::string_view name)
+{
+  if (name == "char" or name == "int8") {
+    return PlyType::int8;
+  }
+  if (name == "uchar" or name == "uint8") {
+    return PlyType::uint8;
+  }
+  if (name == "short" or name == "int16") {
+    return PlyType::int16;
+  }
+  if (name == "ushort" or name == "uint16") {
+    return PlyType::uint16;
+  }
+  if (name == "int" or name == "int32") {
+    return PlyType::int32;
+  }
+  if (name == "uint" or name == "uint32") {
+    return PlyType::uint32;
+  }
+  if (name == "float" or name == "float32") {
+    return PlyType::float32;
+  }
+  if (name == "double" or name == "float64") {
+    return PlyType::float64;
+  }
+
+  throw std::runtime_error("unknown PLY property type '" + std::string(name) + "'");
+}
+
+/// Get the number of bytes a value of a PLY type takes in the binary encodings
+std::size_t getBinarySize(PlyType type) noexcept
+{
+  switch (type) {
+    case PlyType::int8:
+    case PlyType::uint8:   return 1;
+    case PlyType::int16:
+    case PlyType::uint16:  return 2;
+    case PlyType::int32:
+    case PlyType::uint32:
+    case PlyType::float32: return 4;
+    case PlyType::float64: return 8;
+  }
+
+  return 1;
+}
+
+struct PlyProperty
+{
+  std::string name;
+  PlyType type {PlyType::float32};
+
+  /// Whether the property is a list of values, whose length comes first as a value of countType
+  bool isList {false};
+  PlyType countType {PlyType::uint8};
+};
+
+struct PlyElement
+{
+  std::string name;
+  std::size_t count {0};
+  std::vector<PlyProperty> properties;
+};
+
+/// Reverse the order of the bytes of an unsigned integer
+/// \param[in] value The integer
+/// \returns The integer with its bytes reversed
+template <typename U>
+constexpr U swapBytes(U value) noexcept
+{
+  if constexpr (sizeof(U) == 1) {
+    return value;
+  }
+#if defined(__GNUC__) or defined(__clang__)
+  else if constexpr (sizeof(U) == 2) {
+    return __builtin_bswap16(value);
+  }
+  else if constexpr (sizeof(U) == 4) {
+    return __builtin_bswap32(value);
+  }
+  else if constexpr (sizeof(U) == 8) {
+    return __builtin_bswap64(value);
+  }
+#endif
+  else {
+    U swapped {0};
+
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+      swapped = static_cast<U>((swapped << 8) | ((value >> (8 * i)) & 0xFF));
+    }
+
+    return swapped;
+  }
+}
+
+/// Reads the values of the body of a PLY file one at a time, in the encoding of the file
+class PlyReader
+{
+public:
+  /// \param[in] body The bytes after the header
+  /// \param[in] ascii Whether the values are written as text
+  /// \param[in] swap Whether the bytes of binary values are in the other order from the machine's
+  PlyReader(std::string_view body, bool ascii, bool swap) noexcept : m_body(body), m_ascii(ascii), m_swap(swap)
+  {
+  }
+
+  double read(PlyType type)
+  {
+    if (m_ascii) {
+      return readText();
+    }
+
+    switch (type) {
+      case PlyType::int8:    return readBinary<std::int8_t, std::uint8_t>();
+      case PlyType::uint8:   return readBinary<std::uint8_t, std::uint8_t>();
+      case PlyType::int16:   return readBinary<std::int16_t, std::uint16_t>();
+      case PlyType::uint16:  return readBinary<std::uint16_t, std::uint16_t>();
+      case PlyType::int32:   return readBinary<std::int32_t, std::uint32_t>();
+      case PlyType::uint32:  return readBinary<std::uint32_t, std::uint32_t>();
+      case PlyType::float32: return readBinary<float, std::uint32_t>();
+      case PlyType::float64: return readBinary<double, std::uint64_t>();
+    }
+
+    return 0;
+  }
+
+  /// Get the fewest bytes a value of a type can take in the encoding of the file
+  std::size_t getMinimumSize(PlyType type) const noexcept
+  {
+    return m_ascii ? 1 : getBinarySize(type);
+  }
+
+  /// Get the number of bytes that are still to be read
+  std::size_t getRemaining() const noexcept
+  {
+    return m_body.size() - m_pos;
+  }
+
+private:
+  double readText()
+  {
+    while (m_pos < m_body.size() and (isBlank(m_body[m_pos]) or m_body[m_pos] == '\n')) {
+      ++m_pos;
+    }
+
+    if (m_pos == m_body.size()) {
+      throw std::runtime_error("the PLY data ends early");
+    }
+
+    auto const* const first = m_body.data() + m_pos;
+    double value {};
+    auto const [end, error] = std::from_chars(first, m_body.data() + m_body.size(), value);
+
+    if (error != std::errc() or end == first) {
+      throw std::runtime_error("expected a number in the PLY data");
+    }
+
+    m_pos = static_cast<std::size_t>(end - m_body.data());
+
+    return value;
+  }
+
+  /// Read a value of type T, whose bytes are those of the unsigned type U
+  template <typename T, typename U>
+  double readBinary()
+  {
+    if (m_body.size() - m_pos < sizeof(U)) {
+      throw std::runtime_error("the PLY data ends early");
+    }
+
+    U bits {};
+    std::memcpy(&bits, m_body.data() + m_pos, sizeof(U));
+    m_pos += sizeof(U);
+
+    if (m_swap) {
+      bits = swapBytes(bits);
+    }
+
+    return static_cast<double>(std::bit_cast<T>(bits));
+  }
+
+  std::string_view m_body;
+  std::size_t m_pos {0};
+  bool m_ascii;
+  bool m_swap;
+};
+
+/// Convert a value read from a PLY file to a vertex index
+std::uint32_t toIndex(double value)
+{
+  if (not(value >= 0 and value <= std::numeric_limits<std::uint32_t>::max()) or value != std::floor(value)) {
+    throw std::runtime_error("a PLY face refers to vertex " + std::to_string(value));
+  }
+
+  return static_cast<std::uint32_t>(value);
+}
+
+/// Convert a value read from a PLY file to the length of a list
+/// \param[in] value The value
+/// \param[in] limit The most items the rest of the data can hold
+std::size_t toCount(double value, std::size_t limit)
+{
+  if (not(value >= 0 and value <= static_cast<double>(limit)) or value != std::floor(value)) {
+    throw std::runtime_error("a PLY list has " + std::to_string(value) + " items");
+  }
+
+  return static_cast<std::size_t>(value);
+}
+
+/// A ray sheared and scaled so that it runs along the z axis from the origin, as the watertight test of Woop, Benthin
+/// and Wald sees it
+struct ShearedRay
+{
+  explicit ShearedRay(ray::Ray const& ray) noexcept
+  {
+    auto const& o = ray.getOrigin();
+    auto const& d = ray.getDirection();
+    origin = {o.x(), o.y(), o.z()};
+    auto const direction = std::array<double, 3> {d.x(), d.y(), d.z()};
+
+    // The ray runs along its largest component, and the winding of the other two is kept when it runs backwards
+    kz = std::abs(direction[0]) > std::abs(direction[1]) ? 0 : 1;
+    kz = std::abs(direction[2]) > std::abs(direction[kz]) ? 2 : kz;
+    kx = (kz + 1) % 3;
+    ky = (kx + 1) % 3;
+
+    if (direction[kz] < 0) {
+      std::swap(kx, ky);
+    }
+
+    sx = direction[kx] / direction[kz];
+    sy = direction[ky] / direction[kz];
+    sz = 1.0 / direction[kz];
+  }
+
+  std::array<double, 3> origin;
+  std::size_t kx;
+  std::size_t ky;
+  std::size_t kz;
+  double sx;
+  double sy;
+  double sz;
+};
+
+/// Intersect a sheared ray with a triangle
+/// \param[in] ray The ray
+/// \param[in] p0 The first vertex
+/// \param[in] p1 The second vertex
+/// \param[in] p2 The third vertex
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] t Receives the distance of the intersection
+/// \returns true if there was an intersection
+/// \details Every triangle is tested the same way without branching on its shape, and the edge functions of an edge
+/// come out the same for both triangles that share it, so no ray slips through between them
+bool hitTriangle(ShearedRay const& ray, std::array<float, 3> const& p0, std::array<float, 3> const& p1,
+                 std::array<float, 3> const& p2, double tMin, double tMax, double& t) noexcept
+{
+  RT_COUNT(triangleTests);
+
+  auto const& o = ray.origin;
+  auto const a = std::array<double, 3> {p0[0] - o[0], p0[1] - o[1], p0[2] - o[2]};
+  auto const b = std::array<double, 3> {p1[0] - o[0], p1[1] - o[1], p1[2] - o[2]};
+  auto const c = std::array<double, 3> {p2[0] - o[0], p2[1] - o[1], p2[2] - o[2]};
+
+  auto const ax = a[ray.kx] - (ray.sx * a[ray.kz]);
+  auto const ay = a[ray.ky] - (ray.sy * a[ray.kz]);
+  auto const bx = b[ray.kx] - (ray.sx * b[ray.kz]);
+  auto const by = b[ray.ky] - (ray.sy * b[ray.kz]);
+  auto const cx = c[ray.kx] - (ray.sx * c[ray.kz]);
+  auto const cy = c[ray.ky] - (ray.sy * c[ray.kz]);
+
+  // The scaled barycentric coordinates are the areas the edges span with the ray
+  auto const u = (cx * by) - (cy * bx);
+  auto const v = (ax * cy) - (ay * cx);
+  auto const w = (bx * ay) - (by * ax);
+
+  if ((u < 0 or v < 0 or w < 0) and (u > 0 or v > 0 or w > 0)) {
+    return false;
+  }
+
+  auto const determinant = u + v + w;
+
+  if (determinant == 0) {
+    return false;
+  }
+
+  t = ((u * a[ray.kz]) + (v * b[ray.kz]) + (w * c[ray.kz])) * ray.sz / determinant;
+
+  return tMin <= t and t <= tMax;
+}
+
+vec3::Vec3 toVec3(std::array<float, 3> const& position) noexcept
+{
+  return vec3::Vec3(position[0], position[1], position[2]);
+}
+
+}   // namespace
+
+/// Parse a mesh in the Wavefront OBJ format
+/// \details Only vertex positions and faces are read, and every other statement is skipped. Faces with more than three
+/// vertices are split into a fan of triangles, and negative indices count back from the latest vertex
+/// \param[in] text The text of the mesh
+/// \returns The mesh
+/// \throws std::runtime_error naming the offending line if a vertex or face is not valid
+MeshData parseObj(std::string_view text)
+{
+  MeshData mesh;
+
+  // Count the statements first, so that the arrays of a large mesh are allocated once
+  std::size_t vertexCount = 0;
+  std::size_t faceCount = 0;
+
+  forEachLine(text, [&](std::string_view line, std::size_t) {
+    auto const keyword = nextToken(line);
+    vertexCount += keyword == "v" ? 1 : 0;
+    faceCount += keyword == "f" ? 1 : 0;
+  });
+
+  mesh.positions.reserve(vertexCount);
+  mesh.triangles.reserve(faceCount);
+  std::vector<std::uint32_t> polygon;
+
+  forEachLine(text, [&](std::string_view line, std::size_t number) {
+    auto const keyword = nextToken(line);
+
+    if (keyword == "v") {
+      auto& position = mesh.positions.emplace_back();
+
+      for (auto& coordinate : position) {
+        auto const token = nextToken(line);
+        auto const [end, error] = std::from_chars(token.data(), token.data() + token.size(), coordinate);
+
+        if (token.empty() or error != std::errc() or end != token.data() + token.size()) {
+          fail(number, "expected a vertex coordinate");
+        }
+      }
+    }
+    else if (keyword == "f") {
+      polygon.clear();
+
+      for (auto token = nextToken(line); not token.empty(); token = nextToken(line)) {
+        // A vertex of a face may be followed by its texture coordinate and normal, which are not used
+        std::int64_t index {};
+        auto const [end, error] = std::from_chars(token.data(), token.data() + token.size(), index);
+
+        if (error != std::errc() or end == token.data() or (end != token.data() + token.size() and *end != '/')) {
+          fail(number, "expected a vertex index, got '" + std::string(token) + "'");
+        }
+
+        auto const count = static_cast<std::int64_t>(mesh.positions.size());
+        auto const position = index < 0 ? count + index : index - 1;
+
+        if (index == 0 or position < 0 or position >= count) {
+          fail(number, "vertex " + std::to_string(index) + " has not been declared");
+        }
+
+        polygon.push_back(static_cast<std::uint32_t>(position));
+      }
+
+      if (polygon.size() < 3) {
+        fail(number, "a face needs at least three vertices");
+      }
+
+      addFan(polygon, mesh.triangles);
+    }
+  });
+
+  return mesh;
+}
+
+/// Parse a mesh in the PLY format
+/// \details The ASCII and both binary encodings are read. Only the x, y and z properties of the vertices and the
+/// vertex index list of the faces are kept, and faces with more than three vertices are split into a fan of triangles
+/// \param[in] bytes The contents of the file
+/// \returns The mesh
+/// \throws std::runtime_error if the header is not valid or the data is cut short
+MeshData parsePly(std::string_view bytes)
+{
+  auto const headerEnd = bytes.find("end_header");
+
+  if (not bytes.starts_with("ply") or headerEnd == std::string_view::npos) {
+    throw std::runtime_error("not a PLY file");
+  }
+
+  auto const bodyStart = bytes.find('\n', headerEnd);
+  auto const header = bytes.substr(0, headerEnd);
+  auto const body = bodyStart == std::string_view::npos ? std::string_view() : bytes.substr(bodyStart + 1);
+
+  std::string_view format;
+  std::vector<PlyElement> elements;
+
+  forEachLine(header, [&](std::string_view line, std::size_t number) {
+    auto const keyword = nextToken(line);
+
+    if (keyword == "format") {
+      format = nextToken(line);
+    }
+    else if (keyword == "element") {
+      auto& element = elements.emplace_back();
+      element.name = nextToken(line);
+      auto const count = nextToken(line);
+      auto const [end, error] = std::from_chars(count.data(), count.data() + count.size(), element.count);
+
+      if (error != std::errc() or end != count.data() + count.size()) {
+        fail(number, "expected an element count");
+      }
+    }
+    else if (keyword == "property") {
+      if (elements.empty()) {
+        fail(number, "a property comes before any element");
+      }
+
+      auto& property = elements.back().properties.emplace_back();
+      auto const type = nextToken(line);
+
+      if (type == "list") {
+        property.isList = true;
+        property.countType = parsePlyType(nextToken(line));
+        property.type = parsePlyType(nextToken(line));
+      }
+      else {
+        property.type = parsePlyType(type);
+      }
+
+      property.name = nextToken(line);
+    }
+  });
+
+  auto const ascii = format == "ascii";
+  auto const little = format == "binary_little_endian";
+
+  if (not ascii and not little and format != "binary_big_endian") {
+    throw std::runtime_error("unknown PLY format '" + std::string(format) + "'");
+  }
+
+  auto reader = PlyReader(body, ascii, not ascii and little != (std::endian::native == std::endian::little));
+  MeshData mesh;
+  std::vector<std::uint32_t> polygon;
+
+  for (auto const& element : elements) {
+    auto const isVertex = element.name == "vertex";
+    auto const isFace = element.name == "face";
+    std::array<double, 3> position {};
+    std::size_t coordinates = 0;
+    std::size_t itemSize = 0;
+
+    if (isVertex) {
+      for (auto const& property : element.properties) {
+        coordinates += property.name == "x" or property.name == "y" or property.name == "z" ? 1 : 0;
+      }
+
+      if (coordinates != 3) {
+        throw std::runtime_error("the PLY vertices have no x, y and z");
+      }
+    }
+
+    // An item without properties holds nothing to read. Every other one takes some bytes, which bounds the count of
+    // the header before anything is reserved for it
+    for (auto const& property : element.properties) {
+      itemSize += reader.getMinimumSize(property.isList ? property.countType : property.type);
+    }
+
+    if (itemSize == 0) {
+      continue;
+    }
+
+    if (element.count > reader.getRemaining() / itemSize) {
+      throw std::runtime_error("the PLY data ends early");
+    }
+
+    if (isVertex) {
+      mesh.positions.reserve(element.count);
+    }
+
+    if (isFace) {
+      mesh.triangles.reserve(element.count);
+    }
+
+    for (std::size_t item = 0; item < element.count; ++item) {
+      for (auto const& property : element.properties) {
+        if (property.isList) {
+          auto const count = toCount(reader.read(property.countType),
+                                     reader.getRemaining() / reader.getMinimumSize(property.type));
+          auto const keep = isFace and (property.name == "vertex_indices" or property.name == "vertex_index");
+          polygon.clear();
+
+          for (std::size_t i = 0; i < count; ++i) {
+            auto const value = reader.read(property.type);
+
+            if (keep) {
+              polygon.push_back(toIndex(value));
+            }
+          }
+
+          if (keep) {
+            addFan(polygon, mesh.triangles);
+          }
+
+          continue;
+        }
+
+        auto const value = reader.read(property.type);
+
+        if (isVertex and property.name.size() == 1 and property.name[0] >= 'x' and property.name[0] <= 'z') {
+          position[static_cast<std::size_t>(property.name[0] - 'x')] = value;
+        }
+      }
+
+      if (isVertex) {
+        mesh.positions.push_back({static_cast<float>(position[0]), static_cast<float>(position[1]),
+                                  static_cast<float>(position[2])});
+      }
+    }
+  }
+
+  return mesh;
+}
+
+/// Read a mesh file in the OBJ or PLY format, chosen by its extension
+/// \details The file is mapped into memory and parsed where it lies, so it is never copied
+/// \param[in] path The path of the mesh file
+/// \returns The mesh
+/// \throws std::runtime_error if the file cannot be read, has another extension or is not a valid mesh
+MeshData loadMesh(std::filesystem::path const& path)
+{
+  auto extension = path.extension().string();
+  std::ranges::transform(extension, extension.begin(),
+                         [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+  if (extension != ".obj" and extension != ".ply") {
+    throw std::runtime_error(path.string() + " is not an OBJ or PLY file");
+  }
+
+  auto const file = MappedFile(path);
+
+  try {
+    return extension == ".obj" ? parseObj(file.getBytes()) : parsePly(file.getBytes());
+  }
+  catch (std::runtime_error const& error) {
+    throw std::runtime_error(path.string() + ", " + error.what());
+  }
+}
+
+/// Build the hierarchy over the triangles of a mesh
+/// \param[in] data The mesh
+/// \param[in] material The material of every triangle. It must outlive the mesh
+/// \param[in] firstIndex The object index of the first triangle. The others follow it in the order of the data
+/// \throws std::out_of_range if a triangle refers to a vertex that does not exist
+TriangleMesh::TriangleMesh(MeshData data, material::Material* material, std::size_t firstIndex)
+  : m_positions(std::move(data.positions))
+  , m_material(material)
+  , m_firstIndex(firstIndex)
+{
+  std::vector<bvh::Box> boxes(data.triangles.size());
+
+  for (std::size_t i = 0; i < data.triangles.size(); ++i) {
+    for (auto const vertex : data.triangles[i]) {
+      if (vertex >= m_positions.size()) {
+        throw std::out_of_range("a triangle refers to vertex " + std::to_string(vertex) + ", which does not exist");
+      }
+
+      auto const& p = m_positions[vertex];
+      boxes[i].grow(std::array<double, 3> {p[0], p[1], p[2]});
+    }
+  }
+
+  auto tree = bvh::buildOverBoxes(boxes);
+  boxes = {};
+
+  // Put the triangles in the order of the leaves, which then refer to them directly
+  m_triangles.reserve(data.triangles.size());
+
+  for (auto const index : tree.indices) {
+    m_triangles.push_back(data.triangles[index]);
+  }
+
+  m_triangleIndices = std::move(tree.indices);
+  m_nodes = std::move(tree.nodes);
+}
+
+/// Find the nearest triangle a ray hits
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection. Its object index is the first index of the mesh plus the
+/// position of the triangle in the data the mesh was built from
+/// \returns true if there was an intersection and false otherwise
+/// \details The test is watertight: a ray that passes through an edge or vertex shared by several triangles hits at
+/// least one of them
+bool TriangleMesh::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  if (m_nodes.empty()) {
+    return false;
+  }
+
+  return dispatch::run([&]() noexcept { return traverse(ray, tMin, tMax, record); });
+}
+
+/// Get the box the triangles lie within
+/// \returns The bounds of the root of the hierarchy, or an empty box if there are no triangles
+bvh::Box TriangleMesh::getBounds() const noexcept
+{
+  return m_nodes.empty() ? bvh::Box {} : bvh::Box::of(m_nodes[0]);
+}
+
+/// Get the number of bytes the vertices, triangles and hierarchy take up
+std::size_t TriangleMesh::getMemoryUsage() const noexcept
+{
+  return (m_positions.capacity() * sizeof(m_positions[0])) + (m_triangles.capacity() * sizeof(m_triangles[0]))
+       + (m_triangleIndices.capacity() * sizeof(m_triangleIndices[0])) + (m_nodes.capacity() * sizeof(bvh::Node));
+}
+
+/// Walk the hierarchy for the nearest triangle a ray hits. hit runs it compiled for the selected instruction set
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection
+/// \returns true if there was an intersection and false otherwise
+/// \pre The hierarchy has at least one node
+bool TriangleMesh::traverse(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  auto const sheared = ShearedRay(ray);
+  double nearestT = 0;
+  std::uint32_t nearest = 0;
+
+  auto const found = bvh::traverse(m_nodes, ray, tMin, tMax, [&](std::uint32_t first, std::uint32_t count,
+                                                                  Scalar& closest) noexcept {
+    bool found = false;
+
+    for (auto k = first; k < first + count; ++k) {
+      auto const& triangle = m_triangles[k];
+      double t {};
+
+      if (hitTriangle(sheared, m_positions[triangle[0]], m_positions[triangle[1]], m_positions[triangle[2]], tMin,
+                      closest, t)) {
+        found = true;
+        nearestT = t;
+        nearest = k;
+        closest = static_cast<Scalar>(t);
+      }
+    }
+
+    return found;
+  });
+
+  if (not found) {
+    return false;
+  }
+
+  // Only the nearest hit needs its point and normal
+  auto const& triangle = m_triangles[nearest];
+  auto const p0 = toVec3(m_positions[triangle[0]]);
+  auto const p1 = toVec3(m_positions[triangle[1]]);
+  auto const p2 = toVec3(m_positions[triangle[2]]);
+
+  record.t = static_cast<Scalar>(nearestT);
+  record.point = ray.at(record.t);
+  record.setFaceNormal(ray, vec3::getUnitVector(vec3::getCrossProduct(p1 - p0, p2 - p0)));
+  record.materialPtr = m_material;
+  record.objectIndex = m_firstIndex + m_triangleIndices[nearest];
+
+  return true;
+}
+
+}   // namespace rt::mesh
@@ -0,0 +1,129 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include "Bvh.hpp"
+#include "Hittable.hpp"
+#include "Material.hpp"
+#include "Ray.hpp"
+#include "Vec3.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace rt::mesh {
+
+/// The vertices and triangles of a mesh
+struct MeshData
+{
+  /// The positions of the vertices, each shared by every triangle that meets at it
+  std::vector<std::array<float, 3>> positions;
+
+  /// The indices of the three vertices of every triangle, anticlockwise seen from the front
+  std::vector<std::array<std::uint32_t, 3>> triangles;
+};
+
+/// Parse a mesh in the Wavefront OBJ format
+/// \details Only vertex positions and faces are read, and every other statement is skipped. Faces with more than three
+/// vertices are split into a fan of triangles, and negative indices count back from the latest vertex
+/// \param[in] text The text of the mesh
+/// \returns The mesh
+/// \throws std::runtime_error naming the offending line if a vertex or face is not valid
+MeshData parseObj(std::string_view text);
+
+/// Parse a mesh in the PLY format
+/// \details The ASCII and both binary encodings are read. Only the x, y and z properties of the vertices and the
+/// vertex index list of the faces are kept, and faces with more than three vertices are split into a fan of triangles
+/// \param[in] bytes The contents of the file
+/// \returns The mesh
+/// \throws std::runtime_error if the header is not valid or the data is cut short
+MeshData parsePly(std::string_view bytes);
+
+/// Read a mesh file in the OBJ or PLY format, chosen by its extension
+/// \details The file is mapped into memory and parsed where it lies, so it is never copied
+/// \param[in] path The path of the mesh file
+/// \returns The mesh
+/// \throws std::runtime_error if the file cannot be read, has another extension or is not a valid mesh
+MeshData loadMesh(std::filesystem::path const& path);
+
+/// A mesh of triangles made of one material, found through a bounding volume hierarchy of its own
+/// \details The triangles are stored in the order the leaves of the hierarchy visit them, so a leaf's triangles lie
+/// side by side and the hierarchy needs no index array. A triangle takes 12 bytes and a vertex 12 bytes
+class TriangleMesh final : public hittable::Hittable
+{
+public:
+  /// Build the hierarchy over the triangles of a mesh
+  /// \param[in] data The mesh
+  /// \param[in] material The material of every triangle. It must outlive the mesh
+  /// \param[in] firstIndex The object index of the first triangle. The others follow it in the order of the data
+  /// \throws std::out_of_range if a triangle refers to a vertex that does not exist
+  explicit TriangleMesh(MeshData data, material::Material* material, std::size_t firstIndex = 0);
+
+  /// Find the nearest triangle a ray hits
+  /// \param[in] ray The ray
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[inout] record Receives the nearest intersection. Its object index is the first index of the mesh plus the
+  /// position of the triangle in the data the mesh was built from
+  /// \returns true if there was an intersection and false otherwise
+  /// \details The test is watertight: a ray that passes through an edge or vertex shared by several triangles hits at
+  /// least one of them
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+  /// Get the box the triangles lie within
+  /// \returns The bounds of the root of the hierarchy, or an empty box if there are no triangles
+  bvh::Box getBounds() const noexcept;
+
+  std::size_t getTriangleCount() const noexcept
+  {
+    return m_triangles.size();
+  }
+
+  /// Get the number of bytes the vertices, triangles and hierarchy take up
+  std::size_t getMemoryUsage() const noexcept;
+
+private:
+  /// Walk the hierarchy for the nearest triangle a ray hits. hit runs it compiled for the selected instruction set
+  /// \pre The hierarchy has at least one node
+  bool traverse(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept;
+
+  std::vector<std::array<float, 3>> m_positions;
+  std::vector<std::array<std::uint32_t, 3>> m_triangles;
+
+  /// The position of every triangle in the data the mesh was built from
+  std::vector<std::uint32_t> m_triangleIndices;
+
+  std::vector<bvh::Node> m_nodes;
+  material::Material* m_material;
+  std::size_t m_firstIndex;
+};
+
+}   // namespace rt::mesh
+
+#endif
@@ -0,0 +1,213 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Options.hpp"
+
+#include "Packet.hpp"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace rt::options {
+
+namespace {
+
+/// Get the value following the flag at the given index
+/// \param[in] args The command line arguments
+/// \param[inout] index The index of the flag. It is advanced to the index of the value
+/// \returns The value of the flag
+/// \throws std::invalid_argument if the flag is the last argument
+std::string_view getValue(std::span<std::string_view const> args, std::size_t& index)
+{
+  if (index + 1 >= args.size()) {
+    throw std::invalid_argument("missing value for " + std::string(args[index]));
+  }
+
+  return args[++index];
+}
+
+/// Get the value following the flag at the given index as a non-negative integer
+/// \param[in] args The command line arguments
+/// \param[inout] index The index of the flag. It is advanced to the index of the value
+/// \returns The value of the flag
+/// \throws std::invalid_argument if the value is missing or is not a non-negative integer
+std::size_t getCount(std::span<std::string_view const> args, std::size_t& index)
+{
+  auto const flag = args[index];
+  auto const value = getValue(args, index);
+  std::size_t count {};
+  auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+
+  if (error != std::errc() or end != value.data() + value.size()) {
+    throw std::invalid_argument("invalid value for " + std::string(flag) + ": " + std::string(value));
+  }
+
+  return count;
+}
+
+}   // namespace
+
+/// Parse the command line arguments of the application
+/// \param[in] args The command line arguments, excluding the program name
+/// \returns The options described by the arguments
+/// \throws std::invalid_argument if an argument is unknown or is missing its value
+Options parseOptions(std::span<std::string_view const> args)
+{
+  Options options;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    auto const arg = args[i];
+
+    if (arg == "--scene") {
+      options.scenePath = getValue(args, i);
+    }
+    else if (arg == "--convert") {
+      options.convertPath = getValue(args, i);
+    }
+    else if (arg == "--bvh-cache") {
+      options.bvhCacheDirectory = getValue(args, i);
+    }
+    else if (arg == "--no-bvh-cache") {
+      options.useBvhCache = false;
+    }
+    else if (arg == "--serve") {
+      options.servePath = getValue(args, i);
+    }
+    else if (arg == "--worker") {
+      options.workerAddress = getValue(args, i);
+    }
+    else if (arg == "--workers") {
+      auto addresses = getValue(args, i);
+
+      while (not addresses.empty()) {
+        auto const comma = std::min(addresses.find(','), addresses.size());
+
+        if (comma != 0) {
+          options.workerAddresses.emplace_back(addresses.substr(0, comma));
+        }
+
+        addresses.remove_prefix(std::min(comma + 1, addresses.size()));
+      }
+    }
+    else if (arg == "--animation") {
+      options.animationPath = getValue(args, i);
+    }
+    else if (arg == "--frames") {
+      options.framePrefix = getValue(args, i);
+    }
+    else if (arg == "--aov") {
+      options.aovPrefix = getValue(args, i);
+    }
+    else if (arg == "--stats-json") {
+      options.statsJsonPath = getValue(args, i);
+    }
+    else if (arg == "--heatmap") {
+      options.heatmapPrefix = getValue(args, i);
+    }
+    else if (arg == "--trace") {
+      options.tracePath = getValue(args, i);
+    }
+    else if (arg == "--perf-counters") {
+      options.perfCounters = true;
+    }
+    else if (arg == "--threads") {
+      options.threads = getCount(args, i);
+    }
+    else if (arg == "--packet") {
+      options.packetSize = getCount(args, i);
+
+      if (not packet::isValidSize(options.packetSize)) {
+        throw std::invalid_argument("--packet must be 4, 8 or 16");
+      }
+    }
+    else if (arg == "--integrator") {
+      options.integrator = render::parseIntegrator(getValue(args, i));
+    }
+    else if (arg == "--batch") {
+      options.batchSize = getCount(args, i);
+
+      if (options.batchSize == 0) {
+        throw std::invalid_argument("--batch must be at least 1");
+      }
+    }
+    else if (arg == "--sort-rays") {
+      options.sortRays = true;
+    }
+    else if (arg == "--isa") {
+      options.isa = dispatch::parseIsa(getValue(args, i));
+    }
+    else {
+      throw std::invalid_argument("unknown argument " + std::string(arg));
+    }
+  }
+
+  return options;
+}
+
+/// Get a description of the command line arguments understood by parseOptions
+/// \returns A multi-line usage message
+std::string_view getUsage() noexcept
+{
+  return "usage: app [options] > image.ppm\n"
+         "  --scene <path>       Render the scene in the given text or binary scene file\n"
+         "                       instead of a random one\n"
+         "  --convert <path>     Write the scene as a binary scene file with a prebuilt BVH\n"
+         "                       instead of rendering it\n"
+         "  --bvh-cache <dir>    Cache built BVHs in the given directory instead of\n"
+         "                       ~/.cache/raytracer/bvh\n"
+         "  --no-bvh-cache       Always build the BVH and never cache it\n"
+         "  --serve <socket>     Serve render jobs on the given Unix domain socket instead\n"
+         "                       of rendering one image\n"
+         "  --worker <address>   Render tiles for coordinators on the given Unix domain\n"
+         "                       socket or host:port instead of rendering one image\n"
+         "  --workers <list>     Share the tiles of the image out between the workers at the\n"
+         "                       given comma-separated addresses\n"
+         "  --animation <path>   Render every frame of the camera path in the given file to\n"
+         "                       <prefix>.<frame>.ppm instead of rendering one image\n"
+         "  --frames <prefix>    The path prefix of the frames of an animation. Defaults to\n"
+         "                       frame\n"
+         "  --aov <prefix>       Also write depth, normal, albedo, object id and sample\n"
+         "                       count images to <prefix>.<aov>.pfm\n"
+         "  --stats-json <path>  Write the ray tracing counters as JSON. Requires a build\n"
+         "                       configured with MyProject_ENABLE_STATS\n"
+         "  --heatmap <prefix>   Write false-colour images of the render time, intersection\n"
+         "                       tests and path depth of every pixel to <prefix>.<cost>.ppm\n"
+         "  --trace <path>       Write a Chrome trace of the render phases and tiles\n"
+         "  --perf-counters      Report cycles, instructions, cache and branch misses per\n"
+         "                       render thread and tile. Linux only\n"
+         "  --threads <count>    The number of render threads. Defaults to one per core\n"
+         "  --packet <size>      Trace the camera rays of blocks of 4, 8 or 16 neighbouring\n"
+         "                       pixels together\n"
+         "  --integrator <name>  Follow one path at a time (path) or advance every path of a\n"
+         "                       tile a bounce at a time (wavefront). Defaults to path\n"
+         "  --batch <size>       The most paths the wavefront integrator traces together.\n"
+         "                       Defaults to 16384\n"
+         "  --sort-rays          Sort the secondary rays of the wavefront integrator by\n"
+         "                       origin and direction before tracing them\n"
+         "  --isa <name>         Run the hot kernels compiled for generic, avx2 or avx512.\n"
+         "                       Defaults to the widest the processor supports\n";
+}
+
+}   // namespace rt::options
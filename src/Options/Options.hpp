@@ -0,0 +1,118 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include "Dispatch.hpp"
+#include "Render.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rt::options {
+
+/// The settings the application was invoked with
+struct Options
+{
+  /// Path of the scene file to render. A random scene is rendered when empty
+  std::filesystem::path scenePath {};
+
+  /// Path of the binary scene file to convert the scene to. The scene is rendered when empty
+  std::filesystem::path convertPath {};
+
+  /// The directory built BVHs are cached in. The default cache directory of the user is used when empty
+  std::filesystem::path bvhCacheDirectory {};
+
+  /// Whether BVHs are looked up in and added to the cache
+  bool useBvhCache {true};
+
+  /// Path of the Unix domain socket to serve render jobs on. A single image is rendered when empty
+  std::filesystem::path servePath {};
+
+  /// The address to render tiles for coordinators on: a Unix domain socket path, or host:port. A single image is
+  /// rendered when empty
+  std::string workerAddress {};
+
+  /// The addresses of the workers to share the tiles of the image out between. The image is rendered locally when
+  /// empty
+  std::vector<std::string> workerAddresses {};
+
+  /// Path of the camera path to render an animation along. A single image is rendered when empty
+  std::filesystem::path animationPath {};
+
+  /// Path prefix of the frames of an animation
+  std::filesystem::path framePrefix {"frame"};
+
+  /// Path prefix of the AOV images. AOVs are not produced when empty
+  std::filesystem::path aovPrefix {};
+
+  /// Path of the JSON ray tracing statistics. Statistics are only written when not empty
+  std::filesystem::path statsJsonPath {};
+
+  /// Path prefix of the per-pixel cost heatmaps. Costs are not recorded when empty
+  std::filesystem::path heatmapPrefix {};
+
+  /// Path of the Chrome trace of the render phases. Nothing is traced when empty
+  std::filesystem::path tracePath {};
+
+  /// Whether the hardware performance counters of every render thread and tile are reported
+  bool perfCounters {false};
+
+  /// The number of render threads. Zero selects one per hardware thread
+  std::size_t threads {0};
+
+  /// The number of camera rays traced together as a packet: 4, 8 or 16. Zero traces every ray on its own
+  std::size_t packetSize {0};
+
+  /// How the paths are traced
+  render::Integrator integrator {render::Integrator::path};
+
+  /// The most paths the wavefront integrator traces together. Its default is kept when empty
+  std::optional<std::size_t> batchSize {};
+
+  /// Whether the wavefront integrator sorts the secondary rays of every bounce before tracing them
+  bool sortRays {false};
+
+  /// The instruction set the hot kernels run with. The widest one the processor supports is used when empty
+  std::optional<dispatch::Isa> isa {};
+};
+
+/// Parse the command line arguments of the application
+/// \param[in] args The command line arguments, excluding the program name
+/// \returns The options described by the arguments
+/// \throws std::invalid_argument if an argument is unknown or is missing its value
+Options parseOptions(std::span<std::string_view const> args);
+
+/// Get a description of the command line arguments understood by parseOptions
+/// \returns A multi-line usage message
+std::string_view getUsage() noexcept;
+
+}   // namespace rt::options
+
+#endif
@@ -0,0 +1,96 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef PACKET_HPP
+#define PACKET_HPP
+
+#include "Ray.hpp"
+#include "Vec3.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace rt::packet {
+
+/// The most rays a packet holds
+inline constexpr std::size_t maxSize = 16;
+
+/// A bit for every lane of a packet, lane 0 being the lowest
+using Mask = std::uint32_t;
+
+/// Check whether the packet kernels are compiled for a number of lanes
+/// \param[in] size The number of lanes
+/// \returns true for 4, 8 and 16 lanes
+constexpr bool isValidSize(std::size_t size) noexcept
+{
+  return size == 4 or size == 8 or size == 16;
+}
+
+/// Rays that are traced through the scene together
+/// \details Besides the rays themselves, their components are kept lane by lane so that the loops of the packet
+/// kernels over the lanes vectorise. Lanes outside the active mask hold stale rays and are ignored
+struct RayPacket
+{
+  /// The number of lanes, which is one isValidSize accepts
+  std::size_t size {maxSize};
+
+  /// The lanes that hold a ray to trace
+  Mask active {0};
+
+  std::array<ray::Ray, maxSize> rays;
+  std::array<std::array<Scalar, maxSize>, 3> origins {};
+  std::array<std::array<Scalar, maxSize>, 3> directions {};
+  std::array<Scalar, maxSize> times {};
+
+  /// Put a ray into a lane and make the lane active
+  /// \param[in] lane The lane, which is less than the size of the packet
+  /// \param[in] ray The ray
+  constexpr void set(std::size_t lane, ray::Ray const& ray) noexcept
+  {
+    auto const& origin = ray.getOrigin();
+    auto const& direction = ray.getDirection();
+
+    rays[lane] = ray;
+    origins[0][lane] = origin.x();
+    origins[1][lane] = origin.y();
+    origins[2][lane] = origin.z();
+    directions[0][lane] = direction.x();
+    directions[1][lane] = direction.y();
+    directions[2][lane] = direction.z();
+    times[lane] = ray.getTime();
+    active |= Mask {1} << lane;
+  }
+
+  /// Check whether a lane holds a ray to trace
+  /// \param[in] lane The lane
+  /// \returns true if the lane is active
+  constexpr bool isActive(std::size_t lane) const noexcept
+  {
+    return ((active >> lane) & 1) != 0;
+  }
+};
+
+}   // namespace rt::packet
+
+#endif
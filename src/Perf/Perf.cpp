@@ -0,0 +1,389 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Perf.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+  #include <cerrno>
+  #include <cstring>
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace rt::perf {
+
+namespace {
+
+#if defined(__linux__)
+
+/// Get the perf_event_open type and config of an event
+/// \param[in] event The event
+/// \returns The type and config to open the event with
+std::pair<std::uint32_t, std::uint64_t> getEventConfig(Event event) noexcept
+{
+  switch (event) {
+    case Event::cycles:       return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+    case Event::instructions: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+    case Event::l1dMisses:
+      return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    case Event::llcMisses:    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+    case Event::branchMisses: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+    case Event::count:        break;
+  }
+
+  return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+}
+
+/// Open an event counting the user-space work of the calling thread on any CPU
+/// \param[in] event The event to open
+/// \param[in] leader The group leader to join, or -1 to open the event as the leader of a new group
+/// \returns The file descriptor of the event, or -1 with errno set
+int openEvent(Event event, int leader) noexcept
+{
+  auto const [type, config] = getEventConfig(event);
+
+  perf_event_attr attributes {};
+  attributes.size = sizeof(attributes);
+  attributes.type = type;
+  attributes.config = config;
+  attributes.disabled = leader == -1 ? 1 : 0;
+  // Counting only user space keeps the counters available at the default perf_event_paranoid level of 2
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+  attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED
+                         | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0));
+}
+
+#endif
+
+/// Get the number of events per thousand instructions
+double getPerKiloInstruction(Counts const& counts, Event event) noexcept
+{
+  auto const instructions = counts[Event::instructions];
+  return instructions > 0 ? 1000.0 * static_cast<double>(counts[event]) / static_cast<double>(instructions) : 0.0;
+}
+
+/// Write one row of the summary table
+/// \param[inout] out The output stream to write to
+/// \param[in] label The label of the row
+/// \param[in] counts The counts of the row
+void writeRow(std::ostream& out, std::string const& label, Counts const& counts)
+{
+  out << "  " << std::left << std::setw(12) << label << std::right;
+
+  for (std::size_t e = 0; e < eventCount; ++e) {
+    if (counts.measured[e]) {
+      out << std::setw(14) << counts.values[e];
+    }
+    else {
+      out << std::setw(14) << '-';
+    }
+  }
+
+  if (counts.isMeasured(Event::cycles) and counts.isMeasured(Event::instructions) and counts[Event::cycles] > 0) {
+    out << std::setw(8) << std::fixed << std::setprecision(2)
+        << static_cast<double>(counts[Event::instructions]) / static_cast<double>(counts[Event::cycles]);
+  }
+  else {
+    out << std::setw(8) << '-';
+  }
+
+  for (auto const event : {Event::l1dMisses, Event::llcMisses, Event::branchMisses}) {
+    if (counts.isMeasured(event) and counts.isMeasured(Event::instructions)) {
+      out << std::setw(10) << std::fixed << std::setprecision(2) << getPerKiloInstruction(counts, event);
+    }
+    else {
+      out << std::setw(10) << '-';
+    }
+  }
+
+  out << std::defaultfloat << '\n';
+}
+
+}   // namespace
+
+/// Add the values of another set of counts. An event stays measured only if it was measured in both
+Counts& Counts::operator+=(Counts const& other) noexcept
+{
+  for (std::size_t e = 0; e < eventCount; ++e) {
+    values[e] += other.values[e];
+    measured[e] = measured[e] and other.measured[e];
+  }
+
+  return *this;
+}
+
+/// Get the values counted since an earlier reading of the same counters
+Counts Counts::operator-(Counts const& earlier) const noexcept
+{
+  Counts difference;
+
+  for (std::size_t e = 0; e < eventCount; ++e) {
+    difference.measured[e] = measured[e] and earlier.measured[e];
+    difference.values[e] = difference.measured[e] ? values[e] - std::min(values[e], earlier.values[e]) : 0;
+  }
+
+  return difference;
+}
+
+/// Open and start the counters of the calling thread
+ThreadCounters::ThreadCounters()
+{
+  m_fds.fill(-1);
+
+#if defined(__linux__)
+  for (std::size_t e = 0; e < eventCount; ++e) {
+    auto const fd = openEvent(static_cast<Event>(e), m_leader);
+
+    if (fd == -1) {
+      if (m_error.empty()) {
+        m_error = std::string(getEventName(static_cast<Event>(e))) + ": " + std::strerror(errno);
+      }
+
+      continue;
+    }
+
+    m_fds[e] = fd;
+
+    if (m_leader == -1) {
+      m_leader = fd;
+    }
+  }
+
+  if (m_leader != -1) {
+    ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#else
+  m_error = "hardware counters are only supported on Linux";
+#endif
+}
+
+ThreadCounters::~ThreadCounters()
+{
+#if defined(__linux__)
+  // Members of a group are closed before the leader
+  for (auto const fd : m_fds) {
+    if (fd != -1 and fd != m_leader) {
+      close(fd);
+    }
+  }
+
+  if (m_leader != -1) {
+    close(m_leader);
+  }
+#endif
+}
+
+/// Read the current values of the counters
+/// \returns The values since the counters were opened. Nothing is measured if the counters could not be read
+Counts ThreadCounters::read() const noexcept
+{
+  Counts counts;
+
+#if defined(__linux__)
+  if (m_leader == -1) {
+    return counts;
+  }
+
+  // The group is read in one go as { nr, time_enabled, time_running, { value, id } * nr }
+  std::array<std::uint64_t, 3 + 2 * eventCount> buffer {};
+  auto const bytes = ::read(m_leader, buffer.data(), sizeof(buffer));
+
+  if (bytes < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) {
+    return counts;
+  }
+
+  auto const enabled = buffer[1];
+  auto const running = buffer[2];
+
+  if (running == 0) {
+    return counts;
+  }
+
+  // The events were opened in order, so the values are in the order of the events that were opened
+  std::size_t next = 0;
+
+  for (std::size_t e = 0; e < eventCount and next < buffer[0]; ++e) {
+    if (m_fds[e] == -1) {
+      continue;
+    }
+
+    auto const value = buffer[3 + 2 * next++];
+    counts.measured[e] = true;
+    counts.values[e] = enabled == running
+                       ? value
+                       : static_cast<std::uint64_t>(static_cast<double>(value) * static_cast<double>(enabled)
+                                                    / static_cast<double>(running));
+  }
+#endif
+
+  return counts;
+}
+
+/// Record the counts of a tile. May be called from any thread
+/// \param[in] tile The index of the tile
+/// \param[in] thread The render thread the tile was rendered on
+/// \param[in] counts The events counted while rendering the tile
+void Report::addTile(std::size_t tile, std::size_t thread, Counts const& counts)
+{
+  auto const lock = std::scoped_lock(m_mutex);
+  m_tiles.push_back(TileCounts {tile, thread, counts});
+}
+
+/// Record that a render thread could not open some of its counters. Only the first reason is kept
+/// \param[in] reason Why the counters could not be opened
+void Report::addError(std::string const& reason)
+{
+  auto const lock = std::scoped_lock(m_mutex);
+
+  if (m_error.empty()) {
+    m_error = reason;
+  }
+}
+
+/// Get the counts of every render thread, summed over its tiles
+/// \returns The counts indexed by render thread
+std::vector<Counts> Report::getThreadTotals() const
+{
+  std::vector<Counts> totals;
+  std::vector<bool> seen;
+
+  for (auto const& tile : m_tiles) {
+    if (tile.thread >= totals.size()) {
+      totals.resize(tile.thread + 1);
+      seen.resize(tile.thread + 1);
+    }
+
+    if (seen[tile.thread]) {
+      totals[tile.thread] += tile.counts;
+    }
+    else {
+      totals[tile.thread] = tile.counts;
+      seen[tile.thread] = true;
+    }
+  }
+
+  return totals;
+}
+
+/// Get the counts summed over every tile
+Counts Report::getTotal() const noexcept
+{
+  Counts total;
+  total.measured.fill(not m_tiles.empty());
+
+  for (auto const& tile : m_tiles) {
+    total += tile.counts;
+  }
+
+  return total;
+}
+
+/// Write the counts per thread, the total and the most expensive tiles, with the derived instructions per cycle
+/// and misses per thousand instructions
+/// \param[inout] out The output stream to write to
+/// \param[in] hottestTiles The number of tiles with the most cycles to list
+void Report::writeSummary(std::ostream& out, std::size_t hottestTiles) const
+{
+  auto const total = getTotal();
+
+  if (std::none_of(total.measured.begin(), total.measured.end(), [](bool measured) { return measured; })) {
+    out << "Hardware counters are unavailable";
+
+    if (not m_error.empty()) {
+      out << " (" << m_error << ')';
+    }
+
+    out << ". They need Linux, a PMU exposed to this machine and perf_event_paranoid <= 2.\n";
+    return;
+  }
+
+  out << "Hardware counters\n  " << std::left << std::setw(12) << "" << std::right;
+
+  for (std::size_t e = 0; e < eventCount; ++e) {
+    out << std::setw(14) << getEventName(static_cast<Event>(e));
+  }
+
+  out << std::setw(8) << "IPC" << std::setw(10) << "L1D MPKI" << std::setw(10) << "LLC MPKI" << std::setw(10)
+      << "BR MPKI" << '\n';
+
+  auto const threads = getThreadTotals();
+
+  for (std::size_t t = 0; t < threads.size(); ++t) {
+    writeRow(out, "thread " + std::to_string(t), threads[t]);
+  }
+
+  writeRow(out, "total", total);
+
+  if (not m_error.empty()) {
+    out << "  Not counted: " << m_error << '\n';
+  }
+
+  if (not total.isMeasured(Event::cycles) or hottestTiles == 0) {
+    return;
+  }
+
+  auto tiles = m_tiles;
+  auto const hottest = std::min(hottestTiles, tiles.size());
+  std::partial_sort(tiles.begin(), tiles.begin() + static_cast<std::ptrdiff_t>(hottest), tiles.end(),
+                    [](TileCounts const& a, TileCounts const& b) {
+                      return a.counts[Event::cycles] > b.counts[Event::cycles];
+                    });
+
+  out << "  Tiles with the most cycles\n";
+
+  for (std::size_t k = 0; k < hottest; ++k) {
+    writeRow(out, "tile " + std::to_string(tiles[k].tile), tiles[k].counts);
+  }
+}
+
+/// Get the name an event is reported under
+/// \param[in] event The event
+/// \returns The name of the event
+std::string_view getEventName(Event event) noexcept
+{
+  switch (event) {
+    case Event::cycles:       return "cycles";
+    case Event::instructions: return "instructions";
+    case Event::l1dMisses:    return "l1dMisses";
+    case Event::llcMisses:    return "llcMisses";
+    case Event::branchMisses: return "branchMisses";
+    case Event::count:        break;
+  }
+
+  return "unknown";
+}
+
+}   // namespace rt::perf
@@ -0,0 +1,169 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef PERF_HPP
+#define PERF_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rt::perf {
+
+/// The hardware events sampled around every tile
+enum class Event : std::size_t
+{
+  cycles,
+  instructions,
+  l1dMisses,
+  llcMisses,
+  branchMisses,
+  count
+};
+
+inline constexpr auto eventCount = static_cast<std::size_t>(Event::count);
+
+/// The values of the hardware events over some stretch of work
+struct Counts
+{
+  std::array<std::uint64_t, eventCount> values {};
+
+  /// Which events were counted. The values of events that were not are zero
+  std::array<bool, eventCount> measured {};
+
+  std::uint64_t operator[](Event event) const noexcept
+  {
+    return values[static_cast<std::size_t>(event)];
+  }
+
+  bool isMeasured(Event event) const noexcept
+  {
+    return measured[static_cast<std::size_t>(event)];
+  }
+
+  /// Add the values of another set of counts. An event stays measured only if it was measured in both
+  Counts& operator+=(Counts const& other) noexcept;
+
+  /// Get the values counted since an earlier reading of the same counters
+  Counts operator-(Counts const& earlier) const noexcept;
+};
+
+/// The hardware counters of the calling thread, opened with perf_event_open
+/// \details The events are opened as one group so that they are scheduled onto the PMU together, and are scaled
+/// up if the kernel had to multiplex them. Events the kernel refuses, and every event on platforms other than
+/// Linux, are left unmeasured rather than treated as errors
+class ThreadCounters
+{
+public:
+  /// Open and start the counters of the calling thread
+  ThreadCounters();
+  ~ThreadCounters();
+
+  ThreadCounters(ThreadCounters const&) = delete;
+  ThreadCounters& operator=(ThreadCounters const&) = delete;
+
+  /// Whether at least one event is being counted
+  bool isOpen() const noexcept
+  {
+    return m_leader != -1;
+  }
+
+  /// Get why the first event that could not be opened was refused, or an empty string if every event was opened
+  std::string const& getError() const noexcept
+  {
+    return m_error;
+  }
+
+  /// Read the current values of the counters
+  /// \returns The values since the counters were opened. Nothing is measured if the counters could not be read
+  Counts read() const noexcept;
+
+private:
+  /// The file descriptor of every event, or -1 if the event is not counted
+  std::array<int, eventCount> m_fds {};
+  /// The group leader, or -1 if no event is counted
+  int m_leader {-1};
+  std::string m_error;
+};
+
+/// The counts of a single tile
+struct TileCounts
+{
+  std::size_t tile;
+  /// The render thread the tile was rendered on, with 0 being the calling thread of render::render
+  std::size_t thread;
+  Counts counts;
+};
+
+/// Collects the counts of every tile of a render from the render threads
+class Report
+{
+public:
+  /// Record the counts of a tile. May be called from any thread
+  /// \param[in] tile The index of the tile
+  /// \param[in] thread The render thread the tile was rendered on
+  /// \param[in] counts The events counted while rendering the tile
+  void addTile(std::size_t tile, std::size_t thread, Counts const& counts);
+
+  /// Record that a render thread could not open some of its counters. Only the first reason is kept
+  /// \param[in] reason Why the counters could not be opened
+  void addError(std::string const& reason);
+
+  /// Get the counts of every tile, in the order they were recorded
+  std::vector<TileCounts> const& getTiles() const noexcept
+  {
+    return m_tiles;
+  }
+
+  /// Get the counts of every render thread, summed over its tiles
+  /// \returns The counts indexed by render thread
+  std::vector<Counts> getThreadTotals() const;
+
+  /// Get the counts summed over every tile
+  Counts getTotal() const noexcept;
+
+  /// Write the counts per thread, the total and the most expensive tiles, with the derived instructions per cycle
+  /// and misses per thousand instructions
+  /// \param[inout] out The output stream to write to
+  /// \param[in] hottestTiles The number of tiles with the most cycles to list
+  void writeSummary(std::ostream& out, std::size_t hottestTiles = 5) const;
+
+private:
+  std::mutex m_mutex;
+  std::vector<TileCounts> m_tiles;
+  std::string m_error;
+};
+
+/// Get the name an event is reported under
+/// \param[in] event The event
+/// \returns The name of the event
+std::string_view getEventName(Event event) noexcept;
+
+}   // namespace rt::perf
+
+#endif
@@ -0,0 +1,335 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Plane.hpp"
+
+#include "Dispatch.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+namespace rt::plane {
+
+namespace {
+
+/// The number of rays of a stream that go on to the objects together
+constexpr std::size_t streamBlockSize = 64;
+
+/// Scale the normal of a plane or disk to unit length, so that the distance to it is a single division
+scene::ShapeData normalise(scene::ShapeData shape) noexcept
+{
+  if (shape.type != scene::ShapeType::box) {
+    auto const& n = shape.vector;
+    auto const length = vec3::Vec3(n[0], n[1], n[2]).length();
+    shape.vector = {n[0] / length, n[1] / length, n[2] / length};
+  }
+
+  return shape;
+}
+
+/// Find the intersection of a ray with a plane or disk
+bool hitFlat(scene::ShapeData const& shape, ray::Ray const& ray, Scalar tMin, Scalar tMax,
+             hittable::HitRecord& record) noexcept
+{
+  auto const normal = vec3::Vec3(shape.vector[0], shape.vector[1], shape.vector[2]);
+  auto const point = ray::Point3(shape.point[0], shape.point[1], shape.point[2]);
+  auto const denominator = vec3::getDotProduct(normal, ray.getDirection());
+
+  // A ray along the plane never meets it
+  if (denominator == 0) {
+    return false;
+  }
+
+  auto const t = vec3::getDotProduct(normal, point - ray.getOrigin()) / denominator;
+
+  if (not(tMin <= t and t <= tMax)) {
+    return false;
+  }
+
+  auto const hitPoint = ray.at(t);
+
+  if (shape.type == scene::ShapeType::disk
+      and (hitPoint - point).lengthSquared() > static_cast<Scalar>(shape.radius * shape.radius)) {
+    return false;
+  }
+
+  record.t = t;
+  record.point = hitPoint;
+  record.setFaceNormal(ray, normal);
+
+  return true;
+}
+
+/// Find the intersection of a ray with an axis-aligned box with a slab test
+bool hitBox(scene::ShapeData const& shape, ray::Ray const& ray, Scalar tMin, Scalar tMax,
+            hittable::HitRecord& record) noexcept
+{
+  auto const& origin = ray.getOrigin();
+  auto const& direction = ray.getDirection();
+  auto tNear = tMin;
+  auto tFar = tMax;
+
+  // The axes of the faces the ray enters and leaves through, or 3 if it does neither within the range
+  int nearAxis = 3;
+  int farAxis = 3;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    auto const inverse = 1 / direction[axis];
+    auto t0 = (static_cast<Scalar>(shape.point[axis]) - origin[axis]) * inverse;
+    auto t1 = (static_cast<Scalar>(shape.vector[axis]) - origin[axis]) * inverse;
+
+    if (inverse < 0) {
+      std::swap(t0, t1);
+    }
+
+    if (t0 > tNear) {
+      tNear = t0;
+      nearAxis = axis;
+    }
+
+    if (t1 < tFar) {
+      tFar = t1;
+      farAxis = axis;
+    }
+  }
+
+  if (tNear > tFar or (nearAxis == 3 and farAxis == 3)) {
+    return false;
+  }
+
+  // The ray enters through the face facing it, or leaves through the face facing away when it starts inside
+  auto const entering = nearAxis != 3;
+  auto const axis = entering ? nearAxis : farAxis;
+  auto outwardNormal = vec3::Vec3(0, 0, 0);
+  outwardNormal[axis] = (direction[axis] < 0) == entering ? 1 : -1;
+
+  record.t = entering ? tNear : tFar;
+  record.point = ray.at(record.t);
+  record.setFaceNormal(ray, outwardNormal);
+
+  return true;
+}
+
+}   // namespace
+
+/// Find the intersection of a ray with a plane, disk or axis-aligned box within a range of distances
+/// \param[in] shape The shape. The normal of a plane or disk must be of unit length
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] record Receives the distance, point and normal of the intersection, if there is one. Its material and
+/// object index are left untouched
+/// \returns true if there was an intersection and false otherwise
+/// \details A plane or disk costs a dot product and a division, and a box a slab test. A ray that starts inside a box
+/// hits the face it leaves through
+bool hitShape(scene::ShapeData const& shape, ray::Ray const& ray, Scalar tMin, Scalar tMax,
+              hittable::HitRecord& record) noexcept
+{
+  RT_COUNT(shapeTests);
+
+  return shape.type == scene::ShapeType::box ? hitBox(shape, ray, tMin, tMax, record)
+                                             : hitFlat(shape, ray, tMin, tMax, record);
+}
+
+/// Create a shape
+/// \param[in] shape The shape. The normal of a plane or disk need not be of unit length, but must not be zero
+/// \param[in] material The material the shape is made of
+/// \param[in] objectIndex The object index of the hits on the shape
+Shape::Shape(scene::ShapeData const& shape, material::Material* material, std::size_t objectIndex) noexcept
+  : m_shape(normalise(shape))
+  , m_materialPtr(material)
+  , m_objectIndex(objectIndex)
+{
+}
+
+bool Shape::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  if (not hitShape(m_shape, ray, tMin, tMax, record)) {
+    return false;
+  }
+
+  record.materialPtr = m_materialPtr.get();
+  record.objectIndex = m_objectIndex;
+
+  return true;
+}
+
+/// Create a view of the shapes of a scene and the rest of its objects
+/// \param[in] shapes The shapes
+/// \param[in] materials The material objects the shapes refer to
+/// \param[in] objects The other objects. They must outlive the list
+/// \param[in] firstIndex The object index of the first shape. The others follow it in order
+/// \pre The material indices of the shapes are valid, and no normal is zero
+ShapeList::ShapeList(std::span<scene::ShapeData const> shapes, std::span<material::Material* const> materials,
+                     hittable::Hittable const& objects, std::size_t firstIndex)
+  : m_materials(materials)
+  , m_objects(&objects)
+  , m_firstIndex(firstIndex)
+{
+  m_shapes.reserve(shapes.size());
+
+  for (auto const& shape : shapes) {
+    m_shapes.push_back(normalise(shape));
+  }
+}
+
+/// Find the nearest shape or object a ray hits
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection
+/// \returns true if there was an intersection and false otherwise
+bool ShapeList::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  auto const hitShape = hitShapes(ray, tMin, tMax, record);
+  hittable::HitRecord objectRecord;
+
+  // An object as near as the shape wins, as a later object does in a HittableList
+  if (m_objects->hit(ray, tMin, hitShape ? record.t : tMax, objectRecord)) {
+    record = objectRecord;
+    return true;
+  }
+
+  return hitShape;
+}
+
+/// Find the nearest shape or object every active ray of a packet hits
+/// \param[in] packet The rays
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] records Receives the nearest intersection of every lane whose ray hits something
+/// \returns The lanes whose rays hit something
+/// \details The shapes are tested one ray at a time, and the packet then goes on to the objects as a whole, only as
+/// far as the furthest shape hit of its lanes
+packet::Mask ShapeList::hitPacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                                  std::span<hittable::HitRecord> records) const
+{
+  packet::Mask shapeHits = 0;
+  auto furthest = tMin;
+
+  for (std::size_t lane = 0; lane < packet.size; ++lane) {
+    if (not packet.isActive(lane)) {
+      continue;
+    }
+
+    if (hitShapes(packet.rays[lane], tMin, tMax, records[lane])) {
+      shapeHits |= packet::Mask {1} << lane;
+      furthest = std::max(furthest, records[lane].t);
+    }
+    else {
+      furthest = tMax;
+    }
+  }
+
+  std::array<hittable::HitRecord, packet::maxSize> objectRecords;
+  auto const objectHits = m_objects->hitPacket(packet, tMin, furthest, objectRecords);
+
+  for (std::size_t lane = 0; lane < packet.size; ++lane) {
+    auto const bit = packet::Mask {1} << lane;
+
+    if ((objectHits & bit) != 0 and ((shapeHits & bit) == 0 or objectRecords[lane].t <= records[lane].t)) {
+      records[lane] = objectRecords[lane];
+    }
+  }
+
+  return shapeHits | objectHits;
+}
+
+/// Find the nearest shape or object each ray of a stream hits
+/// \param[in] rays The rays
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+/// \param[out] records Receives the nearest intersection of every ray. The distance of the record of a ray that hits
+/// nothing is set to infinity
+/// \returns The number of rays that hit something
+/// \details The shapes are tested one ray at a time, and the stream then goes on to the objects as a whole, a block
+/// at a time, with every ray bounded by the shape it hit
+std::size_t ShapeList::hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                                 std::span<hittable::HitRecord> records) const
+{
+  constexpr auto miss = std::numeric_limits<Scalar>::infinity();
+  std::size_t hits = 0;
+  std::array<hittable::HitRecord, streamBlockSize> objectRecords;
+  std::array<Scalar, streamBlockSize> bounds;
+
+  for (std::size_t first = 0; first < rays.size(); first += streamBlockSize) {
+    auto const last = std::min(first + streamBlockSize, rays.size());
+
+    for (std::size_t r = first; r < last; ++r) {
+      if (hitShapes(rays[r], tMin, tMax[r], records[r])) {
+        bounds[r - first] = records[r].t;
+      }
+      else {
+        records[r].t = miss;
+        bounds[r - first] = tMax[r];
+      }
+    }
+
+    m_objects->hitStream(rays.subspan(first, last - first), tMin, std::span(bounds).first(last - first),
+                         objectRecords);
+
+    for (std::size_t r = first; r < last; ++r) {
+      auto const& objectRecord = objectRecords[r - first];
+
+      if (objectRecord.t != miss and objectRecord.t <= records[r].t) {
+        records[r] = objectRecord;
+      }
+
+      hits += records[r].t != miss ? 1 : 0;
+    }
+  }
+
+  return hits;
+}
+
+/// Find the nearest shape a ray hits
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[inout] record Receives the nearest intersection. Its object index follows the first index of the list
+/// \returns true if there was an intersection and false otherwise
+bool ShapeList::hitShapes(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  auto closest = tMax;
+  bool hitAnything = false;
+
+  for (std::size_t i = 0; i < m_shapes.size(); ++i) {
+    auto const& shape = m_shapes[i];
+
+    if (hitShape(shape, ray, tMin, closest, record)) {
+      hitAnything = true;
+      closest = record.t;
+      record.materialPtr = m_materials[shape.material];
+      record.objectIndex = m_firstIndex + i;
+    }
+  }
+
+  return hitAnything;
+}
+
+}   // namespace rt::plane
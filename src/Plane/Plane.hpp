@@ -0,0 +1,130 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef PLANE_HPP
+#define PLANE_HPP
+
+#include "Hittable.hpp"
+#include "Material.hpp"
+#include "Packet.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rt::plane {
+
+/// Find the intersection of a ray with a plane, disk or axis-aligned box within a range of distances
+/// \param[in] shape The shape. The normal of a plane or disk must be of unit length
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] record Receives the distance, point and normal of the intersection, if there is one. Its material and
+/// object index are left untouched
+/// \returns true if there was an intersection and false otherwise
+/// \details A plane or disk costs a dot product and a division, and a box a slab test. A ray that starts inside a box
+/// hits the face it leaves through
+bool hitShape(scene::ShapeData const& shape, ray::Ray const& ray, Scalar tMin, Scalar tMax,
+              hittable::HitRecord& record) noexcept;
+
+/// A plane, disk or axis-aligned box on its own, which owns its material like a sphere::Sphere
+class Shape final : public hittable::Hittable
+{
+public:
+  /// Create a shape
+  /// \param[in] shape The shape. The normal of a plane or disk need not be of unit length, but must not be zero
+  /// \param[in] material The material the shape is made of
+  /// \param[in] objectIndex The object index of the hits on the shape
+  explicit Shape(scene::ShapeData const& shape, material::Material* material, std::size_t objectIndex = 0) noexcept;
+
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+private:
+  scene::ShapeData m_shape;
+  std::unique_ptr<material::Material> m_materialPtr;
+  std::size_t m_objectIndex;
+};
+
+/// The planes, disks and boxes of a scene together with the rest of its objects
+/// \details The shapes are tested one by one before the other objects, which are usually a hierarchy over spheres.
+/// Keeping an infinite ground plane out of that hierarchy keeps its bounds tight, and the distance to the plane
+/// shortens the ray before it walks the hierarchy
+class ShapeList final : public hittable::Hittable
+{
+public:
+  /// Create a view of the shapes of a scene and the rest of its objects
+  /// \param[in] shapes The shapes
+  /// \param[in] materials The material objects the shapes refer to
+  /// \param[in] objects The other objects. They must outlive the list
+  /// \param[in] firstIndex The object index of the first shape. The others follow it in order
+  /// \pre The material indices of the shapes are valid, and no normal is zero
+  explicit ShapeList(std::span<scene::ShapeData const> shapes, std::span<material::Material* const> materials,
+                     hittable::Hittable const& objects, std::size_t firstIndex);
+
+  /// Find the nearest shape or object a ray hits
+  /// \param[in] ray The ray
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[inout] record Receives the nearest intersection
+  /// \returns true if there was an intersection and false otherwise
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+  /// Find the nearest shape or object every active ray of a packet hits
+  /// \param[in] packet The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection
+  /// \param[out] records Receives the nearest intersection of every lane whose ray hits something
+  /// \returns The lanes whose rays hit something
+  /// \details The shapes are tested one ray at a time, and the packet then goes on to the objects as a whole, only
+  /// as far as the furthest shape hit of its lanes
+  packet::Mask hitPacket(packet::RayPacket const& packet, Scalar tMin, Scalar tMax,
+                         std::span<hittable::HitRecord> records) const override;
+
+  /// Find the nearest shape or object each ray of a stream hits
+  /// \param[in] rays The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+  /// \param[out] records Receives the nearest intersection of every ray. The distance of the record of a ray that
+  /// hits nothing is set to infinity
+  /// \returns The number of rays that hit something
+  /// \details The shapes are tested one ray at a time, and the stream then goes on to the objects as a whole, a
+  /// block at a time
+  std::size_t hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                        std::span<hittable::HitRecord> records) const override;
+
+private:
+  /// Find the nearest shape a ray hits
+  bool hitShapes(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept;
+
+  std::vector<scene::ShapeData> m_shapes;
+  std::span<material::Material* const> m_materials;
+  hittable::Hittable const* m_objects;
+  std::size_t m_firstIndex;
+};
+
+}   // namespace rt::plane
+
+#endif
@@ -28,48 +28,66 @@
 #include "Vec3.hpp"
 
 namespace rt::ray {
+/// A point in 3d space whose coordinates are of the scalar type T
+template <typename T>
+using BasicPoint3 = vec3::BasicVec3<T>;
+
 using Point3 = vec3::Vec3;
 
-class Ray
+/// A ray whose origin, direction and time are of the scalar type T
+template <typename T>
+class BasicRay
 {
 public:
   /// @brief Default constructor
-  constexpr explicit Ray() noexcept = default;
+  constexpr explicit BasicRay() noexcept = default;
 
   /// @brief Constructor. Create a new Ray with the given origin and direction
   /// @param[in] origin The origin of the ray
   /// @param[in] direction The direction the ray is travelling towards
-  constexpr explicit Ray(Point3 const& origin, vec3::Vec3 const& direction) noexcept
-    : m_origin(origin), m_direction(direction)
+  /// @param[in] time The moment the ray is cast at, which places moving objects along their paths
+  constexpr explicit BasicRay(BasicPoint3<T> const& origin, vec3::BasicVec3<T> const& direction, T time = 0) noexcept
+    : m_origin(origin), m_direction(direction), m_time(time)
   {
   }
 
   /// @brief Get the origin of this ray
   /// @return The origin of the ray
-  constexpr Point3 const& getOrigin() const noexcept
+  constexpr BasicPoint3<T> const& getOrigin() const noexcept
   {
     return m_origin;
   }
 
   /// @brief Get the direction this ray is travelling towards
   /// @return The direction the ray is travelling towards
-  constexpr vec3::Vec3 const& getDirection() const noexcept
+  constexpr vec3::BasicVec3<T> const& getDirection() const noexcept
   {
     return m_direction;
   }
 
+  /// @brief Get the moment the ray is cast at
+  /// @return The time of the ray
+  constexpr T getTime() const noexcept
+  {
+    return m_time;
+  }
+
   /// @brief Get the point a given distance from the ray's origin
   /// @param[in] t The distance from the ray's origin
   /// @return The point at the given distance from the ray's origin
-  constexpr Point3 at(double t) const noexcept
+  constexpr BasicPoint3<T> at(T t) const noexcept
   {
     return m_origin + (t * m_direction);
   }
 
 private:
-  Point3 m_origin;
-  vec3::Vec3 m_direction;
+  BasicPoint3<T> m_origin;
+  vec3::BasicVec3<T> m_direction;
+  T m_time {0};
 };
+
+/// The ray the renderer works with
+using Ray = BasicRay<Scalar>;
 }   // namespace rt::ray
 
 #endif
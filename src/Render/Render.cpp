@@ -0,0 +1,481 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Render.hpp"
+
+#include "Material.hpp"
+#include "Packet.hpp"
+#include "Stats.hpp"
+#include "Trace.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include "Wavefront.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace rt::render {
+
+using colour::Colour;
+using hittable::HitRecord;
+using hittable::Hittable;
+using ray::Ray;
+
+/// Split an image into square tiles, starting from the top row as that is the order the image is written in
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+/// \param[in] tileSize The length of the sides of a tile. Tiles on the right and top edges may be smaller
+/// \returns The tiles covering the image
+std::vector<Tile> makeTiles(std::size_t width, std::size_t height, std::size_t tileSize)
+{
+  std::vector<Tile> tiles;
+
+  for (std::size_t y1 = height; y1 > 0; y1 -= std::min(y1, tileSize)) {
+    for (std::size_t x0 = 0; x0 < width; x0 += tileSize) {
+      tiles.push_back(Tile {x0, y1 - std::min(y1, tileSize), std::min(x0 + tileSize, width), y1});
+    }
+  }
+
+  return tiles;
+}
+
+/// Look an integrator up by its name
+/// \param[in] name path or wavefront
+/// \returns The integrator
+/// \throws std::invalid_argument if there is no integrator with the name
+Integrator parseIntegrator(std::string_view name)
+{
+  if (name == "path") {
+    return Integrator::path;
+  }
+
+  if (name == "wavefront") {
+    return Integrator::wavefront;
+  }
+
+  throw std::invalid_argument("unknown integrator " + std::string(name));
+}
+
+/// Get the colour of the sky in the direction of a ray that hits nothing
+/// \param[in] ray The ray
+/// \returns A linear blend of white and blue colours
+Colour getSkyColour(Ray const& ray) noexcept
+{
+  auto const unitDirection = vec3::getUnitVector(ray.getDirection());
+  auto const t = 0.5 * (unitDirection.y() + 1.0);
+
+  // When t = 1.0, we'll have the colour blue
+  // When t = 0.0, we'll have the colour white
+  // In between, we'll have a blend of colours
+  // This produces a linear interpolation of the start and end colours
+  static constexpr auto start = Colour(1.0, 1.0, 1.0);
+  static constexpr auto end = Colour(0.5, 0.7, 1.0);
+
+  return (1.0 - t) * start + t * end;
+}
+
+namespace {
+
+/// Follow a path on from the point its ray hit
+/// \param[in] ray The ray
+/// \param[in] record Where the ray hit
+/// \param[in] world The objects in the scene
+/// \param[in] depthOfRecursion The number of rays the path may still trace, including this one
+/// \param[inout] touched If not null, receives the object index of every later intersection along the path
+/// \returns The light the ray carries back
+Colour shadeHit(Ray const& ray, HitRecord const& record, Hittable const& world, int depthOfRecursion,
+                std::vector<std::uint32_t>* touched) noexcept
+{
+  auto scattered = Ray();
+  auto attenuation = Colour();
+
+  if (record.materialPtr->scatter(ray, record, attenuation, scattered)) {
+    RT_COUNT(secondaryRays);
+    return attenuation * rayColour(scattered, world, depthOfRecursion - 1, nullptr, touched);
+  }
+
+  RT_COUNT(absorptions);
+
+  return Colour(0, 0, 0);
+}
+
+}   // namespace
+
+/// \brief Produce a linear blend of white and blue colours
+/// \param[in] ray The ray whose colour is to be computed
+/// \param[out] primaryHit If not null, receives the first intersection of the ray. Its t is set to infinity if the
+/// ray hits nothing
+/// \param[inout] touched If not null, receives the object index of every intersection along the path
+/// \returns A linear blend of white and blue colours
+Colour rayColour(Ray const& ray, Hittable const& world, int depthOfRecursion, HitRecord* primaryHit,
+                 std::vector<std::uint32_t>* touched) noexcept
+{
+  HitRecord record;
+
+  if (depthOfRecursion <= 0) {
+    RT_COUNT(depthLimits);
+
+    if (primaryHit) {
+      primaryHit->t = rt::infinity;
+    }
+
+    return Colour(0, 0, 0);
+  }
+
+  if (world.hit(ray, 0.001, rt::infinity, record)) {
+    if (primaryHit) {
+      *primaryHit = record;
+    }
+
+    if (touched) {
+      touched->push_back(static_cast<std::uint32_t>(record.objectIndex));
+    }
+
+    return shadeHit(ray, record, world, depthOfRecursion, touched);
+  }
+
+  RT_COUNT(skyMisses);
+
+  if (primaryHit) {
+    primaryHit->t = rt::infinity;
+  }
+
+  return getSkyColour(ray);
+}
+
+namespace {
+
+/// Trace the pixels of a tile in small blocks, whose camera rays are traced through the scene together as packets
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution, sampling and packet parameters
+/// \param[in] tile The tile
+/// \param[inout] framebuffer Receives the sum of the samples of every pixel of the tile
+/// \details Only the camera rays go in packets. The bounces after them scatter in every direction and are traced one
+/// at a time
+void tracePackets(Hittable const& world, camera::Camera const& camera, Settings const& settings, Tile const& tile,
+                  std::span<Colour> framebuffer) noexcept
+{
+  auto const imgWidth = settings.imgWidth;
+  auto const imgHeight = settings.imgHeight;
+
+  // Blocks are 2 x 2, 4 x 2 or 4 x 4 pixels, and lose the lanes that would fall outside the tile
+  auto const blockWidth = settings.packetSize == 4 ? std::size_t {2} : std::size_t {4};
+  auto const blockHeight = settings.packetSize / blockWidth;
+
+  auto packet = packet::RayPacket();
+  packet.size = settings.packetSize;
+  std::array<HitRecord, packet::maxSize> records;
+  std::array<Colour, packet::maxSize> pixelColours;
+
+  for (std::size_t j0 = tile.y0; j0 < tile.y1; j0 += blockHeight) {
+    for (std::size_t i0 = tile.x0; i0 < tile.x1; i0 += blockWidth) {
+      pixelColours.fill(Colour(0, 0, 0));
+
+      for (std::size_t s = 0; s < settings.samplesPerPixel; ++s) {
+        packet.active = 0;
+
+        for (std::size_t lane = 0; lane < packet.size; ++lane) {
+          auto const i = i0 + (lane % blockWidth);
+          auto const j = j0 + (lane / blockWidth);
+
+          if (i < tile.x1 and j < tile.y1) {
+            auto u = (static_cast<double>(i) + getRandomDouble()) / static_cast<double>(imgWidth - 1);
+            auto v = (static_cast<double>(j) + getRandomDouble()) / static_cast<double>(imgHeight - 1);
+            packet.set(lane, camera.getRay(u, v));
+            RT_COUNT(cameraRays);
+          }
+        }
+
+        auto const hits = world.hitPacket(packet, 0.001, rt::infinity, records);
+
+        for (std::size_t lane = 0; lane < packet.size; ++lane) {
+          if (not packet.isActive(lane)) {
+            continue;
+          }
+
+          if (((hits >> lane) & 1) != 0) {
+            pixelColours[lane] += shadeHit(packet.rays[lane], records[lane], world, settings.maxDepth, nullptr);
+          }
+          else {
+            RT_COUNT(skyMisses);
+            pixelColours[lane] += getSkyColour(packet.rays[lane]);
+          }
+        }
+      }
+
+      for (std::size_t lane = 0; lane < packet.size; ++lane) {
+        if (packet.isActive(lane)) {
+          auto const i = i0 + (lane % blockWidth);
+          auto const j = j0 + (lane / blockWidth);
+          framebuffer[j * imgWidth + i] = pixelColours[lane];
+        }
+      }
+    }
+  }
+}
+
+/// Trace the pixels of some of the tiles of an image on a pool of render threads
+/// \param[in] pool The threads to render on
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution and sampling parameters
+/// \param[in] tiles The tiles of the image
+/// \param[in] tileIndices The tiles to render
+/// \param[inout] outputs The optional per-pixel outputs to fill in
+/// \param[in] stop Stops the render once the tiles that are being rendered are finished
+/// \returns The sum of the samples of every pixel, with the pixels of tiles that were not rendered left black
+std::vector<Colour> traceTiles(threadpool::ThreadPool& pool, Hittable const& world, camera::Camera const& camera,
+                               Settings const& settings, std::span<Tile const> tiles,
+                               std::span<std::size_t const> tileIndices, Outputs const& outputs, std::stop_token stop)
+{
+  auto const imgWidth = settings.imgWidth;
+  auto const imgHeight = settings.imgHeight;
+  auto* const aovs = outputs.aovs;
+  auto* const costs = outputs.costs;
+  auto* const perfReport = outputs.perf;
+  auto* const touches = outputs.touches;
+
+  std::vector<Colour> framebuffer(imgWidth * imgHeight);
+  std::atomic<std::size_t> nextTile {0};
+  std::atomic<std::size_t> tilesDone {0};
+  std::mutex progressMutex;
+
+  // The per-pixel outputs follow every path from its camera ray, so they are only produced with single rays
+  auto const followsPaths = aovs or costs or touches;
+  auto const useWavefront = settings.integrator == Integrator::wavefront and not followsPaths;
+  auto const usePackets = packet::isValidSize(settings.packetSize) and settings.maxDepth > 0 and not followsPaths;
+
+  // Each tile reseeds the generator of the thread rendering it, so the image does not depend on the thread count
+  auto const renderTiles = [&](std::size_t thread) {
+    std::optional<perf::ThreadCounters> counters;
+
+    if (perfReport) {
+      counters.emplace();
+
+      if (not counters->getError().empty()) {
+        perfReport->addError(counters->getError());
+      }
+    }
+
+    std::vector<std::uint32_t> touched;
+
+    for (auto n = nextTile++; n < tileIndices.size() and not stop.stop_requested(); n = nextTile++) {
+      auto const t = tileIndices[n];
+      auto const span = trace::Span("tile", "render", static_cast<std::int64_t>(t));
+      auto const& tile = tiles[t];
+      auto const countsBefore = counters ? counters->read() : perf::Counts();
+
+      seedRandom(settings.seed, t);
+
+      if (useWavefront) {
+        wavefront::traceTile(world, camera, settings, tile, framebuffer);
+      }
+      else if (usePackets) {
+        tracePackets(world, camera, settings, tile, framebuffer);
+      }
+      else {
+        for (std::size_t j = tile.y0; j < tile.y1; ++j) {
+          for (std::size_t i = tile.x0; i < tile.x1; ++i) {
+            Colour pixelColour(0, 0, 0);
+
+            // The intersection tests and rays of the pixel are read off the counters of this thread
+            auto const pixelStart =
+              costs ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+            auto const testsBefore = costs ? stats::getThreadTestCount() : 0;
+            auto const raysBefore = costs ? stats::getThreadCount(stats::Counter::cameraRays)
+                                              + stats::getThreadCount(stats::Counter::secondaryRays)
+                                          : 0;
+
+            for (std::size_t s = 0; s < settings.samplesPerPixel; ++s) {
+              auto u = (static_cast<double>(i) + getRandomDouble()) / static_cast<double>(imgWidth - 1);
+              auto v = (static_cast<double>(j) + getRandomDouble()) / static_cast<double>(imgHeight - 1);
+              Ray ray = camera.getRay(u, v);
+              RT_COUNT(cameraRays);
+
+              if (aovs) {
+                HitRecord primaryHit;
+                pixelColour +=
+                  rayColour(ray, world, settings.maxDepth, &primaryHit, touches ? &touched : nullptr);
+                aovs->addSample(i, j, ray, primaryHit);
+              }
+              else {
+                pixelColour += rayColour(ray, world, settings.maxDepth, nullptr, touches ? &touched : nullptr);
+              }
+            }
+
+            framebuffer[j * imgWidth + i] = pixelColour;
+
+            if (touches) {
+              std::sort(touched.begin(), touched.end());
+              touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+              (*touches)[j * imgWidth + i].assign(touched.begin(), touched.end());
+              touched.clear();
+            }
+
+            if (costs) {
+              auto const seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - pixelStart).count();
+              auto const tests = stats::getThreadTestCount() - testsBefore;
+              auto const rays = stats::getThreadCount(stats::Counter::cameraRays)
+                              + stats::getThreadCount(stats::Counter::secondaryRays) - raysBefore;
+
+              costs->record(i, j, seconds, tests,
+                            static_cast<double>(rays) / static_cast<double>(settings.samplesPerPixel));
+            }
+          }
+        }
+      }
+
+      if (counters) {
+        perfReport->addTile(t, thread, counters->read() - countsBefore);
+      }
+
+      auto const remaining = tileIndices.size() - ++tilesDone;
+
+      if (settings.showProgress) {
+        auto const lock = std::scoped_lock(progressMutex);
+        std::clog << "\rTiles remaining: " << remaining << ' ' << std::flush;
+      }
+    }
+  };
+
+  auto const span = trace::Span("trace", "render");
+
+  pool.run([&](std::size_t thread) {
+    if (thread != 0 and trace::isRecording()) {
+      trace::setThreadName("render worker " + std::to_string(thread));
+    }
+
+    renderTiles(thread);
+  });
+
+  if (settings.showProgress) {
+    std::clog << "\rDone.            \n";
+  }
+
+  return framebuffer;
+}
+
+}   // namespace
+
+/// Trace every pixel of an image on a pool of render threads
+/// \param[in] pool The threads to render on. The thread count of the settings is ignored
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution and sampling parameters
+/// \param[inout] outputs The optional per-pixel outputs to fill in
+/// \param[in] stop Stops the render once the tiles that are being rendered are finished
+/// \returns The sum of the samples of every pixel. Pixel (i, j) is at j * imgWidth + i, with j = 0 being the bottom row.
+/// Tiles that were not rendered because the render was stopped are black
+std::vector<Colour> render(threadpool::ThreadPool& pool, Hittable const& world, camera::Camera const& camera,
+                           Settings const& settings, Outputs const& outputs, std::stop_token stop)
+{
+  auto const tiles = makeTiles(settings.imgWidth, settings.imgHeight, settings.tileSize);
+  std::vector<std::size_t> tileIndices(tiles.size());
+  std::iota(tileIndices.begin(), tileIndices.end(), std::size_t {0});
+
+  return traceTiles(pool, world, camera, settings, tiles, tileIndices, outputs, stop);
+}
+
+/// Trace the pixels of some of the tiles of an image on a pool of render threads
+/// \param[in] pool The threads to render on. The thread count of the settings is ignored
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution and sampling parameters
+/// \param[in] tileIndices The tiles to render, as indices into makeTiles(imgWidth, imgHeight, tileSize). A tile is
+/// rendered the same as it is by render, whichever other tiles are rendered with it
+/// \param[inout] outputs The optional per-pixel outputs to fill in for the pixels of the tiles
+/// \param[in] stop Stops the render once the tiles that are being rendered are finished
+/// \returns The sum of the samples of every pixel, with the pixels of tiles that were not rendered left black
+/// \throws std::out_of_range if a tile index is not that of a tile of the image
+std::vector<Colour> renderTiles(threadpool::ThreadPool& pool, Hittable const& world, camera::Camera const& camera,
+                                Settings const& settings, std::span<std::size_t const> tileIndices,
+                                Outputs const& outputs, std::stop_token stop)
+{
+  auto const tiles = makeTiles(settings.imgWidth, settings.imgHeight, settings.tileSize);
+
+  for (auto const t : tileIndices) {
+    if (t >= tiles.size()) {
+      throw std::out_of_range("the image has no tile " + std::to_string(t));
+    }
+  }
+
+  return traceTiles(pool, world, camera, settings, tiles, tileIndices, outputs, stop);
+}
+
+/// Trace every pixel of an image on threads started for the render
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution, sampling and threading parameters
+/// \param[inout] outputs The optional per-pixel outputs to fill in
+/// \returns The sum of the samples of every pixel. Pixel (i, j) is at j * imgWidth + i, with j = 0 being the bottom row
+std::vector<Colour> render(Hittable const& world, camera::Camera const& camera, Settings const& settings,
+                           Outputs const& outputs)
+{
+  auto pool = threadpool::ThreadPool(settings.threads);
+  return render(pool, world, camera, settings, outputs);
+}
+
+/// Map the summed samples of every pixel to the range [0, 255]
+/// \param[in] framebuffer The summed samples of every pixel
+/// \param[in] samplesPerPixel The number of samples of each pixel
+/// \returns The pixels of the image, in the same order as the framebuffer
+std::vector<Colour> tonemap(std::vector<Colour> const& framebuffer, std::size_t samplesPerPixel)
+{
+  auto const span = trace::Span("tonemap", "output");
+  std::vector<Colour> image(framebuffer.size());
+
+  colour::mapToByteRange(framebuffer, static_cast<int>(samplesPerPixel), image);
+
+  return image;
+}
+
+/// Write an image in the plain PPM format, top row first
+/// \param[inout] out The output stream to write to
+/// \param[in] image The tonemapped pixels, bottom row first
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+void writePpm(std::ostream& out, std::vector<Colour> const& image, std::size_t width, std::size_t height)
+{
+  auto const span = trace::Span("writeImage", "output");
+
+  out << "P3\n" << width << ' ' << height << "\n255\n";
+
+  for (std::size_t j = height - 1; j < height; --j) {
+    for (std::size_t i = 0; i < width; ++i) {
+      colour::writeColour(out, image[j * width + i]);
+    }
+  }
+}
+
+}   // namespace rt::render
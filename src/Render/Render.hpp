@@ -0,0 +1,198 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef RENDER_HPP
+#define RENDER_HPP
+
+#include "Aov.hpp"
+#include "Camera.hpp"
+#include "Colour.hpp"
+#include "Heatmap.hpp"
+#include "Hittable.hpp"
+#include "Perf.hpp"
+#include "Ray.hpp"
+#include "ThreadPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <stop_token>
+#include <string_view>
+#include <vector>
+
+namespace rt::render {
+
+/// How the paths of a render are traced
+enum class Integrator : std::uint8_t
+{
+  /// Every path is followed to its end before the next one starts
+  path,
+
+  /// The paths of a tile advance together a bounce at a time, and their hits are shaded in a queue per material
+  wavefront
+};
+
+/// Look an integrator up by its name
+/// \param[in] name path or wavefront
+/// \returns The integrator
+/// \throws std::invalid_argument if there is no integrator with the name
+Integrator parseIntegrator(std::string_view name);
+
+/// The parameters of a render that do not depend on the scene
+struct Settings
+{
+  std::size_t imgWidth {400};
+  std::size_t imgHeight {225};
+  std::size_t samplesPerPixel {100};
+  int maxDepth {50};
+
+  /// The length of the sides of the square tiles the image is split into
+  std::size_t tileSize {16};
+
+  /// The number of render threads. Zero selects one per hardware thread
+  std::size_t threads {0};
+
+  /// The seed of the random numbers used while tracing. Every tile derives its own stream from it
+  std::uint64_t seed {0};
+
+  /// Whether the number of remaining tiles is reported on std::clog
+  bool showProgress {true};
+
+  /// The number of camera rays of neighbouring pixels that are traced through the scene together: 4, 8 or 16. Any
+  /// other value traces every ray on its own, as do renders that fill in per-pixel outputs
+  std::size_t packetSize {0};
+
+  /// How the paths are traced. Renders that fill in per-pixel outputs always follow one path at a time
+  Integrator integrator {Integrator::path};
+
+  /// The most paths the wavefront integrator traces together
+  std::size_t batchSize {16384};
+
+  /// Whether the wavefront integrator sorts the secondary rays of every bounce by where they start and which way they
+  /// go before tracing them, so that rays that visit the same parts of the scene are traced one after another
+  bool sortRays {false};
+};
+
+/// Optional per-pixel outputs filled in alongside the image
+struct Outputs
+{
+  /// Receives the first hit of every camera path
+  aov::AovBuffers* aovs {nullptr};
+
+  /// Receives the wall time, intersection tests and path depth of every pixel
+  heatmap::CostBuffers* costs {nullptr};
+
+  /// Receives the hardware counters of every tile
+  perf::Report* perf {nullptr};
+
+  /// Receives the sorted indices of the objects the paths of every pixel hit. Pixel (i, j) is at j * imgWidth + i, and
+  /// the sets of pixels that are not rendered are left as they are
+  std::vector<std::vector<std::uint32_t>>* touches {nullptr};
+};
+
+/// A rectangular block of pixels that is rendered by a single thread
+struct Tile
+{
+  std::size_t x0;
+  std::size_t y0;
+  std::size_t x1;
+  std::size_t y1;
+};
+
+/// Split an image into square tiles, starting from the top row as that is the order the image is written in
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+/// \param[in] tileSize The length of the sides of a tile. Tiles on the right and top edges may be smaller
+/// \returns The tiles covering the image
+std::vector<Tile> makeTiles(std::size_t width, std::size_t height, std::size_t tileSize);
+
+/// Get the colour of the sky in the direction of a ray that hits nothing
+/// \param[in] ray The ray
+/// \returns A linear blend of white and blue colours
+colour::Colour getSkyColour(ray::Ray const& ray) noexcept;
+
+/// \brief Produce a linear blend of white and blue colours
+/// \param[in] ray The ray whose colour is to be computed
+/// \param[out] primaryHit If not null, receives the first intersection of the ray. Its t is set to infinity if the
+/// ray hits nothing
+/// \param[inout] touched If not null, receives the object index of every intersection along the path
+/// \returns A linear blend of white and blue colours
+colour::Colour rayColour(ray::Ray const& ray, hittable::Hittable const& world, int depthOfRecursion,
+                         hittable::HitRecord* primaryHit = nullptr,
+                         std::vector<std::uint32_t>* touched = nullptr) noexcept;
+
+/// Trace every pixel of an image on a pool of render threads
+/// \param[in] pool The threads to render on. The thread count of the settings is ignored
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution and sampling parameters
+/// \param[inout] outputs The optional per-pixel outputs to fill in
+/// \param[in] stop Stops the render once the tiles that are being rendered are finished
+/// \returns The sum of the samples of every pixel. Pixel (i, j) is at j * imgWidth + i, with j = 0 being the bottom row.
+/// Tiles that were not rendered because the render was stopped are black
+std::vector<colour::Colour> render(threadpool::ThreadPool& pool, hittable::Hittable const& world,
+                                   camera::Camera const& camera, Settings const& settings,
+                                   Outputs const& outputs = {}, std::stop_token stop = {});
+
+/// Trace the pixels of some of the tiles of an image on a pool of render threads
+/// \param[in] pool The threads to render on. The thread count of the settings is ignored
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution and sampling parameters
+/// \param[in] tileIndices The tiles to render, as indices into makeTiles(imgWidth, imgHeight, tileSize). A tile is
+/// rendered the same as it is by render, whichever other tiles are rendered with it
+/// \param[inout] outputs The optional per-pixel outputs to fill in for the pixels of the tiles
+/// \param[in] stop Stops the render once the tiles that are being rendered are finished
+/// \returns The sum of the samples of every pixel, with the pixels of tiles that were not rendered left black
+/// \throws std::out_of_range if a tile index is not that of a tile of the image
+std::vector<colour::Colour> renderTiles(threadpool::ThreadPool& pool, hittable::Hittable const& world,
+                                        camera::Camera const& camera, Settings const& settings,
+                                        std::span<std::size_t const> tileIndices, Outputs const& outputs = {},
+                                        std::stop_token stop = {});
+
+/// Trace every pixel of an image on threads started for the render
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution, sampling and threading parameters
+/// \param[inout] outputs The optional per-pixel outputs to fill in
+/// \returns The sum of the samples of every pixel. Pixel (i, j) is at j * imgWidth + i, with j = 0 being the bottom row
+std::vector<colour::Colour> render(hittable::Hittable const& world, camera::Camera const& camera,
+                                   Settings const& settings, Outputs const& outputs = {});
+
+/// Map the summed samples of every pixel to the range [0, 255]
+/// \param[in] framebuffer The summed samples of every pixel
+/// \param[in] samplesPerPixel The number of samples of each pixel
+/// \returns The pixels of the image, in the same order as the framebuffer
+std::vector<colour::Colour> tonemap(std::vector<colour::Colour> const& framebuffer, std::size_t samplesPerPixel);
+
+/// Write an image in the plain PPM format, top row first
+/// \param[inout] out The output stream to write to
+/// \param[in] image The tonemapped pixels, bottom row first
+/// \param[in] width The width of the image in pixels
+/// \param[in] height The height of the image in pixels
+void writePpm(std::ostream& out, std::vector<colour::Colour> const& image, std::size_t width, std::size_t height);
+
+}   // namespace rt::render
+
+#endif
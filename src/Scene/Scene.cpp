@@ -0,0 +1,713 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Scene.hpp"
+
+#include "Colour.hpp"
+#include "Dielectric.hpp"
+#include "Lambertian.hpp"
+#include "Metal.hpp"
+#include "Plane.hpp"
+#include "Sphere.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace rt::scene {
+
+namespace {
+
+/// Splits the text of a scene into whitespace-separated tokens, one line at a time
+class Tokenizer
+{
+public:
+  explicit Tokenizer(std::string_view text) noexcept : m_text(text)
+  {
+  }
+
+  /// Move to the start of the next line that holds a statement
+  /// \returns false once the end of the text is reached
+  bool nextStatement() noexcept
+  {
+    while (m_pos < m_text.size()) {
+      skipBlanks();
+
+      if (m_pos < m_text.size() and m_text[m_pos] != '\n') {
+        return true;
+      }
+
+      if (m_pos < m_text.size()) {
+        ++m_pos;
+        ++m_line;
+      }
+    }
+
+    return false;
+  }
+
+  /// Get the next token of the current line
+  /// \returns The token, or an empty view at the end of the line
+  std::string_view next() noexcept
+  {
+    skipBlanks();
+    auto const start = m_pos;
+
+    while (not isDelimiter(m_text.data() + m_pos, m_text.data() + m_text.size())) {
+      ++m_pos;
+    }
+
+    return m_text.substr(start, m_pos - start);
+  }
+
+  /// Get the next token of the current line as a number
+  /// \details The number is converted straight from the text, without finding the end of the token first
+  /// \tparam T The type of the number
+  /// \param[in] what What the number means, for the error message
+  /// \throws std::runtime_error if the token is missing or is not a number of type T
+  template <typename T>
+  T nextNumber(char const* what)
+  {
+    skipBlanks();
+    auto const* const first = m_text.data() + m_pos;
+    auto const* const last = m_text.data() + m_text.size();
+    T value {};
+    auto const [end, error] = std::from_chars(first, last, value);
+
+    if (error != std::errc() or end == first or not isDelimiter(end, last)) {
+      auto const token = next();
+      fail(std::string("expected ") + what + (token.empty() ? std::string() : ", got '" + std::string(token) + "'"));
+    }
+
+    m_pos = static_cast<std::size_t>(end - m_text.data());
+
+    return value;
+  }
+
+  /// Get the next token of the current line as a finite number
+  /// \param[in] what What the number means, for the error message
+  /// \throws std::runtime_error if the token is missing, is not a number, or is infinite or not a number
+  double nextFinite(char const* what)
+  {
+    auto const value = nextNumber<double>(what);
+
+    if (not std::isfinite(value)) {
+      fail(std::string(what) + " must be finite");
+    }
+
+    return value;
+  }
+
+  /// Get the next three tokens of the current line as the components of a vector
+  /// \throws std::runtime_error if a component is missing, is not a number, or is infinite or not a number
+  std::array<double, 3> nextTriple(char const* what)
+  {
+    auto const x = nextFinite(what);
+    auto const y = nextFinite(what);
+    auto const z = nextFinite(what);
+
+    return {x, y, z};
+  }
+
+  /// Finish the current line
+  /// \throws std::runtime_error if anything other than a comment is left on the line
+  void endStatement()
+  {
+    if (auto const token = next(); not token.empty()) {
+      fail("unexpected '" + std::string(token) + "'");
+    }
+  }
+
+  /// Report an error on the current line
+  [[noreturn]] void fail(std::string const& message) const
+  {
+    throw std::runtime_error("line " + std::to_string(m_line) + ": " + message);
+  }
+
+private:
+  static constexpr bool isBlank(char c) noexcept
+  {
+    return c == ' ' or c == '\t' or c == '\r';
+  }
+
+  /// Whether a token ends at the given position
+  static constexpr bool isDelimiter(char const* position, char const* last) noexcept
+  {
+    return position == last or isBlank(*position) or *position == '\n' or *position == '#';
+  }
+
+  /// Skip blanks and any comment, stopping at the end of the line
+  void skipBlanks() noexcept
+  {
+    while (m_pos < m_text.size() and isBlank(m_text[m_pos])) {
+      ++m_pos;
+    }
+
+    if (m_pos < m_text.size() and m_text[m_pos] == '#') {
+      while (m_pos < m_text.size() and m_text[m_pos] != '\n') {
+        ++m_pos;
+      }
+    }
+  }
+
+  std::string_view m_text;
+  std::size_t m_pos {0};
+  std::size_t m_line {1};
+};
+
+/// Create the material object described by a material
+material::Material* makeMaterial(MaterialData const& material)
+{
+  auto const albedo = colour::Colour(material.albedo[0], material.albedo[1], material.albedo[2]);
+
+  switch (material.type) {
+    case MaterialType::lambertian: return new material::Lambertian(albedo);
+    case MaterialType::metal:      return new material::Metal(albedo, material.parameter);
+    case MaterialType::dielectric: return new material::Dielectric(material.parameter);
+  }
+
+  throw std::out_of_range("unknown material type");
+}
+
+/// Write a number in its shortest form that reads back exactly
+void writeNumber(std::ostream& out, double value)
+{
+  std::array<char, 32> buffer {};
+  auto const result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  out << ' ' << std::string_view(buffer.data(), static_cast<std::size_t>(result.ptr - buffer.data()));
+}
+
+void writeTriple(std::ostream& out, std::array<double, 3> const& v)
+{
+  writeNumber(out, v[0]);
+  writeNumber(out, v[1]);
+  writeNumber(out, v[2]);
+}
+
+void writeTriple(std::ostream& out, vec3::Vec3 const& v)
+{
+  writeTriple(out, std::array<double, 3> {v.x(), v.y(), v.z()});
+}
+
+vec3::Vec3 toVec3(std::array<double, 3> const& v) noexcept
+{
+  return vec3::Vec3(v[0], v[1], v[2]);
+}
+
+/// Read a whole text file
+/// \throws std::runtime_error if the file cannot be read
+std::string readText(std::filesystem::path const& path)
+{
+  std::ifstream file(path, std::ios::binary);
+
+  if (not file) {
+    throw std::runtime_error("cannot open " + path.string());
+  }
+
+  // The whole file is read with one call, and the parsers work on views into it
+  std::string text(std::filesystem::file_size(path), '\0');
+
+  if (not file.read(text.data(), static_cast<std::streamsize>(text.size()))) {
+    throw std::runtime_error("cannot read " + path.string());
+  }
+
+  return text;
+}
+
+/// Parse a statement that sets the image, sampling, camera or shutter parameters of a scene
+/// \param[inout] tokens The tokens of the text, after the keyword of the statement
+/// \param[in] keyword The keyword of the statement
+/// \param[inout] scene The scene to set the parameter of
+/// \returns false if the statement is not a setting
+bool parseSetting(Tokenizer& tokens, std::string_view keyword, Description& scene)
+{
+  if (keyword == "camera") {
+    auto& camera = scene.camera;
+    camera.lookFrom = toVec3(tokens.nextTriple("a camera position"));
+    camera.lookAt = toVec3(tokens.nextTriple("a camera target"));
+    camera.viewUp = toVec3(tokens.nextTriple("a view up vector"));
+    camera.verticalFieldOfView = tokens.nextFinite("a vertical field of view");
+    camera.aperture = tokens.nextFinite("an aperture");
+    camera.focusDistance = tokens.nextFinite("a focus distance");
+  }
+  else if (keyword == "shutter") {
+    scene.camera.shutterOpen = tokens.nextNumber<double>("a shutter opening time");
+    scene.camera.shutterClose = tokens.nextNumber<double>("a shutter closing time");
+
+    if (not(0 <= scene.camera.shutterOpen and scene.camera.shutterOpen <= scene.camera.shutterClose
+            and scene.camera.shutterClose <= 1)) {
+      tokens.fail("the shutter must open and then close at times from 0 to 1");
+    }
+  }
+  else if (keyword == "image") {
+    scene.imgWidth = tokens.nextNumber<std::size_t>("an image width");
+    scene.imgHeight = tokens.nextNumber<std::size_t>("an image height");
+
+    if (scene.imgWidth < 2 or scene.imgHeight < 2) {
+      tokens.fail("the image must be at least 2 px by 2 px");
+    }
+  }
+  else if (keyword == "samples") {
+    scene.samplesPerPixel = tokens.nextNumber<std::size_t>("a number of samples per pixel");
+
+    if (scene.samplesPerPixel == 0) {
+      tokens.fail("there must be at least one sample per pixel");
+    }
+  }
+  else if (keyword == "depth") {
+    scene.maxDepth = tokens.nextNumber<int>("a maximum depth");
+
+    if (scene.maxDepth < 1) {
+      tokens.fail("the maximum depth must be at least 1");
+    }
+  }
+  else {
+    return false;
+  }
+
+  return true;
+}
+
+}   // namespace
+
+/// Create the material objects of a material table
+/// \param[in] materials The materials, in the order spheres refer to them
+MaterialTable::MaterialTable(std::span<MaterialData const> materials)
+{
+  m_materials.reserve(materials.size());
+  m_pointers.reserve(materials.size());
+
+  for (auto const& material : materials) {
+    auto const albedo = colour::Colour(material.albedo[0], material.albedo[1], material.albedo[2]);
+
+    switch (material.type) {
+      case MaterialType::lambertian:
+        m_materials.emplace_back(std::in_place_type<material::Lambertian>, albedo);
+        break;
+      case MaterialType::metal:
+        m_materials.emplace_back(std::in_place_type<material::Metal>, albedo, material.parameter);
+        break;
+      case MaterialType::dielectric:
+        m_materials.emplace_back(std::in_place_type<material::Dielectric>, material.parameter);
+        break;
+      default:
+        throw std::out_of_range("unknown material type");
+    }
+
+    m_pointers.push_back(std::visit([](auto& object) -> material::Material* { return &object; }, m_materials.back()));
+  }
+}
+
+/// Parse a scene in the text format
+/// \param[in] text The text of the scene
+/// \returns The scene
+/// \throws std::runtime_error naming the offending line if the text is not a valid scene
+Description parseScene(std::string_view text)
+{
+  Description scene;
+  Tokenizer tokens(text);
+
+  // Scenes are mostly spheres, so reserving one per line avoids copying the sphere array as it grows
+  scene.spheres.reserve(static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+  while (tokens.nextStatement()) {
+    auto const keyword = tokens.next();
+
+    if (keyword == "sphere" or keyword == "moving") {
+      auto& sphere = scene.spheres.emplace_back();
+      sphere.centre = tokens.nextTriple("a sphere centre");
+      sphere.radius = tokens.nextNumber<double>("a sphere radius");
+
+      // Also rejects NaN
+      if (not(sphere.radius > 0 and sphere.radius <= std::numeric_limits<double>::max())) {
+        tokens.fail("the radius of a sphere must be positive and finite");
+      }
+
+      sphere.material = tokens.nextNumber<std::uint32_t>("a material index");
+
+      if (sphere.material >= scene.materials.size()) {
+        tokens.fail("material " + std::to_string(sphere.material) + " has not been declared");
+      }
+
+      if (keyword == "moving") {
+        sphere.velocity = tokens.nextTriple("a sphere velocity");
+      }
+    }
+    else if (keyword == "plane" or keyword == "disk" or keyword == "box") {
+      auto& shape = scene.shapes.emplace_back();
+      shape.type = keyword == "plane" ? ShapeType::plane : keyword == "disk" ? ShapeType::disk : ShapeType::box;
+      shape.point = tokens.nextTriple(shape.type == ShapeType::box ? "a lower corner" : "a point");
+      shape.vector = tokens.nextTriple(shape.type == ShapeType::box ? "an upper corner" : "a normal");
+
+      if (shape.type == ShapeType::disk) {
+        shape.radius = tokens.nextNumber<double>("a disk radius");
+
+        if (not(shape.radius > 0 and shape.radius <= std::numeric_limits<double>::max())) {
+          tokens.fail("the radius of a disk must be positive and finite");
+        }
+      }
+
+      shape.material = tokens.nextNumber<std::uint32_t>("a material index");
+
+      if (shape.material >= scene.materials.size()) {
+        tokens.fail("material " + std::to_string(shape.material) + " has not been declared");
+      }
+
+      // A normal whose squared length underflows to zero or overflows could not be normalised either
+      auto const [x, y, z] = shape.vector;
+      auto const lengthSquared = x * x + y * y + z * z;
+
+      if (shape.type != ShapeType::box
+          and not(lengthSquared > 0 and lengthSquared <= std::numeric_limits<double>::max())) {
+        tokens.fail("the normal must be finite and not zero");
+      }
+
+      if (shape.type == ShapeType::box
+          and not(shape.point[0] <= shape.vector[0] and shape.point[1] <= shape.vector[1]
+                  and shape.point[2] <= shape.vector[2])) {
+        tokens.fail("the lower corner of a box must not lie above its upper corner");
+      }
+    }
+    else if (keyword == "mesh") {
+      auto& mesh = scene.meshes.emplace_back();
+      auto const path = tokens.next();
+
+      if (path.empty()) {
+        tokens.fail("expected a mesh path");
+      }
+
+      mesh.path = path;
+      mesh.material = tokens.nextNumber<std::uint32_t>("a material index");
+
+      if (mesh.material >= scene.materials.size()) {
+        tokens.fail("material " + std::to_string(mesh.material) + " has not been declared");
+      }
+    }
+    else if (keyword == "instance") {
+      auto& instance = scene.instances.emplace_back();
+      auto const path = tokens.next();
+
+      if (path.empty()) {
+        tokens.fail("expected a scene path");
+      }
+
+      instance.path = path;
+      instance.offset = tokens.nextTriple("an offset");
+      instance.axis = tokens.nextTriple("an axis");
+      instance.degrees = tokens.nextFinite("an angle");
+      instance.scale = tokens.nextFinite("a scale");
+
+      if (instance.axis == std::array<double, 3> {}) {
+        tokens.fail("the axis must not be zero");
+      }
+
+      if (not(instance.scale > 0)) {
+        tokens.fail("the scale of an instance must be positive");
+      }
+    }
+    else if (keyword == "lambertian") {
+      auto& material = scene.materials.emplace_back();
+      material.type = MaterialType::lambertian;
+      material.albedo = tokens.nextTriple("an albedo");
+    }
+    else if (keyword == "metal") {
+      auto& material = scene.materials.emplace_back();
+      material.type = MaterialType::metal;
+      material.albedo = tokens.nextTriple("an albedo");
+      material.parameter = tokens.nextFinite("a fuzz");
+    }
+    else if (keyword == "dielectric") {
+      auto& material = scene.materials.emplace_back();
+      material.type = MaterialType::dielectric;
+      material.parameter = tokens.nextFinite("a refractive index");
+    }
+    else if (not parseSetting(tokens, keyword, scene)) {
+      tokens.fail("unknown statement '" + std::string(keyword) + "'");
+    }
+
+    tokens.endStatement();
+  }
+
+  return scene;
+}
+
+/// Parse the image, sampling, camera and shutter statements of the text format onto a scene
+/// \param[in] text The statements
+/// \param[inout] scene The scene to set the parameters of. Parameters that are not given are left as they are
+/// \throws std::runtime_error naming the offending line if a statement is not valid or is not a setting
+void parseSettings(std::string_view text, Description& scene)
+{
+  Tokenizer tokens(text);
+
+  while (tokens.nextStatement()) {
+    auto const keyword = tokens.next();
+
+    if (not parseSetting(tokens, keyword, scene)) {
+      tokens.fail("unexpected statement '" + std::string(keyword) + "', only image, samples, depth, camera and "
+                  "shutter can be given");
+    }
+
+    tokens.endStatement();
+  }
+}
+
+/// Copy the settings and camera of a scene without its objects
+/// \param[in] scene The scene
+/// \returns The scene without materials or objects
+Description getSettings(Description const& scene)
+{
+  Description settings;
+  settings.imgWidth = scene.imgWidth;
+  settings.imgHeight = scene.imgHeight;
+  settings.samplesPerPixel = scene.samplesPerPixel;
+  settings.maxDepth = scene.maxDepth;
+  settings.camera = scene.camera;
+
+  return settings;
+}
+
+/// Read and parse a scene file in the text format
+/// \details Relative mesh and instance paths are taken to be relative to the directory of the scene file
+/// \param[in] path The path of the scene file
+/// \returns The scene
+/// \throws std::runtime_error if the file cannot be read or is not a valid scene
+Description loadScene(std::filesystem::path const& path)
+{
+  auto const text = readText(path);
+  Description scene;
+
+  try {
+    scene = parseScene(text);
+  }
+  catch (std::runtime_error const& error) {
+    throw std::runtime_error(path.string() + ", " + error.what());
+  }
+
+  for (auto& mesh : scene.meshes) {
+    if (mesh.path.is_relative()) {
+      mesh.path = path.parent_path() / mesh.path;
+    }
+  }
+
+  for (auto& instance : scene.instances) {
+    if (instance.path.is_relative()) {
+      instance.path = path.parent_path() / instance.path;
+    }
+  }
+
+  return scene;
+}
+
+/// Parse a camera path in the text format
+/// \param[in] text The text of the camera path
+/// \returns The keyframes
+/// \throws std::runtime_error naming the offending line if the text is not a valid camera path, or has no keyframes
+std::vector<Keyframe> parseCameraPath(std::string_view text)
+{
+  std::vector<Keyframe> keyframes;
+  Tokenizer tokens(text);
+
+  while (tokens.nextStatement()) {
+    if (auto const keyword = tokens.next(); keyword != "keyframe") {
+      tokens.fail("unknown statement '" + std::string(keyword) + "'");
+    }
+
+    auto& keyframe = keyframes.emplace_back();
+    keyframe.frame = tokens.nextNumber<std::size_t>("a frame number");
+    keyframe.lookFrom = toVec3(tokens.nextTriple("a camera position"));
+    keyframe.lookAt = toVec3(tokens.nextTriple("a camera target"));
+    keyframe.focusDistance = tokens.nextFinite("a focus distance");
+
+    if (keyframes.size() > 1 and keyframe.frame <= keyframes[keyframes.size() - 2].frame) {
+      tokens.fail("keyframes must be in increasing frame order");
+    }
+
+    tokens.endStatement();
+  }
+
+  if (keyframes.empty()) {
+    throw std::runtime_error("the camera path has no keyframes");
+  }
+
+  return keyframes;
+}
+
+/// Read and parse a camera path file
+/// \param[in] path The path of the camera path file
+/// \returns The keyframes
+/// \throws std::runtime_error if the file cannot be read or is not a valid camera path
+std::vector<Keyframe> loadCameraPath(std::filesystem::path const& path)
+{
+  auto const text = readText(path);
+
+  try {
+    return parseCameraPath(text);
+  }
+  catch (std::runtime_error const& error) {
+    throw std::runtime_error(path.string() + ", " + error.what());
+  }
+}
+
+/// Write a scene in the text format, with every number written in its shortest form that reads back exactly
+/// \param[inout] out The output stream to write to
+/// \param[in] scene The scene
+void writeScene(std::ostream& out, Description const& scene)
+{
+  out << "image " << scene.imgWidth << ' ' << scene.imgHeight << '\n';
+  out << "samples " << scene.samplesPerPixel << '\n';
+  out << "depth " << scene.maxDepth << '\n';
+
+  out << "camera";
+  writeTriple(out, scene.camera.lookFrom);
+  writeTriple(out, scene.camera.lookAt);
+  writeTriple(out, scene.camera.viewUp);
+  writeNumber(out, scene.camera.verticalFieldOfView);
+  writeNumber(out, scene.camera.aperture);
+  writeNumber(out, scene.camera.focusDistance);
+  out << '\n';
+
+  if (scene.camera.shutterOpen != 0 or scene.camera.shutterClose != 0) {
+    out << "shutter";
+    writeNumber(out, scene.camera.shutterOpen);
+    writeNumber(out, scene.camera.shutterClose);
+    out << '\n';
+  }
+
+  for (auto const& material : scene.materials) {
+    switch (material.type) {
+      case MaterialType::lambertian:
+        out << "lambertian";
+        writeTriple(out, material.albedo);
+        break;
+      case MaterialType::metal:
+        out << "metal";
+        writeTriple(out, material.albedo);
+        writeNumber(out, material.parameter);
+        break;
+      case MaterialType::dielectric:
+        out << "dielectric";
+        writeNumber(out, material.parameter);
+        break;
+    }
+
+    out << '\n';
+  }
+
+  for (auto const& sphere : scene.spheres) {
+    auto const moving = sphere.velocity != std::array<double, 3> {};
+    out << (moving ? "moving" : "sphere");
+    writeTriple(out, sphere.centre);
+    writeNumber(out, sphere.radius);
+    out << ' ' << sphere.material;
+
+    if (moving) {
+      writeTriple(out, sphere.velocity);
+    }
+
+    out << '\n';
+  }
+
+  for (auto const& shape : scene.shapes) {
+    switch (shape.type) {
+      case ShapeType::plane:
+        out << "plane";
+        break;
+      case ShapeType::disk:
+        out << "disk";
+        break;
+      case ShapeType::box:
+        out << "box";
+        break;
+    }
+
+    writeTriple(out, shape.point);
+    writeTriple(out, shape.vector);
+
+    if (shape.type == ShapeType::disk) {
+      writeNumber(out, shape.radius);
+    }
+
+    out << ' ' << shape.material << '\n';
+  }
+
+  for (auto const& mesh : scene.meshes) {
+    out << "mesh " << mesh.path.string() << ' ' << mesh.material << '\n';
+  }
+
+  for (auto const& instance : scene.instances) {
+    out << "instance " << instance.path.string();
+    writeTriple(out, instance.offset);
+    writeTriple(out, instance.axis);
+    writeNumber(out, instance.degrees);
+    writeNumber(out, instance.scale);
+    out << '\n';
+  }
+}
+
+/// Create the objects of a scene
+/// \param[in] scene The scene
+/// \returns The spheres of the scene followed by its shapes, each in the order they are described and with its own
+/// copy of its material. Their object indices are their positions in the list
+/// \throws std::out_of_range if a sphere or shape refers to a material that does not exist
+/// \throws std::invalid_argument if the scene has meshes or instances, which only world::World loads
+hittable::HittableList buildWorld(Description const& scene)
+{
+  if (not scene.meshes.empty() or not scene.instances.empty()) {
+    throw std::invalid_argument("meshes and instances can only be rendered through a world");
+  }
+
+  hittable::HittableList world;
+
+  for (std::size_t i = 0; i < scene.spheres.size(); ++i) {
+    auto const& sphere = scene.spheres[i];
+    auto* const material = makeMaterial(scene.materials.at(sphere.material));
+    world.add(new sphere::Sphere(toVec3(sphere.centre), toVec3(sphere.velocity), sphere.radius, material, i));
+  }
+
+  for (std::size_t i = 0; i < scene.shapes.size(); ++i) {
+    auto const& shape = scene.shapes[i];
+    world.add(new plane::Shape(shape, makeMaterial(scene.materials.at(shape.material)), scene.spheres.size() + i));
+  }
+
+  return world;
+}
+
+/// Create the camera of a scene
+/// \param[in] scene The scene. The aspect ratio of the camera is that of its image
+/// \returns The camera
+camera::Camera buildCamera(Description const& scene) noexcept
+{
+  auto const& camera = scene.camera;
+  auto const aspectRatio = static_cast<double>(scene.imgWidth) / static_cast<double>(scene.imgHeight);
+
+  return camera::Camera(camera.lookFrom, camera.lookAt, camera.viewUp, camera.verticalFieldOfView, aspectRatio,
+                        camera.aperture, camera.focusDistance, camera.shutterOpen, camera.shutterClose);
+}
+
+}   // namespace rt::scene
@@ -0,0 +1,302 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include "Camera.hpp"
+#include "Dielectric.hpp"
+#include "HittableList.hpp"
+#include "Lambertian.hpp"
+#include "Material.hpp"
+#include "Metal.hpp"
+#include "Ray.hpp"
+#include "Vec3.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace rt::scene {
+
+/// The kinds of material a scene can describe
+enum class MaterialType : std::uint32_t
+{
+  lambertian,
+  metal,
+  dielectric
+};
+
+/// A material, described by value
+/// \details The layout has no implicit padding, so that materials can be written to and mapped from binary scene files
+struct MaterialData
+{
+  MaterialType type {MaterialType::lambertian};
+  std::uint32_t reserved {};
+
+  /// The albedo of a lambertian or metal material. Unused by dielectrics
+  std::array<double, 3> albedo {};
+
+  /// The fuzz of a metal or the refractive index of a dielectric. Unused by lambertian materials
+  double parameter {};
+};
+
+/// A sphere, described by value
+/// \details The layout has no implicit padding, so that spheres can be written to and mapped from binary scene files
+struct SphereData
+{
+  std::array<double, 3> centre {};
+  double radius {};
+
+  /// The index of the material of the sphere in the material table of the scene
+  std::uint32_t material {};
+  std::uint32_t reserved {};
+
+  /// How far the centre moves per unit of time. The centre above is where the sphere is at time 0
+  std::array<double, 3> velocity {};
+};
+
+/// The kinds of flat-faced shape a scene can describe besides spheres
+enum class ShapeType : std::uint32_t
+{
+  plane,
+  disk,
+  box
+};
+
+/// An infinite plane, a disk or an axis-aligned box, described by value
+/// \details The layout has no implicit padding, so that shapes can be written to and mapped from binary scene files
+struct ShapeData
+{
+  ShapeType type {ShapeType::plane};
+
+  /// The index of the material of the shape in the material table of the scene
+  std::uint32_t material {};
+
+  /// A point on a plane, the centre of a disk or the lower corner of a box
+  std::array<double, 3> point {};
+
+  /// The normal of a plane or disk, which need not be of unit length, or the upper corner of a box
+  std::array<double, 3> vector {};
+
+  /// The radius of a disk. Unused by planes and boxes
+  double radius {};
+};
+
+static_assert(std::is_trivially_copyable_v<MaterialData> and sizeof(MaterialData) == 40);
+static_assert(std::is_trivially_copyable_v<SphereData> and sizeof(SphereData) == 64);
+static_assert(std::is_trivially_copyable_v<ShapeData> and sizeof(ShapeData) == 64);
+
+/// A triangle mesh the scene loads from a file in the OBJ or PLY format
+struct MeshReference
+{
+  std::filesystem::path path;
+
+  /// The index of the material of every triangle of the mesh in the material table of the scene
+  std::uint32_t material {};
+};
+
+/// A copy of the spheres of another scene file, which the scene places by a uniform scale, a rotation and then a
+/// translation
+struct InstanceReference
+{
+  /// The scene file whose materials and spheres are copied. Every instance of a file shares one hierarchy
+  std::filesystem::path path;
+
+  /// How far the copy is moved once it has been scaled and rotated
+  std::array<double, 3> offset {};
+
+  /// The axis, through the origin of the copy, that it is rotated about
+  std::array<double, 3> axis {0, 1, 0};
+
+  /// The angle of the rotation, anticlockwise when looking down the axis
+  double degrees {0};
+
+  double scale {1};
+};
+
+/// The parameters of the camera the scene is viewed through
+struct CameraData
+{
+  ray::Point3 lookFrom {13, 2, 3};
+  ray::Point3 lookAt {0, 0, 0};
+  vec3::Vec3 viewUp {0, 1, 0};
+  double verticalFieldOfView {20};
+  double aperture {0.1};
+  double focusDistance {10};
+
+  /// The interval the shutter is open for. Spheres move over times from 0 to 1, so the interval must lie within them
+  double shutterOpen {0};
+  double shutterClose {0};
+};
+
+/// The camera of one frame of an animation. The camera of the frames in between is interpolated
+struct Keyframe
+{
+  std::size_t frame {0};
+  ray::Point3 lookFrom {};
+  ray::Point3 lookAt {};
+  double focusDistance {10};
+};
+
+/// Everything needed to render an image: the output settings, the camera and the objects in the scene
+struct Description
+{
+  std::size_t imgWidth {400};
+  std::size_t imgHeight {225};
+  std::size_t samplesPerPixel {100};
+  int maxDepth {50};
+
+  CameraData camera {};
+
+  /// The materials of the scene. Spheres refer to them by their index
+  std::vector<MaterialData> materials;
+
+  std::vector<SphereData> spheres;
+
+  /// The planes, disks and boxes of the scene. They are tested on their own rather than through the hierarchy over
+  /// the spheres, so an infinite plane does not stretch its bounds
+  std::vector<ShapeData> shapes;
+
+  /// The meshes of the scene. They are loaded by world::World, and the binary format cannot hold them
+  std::vector<MeshReference> meshes;
+
+  /// The copies of other scenes placed in the scene. They are loaded by world::World, and the binary format cannot
+  /// hold them
+  std::vector<InstanceReference> instances;
+};
+
+/// The material objects of a material table, stored side by side in a single allocation
+class MaterialTable
+{
+public:
+  /// Create the material objects of a material table
+  /// \param[in] materials The materials, in the order spheres refer to them
+  explicit MaterialTable(std::span<MaterialData const> materials);
+
+  /// Get the material objects, in the order of the material table
+  std::span<material::Material* const> getMaterials() const noexcept
+  {
+    return m_pointers;
+  }
+
+private:
+  std::vector<std::variant<material::Lambertian, material::Metal, material::Dielectric>> m_materials;
+  std::vector<material::Material*> m_pointers;
+};
+
+/// Parse a scene in the text format
+/// \details Every line holds one statement, and # starts a comment that runs to the end of the line:
+///
+///     image <width> <height>
+///     samples <samples per pixel>
+///     depth <maximum path depth>
+///     camera <look from x y z> <look at x y z> <view up x y z> <vertical field of view> <aperture> <focus distance>
+///     lambertian <r g b>
+///     metal <r g b> <fuzz>
+///     dielectric <refractive index>
+///     shutter <open time> <close time>
+///     sphere <centre x y z> <radius> <material>
+///     moving <centre x y z> <radius> <material> <velocity x y z>
+///     plane <point x y z> <normal x y z> <material>
+///     disk <centre x y z> <normal x y z> <radius> <material>
+///     box <lower corner x y z> <upper corner x y z> <material>
+///     mesh <path> <material>
+///     instance <path> <offset x y z> <axis x y z> <degrees> <scale>
+///
+/// Materials are numbered from 0 in the order they are declared, and an object may only use a material declared before
+/// it. A mesh path names an OBJ or PLY file and may not contain blanks. An instance path names a scene file in the text
+/// format, whose spheres are copied with their own materials. A moving sphere is at its centre at time 0 and moves with
+/// its velocity, and the shutter interval must lie within times 0 to 1. There must be at least one sample per pixel and
+/// a depth of at least 1, every other number must be finite, radii and scales must be positive and normals and axes not
+/// zero. Statements that are left out keep the defaults of Description. Tokens are views into the text and numbers are
+/// converted in place, so nothing is allocated per token
+/// \param[in] text The text of the scene
+/// \returns The scene
+/// \throws std::runtime_error naming the offending line if the text is not a valid scene
+Description parseScene(std::string_view text);
+
+/// Parse the image, sampling, camera and shutter statements of the text format onto a scene
+/// \details This changes how an existing scene is viewed without touching its objects, so object and material
+/// statements are rejected
+/// \param[in] text The statements
+/// \param[inout] scene The scene to set the parameters of. Parameters that are not given are left as they are
+/// \throws std::runtime_error naming the offending line if a statement is not valid or is not a setting
+void parseSettings(std::string_view text, Description& scene);
+
+/// Copy the settings and camera of a scene without its objects
+/// \param[in] scene The scene
+/// \returns The scene without materials or objects
+Description getSettings(Description const& scene);
+
+/// Read and parse a scene file in the text format
+/// \details Relative mesh and instance paths are taken to be relative to the directory of the scene file
+/// \param[in] path The path of the scene file
+/// \returns The scene
+/// \throws std::runtime_error if the file cannot be read or is not a valid scene
+Description loadScene(std::filesystem::path const& path);
+
+/// Parse a camera path in the text format
+/// \details Every line holds one keyframe, and # starts a comment that runs to the end of the line:
+///
+///     keyframe <frame> <look from x y z> <look at x y z> <focus distance>
+///
+/// Keyframes must be given in increasing frame order
+/// \param[in] text The text of the camera path
+/// \returns The keyframes
+/// \throws std::runtime_error naming the offending line if the text is not a valid camera path, or has no keyframes
+std::vector<Keyframe> parseCameraPath(std::string_view text);
+
+/// Read and parse a camera path file
+/// \param[in] path The path of the camera path file
+/// \returns The keyframes
+/// \throws std::runtime_error if the file cannot be read or is not a valid camera path
+std::vector<Keyframe> loadCameraPath(std::filesystem::path const& path);
+
+/// Write a scene in the text format, with every number written in its shortest form that reads back exactly
+/// \param[inout] out The output stream to write to
+/// \param[in] scene The scene
+void writeScene(std::ostream& out, Description const& scene);
+
+/// Create the objects of a scene
+/// \param[in] scene The scene
+/// \returns The spheres of the scene followed by its shapes, each in the order they are described and with its own
+/// copy of its material. Their object indices are their positions in the list
+/// \throws std::out_of_range if a sphere or shape refers to a material that does not exist
+/// \throws std::invalid_argument if the scene has meshes or instances, which only world::World loads
+hittable::HittableList buildWorld(Description const& scene);
+
+/// Create the camera of a scene
+/// \param[in] scene The scene. The aspect ratio of the camera is that of its image
+/// \returns The camera
+camera::Camera buildCamera(Description const& scene) noexcept;
+
+}   // namespace rt::scene
+
+#endif
@@ -0,0 +1,391 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Server.hpp"
+
+#include "Render.hpp"
+#include "Scene.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace rt::server {
+
+namespace {
+
+/// The longest a client may take to send its request
+constexpr int requestTimeoutSeconds = 10;
+
+/// The longest a write of an answer may wait for the client to read. A client that takes longer is dropped
+constexpr int replyTimeoutSeconds = 10;
+
+/// Split a request line into its words
+std::vector<std::string> splitWords(std::string_view line)
+{
+  std::vector<std::string> words;
+  std::size_t pos = 0;
+
+  while (pos < line.size()) {
+    auto const start = line.find_first_not_of(" \t\r", pos);
+
+    if (start == std::string_view::npos) {
+      break;
+    }
+
+    pos = std::min(line.find_first_of(" \t\r", start), line.size());
+    words.emplace_back(line.substr(start, pos - start));
+  }
+
+  return words;
+}
+
+/// Answer a client, ignoring a client that has gone away
+void reply(socket::Socket& client, std::string_view answer) noexcept
+{
+  try {
+    client.writeAll(answer);
+  }
+  catch (std::exception const&) {
+  }
+}
+
+}   // namespace
+
+/// Start listening for requests
+/// \param[in] socketPath The path of the Unix domain socket to listen on
+/// \param[in] threads The number of render threads. Zero selects one per hardware thread
+/// \param[in] loadScene Prepares the scenes jobs name
+/// \throws std::system_error if the socket cannot be created
+Server::Server(std::filesystem::path socketPath, std::size_t threads, world::Loader loadScene)
+  : m_socketPath(std::move(socketPath))
+  , m_listener(socket::listenUnix(m_socketPath))
+  , m_loadScene(std::move(loadScene))
+  , m_pool(threads)
+{
+  m_dispatcher = std::jthread([this](std::stop_token stop) { dispatch(stop); });
+}
+
+/// Cancel every job and remove the socket
+Server::~Server()
+{
+  cancelAll();
+  m_dispatcher.request_stop();
+  m_dispatcher.join();
+
+  std::error_code error;
+  std::filesystem::remove(m_socketPath, error);
+}
+
+/// Serve requests until the server is stopped or asked to shut down
+/// \details Returns once every connection that was accepted has been answered or handed to a job
+void Server::run()
+{
+  while (auto client = socket::acceptUnlessInterrupted(m_listener, m_interrupter)) {
+    // Threads that have finished are joined straight away
+    std::erase_if(m_connections, [](Connection const& connection) { return connection.finished.load(); });
+
+    auto& connection = m_connections.emplace_back();
+    connection.thread = std::jthread([this, &connection, client = *std::move(client)]() mutable {
+      handle(std::move(client));
+      connection.finished.store(true);
+    });
+  }
+
+  m_connections.clear();
+}
+
+/// Make run return. Can be called from any thread
+void Server::stop() noexcept
+{
+  m_interrupter.interrupt();
+}
+
+/// Read a request from a client and act on it
+/// \param[in] client The connection of the client. A render job keeps it until the job has run
+void Server::handle(socket::Socket client)
+{
+  try {
+    client.setReadTimeout(requestTimeoutSeconds);
+    client.setWriteTimeout(replyTimeoutSeconds);
+    auto const line = client.readLine();
+
+    if (not line) {
+      return;
+    }
+
+    auto const words = splitWords(*line);
+    auto const command = words.empty() ? std::string() : words[0];
+
+    if (command == "render" and words.size() == 4) {
+      auto job = std::make_shared<Job>();
+      job->id = words[1];
+      job->scene = words[3];
+
+      int priority = 0;
+
+      if (auto const [end, error] = std::from_chars(words[2].data(), words[2].data() + words[2].size(), priority);
+          error != std::errc() or end != words[2].data() + words[2].size()) {
+        throw std::runtime_error("priority '" + words[2] + "' is not an integer");
+      }
+
+      while (true) {
+        auto const setting = client.readLine();
+
+        if (not setting) {
+          throw std::runtime_error("request ended before end");
+        }
+
+        if (splitWords(*setting) == std::vector<std::string> {"end"}) {
+          break;
+        }
+
+        job->settings += *setting;
+        job->settings += '\n';
+      }
+
+      // Mistakes in the settings are reported straight away rather than when the job runs
+      auto settings = scene::Description();
+      scene::parseSettings(job->settings, settings);
+
+      auto const lock = std::scoped_lock(m_mutex);
+
+      if ((m_running and m_running->id == job->id)
+          or std::any_of(m_queue.begin(), m_queue.end(), [&job](auto const& entry) {
+               return entry.second->id == job->id;
+             })) {
+        throw std::runtime_error("job " + job->id + " already exists");
+      }
+
+      job->client = std::move(client);
+      m_queue.emplace(QueueKey(-priority, m_arrivals++), std::move(job));
+      m_jobReady.notify_one();
+    }
+    else if (command == "cancel" and words.size() == 2) {
+      cancel(words[1], client);
+    }
+    else if (command == "load" and words.size() == 2) {
+      auto const world = getWorld(words[1]);
+      reply(client, "ok " + std::to_string(world->getSpheres().size()) + '\n');
+    }
+    else if (command == "status" and words.size() == 1) {
+      auto const lock = std::scoped_lock(m_mutex);
+      reply(client, "ok " + std::to_string(m_queue.size()) + ' ' + (m_running ? m_running->id : "-") + '\n');
+    }
+    else if (command == "shutdown" and words.size() == 1) {
+      cancelAll();
+      reply(client, "ok\n");
+      stop();
+    }
+    else {
+      throw std::runtime_error("unknown request '" + *line + "'");
+    }
+  }
+  catch (std::exception const& error) {
+    if (client.isOpen()) {
+      reply(client, std::string("error ") + error.what() + '\n');
+    }
+  }
+}
+
+/// Stop a queued or running job
+/// \param[in] id The identifier of the job
+/// \param[inout] client The connection of the client that asked for the job to be stopped
+void Server::cancel(std::string const& id, socket::Socket& client)
+{
+  std::shared_ptr<Job> removed;
+
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+
+    if (m_running and m_running->id == id) {
+      // The dispatcher answers the job once the tiles being rendered are finished
+      m_running->stop.request_stop();
+    }
+    else {
+      auto const job = std::find_if(m_queue.begin(), m_queue.end(), [&id](auto const& entry) {
+        return entry.second->id == id;
+      });
+
+      if (job == m_queue.end()) {
+        throw std::runtime_error("no job " + id);
+      }
+
+      removed = std::move(job->second);
+      m_queue.erase(job);
+    }
+  }
+
+  if (removed) {
+    reply(removed->client, "cancelled " + id + '\n');
+  }
+
+  reply(client, "ok\n");
+}
+
+/// Stop the running job and every queued job
+void Server::cancelAll()
+{
+  std::map<QueueKey, std::shared_ptr<Job>> queue;
+
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+    queue.swap(m_queue);
+
+    if (m_running) {
+      m_running->stop.request_stop();
+    }
+  }
+
+  for (auto& [key, job] : queue) {
+    reply(job->client, "cancelled " + job->id + '\n');
+  }
+}
+
+/// Run the queued jobs one at a time until the server is destroyed
+/// \param[in] stop Stops the dispatcher
+void Server::dispatch(std::stop_token stop)
+{
+  while (true) {
+    std::shared_ptr<Job> job;
+
+    {
+      auto lock = std::unique_lock(m_mutex);
+
+      if (not m_jobReady.wait(lock, stop, [this] { return not m_queue.empty(); })) {
+        return;
+      }
+
+      job = std::move(m_queue.begin()->second);
+      m_queue.erase(m_queue.begin());
+      m_running = job;
+    }
+
+    try {
+      render(*job);
+    }
+    catch (std::exception const& error) {
+      reply(job->client, std::string("error ") + error.what() + '\n');
+    }
+
+    auto const lock = std::scoped_lock(m_mutex);
+    m_running.reset();
+  }
+}
+
+/// Render a job and send its image to its client
+/// \param[inout] job The job
+void Server::render(Job& job)
+{
+  auto const start = std::chrono::steady_clock::now();
+  auto const world = getWorld(job.scene);
+
+  auto description = scene::getSettings(world->getDescription());
+  scene::parseSettings(job.settings, description);
+
+  auto settings = render::Settings();
+  settings.imgWidth = description.imgWidth;
+  settings.imgHeight = description.imgHeight;
+  settings.samplesPerPixel = description.samplesPerPixel;
+  settings.maxDepth = description.maxDepth;
+  settings.showProgress = false;
+
+  auto const framebuffer = render::render(m_pool, world->getHittable(), scene::buildCamera(description), settings,
+                                          {}, job.stop.get_token());
+
+  if (job.stop.stop_requested()) {
+    reply(job.client, "cancelled " + job.id + '\n');
+    return;
+  }
+
+  std::ostringstream answer;
+  answer << "ok " << job.id << ' ' << settings.imgWidth << ' ' << settings.imgHeight << '\n';
+  render::writePpm(answer, render::tonemap(framebuffer, settings.samplesPerPixel), settings.imgWidth,
+                   settings.imgHeight);
+  reply(job.client, answer.view());
+
+  auto const milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+  std::clog << "job " << job.id << ": " << settings.imgWidth << 'x' << settings.imgHeight << ", "
+            << settings.samplesPerPixel << " spp in " << milliseconds.count() << " ms\n";
+}
+
+/// Get a scene that has been loaded, or load it
+/// \param[in] name The name of the scene
+/// \returns The scene
+/// \throws std::exception if the scene cannot be loaded
+/// \details The scene is loaded without holding the lock, so loading one scene does not hold up requests for others.
+/// Requests for a scene that is being loaded wait for it to be loaded once
+std::shared_ptr<world::World const> Server::getWorld(std::string const& name)
+{
+  std::promise<std::shared_ptr<world::World const>> loaded;
+  SceneFuture scene;
+  bool load = false;
+
+  {
+    auto const lock = std::scoped_lock(m_scenesMutex);
+    auto const [entry, added] = m_scenes.try_emplace(name);
+
+    if (added) {
+      entry->second = loaded.get_future().share();
+      load = true;
+    }
+
+    scene = entry->second;
+  }
+
+  if (load) {
+    try {
+      loaded.set_value(m_loadScene(name));
+    }
+    catch (...) {
+      // A scene that failed to load is tried again by the next request that names it
+      {
+        auto const lock = std::scoped_lock(m_scenesMutex);
+        m_scenes.erase(name);
+      }
+
+      loaded.set_exception(std::current_exception());
+    }
+  }
+
+  return scene.get();
+}
+
+/// Send a request to a server and wait for the whole answer
+/// \param[in] socketPath The path of the socket the server listens on
+/// \param[in] request The request, including its line feeds
+/// \returns The answer
+/// \throws std::system_error if the server cannot be reached
+std::string sendRequest(std::filesystem::path const& socketPath, std::string_view request)
+{
+  auto connection = socket::connectUnix(socketPath);
+  connection.writeAll(request);
+
+  return connection.readAll();
+}
+
+}   // namespace rt::server
@@ -0,0 +1,160 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "Socket.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace rt::server {
+
+/// Renders images of warm scenes on a warm thread pool for clients of a Unix domain socket
+/// \details Every connection carries one request, written as lines of text:
+///
+///     render <id> <priority> <scene>    followed by image, samples, depth and camera statements, then a line
+///                                       holding end. Answered with ok <id> <width> <height> and a PPM image once
+///                                       the job has run, or with cancelled <id>
+///     cancel <id>                       stops a queued or running job. Answered with ok
+///     load <scene>                      loads a scene ahead of the jobs that use it. Answered with ok <spheres>
+///     status                            answered with ok <queued jobs> <id of the running job, or ->
+///     shutdown                          cancels every job and stops the server. Answered with ok
+///
+/// Failed requests are answered with error <message>. Jobs run one at a time on every thread of the pool, highest
+/// priority first and in the order they arrived for equal priorities. Scenes are loaded the first time a job or a
+/// load request names them and are kept for later jobs.
+///
+/// Every connection is read and answered on a thread of its own, so a slow client or a scene being loaded does not
+/// hold up other requests. A client that stops reading its answer is dropped once a write has waited for
+/// replyTimeoutSeconds, so it cannot stall the jobs after its own
+class Server
+{
+public:
+  /// Start listening for requests
+  /// \param[in] socketPath The path of the Unix domain socket to listen on
+  /// \param[in] threads The number of render threads. Zero selects one per hardware thread
+  /// \param[in] loadScene Prepares the scenes jobs name
+  /// \throws std::system_error if the socket cannot be created
+  Server(std::filesystem::path socketPath, std::size_t threads, world::Loader loadScene);
+
+  /// Cancel every job and remove the socket
+  ~Server();
+
+  Server(Server const&) = delete;
+  Server& operator=(Server const&) = delete;
+
+  /// Serve requests until the server is stopped or asked to shut down
+  /// \details Returns once every connection that was accepted has been answered or handed to a job
+  void run();
+
+  /// Make run return. Can be called from any thread
+  void stop() noexcept;
+
+private:
+  /// A render request that has been accepted, with the connection its answer is sent on
+  struct Job
+  {
+    std::string id;
+    std::string scene;
+    std::string settings;
+    socket::Socket client;
+    std::stop_source stop;
+  };
+
+  /// Jobs are ordered by descending priority, then by arrival
+  using QueueKey = std::pair<int, std::uint64_t>;
+
+  /// A connection that is being read and answered on a thread of its own
+  struct Connection
+  {
+    std::jthread thread;
+    std::atomic<bool> finished {false};
+  };
+
+  /// A scene that has been loaded or is being loaded by the first request that named it
+  using SceneFuture = std::shared_future<std::shared_ptr<world::World const>>;
+
+  /// Read a request from a client and act on it
+  void handle(socket::Socket client);
+
+  /// Stop a queued or running job
+  void cancel(std::string const& id, socket::Socket& client);
+
+  /// Stop the running job and every queued job
+  void cancelAll();
+
+  /// Run the queued jobs one at a time until the server is destroyed
+  void dispatch(std::stop_token stop);
+
+  /// Render a job and send its image to its client
+  void render(Job& job);
+
+  /// Get a scene that has been loaded, or load it
+  std::shared_ptr<world::World const> getWorld(std::string const& name);
+
+  std::filesystem::path m_socketPath;
+  socket::Socket m_listener;
+  socket::Interrupter m_interrupter;
+  world::Loader m_loadScene;
+  threadpool::ThreadPool m_pool;
+
+  std::mutex m_scenesMutex;
+  std::map<std::string, SceneFuture> m_scenes;
+
+  std::mutex m_mutex;
+  std::condition_variable_any m_jobReady;
+  std::map<QueueKey, std::shared_ptr<Job>> m_queue;
+  std::shared_ptr<Job> m_running;
+  std::uint64_t m_arrivals {0};
+
+  std::jthread m_dispatcher;
+
+  /// Only touched by run
+  std::list<Connection> m_connections;
+};
+
+/// Send a request to a server and wait for the whole answer
+/// \param[in] socketPath The path of the socket the server listens on
+/// \param[in] request The request, including its line feeds
+/// \returns The answer
+/// \throws std::system_error if the server cannot be reached
+std::string sendRequest(std::filesystem::path const& socketPath, std::string_view request);
+
+}   // namespace rt::server
+
+#endif
@@ -0,0 +1,506 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Socket.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace rt::socket {
+
+namespace {
+
+[[noreturn]] void throwError(std::string const& what)
+{
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+sockaddr_un makeAddress(std::filesystem::path const& path)
+{
+  sockaddr_un address {};
+  address.sun_family = AF_UNIX;
+  auto const& name = path.native();
+
+  if (name.empty() or name.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("socket path '" + name + "' must have 1 to " +
+                                std::to_string(sizeof(address.sun_path) - 1) + " characters");
+  }
+
+  std::copy(name.begin(), name.end(), address.sun_path);
+
+  return address;
+}
+
+Socket makeSocket(int family = AF_UNIX)
+{
+  auto const fd = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (fd < 0) {
+    throwError("cannot create a socket");
+  }
+
+  return Socket(fd);
+}
+
+bool isUnixAddress(std::string_view address) noexcept
+{
+  return address.find('/') != std::string_view::npos;
+}
+
+/// The TCP addresses a host and port resolve to
+class TcpAddresses
+{
+public:
+  TcpAddresses(std::string const& address, bool passive)
+  {
+    auto const colon = address.rfind(':');
+
+    if (colon == std::string::npos or colon + 1 == address.size()) {
+      throw std::invalid_argument("address '" + address + "' is neither a socket path nor host:port");
+    }
+
+    auto host = address.substr(0, colon);
+
+    // IPv6 hosts are written in brackets to set them apart from the port
+    if (host.size() >= 2 and host.front() == '[' and host.back() == ']') {
+      host = host.substr(1, host.size() - 2);
+    }
+
+    auto const port = address.substr(colon + 1);
+    auto hints = addrinfo {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+    if (auto const error = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &m_first);
+        error != 0) {
+      throw std::invalid_argument("cannot resolve '" + address + "': " + ::gai_strerror(error));
+    }
+  }
+
+  ~TcpAddresses()
+  {
+    ::freeaddrinfo(m_first);
+  }
+
+  TcpAddresses(TcpAddresses const&) = delete;
+  TcpAddresses& operator=(TcpAddresses const&) = delete;
+
+  addrinfo const* getFirst() const noexcept
+  {
+    return m_first;
+  }
+
+private:
+  addrinfo* m_first {nullptr};
+};
+
+}   // namespace
+
+Socket::~Socket()
+{
+  close();
+}
+
+Socket::Socket(Socket&& other) noexcept
+  : m_fd(std::exchange(other.m_fd, -1))
+  , m_buffer(std::move(other.m_buffer))
+{
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept
+{
+  if (this != &other) {
+    close();
+    m_fd = std::exchange(other.m_fd, -1);
+    m_buffer = std::move(other.m_buffer);
+  }
+
+  return *this;
+}
+
+/// Read the next line, without its line feed
+/// \param[in] maxLength The longest line accepted
+/// \returns The line, or nothing if the peer closed the connection before sending a line
+/// \throws std::system_error if the socket cannot be read
+/// \throws std::runtime_error if the line is longer than maxLength
+std::optional<std::string> Socket::readLine(std::size_t maxLength)
+{
+  std::size_t searched = 0;
+
+  while (true) {
+    if (auto const end = m_buffer.find('\n', searched); end != std::string::npos) {
+      auto line = m_buffer.substr(0, end);
+      m_buffer.erase(0, end + 1);
+
+      return line;
+    }
+
+    if (m_buffer.size() > maxLength) {
+      throw std::runtime_error("line longer than " + std::to_string(maxLength) + " characters");
+    }
+
+    searched = m_buffer.size();
+
+    if (not fill()) {
+      return std::nullopt;
+    }
+  }
+}
+
+/// Read an exact number of bytes
+/// \param[in] size The number of bytes
+/// \returns The bytes
+/// \throws std::system_error if the socket cannot be read
+/// \throws std::runtime_error if the peer closes the connection first
+std::string Socket::readExactly(std::size_t size)
+{
+  while (m_buffer.size() < size) {
+    if (not fill()) {
+      throw std::runtime_error("connection closed after " + std::to_string(m_buffer.size()) + " of " +
+                               std::to_string(size) + " bytes");
+    }
+  }
+
+  auto data = m_buffer.substr(0, size);
+  m_buffer.erase(0, size);
+
+  return data;
+}
+
+/// Read until the peer closes the connection
+/// \returns Everything that was sent
+/// \throws std::system_error if the socket cannot be read
+std::string Socket::readAll()
+{
+  while (fill()) {
+  }
+
+  return std::exchange(m_buffer, {});
+}
+
+/// Send all of the data
+/// \param[in] data The data
+/// \throws std::system_error if the data cannot be sent, such as when the peer has closed the connection
+void Socket::writeAll(std::string_view data) const
+{
+  while (not data.empty()) {
+    // A peer that has gone away is reported as an error rather than raising SIGPIPE
+    auto const sent = ::send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throwError("cannot send");
+    }
+
+    data.remove_prefix(static_cast<std::size_t>(sent));
+  }
+}
+
+/// Stop reads on the socket from waiting forever for a peer that sends nothing
+/// \param[in] seconds The longest time a read waits for data
+void Socket::setReadTimeout(int seconds) const
+{
+  auto const timeout = timeval {.tv_sec = seconds, .tv_usec = 0};
+
+  if (::setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+    throwError("cannot set the read timeout");
+  }
+}
+
+/// Stop writes on the socket from waiting forever for a peer that reads nothing
+/// \param[in] seconds The longest time a write waits for room to send. A write that times out throws
+void Socket::setWriteTimeout(int seconds) const
+{
+  auto const timeout = timeval {.tv_sec = seconds, .tv_usec = 0};
+
+  if (::setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0) {
+    throwError("cannot set the write timeout");
+  }
+}
+
+/// Close the socket
+void Socket::close() noexcept
+{
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+/// Read whatever is available into the buffer
+/// \returns false if the peer closed the connection
+bool Socket::fill()
+{
+  char chunk[65536];
+
+  while (true) {
+    auto const received = ::recv(m_fd, chunk, sizeof(chunk), 0);
+
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throwError("cannot receive");
+    }
+
+    m_buffer.append(chunk, static_cast<std::size_t>(received));
+
+    return received > 0;
+  }
+}
+
+Interrupter::Interrupter()
+{
+  int fds[2];
+
+  if (::pipe2(fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+    throwError("cannot create a pipe");
+  }
+
+  m_read = fds[0];
+  m_write = fds[1];
+}
+
+Interrupter::~Interrupter()
+{
+  ::close(m_read);
+  ::close(m_write);
+}
+
+/// Wake every waiting thread. Can be called from any thread
+void Interrupter::interrupt() const noexcept
+{
+  char const wake = 0;
+  [[maybe_unused]] auto const written = ::write(m_write, &wake, 1);
+}
+
+/// Listen for connections on a Unix domain socket
+/// \param[in] path The path of the socket
+/// \returns The listening socket
+/// \throws std::system_error if the socket cannot be created or bound
+/// \throws std::invalid_argument if the path is too long for a socket address
+Socket listenUnix(std::filesystem::path const& path)
+{
+  auto const address = makeAddress(path);
+  auto listener = makeSocket();
+
+  // Only a socket nobody answers on is removed, so a running server cannot be displaced by accident
+  if (std::filesystem::is_socket(path)) {
+    try {
+      connectUnix(path);
+    }
+    catch (std::system_error const&) {
+      std::filesystem::remove(path);
+    }
+  }
+
+  if (::bind(listener.getDescriptor(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+    throwError("cannot bind " + path.string());
+  }
+
+  if (::listen(listener.getDescriptor(), SOMAXCONN) != 0) {
+    throwError("cannot listen on " + path.string());
+  }
+
+  return listener;
+}
+
+/// Connect to a Unix domain socket
+/// \param[in] path The path of the socket
+/// \returns The connected socket
+/// \throws std::system_error if the connection cannot be made
+/// \throws std::invalid_argument if the path is too long for a socket address
+Socket connectUnix(std::filesystem::path const& path)
+{
+  auto const address = makeAddress(path);
+  auto socket = makeSocket();
+
+  if (::connect(socket.getDescriptor(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+    throwError("cannot connect to " + path.string());
+  }
+
+  return socket;
+}
+
+/// Listen for connections on a Unix domain socket or a TCP port
+/// \param[in] address A path holding a /, which names a Unix domain socket, or host:port for TCP. Port 0 lets the
+/// system choose a free port
+/// \returns The listening socket
+/// \throws std::system_error if the socket cannot be created or bound
+/// \throws std::invalid_argument if the address is not valid
+Socket listenAt(std::string const& address)
+{
+  if (isUnixAddress(address)) {
+    return listenUnix(address);
+  }
+
+  auto const addresses = TcpAddresses(address, true);
+  auto const* const first = addresses.getFirst();
+  auto listener = makeSocket(first->ai_family);
+  int const reuse = 1;
+
+  if (::setsockopt(listener.getDescriptor(), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) {
+    throwError("cannot reuse " + address);
+  }
+
+  if (::bind(listener.getDescriptor(), first->ai_addr, first->ai_addrlen) != 0) {
+    throwError("cannot bind " + address);
+  }
+
+  if (::listen(listener.getDescriptor(), SOMAXCONN) != 0) {
+    throwError("cannot listen on " + address);
+  }
+
+  return listener;
+}
+
+/// Connect to a Unix domain socket or a TCP port
+/// \param[in] address A path holding a /, which names a Unix domain socket, or host:port for TCP
+/// \returns The connected socket
+/// \throws std::system_error if the connection cannot be made
+/// \throws std::invalid_argument if the address is not valid
+Socket connectTo(std::string const& address)
+{
+  if (isUnixAddress(address)) {
+    return connectUnix(address);
+  }
+
+  auto const addresses = TcpAddresses(address, false);
+
+  for (auto const* candidate = addresses.getFirst(); candidate; candidate = candidate->ai_next) {
+    auto socket = makeSocket(candidate->ai_family);
+
+    if (::connect(socket.getDescriptor(), candidate->ai_addr, candidate->ai_addrlen) == 0) {
+      // Requests are short lines that are answered before the next is sent, so they are not held back to be batched
+      int const noDelay = 1;
+      ::setsockopt(socket.getDescriptor(), IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+      return socket;
+    }
+  }
+
+  throwError("cannot connect to " + address);
+}
+
+/// Get the address a socket listens on, in the form listenAt and connectTo take
+/// \param[in] listener The listening socket
+/// \returns The path of a Unix domain socket, or host:port with the port the system chose
+/// \throws std::system_error if the address cannot be read
+std::string getLocalAddress(Socket const& listener)
+{
+  sockaddr_storage address {};
+  socklen_t length = sizeof(address);
+
+  if (::getsockname(listener.getDescriptor(), reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+    throwError("cannot get the address of a socket");
+  }
+
+  char host[INET6_ADDRSTRLEN] {};
+
+  switch (address.ss_family) {
+    case AF_UNIX:
+      return reinterpret_cast<sockaddr_un const&>(address).sun_path;
+    case AF_INET: {
+      auto const& ipv4 = reinterpret_cast<sockaddr_in const&>(address);
+      ::inet_ntop(AF_INET, &ipv4.sin_addr, host, sizeof(host));
+      return std::string(host) + ':' + std::to_string(ntohs(ipv4.sin_port));
+    }
+    case AF_INET6: {
+      auto const& ipv6 = reinterpret_cast<sockaddr_in6 const&>(address);
+      ::inet_ntop(AF_INET6, &ipv6.sin6_addr, host, sizeof(host));
+      return '[' + std::string(host) + "]:" + std::to_string(ntohs(ipv6.sin6_port));
+    }
+    default:
+      throw std::system_error(EAFNOSUPPORT, std::generic_category(), "unknown socket address family");
+  }
+}
+
+/// Accept the next connection on a listening socket
+/// \param[in] listener The listening socket
+/// \returns The connected socket
+/// \throws std::system_error if no connection can be accepted
+Socket accept(Socket const& listener)
+{
+  while (true) {
+    auto const fd = ::accept4(listener.getDescriptor(), nullptr, nullptr, SOCK_CLOEXEC);
+
+    if (fd >= 0) {
+      return Socket(fd);
+    }
+
+    if (errno != EINTR) {
+      throwError("cannot accept a connection");
+    }
+  }
+}
+
+/// Wait for the next connection on a listening socket unless interrupted
+/// \param[in] listener The listening socket
+/// \param[in] interrupter Stops the wait
+/// \returns The connected socket, or nothing once interrupted
+/// \throws std::system_error if no connection can be accepted
+std::optional<Socket> acceptUnlessInterrupted(Socket const& listener, Interrupter const& interrupter)
+{
+  while (true) {
+    pollfd fds[] = {{.fd = listener.getDescriptor(), .events = POLLIN, .revents = 0},
+                    {.fd = interrupter.getDescriptor(), .events = POLLIN, .revents = 0}};
+
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throwError("cannot wait for connections");
+    }
+
+    if (fds[1].revents != 0) {
+      return std::nullopt;
+    }
+
+    if (fds[0].revents != 0) {
+      return accept(listener);
+    }
+  }
+}
+
+}   // namespace rt::socket
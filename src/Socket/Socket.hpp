@@ -0,0 +1,186 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef SOCKET_HPP
+#define SOCKET_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace rt::socket {
+
+/// A connected or listening stream socket, closed when it is destroyed
+/// \details Reads are buffered so that a line-based request can be followed by raw data on the same socket
+class Socket
+{
+public:
+  Socket() noexcept = default;
+
+  /// Take ownership of a socket
+  /// \param[in] fd The file descriptor of the socket
+  explicit Socket(int fd) noexcept : m_fd(fd)
+  {
+  }
+
+  ~Socket();
+
+  Socket(Socket&& other) noexcept;
+  Socket& operator=(Socket&& other) noexcept;
+
+  Socket(Socket const&) = delete;
+  Socket& operator=(Socket const&) = delete;
+
+  bool isOpen() const noexcept
+  {
+    return m_fd >= 0;
+  }
+
+  int getDescriptor() const noexcept
+  {
+    return m_fd;
+  }
+
+  /// Read the next line, without its line feed
+  /// \param[in] maxLength The longest line accepted
+  /// \returns The line, or nothing if the peer closed the connection before sending a line
+  /// \throws std::system_error if the socket cannot be read
+  /// \throws std::runtime_error if the line is longer than maxLength
+  std::optional<std::string> readLine(std::size_t maxLength = 65536);
+
+  /// Read an exact number of bytes
+  /// \param[in] size The number of bytes
+  /// \returns The bytes
+  /// \throws std::system_error if the socket cannot be read
+  /// \throws std::runtime_error if the peer closes the connection first
+  std::string readExactly(std::size_t size);
+
+  /// Read until the peer closes the connection
+  /// \returns Everything that was sent
+  /// \throws std::system_error if the socket cannot be read
+  std::string readAll();
+
+  /// Send all of the data
+  /// \param[in] data The data
+  /// \throws std::system_error if the data cannot be sent, such as when the peer has closed the connection
+  void writeAll(std::string_view data) const;
+
+  /// Stop reads on the socket from waiting forever for a peer that sends nothing
+  /// \param[in] seconds The longest time a read waits for data
+  void setReadTimeout(int seconds) const;
+
+  /// Stop writes on the socket from waiting forever for a peer that reads nothing
+  /// \param[in] seconds The longest time a write waits for room to send. A write that times out throws
+  void setWriteTimeout(int seconds) const;
+
+  /// Close the socket
+  void close() noexcept;
+
+private:
+  /// Read whatever is available into the buffer
+  /// \returns false if the peer closed the connection
+  bool fill();
+
+  int m_fd {-1};
+  std::string m_buffer;
+};
+
+/// Lets one thread stop another from waiting for connections
+/// \details Once interrupted, it stays interrupted
+class Interrupter
+{
+public:
+  /// \throws std::system_error if the pipe it signals through cannot be created
+  Interrupter();
+  ~Interrupter();
+
+  Interrupter(Interrupter const&) = delete;
+  Interrupter& operator=(Interrupter const&) = delete;
+
+  /// Wake every waiting thread. Can be called from any thread
+  void interrupt() const noexcept;
+
+  int getDescriptor() const noexcept
+  {
+    return m_read;
+  }
+
+private:
+  int m_read {-1};
+  int m_write {-1};
+};
+
+/// Listen for connections on a Unix domain socket
+/// \details A socket file left behind by a process that is no longer listening on it is replaced
+/// \param[in] path The path of the socket
+/// \returns The listening socket
+/// \throws std::system_error if the socket cannot be created or bound
+/// \throws std::invalid_argument if the path is too long for a socket address
+Socket listenUnix(std::filesystem::path const& path);
+
+/// Connect to a Unix domain socket
+/// \param[in] path The path of the socket
+/// \returns The connected socket
+/// \throws std::system_error if the connection cannot be made
+/// \throws std::invalid_argument if the path is too long for a socket address
+Socket connectUnix(std::filesystem::path const& path);
+
+/// Listen for connections on a Unix domain socket or a TCP port
+/// \param[in] address A path holding a /, which names a Unix domain socket, or host:port for TCP. Port 0 lets the
+/// system choose a free port
+/// \returns The listening socket
+/// \throws std::system_error if the socket cannot be created or bound
+/// \throws std::invalid_argument if the address is not valid
+Socket listenAt(std::string const& address);
+
+/// Connect to a Unix domain socket or a TCP port
+/// \param[in] address A path holding a /, which names a Unix domain socket, or host:port for TCP
+/// \returns The connected socket
+/// \throws std::system_error if the connection cannot be made
+/// \throws std::invalid_argument if the address is not valid
+Socket connectTo(std::string const& address);
+
+/// Get the address a socket listens on, in the form listenAt and connectTo take
+/// \param[in] listener The listening socket
+/// \returns The path of a Unix domain socket, or host:port with the port the system chose
+/// \throws std::system_error if the address cannot be read
+std::string getLocalAddress(Socket const& listener);
+
+/// Accept the next connection on a listening socket
+/// \param[in] listener The listening socket
+/// \returns The connected socket
+/// \throws std::system_error if no connection can be accepted
+Socket accept(Socket const& listener);
+
+/// Wait for the next connection on a listening socket unless interrupted
+/// \param[in] listener The listening socket
+/// \param[in] interrupter Stops the wait
+/// \returns The connected socket, or nothing once interrupted
+/// \throws std::system_error if no connection can be accepted
+std::optional<Socket> acceptUnlessInterrupted(Socket const& listener, Interrupter const& interrupter);
+
+}   // namespace rt::socket
+
+#endif
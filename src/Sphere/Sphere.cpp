@@ -24,8 +24,9 @@
 
 #include "Sphere.hpp"
 
+#include "Dispatch.hpp"
+#include "Utilities.hpp"
 #include "Vec3.hpp"
-#include <cmath>
 
 namespace rt::sphere {
 
@@ -33,44 +34,70 @@ namespace rt::sphere {
 /// \param[in] centre The centre of the sphere
 /// \param[in] radius The radius of the sphere
 /// \param[in] material The material the sphere is made of
-Sphere::Sphere(ray::Point3 const& centre, double radius, material::Material* material) noexcept
-  : m_centre(centre), m_radius(radius), m_materialPtr(material)
+/// \param[in] objectIndex The object index of the hits on the sphere
+Sphere::Sphere(ray::Point3 const& centre, Scalar radius, material::Material* material, std::size_t objectIndex) noexcept
+  : m_centre(centre), m_radius(radius), m_materialPtr(material), m_objectIndex(objectIndex)
 {
 }
 
-bool Sphere::hit(ray::Ray const& ray, double tMin, double tMax, hittable::HitRecord& record) const noexcept
+/// Create a moving Sphere instance
+/// \param[in] centre The centre of the sphere at time 0
+/// \param[in] velocity How far the centre moves per unit of time
+/// \param[in] radius The radius of the sphere
+/// \param[in] material The material the sphere is made of
+/// \param[in] objectIndex The object index of the hits on the sphere
+Sphere::Sphere(ray::Point3 const& centre, vec3::Vec3 const& velocity, Scalar radius, material::Material* material,
+               std::size_t objectIndex) noexcept
+  : m_centre(centre), m_velocity(velocity), m_radius(radius), m_materialPtr(material), m_objectIndex(objectIndex)
 {
-  auto const oc = ray.getOrigin() - m_centre;
-  auto const a = ray.getDirection().lengthSquared();
-  auto const halfB = vec3::getDotProduct(oc, ray.getDirection());
-  auto const c = oc.lengthSquared() - (m_radius * m_radius);
+}
 
-  auto const discriminant = (halfB * halfB) - (a * c);
+bool Sphere::hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept
+{
+  auto const hit = dispatch::run([&]() noexcept {
+    return hitSphere(m_centre + ray.getTime() * m_velocity, m_radius, ray, tMin, tMax, record);
+  });
 
-  if (discriminant < 0) {
+  if (not hit) {
     return false;
   }
 
-  auto const sqrtDiscriminant = std::sqrt(discriminant);
-
-  // Find the nearest root that lies in the acceptable range
-  auto root = (-halfB - sqrtDiscriminant) / a;
+  record.materialPtr = m_materialPtr.get();
+  record.objectIndex = m_objectIndex;
 
-  if (root < tMin or tMax < root) {
-    root = (-halfB + sqrtDiscriminant) / a;
+  return true;
+}
 
-    if (root < tMin or tMax < root) {
-      return false;
+/// Intersect a stream of rays with the sphere
+/// \param[in] rays The rays
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+/// \param[out] records Receives the intersection of every ray that hits the sphere, at the index of the ray. The
+/// distance of the record of a ray that misses is set to infinity
+/// \returns The number of rays that hit the sphere
+/// \details The whole stream runs in one call of the kernel compiled for the selected instruction set
+std::size_t Sphere::hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                              std::span<hittable::HitRecord> records) const noexcept
+{
+  return dispatch::run([&]() noexcept {
+    std::size_t hits = 0;
+
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      auto const& ray = rays[i];
+      auto& record = records[i];
+
+      if (hitSphere(m_centre + ray.getTime() * m_velocity, m_radius, ray, tMin, tMax[i], record)) {
+        record.materialPtr = m_materialPtr.get();
+        record.objectIndex = m_objectIndex;
+        ++hits;
+      }
+      else {
+        record.t = rt::infinity;
+      }
     }
-  }
 
-  record.t = root;
-  record.point = ray.at(record.t);
-  auto const& outwardNormal = (record.point - m_centre) / m_radius;
-  record.setFaceNormal(ray, outwardNormal);
-  record.materialPtr = m_materialPtr.get();
-
-  return true;
+    return hits;
+  });
 }
 
 }   // namespace rt::sphere
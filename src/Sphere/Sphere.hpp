@@ -28,7 +28,13 @@
 #include "Hittable.hpp"
 #include "Material.hpp"
 #include "Ray.hpp"
+#include "Stats.hpp"
+#include "Vec3.hpp"
+#include <cmath>
+#include <cstddef>
 #include <memory>
+#include <span>
+#include <type_traits>
 
 namespace rt::sphere {
 
@@ -42,16 +48,91 @@ public:
   /// \param[in] centre The centre of the sphere
   /// \param[in] radius The radius of the sphere
   /// \param[in] material The material the sphere is made of
-  explicit Sphere(ray::Point3 const& centre, double radius, material::Material* material) noexcept;
+  /// \param[in] objectIndex The object index of the hits on the sphere
+  explicit Sphere(ray::Point3 const& centre, Scalar radius, material::Material* material,
+                  std::size_t objectIndex = 0) noexcept;
 
-  bool hit(ray::Ray const& ray, double tMin, double tMax, hittable::HitRecord& record) const noexcept override;
+  /// Create a moving Sphere instance
+  /// \param[in] centre The centre of the sphere at time 0
+  /// \param[in] velocity How far the centre moves per unit of time
+  /// \param[in] radius The radius of the sphere
+  /// \param[in] material The material the sphere is made of
+  /// \param[in] objectIndex The object index of the hits on the sphere
+  explicit Sphere(ray::Point3 const& centre, vec3::Vec3 const& velocity, Scalar radius, material::Material* material,
+                  std::size_t objectIndex = 0) noexcept;
+
+  bool hit(ray::Ray const& ray, Scalar tMin, Scalar tMax, hittable::HitRecord& record) const noexcept override;
+
+  /// Intersect a stream of rays with the sphere
+  /// \param[in] rays The rays
+  /// \param[in] tMin The lower bound of the distances that count as an intersection
+  /// \param[in] tMax The upper bound of the distances that count as an intersection for every ray, at its index
+  /// \param[out] records Receives the intersection of every ray that hits the sphere, at the index of the ray. The
+  /// distance of the record of a ray that misses is set to infinity
+  /// \returns The number of rays that hit the sphere
+  /// \details The whole stream runs in one call of the kernel compiled for the selected instruction set
+  std::size_t hitStream(std::span<ray::Ray const> rays, Scalar tMin, std::span<Scalar const> tMax,
+                        std::span<hittable::HitRecord> records) const noexcept override;
 
 private:
   ray::Point3 m_centre {};
-  double m_radius {};
+  vec3::Vec3 m_velocity {};
+  Scalar m_radius {};
   std::unique_ptr<material::Material> m_materialPtr;
+  std::size_t m_objectIndex {0};
 };
 
+/// Find the nearest intersection of a ray with a sphere within a range of distances
+/// \param[in] centre The centre of the sphere
+/// \param[in] radius The radius of the sphere. A negative radius turns the normals inwards
+/// \param[in] ray The ray
+/// \param[in] tMin The lower bound of the distances that count as an intersection
+/// \param[in] tMax The upper bound of the distances that count as an intersection
+/// \param[out] record Receives the distance, point and normal of the intersection, if there is one. Its material and
+/// object index are left untouched
+/// \returns true if there was an intersection and false otherwise
+/// \tparam T The scalar type the intersection is computed in, which is the one of the ray
+template <typename T>
+bool hitSphere(ray::BasicPoint3<T> const& centre, std::type_identity_t<T> radius, ray::BasicRay<T> const& ray,
+               std::type_identity_t<T> tMin, std::type_identity_t<T> tMax,
+               hittable::BasicHitRecord<T>& record) noexcept
+{
+  RT_COUNT(sphereTests);
+
+  auto const oc = ray.getOrigin() - centre;
+  auto const a = ray.getDirection().lengthSquared();
+  auto const halfB = vec3::getDotProduct(oc, ray.getDirection());
+  auto const c = oc.lengthSquared() - (radius * radius);
+
+  auto const discriminant = (halfB * halfB) - (a * c);
+
+  if (discriminant < 0) {
+    return false;
+  }
+
+  auto const sqrtDiscriminant = std::sqrt(discriminant);
+
+  // Find the nearest root that lies in the acceptable range
+  auto root = (-halfB - sqrtDiscriminant) / a;
+
+  if (root < tMin or tMax < root) {
+    root = (-halfB + sqrtDiscriminant) / a;
+
+    if (root < tMin or tMax < root) {
+      return false;
+    }
+  }
+
+  record.t = root;
+  record.point = ray.at(record.t);
+  auto const& outwardNormal = (record.point - centre) / radius;
+  record.setFaceNormal(ray, outwardNormal);
+
+  RT_COUNT(sphereHits);
+
+  return true;
+}
+
 }   // namespace rt::sphere
 
 #endif
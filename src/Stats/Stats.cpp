@@ -0,0 +1,198 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Stats.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+namespace rt::stats {
+
+namespace {
+
+/// The counters of every thread that has ever counted anything, followed by the counters shared by the threads that
+/// came after the pool was used up
+/// \details Constant-initialised, so the pool takes no memory until threads touch it
+struct Registry
+{
+  std::array<ThreadCounters, maxThreads> threads {};
+  ThreadCounters shared {};
+  /// The number of sets of counters handed out, which may overshoot maxThreads
+  std::atomic<std::size_t> used {0};
+
+  /// Call a function on every set of counters handed out so far, and then on the shared one
+  template <typename Function>
+  void forEach(Function&& function) noexcept
+  {
+    auto const count = std::min(used.load(std::memory_order_acquire), maxThreads);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      function(threads[i]);
+    }
+
+    function(shared);
+  }
+};
+
+constinit Registry registry;
+
+/// Get the total number of rays traced
+std::uint64_t getRayCount(Snapshot const& snapshot) noexcept
+{
+  return snapshot[static_cast<std::size_t>(Counter::cameraRays)]
+       + snapshot[static_cast<std::size_t>(Counter::secondaryRays)];
+}
+
+}   // namespace
+
+/// Claim a set of counters for the calling thread and make it the thread's threadCounters
+/// \returns The counters of the calling thread, or null if all maxThreads sets are taken
+/// \details The counters come from a fixed pool, so registering allocates nothing and cannot fail. They outlive
+/// their thread, so the work of finished threads is still reported, and are never handed to another thread
+ThreadCounters* registerThread() noexcept
+{
+  // Checking first keeps threads that keep finding the pool full from pushing the count towards overflow
+  if (registry.used.load(std::memory_order_relaxed) >= maxThreads) {
+    return nullptr;
+  }
+
+  auto const index = registry.used.fetch_add(1, std::memory_order_acq_rel);
+
+  if (index >= maxThreads) {
+    return nullptr;
+  }
+
+  threadCounters = &registry.threads[index];
+  return threadCounters;
+}
+
+/// Increment one of the counters shared by the threads that found every set of counters taken
+/// \param[in] counter The counter to increment
+/// \details Uses an atomic add, as several threads may write the shared counters at once
+void incrementShared(Counter counter) noexcept
+{
+  registry.shared.values[static_cast<std::size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Sum the counters of every thread that has counted anything
+/// \returns The counter totals
+/// \details May be called while other threads count. Increments that race with it may or may not be included
+Snapshot collect() noexcept
+{
+  Snapshot snapshot {};
+
+  registry.forEach([&](ThreadCounters const& thread) {
+    for (std::size_t i = 0; i < counterCount; ++i) {
+      snapshot[i] += thread.values[i].load(std::memory_order_relaxed);
+    }
+  });
+
+  return snapshot;
+}
+
+/// Zero the counters of every thread
+/// \details Should only be called while no other thread counts, as an increment racing with it may be lost or
+/// survive the reset
+void reset() noexcept
+{
+  registry.forEach([](ThreadCounters& thread) {
+    for (auto& value : thread.values) {
+      value.store(0, std::memory_order_relaxed);
+    }
+  });
+}
+
+/// Get the name a counter is reported under in the summary and the JSON output
+/// \param[in] counter The counter
+/// \returns The name of the counter, or "unknown" for Counter::count
+std::string_view getCounterName(Counter counter) noexcept
+{
+  switch (counter) {
+    case Counter::cameraRays:         return "cameraRays";
+    case Counter::secondaryRays:      return "secondaryRays";
+    case Counter::sphereTests:        return "sphereTests";
+    case Counter::sphereHits:         return "sphereHits";
+    case Counter::instanceTests:      return "instanceTests";
+    case Counter::triangleTests:      return "triangleTests";
+    case Counter::shapeTests:         return "shapeTests";
+    case Counter::skyMisses:          return "skyMisses";
+    case Counter::lambertianScatters: return "lambertianScatters";
+    case Counter::metalScatters:      return "metalScatters";
+    case Counter::dielectricScatters: return "dielectricScatters";
+    case Counter::absorptions:        return "absorptions";
+    case Counter::depthLimits:        return "depthLimits";
+    case Counter::sortedRays:         return "sortedRays";
+    case Counter::count:              break;
+  }
+
+  return "unknown";
+}
+
+/// Write a human-readable summary of the counters
+/// \param[inout] out The output stream to write to
+/// \param[in] snapshot The counter totals
+/// \param[in] seconds The wall time the counted work took
+void writeSummary(std::ostream& out, Snapshot const& snapshot, double seconds)
+{
+  auto const rays = getRayCount(snapshot);
+
+  out << "Ray tracing statistics\n";
+
+  for (std::size_t i = 0; i < counterCount; ++i) {
+    out << "  " << std::left << std::setw(20) << getCounterName(static_cast<Counter>(i)) << std::right
+        << std::setw(16) << snapshot[i] << '\n';
+  }
+
+  out << "  " << std::left << std::setw(20) << "rays" << std::right << std::setw(16) << rays << '\n';
+  out << "  " << std::left << std::setw(20) << "seconds" << std::right << std::setw(16) << std::fixed
+      << std::setprecision(3) << seconds << '\n';
+  out << "  " << std::left << std::setw(20) << "Mrays/s" << std::right << std::setw(16)
+      << (seconds > 0 ? static_cast<double>(rays) / seconds / 1e6 : 0.0) << '\n';
+  out << std::defaultfloat;
+}
+
+/// Write the counters as a JSON object
+/// \param[inout] out The output stream to write to
+/// \param[in] snapshot The counter totals
+/// \param[in] seconds The wall time the counted work took
+void writeJson(std::ostream& out, Snapshot const& snapshot, double seconds)
+{
+  auto const rays = getRayCount(snapshot);
+
+  out << "{\n  \"counters\": {\n";
+
+  for (std::size_t i = 0; i < counterCount; ++i) {
+    out << "    \"" << getCounterName(static_cast<Counter>(i)) << "\": " << snapshot[i]
+        << (i + 1 < counterCount ? ",\n" : "\n");
+  }
+
+  out << "  },\n";
+  out << "  \"rays\": " << rays << ",\n";
+  out << "  \"seconds\": " << seconds << ",\n";
+  out << "  \"raysPerSecond\": " << (seconds > 0 ? static_cast<double>(rays) / seconds : 0.0) << "\n";
+  out << "}\n";
+}
+
+}   // namespace rt::stats
@@ -0,0 +1,172 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+/// Increment the given ray tracing counter of the calling thread
+/// \details Expands to nothing unless the project is configured with MyProject_ENABLE_STATS
+#ifdef RT_ENABLE_STATS
+  #define RT_COUNT(counter) ::rt::stats::increment(::rt::stats::Counter::counter)
+#else
+  #define RT_COUNT(counter) static_cast<void>(0)
+#endif
+
+namespace rt::stats {
+
+/// Whether the RT_COUNT instrumentation is compiled in
+#ifdef RT_ENABLE_STATS
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+/// The events counted by the ray tracing instrumentation
+enum class Counter : std::size_t
+{
+  cameraRays,
+  secondaryRays,
+  sphereTests,
+  sphereHits,
+  instanceTests,
+  triangleTests,
+  shapeTests,
+  skyMisses,
+  lambertianScatters,
+  metalScatters,
+  dielectricScatters,
+  absorptions,
+  depthLimits,
+  sortedRays,
+  count
+};
+
+inline constexpr auto counterCount = static_cast<std::size_t>(Counter::count);
+
+/// The size of a cache line on the targets we care about. Counters of different threads are kept this far apart
+inline constexpr std::size_t cacheLineSize = 64;
+
+/// The counters owned by a single thread, padded to a cache line so that threads never share one
+struct alignas(cacheLineSize) ThreadCounters
+{
+  std::array<std::atomic<std::uint64_t>, counterCount> values {};
+};
+
+/// The number of threads that get counters of their own. Threads beyond it share a single set of counters
+inline constexpr std::size_t maxThreads = 256;
+
+/// The counter totals over every thread
+using Snapshot = std::array<std::uint64_t, counterCount>;
+
+/// The counters of the calling thread, or null until the thread first counts something
+/// \details Constant-initialised so that reading it compiles to a plain thread-local load
+inline thread_local ThreadCounters* threadCounters = nullptr;
+
+/// Claim a set of counters for the calling thread and make it the thread's threadCounters
+/// \returns The counters of the calling thread, or null if all maxThreads sets are taken
+/// \details The counters come from a fixed pool, so registering allocates nothing and cannot fail. They outlive
+/// their thread, so the work of finished threads is still reported, and are never handed to another thread
+ThreadCounters* registerThread() noexcept;
+
+/// Increment one of the counters shared by the threads that found every set of counters taken
+/// \param[in] counter The counter to increment
+/// \details Uses an atomic add, as several threads may write the shared counters at once
+void incrementShared(Counter counter) noexcept;
+
+/// Increment one of the counters of the calling thread
+/// \param[in] counter The counter to increment
+/// \details The first increment on a thread registers it. Every later one is a thread-local load, a relaxed load
+/// and a relaxed store
+inline void increment(Counter counter) noexcept
+{
+  auto* counters = threadCounters;
+
+  if (counters == nullptr) [[unlikely]] {
+    counters = registerThread();
+
+    if (counters == nullptr) {
+      incrementShared(counter);
+      return;
+    }
+  }
+
+  // Only the owning thread ever writes its counters, so a relaxed load and store is enough and avoids a locked add
+  auto& value = counters->values[static_cast<std::size_t>(counter)];
+  value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/// Get the current value of one of the counters of the calling thread
+/// \param[in] counter The counter
+/// \returns The number of times the calling thread has incremented the counter since the last reset
+inline std::uint64_t getThreadCount(Counter counter) noexcept
+{
+  auto const* counters = threadCounters;
+  return counters ? counters->values[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed) : 0;
+}
+
+/// Get the number of ray-object intersection tests the calling thread has performed, of every kind of object
+/// \returns The sum of the test counters of the calling thread
+inline std::uint64_t getThreadTestCount() noexcept
+{
+  return getThreadCount(Counter::sphereTests) + getThreadCount(Counter::instanceTests)
+       + getThreadCount(Counter::triangleTests) + getThreadCount(Counter::shapeTests);
+}
+
+/// Sum the counters of every thread that has counted anything
+/// \returns The counter totals
+/// \details May be called while other threads count. Increments that race with it may or may not be included
+Snapshot collect() noexcept;
+
+/// Zero the counters of every thread
+/// \details Should only be called while no other thread counts, as an increment racing with it may be lost or
+/// survive the reset
+void reset() noexcept;
+
+/// Get the name a counter is reported under in the summary and the JSON output
+/// \param[in] counter The counter
+/// \returns The name of the counter, or "unknown" for Counter::count
+std::string_view getCounterName(Counter counter) noexcept;
+
+/// Write a human-readable summary of the counters
+/// \param[inout] out The output stream to write to
+/// \param[in] snapshot The counter totals
+/// \param[in] seconds The wall time the counted work took
+void writeSummary(std::ostream& out, Snapshot const& snapshot, double seconds);
+
+/// Write the counters as a JSON object
+/// \param[inout] out The output stream to write to
+/// \param[in] snapshot The counter totals
+/// \param[in] seconds The wall time the counted work took
+void writeJson(std::ostream& out, Snapshot const& snapshot, double seconds);
+
+}   // namespace rt::stats
+
+#endif
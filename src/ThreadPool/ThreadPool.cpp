@@ -0,0 +1,112 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace rt::threadpool {
+
+/// Start the threads of the pool
+/// \param[in] threadCount The number of threads that run every task, including the calling thread of run. Zero
+/// selects one per hardware thread
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+  if (threadCount == 0) {
+    threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+
+  m_workers.reserve(threadCount - 1);
+
+  for (std::size_t thread = 1; thread < threadCount; ++thread) {
+    m_workers.emplace_back([this, thread] { work(thread); });
+  }
+}
+
+/// Stop and join the threads of the pool
+ThreadPool::~ThreadPool()
+{
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+    m_stopping = true;
+  }
+
+  m_taskReady.notify_all();
+  m_workers.clear();
+}
+
+/// Run a task on every thread of the pool and wait for all of them to finish it
+/// \param[in] task The task. It is passed the index of the thread running it, from 0 to getThreadCount() - 1
+/// \pre The task does not throw
+void ThreadPool::run(std::function<void(std::size_t)> const& task)
+{
+  auto const runLock = std::scoped_lock(m_runMutex);
+
+  {
+    auto const lock = std::scoped_lock(m_mutex);
+    m_task = &task;
+    m_running = m_workers.size();
+    ++m_generation;
+  }
+
+  m_taskReady.notify_all();
+  task(0);
+
+  auto lock = std::unique_lock(m_mutex);
+  m_taskDone.wait(lock, [this] { return m_running == 0; });
+  m_task = nullptr;
+}
+
+/// Run every task of the pool until it is stopped
+/// \param[in] thread The index of the thread
+void ThreadPool::work(std::size_t thread)
+{
+  std::uint64_t generation = 0;
+
+  while (true) {
+    std::function<void(std::size_t)> const* task = nullptr;
+
+    {
+      auto lock = std::unique_lock(m_mutex);
+      m_taskReady.wait(lock, [&] { return m_stopping or m_generation != generation; });
+
+      if (m_stopping) {
+        return;
+      }
+
+      generation = m_generation;
+      task = m_task;
+    }
+
+    (*task)(thread);
+
+    {
+      auto const lock = std::scoped_lock(m_mutex);
+      --m_running;
+    }
+
+    m_taskDone.notify_one();
+  }
+}
+
+}   // namespace rt::threadpool
@@ -0,0 +1,84 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rt::threadpool {
+
+/// A fixed set of threads that run the same task together
+/// \details The threads are started once and wait between tasks, so running a task costs a wake-up rather than
+/// creating threads. The thread calling run takes part in every task as thread 0
+class ThreadPool
+{
+public:
+  /// Start the threads of the pool
+  /// \param[in] threadCount The number of threads that run every task, including the calling thread of run. Zero
+  /// selects one per hardware thread
+  explicit ThreadPool(std::size_t threadCount);
+
+  /// Stop and join the threads of the pool
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  /// Get the number of threads that run every task, including the calling thread of run
+  std::size_t getThreadCount() const noexcept
+  {
+    return m_workers.size() + 1;
+  }
+
+  /// Run a task on every thread of the pool and wait for all of them to finish it
+  /// \details Only one task runs at a time. Concurrent calls wait for each other
+  /// \param[in] task The task. It is passed the index of the thread running it, from 0 to getThreadCount() - 1
+  /// \pre The task does not throw
+  void run(std::function<void(std::size_t)> const& task);
+
+private:
+  /// Run every task of the pool until it is stopped
+  /// \param[in] thread The index of the thread
+  void work(std::size_t thread);
+
+  std::mutex m_runMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_taskReady;
+  std::condition_variable m_taskDone;
+  std::function<void(std::size_t)> const* m_task {nullptr};
+  std::uint64_t m_generation {0};
+  std::size_t m_running {0};
+  bool m_stopping {false};
+  std::vector<std::jthread> m_workers;
+};
+
+}   // namespace rt::threadpool
+
+#endif
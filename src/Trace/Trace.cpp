@@ -0,0 +1,177 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace rt::trace {
+
+namespace {
+
+/// The buffers of every thread that has ever recorded a span
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> threads;
+};
+
+Registry& getRegistry() noexcept
+{
+  static Registry registry;
+  return registry;
+}
+
+std::atomic<Clock::rep> origin {0};
+
+/// Write a string as a JSON string literal
+void writeJsonString(std::ostream& out, std::string_view text)
+{
+  out << '"';
+
+  for (auto const c : text) {
+    if (c == '"' or c == '\\') {
+      out << '\\';
+    }
+
+    out << c;
+  }
+
+  out << '"';
+}
+
+/// Write a time in the microseconds Chrome trace events are given in, to a tenth of a microsecond
+/// \param[inout] out The output stream to write to
+/// \param[in] ns The time in nanoseconds, which may be negative
+void writeMicroseconds(std::ostream& out, std::int64_t ns)
+{
+  // Split the magnitude, as division and remainder round towards zero and would give "-2.-5" for -2500 ns
+  auto const magnitude = ns < 0 ? 0 - static_cast<std::uint64_t>(ns) : static_cast<std::uint64_t>(ns);
+
+  if (ns < 0) {
+    out << '-';
+  }
+
+  out << magnitude / 1000 << '.' << magnitude % 1000 / 100;
+}
+
+}   // namespace
+
+/// Allocate and register the trace buffer of the calling thread
+/// \returns The trace buffer of the calling thread
+ThreadBuffer* registerThread()
+{
+  auto& registry = getRegistry();
+  auto const lock = std::scoped_lock(registry.mutex);
+  auto const threadId = static_cast<std::uint32_t>(registry.threads.size() + 1);
+  threadBuffer = registry.threads.emplace_back(std::make_unique<ThreadBuffer>(threadId)).get();
+
+  return threadBuffer;
+}
+
+/// Start recording spans on every thread and make now the origin of the trace timeline
+void start()
+{
+  origin.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+  recording.store(true, std::memory_order_release);
+}
+
+/// Stop recording spans. Spans that are still open when this is called are dropped
+void stop() noexcept
+{
+  recording.store(false, std::memory_order_release);
+}
+
+/// Get the time at which the trace was started
+Clock::time_point getOrigin() noexcept
+{
+  return Clock::time_point(Clock::duration(origin.load(std::memory_order_relaxed)));
+}
+
+/// Set the name the calling thread is shown under in the trace viewer
+/// \param[in] name The name of the thread
+void setThreadName(std::string name)
+{
+  auto* buffer = threadBuffer ? threadBuffer : registerThread();
+  buffer->setThreadName(std::move(name));
+}
+
+/// Write every recorded span in the Chrome trace event JSON format
+/// \param[inout] out The output stream to write to
+/// \details Must not be called while other threads are recording. The output can be loaded into chrome://tracing or
+/// https://ui.perfetto.dev
+void writeChromeTrace(std::ostream& out)
+{
+  auto& registry = getRegistry();
+  auto const lock = std::scoped_lock(registry.mutex);
+  bool first = true;
+
+  auto const separator = [&] {
+    out << (first ? "\n" : ",\n");
+    first = false;
+  };
+
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+  for (auto const& thread : registry.threads) {
+    if (not thread->getThreadName().empty()) {
+      separator();
+      out << R"({"name": "thread_name", "ph": "M", "pid": 1, "tid": )" << thread->getThreadId()
+          << R"(, "args": {"name": )";
+      writeJsonString(out, thread->getThreadName());
+      out << "}}";
+    }
+
+    auto const head = thread->getHead();
+    auto const oldest = head - std::min(head, ThreadBuffer::capacity);
+
+    for (auto sequence = oldest; sequence < head; ++sequence) {
+      auto const& event = thread->getEvent(sequence);
+
+      separator();
+      out << "{\"name\": ";
+      writeJsonString(out, event.name);
+      out << ", \"cat\": ";
+      writeJsonString(out, event.category);
+      out << R"(, "ph": "X", "pid": 1, "tid": )" << thread->getThreadId() << ", \"ts\": ";
+      writeMicroseconds(out, event.startNs);
+      out << ", \"dur\": ";
+      writeMicroseconds(out, event.durationNs);
+
+      if (event.id >= 0) {
+        out << R"(, "args": {"id": )" << event.id << '}';
+      }
+
+      out << '}';
+    }
+  }
+
+  out << "\n]}\n";
+}
+
+}   // namespace rt::trace
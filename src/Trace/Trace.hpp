@@ -0,0 +1,203 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+
+namespace rt::trace {
+
+/// The clock spans are timed with
+using Clock = std::chrono::steady_clock;
+
+/// A completed span, in the form of a Chrome trace "complete" event
+struct Event
+{
+  /// The name of the span. Must point to a string with static storage duration
+  char const* name;
+  /// The category of the span. Must point to a string with static storage duration
+  char const* category;
+  /// The start of the span, relative to the start of the trace. Negative for a span opened before the trace was
+  /// last restarted
+  std::int64_t startNs;
+  /// The length of the span
+  std::int64_t durationNs;
+  /// An optional integer shown as args.id in the trace viewer, or -1
+  std::int64_t id;
+};
+
+/// A fixed-capacity ring buffer of the events recorded by one thread
+/// \details Only the owning thread writes to the buffer. Once full, the oldest events are overwritten
+class ThreadBuffer
+{
+public:
+  static constexpr std::size_t capacity = std::size_t {1} << 16;
+
+  /// Create an empty buffer for the thread with the given trace id
+  explicit ThreadBuffer(std::uint32_t threadId) noexcept : m_threadId(threadId)
+  {
+  }
+
+  /// Append an event, overwriting the oldest one if the buffer is full
+  /// \param[in] event The event to append
+  void push(Event const& event) noexcept
+  {
+    auto const head = m_head.load(std::memory_order_relaxed);
+    m_events[head % capacity] = event;
+    m_head.store(head + 1, std::memory_order_release);
+  }
+
+  /// Get the total number of events ever pushed
+  std::size_t getHead() const noexcept
+  {
+    return m_head.load(std::memory_order_acquire);
+  }
+
+  /// Get the event with the given sequence number
+  /// \pre sequence must be one of the last capacity events pushed
+  Event const& getEvent(std::size_t sequence) const noexcept
+  {
+    return m_events[sequence % capacity];
+  }
+
+  /// Get the id the owning thread is shown under in the trace
+  std::uint32_t getThreadId() const noexcept
+  {
+    return m_threadId;
+  }
+
+  /// Get the name the owning thread is shown under in the trace viewer, which is empty if it was never named
+  std::string const& getThreadName() const noexcept
+  {
+    return m_threadName;
+  }
+
+  /// Set the name the owning thread is shown under in the trace viewer
+  /// \param[in] name The name of the thread
+  void setThreadName(std::string name)
+  {
+    m_threadName = std::move(name);
+  }
+
+private:
+  std::array<Event, capacity> m_events {};
+  std::atomic<std::size_t> m_head {0};
+  std::uint32_t m_threadId {};
+  std::string m_threadName;
+};
+
+/// Whether spans are currently being recorded
+inline std::atomic<bool> recording {false};
+
+/// The buffer of the calling thread, or null until the thread first records a span
+inline thread_local ThreadBuffer* threadBuffer = nullptr;
+
+/// Allocate and register the trace buffer of the calling thread
+/// \returns The trace buffer of the calling thread
+ThreadBuffer* registerThread();
+
+/// Check whether spans are currently being recorded
+inline bool isRecording() noexcept
+{
+  return recording.load(std::memory_order_acquire);
+}
+
+/// Start recording spans on every thread and make now the origin of the trace timeline
+void start();
+
+/// Stop recording spans. Spans that are still open when this is called are dropped
+void stop() noexcept;
+
+/// Get the time at which the trace was started
+Clock::time_point getOrigin() noexcept;
+
+/// Set the name the calling thread is shown under in the trace viewer
+/// \param[in] name The name of the thread
+void setThreadName(std::string name);
+
+/// Record a span covering the lifetime of the object
+/// \details The span costs a single atomic load when recording is off
+class Span
+{
+public:
+  /// Open a span
+  /// \param[in] name The name of the span. Must be a string literal
+  /// \param[in] category The category of the span. Must be a string literal
+  /// \param[in] id An optional integer such as a tile index, or -1
+  explicit Span(char const* name, char const* category, std::int64_t id = -1) noexcept
+    : m_name(name), m_category(category), m_id(id)
+  {
+    if (isRecording()) {
+      m_start = Clock::now();
+      m_active = true;
+    }
+  }
+
+  Span(Span const&) = delete;
+  Span& operator=(Span const&) = delete;
+
+  /// Close the span and record it in the buffer of the calling thread
+  ~Span()
+  {
+    if (m_active and isRecording()) {
+      auto const end = Clock::now();
+      auto* buffer = threadBuffer ? threadBuffer : registerThread();
+      auto const origin = getOrigin();
+
+      buffer->push(Event {m_name, m_category, toNanoseconds(m_start - origin), toNanoseconds(end - m_start), m_id});
+    }
+  }
+
+private:
+  char const* m_name;
+  char const* m_category;
+  std::int64_t m_id;
+
+  /// Convert a duration of the trace clock to whole nanoseconds
+  static std::int64_t toNanoseconds(Clock::duration duration) noexcept
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  }
+
+  Clock::time_point m_start {};
+  bool m_active {false};
+};
+
+/// Write every recorded span in the Chrome trace event JSON format
+/// \param[inout] out The output stream to write to
+/// \details Must not be called while other threads are recording. The output can be loaded into chrome://tracing or
+/// https://ui.perfetto.dev
+void writeChromeTrace(std::ostream& out);
+
+}   // namespace rt::trace
+
+#endif
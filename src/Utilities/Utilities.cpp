@@ -24,17 +24,93 @@
 
 #include "Utilities.hpp"
 
+#include "Dispatch.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <random>
 
 namespace rt {
 
+namespace {
+
+/// The number of random numbers a thread draws from its generator at once
+constexpr std::size_t blockSize = 256;
+
+/// The random number generator of a thread and the numbers it has drawn ahead of their use
+struct RandomState
+{
+  std::mt19937 generator;
+  std::array<double, blockSize> values {};
+  std::size_t next {blockSize};
+};
+
+/// Get the random number state of the calling thread
+RandomState& getRandomState()
+{
+  thread_local RandomState state;
+  return state;
+}
+
+/// Draw the next block of random numbers of a thread
+/// \param[inout] state The random number state of the thread. Its next number is the first of the new block
+/// \details Runs compiled for the instruction set selected with dispatch. Every number is made from two words of the
+/// generator, low word first, exactly as std::generate_canonical in libstdc++ makes them, so the sequence is the one
+/// std::uniform_real_distribution gives
+void refill(RandomState& state) noexcept
+{
+  dispatch::run([&]() noexcept {
+    std::array<std::uint32_t, 2 * blockSize> words;
+    std::ranges::generate(words, std::ref(state.generator));
+
+    for (std::size_t k = 0; k < blockSize; ++k) {
+      auto const low = static_cast<double>(words[2 * k]);
+      auto const high = static_cast<double>(words[2 * k + 1]);
+      auto const value = (low + (high * 0x1p32)) * 0x1p-64;
+      state.values[k] = value < 1.0 ? value : std::nextafter(1.0, 0.0);
+    }
+  });
+
+  state.next = 0;
+}
+
+}   // namespace
+
 /// Get a random real number in the range [0, 1)
 /// \returns A random real number in the range [0, 1)
+/// \details Every thread draws from its own generator
 double getRandomDouble()
 {
-  static std::uniform_real_distribution<double> distribution(0.0, 1.0);
-  static std::mt19937 generator;
-  return distribution(generator);
+  auto& state = getRandomState();
+
+  if (state.next == blockSize) [[unlikely]] {
+    refill(state);
+  }
+
+  return state.values[state.next++];
+}
+
+/// Reseed the random number generator of the calling thread
+/// \param[in] seed The seed shared by every stream of a render
+/// \param[in] stream Selects an independent sequence for the given seed, such as the index of a tile
+void seedRandom(std::uint64_t seed, std::uint64_t stream)
+{
+  std::seed_seq sequence {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                          static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)};
+  auto& state = getRandomState();
+  state.generator.seed(sequence);
+  state.next = blockSize;
+}
+
+/// Return the random number generator of the calling thread to the state every thread starts in
+void resetRandom()
+{
+  auto& state = getRandomState();
+  state.generator.seed(std::mt19937::default_seed);
+  state.next = blockSize;
 }
 
 /// Get a random real number in the range [min, max)
@@ -26,6 +26,7 @@
 #define UTILITIES_HPP
 
 #include <cmath>
+#include <cstdint>
 #include <limits>
 #include <numbers>
 
@@ -44,8 +45,17 @@ constexpr double degreesToRadians(double degrees) noexcept
 
 /// Get a random real number in the range [0, 1)
 /// \returns A random real number in the range [0, 1)
+/// \details Every thread draws from its own generator
 double getRandomDouble();
 
+/// Reseed the random number generator of the calling thread
+/// \param[in] seed The seed shared by every stream of a render
+/// \param[in] stream Selects an independent sequence for the given seed, such as the index of a tile
+void seedRandom(std::uint64_t seed, std::uint64_t stream = 0);
+
+/// Return the random number generator of the calling thread to the state every thread starts in
+void resetRandom();
+
 /// Get a random real number in the range [min, max)
 /// \returns A random real number in the range [min, max)
 double getRandomDoubleInRange(double min, double max);
@@ -31,7 +31,8 @@ namespace rt::vec3 {
 
 /// Determine if this vector is very close to zero in all its dimensions
 /// \returns True if the vector is very close to zero in all dimensions, false otherwise
-bool Vec3::nearZero() const noexcept
+template <typename T>
+bool BasicVec3<T>::nearZero() const noexcept
 {
   static constexpr auto s = 1e-8;
   return ((std::fabs(e[0]) < s) and (std::fabs(e[1]) < s) and std::fabs(e[2]) < s);
@@ -41,36 +42,42 @@ bool Vec3::nearZero() const noexcept
 /// \param[in] incidentRay The ray of incidence
 /// \param[in] normal The normal
 /// \param[in] etaIOverEtaT The ratio of the refractive indices of the material and its surrounding medium
-/// \returns A Vec3 instance representing the direction of the refracted ray
-Vec3 getRefractedRay(Vec3 const& incidentRay, Vec3 const& normal, double etaIOverEtaT) noexcept
+/// \returns A vector representing the direction of the refracted ray
+template <typename T>
+BasicVec3<T> getRefractedRay(BasicVec3<T> const& incidentRay, BasicVec3<T> const& normal,
+                             std::type_identity_t<T> etaIOverEtaT) noexcept
 {
-  auto const cosTheta = std::fmin(getDotProduct(-incidentRay, normal), 1.0);
+  auto const cosTheta = std::fmin(getDotProduct(-incidentRay, normal), T {1});
   auto const rOutPerp = etaIOverEtaT * (incidentRay + cosTheta * normal);
-  auto const rOutParallel = -std::sqrt(std::fabs(1.0 - rOutPerp.lengthSquared())) * normal;
+  auto const rOutParallel = -std::sqrt(std::fabs(1 - rOutPerp.lengthSquared())) * normal;
 
   return rOutPerp + rOutParallel;
 }
 
-/// Get a Vec3 with all coordinates randomly generated and in the range [0, 1)
-/// \returns A Vec3 with all coordinates randomly generated and in the range [0, 1)
-Vec3 Vec3::createRandomVec()
+/// Get a vector with all coordinates randomly generated and in the range [0, 1)
+/// \returns A vector with all coordinates randomly generated and in the range [0, 1)
+template <typename T>
+BasicVec3<T> BasicVec3<T>::createRandomVec()
 {
-  return Vec3(getRandomDouble(), getRandomDouble(), getRandomDouble());
+  return BasicVec3(getRandomDouble(), getRandomDouble(), getRandomDouble());
 }
 
-/// Get a Vec3 with all coordinates randomly generated and in the range [min, max)
-/// \returns A Vec3 with all coordinates randomly generated and in the range [min, max)
-Vec3 Vec3::createRandomVecInRange(double min, double max)
+/// Get a vector with all coordinates randomly generated and in the range [min, max)
+/// \returns A vector with all coordinates randomly generated and in the range [min, max)
+template <typename T>
+BasicVec3<T> BasicVec3<T>::createRandomVecInRange(T min, T max)
 {
-  return Vec3(getRandomDoubleInRange(min, max), getRandomDoubleInRange(min, max), getRandomDoubleInRange(min, max));
+  return BasicVec3(getRandomDoubleInRange(min, max), getRandomDoubleInRange(min, max),
+                   getRandomDoubleInRange(min, max));
 }
 
-/// Get a point (Vec3) that lies in a sphere of unit radius
-/// \returns A point (Vec3) that lies in a sphere of unit radius
-Vec3 getRandomVecInUnitSphere()
+/// Get a point that lies in a sphere of unit radius
+/// \returns A point that lies in a sphere of unit radius
+template <typename T>
+BasicVec3<T> getRandomVecInUnitSphere()
 {
   while (true) {
-    auto const point = Vec3::createRandomVecInRange(-1, 1);
+    auto const point = BasicVec3<T>::createRandomVecInRange(-1, 1);
 
     if (point.lengthSquared() >= 1) {
       continue;
@@ -83,17 +90,19 @@ Vec3 getRandomVecInUnitSphere()
 
 /// Get a random unit vector in a unit sphere
 /// \returns A random unit vector in a unit sphere
-Vec3 getRandomUnitVector()
+template <typename T>
+BasicVec3<T> getRandomUnitVector()
 {
-  return getUnitVector(getRandomVecInUnitSphere());
+  return getUnitVector(getRandomVecInUnitSphere<T>());
 }
 
 /// Generate a random vector in a unit disk
 /// \returns A random vector in a unit disk
-Vec3 getRandomVecInUnitDisk()
+template <typename T>
+BasicVec3<T> getRandomVecInUnitDisk()
 {
   while (true) {
-    auto p = Vec3(getRandomDoubleInRange(-1, 1), getRandomDoubleInRange(-1, 1), 0);
+    auto p = BasicVec3<T>(getRandomDoubleInRange(-1, 1), getRandomDoubleInRange(-1, 1), 0);
 
     if (p.lengthSquared() >= 1) {
       continue;
@@ -103,4 +112,16 @@ Vec3 getRandomVecInUnitDisk()
   }
 }
 
+template class BasicVec3<float>;
+template class BasicVec3<double>;
+
+template BasicVec3<float> getRefractedRay(BasicVec3<float> const&, BasicVec3<float> const&, float) noexcept;
+template BasicVec3<double> getRefractedRay(BasicVec3<double> const&, BasicVec3<double> const&, double) noexcept;
+template BasicVec3<float> getRandomVecInUnitSphere();
+template BasicVec3<double> getRandomVecInUnitSphere();
+template BasicVec3<float> getRandomUnitVector();
+template BasicVec3<double> getRandomUnitVector();
+template BasicVec3<float> getRandomVecInUnitDisk();
+template BasicVec3<double> getRandomVecInUnitDisk();
+
 }   // namespace rt::vec3
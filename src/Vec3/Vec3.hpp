@@ -29,55 +29,74 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <type_traits>
+
+namespace rt {
+
+/// The floating-point type of the coordinates, distances and colours the renderer works with. Building with
+/// RT_USE_FLOAT trades precision for speed by switching it from double to float
+#ifdef RT_USE_FLOAT
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+
+}   // namespace rt
 
 namespace rt::vec3 {
-class Vec3
+/// A vector in 3d space whose components are of the scalar type T
+template <typename T>
+class BasicVec3
 {
 public:
   /// @brief Default constructor
-  explicit constexpr Vec3() noexcept = default;
+  explicit constexpr BasicVec3() noexcept = default;
 
   /// @brief Constructor
   /// @param[in] e0 The x-coordinate of the 3d vector
   /// @param[in] e1 The y-coordinate of the 3d vector
   /// @param[in] e2 The z-coordinate of the 3d vector
-  explicit constexpr Vec3(double e0, double e1, double e2) noexcept : e {e0, e1, e2}
+  explicit constexpr BasicVec3(T e0, T e1, T e2) noexcept : e {e0, e1, e2}
   {
   }
 
   /// @brief Get the x-coordinate of the vector
   /// @return The x-coordinate of the vector
-  constexpr double x() const noexcept
+  constexpr T x() const noexcept
   {
     return e[0];
   }
 
   /// @brief Get the y-coordinate of the vector
   /// @return The y-coordinate of the vector
-  constexpr double y() const noexcept
+  constexpr T y() const noexcept
   {
     return e[1];
   }
 
   /// @brief Get the z-coordinate of the vector
   /// @return The z-coordinate of the vector
-  constexpr double z() const noexcept
+  constexpr T z() const noexcept
   {
     return e[2];
   }
 
   /// @brief Get the negation of this vector
   /// @return The negation of this vector
-  constexpr Vec3 operator-() const noexcept
+  constexpr BasicVec3 operator-() const noexcept
   {
-    return Vec3(-e[0], -e[1], -e[2]);
+#ifdef RT_SIMD_VEC3
+    return BasicVec3(-e);
+#else
+    return BasicVec3(-e[0], -e[1], -e[2]);
+#endif
   }
 
   /// @brief Access the element at the given index
   /// @param[in] i The index of the element in the vector
   /// @pre The index must be within the valid range
   /// @return The element at the given index
-  constexpr double operator[](int i) const noexcept
+  constexpr T operator[](int i) const noexcept
   {
     assert(i >= 0 and i <= 2);
     return e[i];
@@ -87,7 +106,7 @@ public:
   /// @param[in] i The index of the element in the vector
   /// @pre The index must be within the valid range
   /// @return The element at the given index
-  double& operator[](int i) noexcept
+  T& operator[](int i) noexcept
   {
     assert(i >= 0 and i <= 2);
     return e[i];
@@ -96,11 +115,15 @@ public:
   /// @brief Perform component-wise sum of the given vector and this vector
   /// @param[in] v The vector to be added to this one
   /// @return This vector after the addition has been performed
-  constexpr Vec3& operator+=(Vec3 const& v) noexcept
+  constexpr BasicVec3& operator+=(BasicVec3 const& v) noexcept
   {
+#ifdef RT_SIMD_VEC3
+    e += v.e;
+#else
     e[0] += v.e[0];
     e[1] += v.e[1];
     e[2] += v.e[2];
+#endif
 
     return *this;
   }
@@ -108,11 +131,15 @@ public:
   /// @brief Multiply this vector by the given constant
   /// @param[in] t The scalar constant to be multiplied with the vector
   /// @return This vector after it has been scaled by the given constant
-  constexpr Vec3& operator*=(double t) noexcept
+  constexpr BasicVec3& operator*=(T t) noexcept
   {
+#ifdef RT_SIMD_VEC3
+    e *= t;
+#else
     for (auto& elem : e) {
       elem *= t;
     }
+#endif
 
     return *this;
   }
@@ -120,45 +147,70 @@ public:
   /// @brief Divide this vector by the given constant
   /// @param[in] t The scalar constant to divide the vector with
   /// @return This vector after it has been down-scaled by the given constant
-  constexpr Vec3& operator/=(double t) noexcept
+  constexpr BasicVec3& operator/=(T t) noexcept
   {
     return *this *= (1 / t);
   }
 
   /// @brief Get the length of this vector
   /// @return The length of the vector
-  constexpr double length() const noexcept
+  constexpr T length() const noexcept
   {
     return std::sqrt(lengthSquared());
   }
 
   /// @brief Get the sum of the squares of the components of this vector
   /// @return The sum of the squares of the components of this vector
-  constexpr double lengthSquared() const noexcept
+  constexpr T lengthSquared() const noexcept
   {
+#ifdef RT_SIMD_VEC3
+    auto const squares = e * e;
+    return (squares[0] + squares[1]) + squares[2];
+#else
     return (e[0] * e[0]) + (e[1] * e[1]) + (e[2] * e[2]);
+#endif
   }
 
   /// Determine if this vector is very close to zero in all its dimensions
   /// \returns True if the vector is very close to zero in all dimensions, false otherwise
   bool nearZero() const noexcept;
 
-  /// Get a Vec3 with all coordinates randomly generated and in the range [0, 1)
-  /// \returns A Vec3 with all coordinates randomly generated and in the range [0, 1)
-  static Vec3 createRandomVec();
+  /// Get a vector with all coordinates randomly generated and in the range [0, 1)
+  /// \returns A vector with all coordinates randomly generated and in the range [0, 1)
+  static BasicVec3 createRandomVec();
 
-  /// Get a Vec3 with all coordinates randomly generated and in the range [min, max)
-  /// \returns A Vec3 with all coordinates randomly generated and in the range [min, max)
-  static Vec3 createRandomVecInRange(double min, double max);
+  /// Get a vector with all coordinates randomly generated and in the range [min, max)
+  /// \returns A vector with all coordinates randomly generated and in the range [min, max)
+  static BasicVec3 createRandomVecInRange(T min, T max);
 
 private:
-  std::array<double, 3> e {0, 0, 0};
+#ifdef RT_SIMD_VEC3
+  /// The components as a vector of the compiler's vector extensions, whose operators work on every lane at once
+  /// \details The alignment is explicit because GCC otherwise caps it at the widest register of the target, 16 bytes
+  /// without AVX, while the AVX variants of the dispatched kernels load and store the vectors as aligned 32 bytes
+  typedef T Lanes __attribute__((vector_size(4 * sizeof(T)), aligned(4 * sizeof(T))));
+
+  /// The components, padded with a zero fourth lane. Vectors are aligned to their size, so that they load into one
+  /// 16-byte (float) or 32-byte (double) register
+  Lanes e {0, 0, 0, 0};
+
+  /// @brief Create a vector from its lanes
+  /// @param[in] lanes The components of the vector. The fourth lane must be zero
+  explicit constexpr BasicVec3(Lanes lanes) noexcept : e(lanes)
+  {
+  }
+
+  template <typename U>
+  friend constexpr BasicVec3<U> getCrossProduct(BasicVec3<U> const& u, BasicVec3<U> const& v) noexcept;
+#else
+  std::array<T, 3> e {0, 0, 0};
+#endif
 
   /// @brief Write the given vector to an output stream
   /// @param[inout] out The output stream to which the vector is to be written
   /// @param[in] v The vector to be written to the output stream
   /// @return The output stream containing a string representation of the vector
-  friend std::ostream& operator<<(std::ostream& out, Vec3 const& v) noexcept
+  friend std::ostream& operator<<(std::ostream& out, BasicVec3 const& v) noexcept
   {
     return out << v.e[0] << ' ' << v.e[1] << ' ' << v.e[2];
   }
@@ -167,27 +219,39 @@ private:
   /// @param[in] u The first vector in the sum
   /// @param[in] v The second vector in the sum
   /// @return A new vector equal to the sum of the 2 vectors
-  friend constexpr Vec3 operator+(Vec3 const& u, Vec3 const& v) noexcept
+  friend constexpr BasicVec3 operator+(BasicVec3 const& u, BasicVec3 const& v) noexcept
   {
-    return Vec3(u.e[0] + v.e[0], u.e[1] + v.e[1], u.e[2] + v.e[2]);
+#ifdef RT_SIMD_VEC3
+    return BasicVec3(u.e + v.e);
+#else
+    return BasicVec3(u.e[0] + v.e[0], u.e[1] + v.e[1], u.e[2] + v.e[2]);
+#endif
   }
 
   /// @brief Perform component-wise subtraction of 2 vectors
   /// @param[in] u The first vector in the difference
   /// @param[in] v The second vector in the difference
   /// @return A new vector equal to the difference of the 2 vectors
-  friend constexpr Vec3 operator-(Vec3 const& u, Vec3 const& v) noexcept
+  friend constexpr BasicVec3 operator-(BasicVec3 const& u, BasicVec3 const& v) noexcept
   {
-    return Vec3(u.e[0] - v.e[0], u.e[1] - v.e[1], u.e[2] - v.e[2]);
+#ifdef RT_SIMD_VEC3
+    return BasicVec3(u.e - v.e);
+#else
+    return BasicVec3(u.e[0] - v.e[0], u.e[1] - v.e[1], u.e[2] - v.e[2]);
+#endif
   }
 
   /// @brief Perform component-wise multiplication of 2 vectors
   /// @param[in] u The first vector in the product
   /// @param[in] v The second vector in the product
   /// @return A new vector equal to the product of the 2 vectors
-  friend constexpr Vec3 operator*(Vec3 const& u, Vec3 const& v) noexcept
+  friend constexpr BasicVec3 operator*(BasicVec3 const& u, BasicVec3 const& v) noexcept
   {
-    return Vec3(u.e[0] * v.e[0], u.e[1] * v.e[1], u.e[2] * v.e[2]);
+#ifdef RT_SIMD_VEC3
+    return BasicVec3(u.e * v.e);
+#else
+    return BasicVec3(u.e[0] * v.e[0], u.e[1] * v.e[1], u.e[2] * v.e[2]);
+#endif
   }
 
   /// @brief Get a new vector equal to the given vector scaled by the given
@@ -196,9 +260,13 @@ private:
   /// @param[in] v The vector to be scaled
   /// @return A new vector equal to the given vector scaled by the given scaling
   /// factor
-  friend constexpr Vec3 operator*(double t, Vec3 const& v) noexcept
+  friend constexpr BasicVec3 operator*(T t, BasicVec3 const& v) noexcept
   {
-    return Vec3(t * v.e[0], t * v.e[1], t * v.e[2]);
+#ifdef RT_SIMD_VEC3
+    return BasicVec3(t * v.e);
+#else
+    return BasicVec3(t * v.e[0], t * v.e[1], t * v.e[2]);
+#endif
   }
 
   /// @brief Get a new vector equal to the given vector scaled by the given
@@ -207,7 +275,7 @@ private:
   /// @param[in] v The vector to be scaled
   /// @return A new vector equal to the given vector scaled by the given scaling
   /// factor
-  friend constexpr Vec3 operator*(Vec3 const& v, double t) noexcept
+  friend constexpr BasicVec3 operator*(BasicVec3 const& v, T t) noexcept
   {
     return t * v;
   }
@@ -218,43 +286,62 @@ private:
   /// @param[in] v The vector to be scaled
   /// @return A new vector equal to the given vector scaled by the given scaling
   /// factor
-  friend constexpr Vec3 operator/(Vec3 const& v, double t) noexcept
+  friend constexpr BasicVec3 operator/(BasicVec3 const& v, T t) noexcept
   {
     return (1 / t) * v;
   }
 
-  /// @brief Compare two Vec3 objects for equality
-  /// @param[in] a The first Vec3 object
-  /// @param[in] b The second Vec3 object
+  /// @brief Compare two vectors for equality
+  /// @param[in] a The first vector
+  /// @param[in] b The second vector
   /// @returns True if they are equal and false otherwise
-  friend constexpr bool operator==(Vec3 const& a, Vec3 const& b) noexcept
+  friend constexpr bool operator==(BasicVec3 const& a, BasicVec3 const& b) noexcept
   {
     return a.x() == b.x() and a.y() == b.y() and a.z() == b.z();
   }
 };
 
+/// The vector the renderer works with
+using Vec3 = BasicVec3<Scalar>;
+
 /// @brief Get the dot product of 2 given vectors
 /// @param[in] u The first vector in the operation
 /// @param[in] v The second vector in the operation
 /// @return The dot product of the 2 vectors
-constexpr double getDotProduct(Vec3 const& u, Vec3 const& v) noexcept
+template <typename T>
+constexpr T getDotProduct(BasicVec3<T> const& u, BasicVec3<T> const& v) noexcept
 {
+#ifdef RT_SIMD_VEC3
+  auto const products = u * v;
+  return (products.x() + products.y() + products.z());
+#else
   return (u.x() * v.x() + u.y() * v.y() + u.z() * v.z());
+#endif
 }
 
 /// @brief Get the cross product of 2 given vectors
 /// @param[in] u The first vector in the operation
 /// @param[in] v The second vector in the operation
 /// @return The cross product of the 2 vectors
-constexpr Vec3 getCrossProduct(Vec3 const& u, Vec3 const& v) noexcept
+template <typename T>
+constexpr BasicVec3<T> getCrossProduct(BasicVec3<T> const& u, BasicVec3<T> const& v) noexcept
 {
-  return Vec3(u.y() * v.z() - u.z() * v.y(), u.z() * v.x() - u.x() * v.z(), u.x() * v.y() - u.y() * v.x());
+#ifdef RT_SIMD_VEC3
+  // (y, z, x) and (z, x, y) rotations of the lanes, which leave the zero fourth lane in place
+  auto const a = u.e;
+  auto const b = v.e;
+  return BasicVec3<T>(__builtin_shufflevector(a, a, 1, 2, 0, 3) * __builtin_shufflevector(b, b, 2, 0, 1, 3) -
+                      __builtin_shufflevector(a, a, 2, 0, 1, 3) * __builtin_shufflevector(b, b, 1, 2, 0, 3));
+#else
+  return BasicVec3<T>(u.y() * v.z() - u.z() * v.y(), u.z() * v.x() - u.x() * v.z(), u.x() * v.y() - u.y() * v.x());
+#endif
 }
 
 /// @brief Get the unit vector of the given vector
 /// @param[in] v The vector whose unit vector is to be computed
 /// @return The unit vector of the given vector
-constexpr Vec3 getUnitVector(Vec3 const& v) noexcept
+template <typename T>
+constexpr BasicVec3<T> getUnitVector(BasicVec3<T> const& v) noexcept
 {
   return v / v.length();
 }
@@ -262,8 +349,9 @@ constexpr Vec3 getUnitVector(Vec3 const& v) noexcept
 /// Get the direction of a reflected ray
 /// \param[in] incidenceRay The ray of incidence
 /// \param[in] normal The normal
-/// \returns A Vec3 instance representing the direction of the reflected ray
-constexpr Vec3 getReflectedRay(Vec3 const& incidenceRay, Vec3 const& normal) noexcept
+/// \returns A vector representing the direction of the reflected ray
+template <typename T>
+constexpr BasicVec3<T> getReflectedRay(BasicVec3<T> const& incidenceRay, BasicVec3<T> const& normal) noexcept
 {
   return incidenceRay - 2 * getDotProduct(incidenceRay, normal) * normal;
 }
@@ -272,20 +360,25 @@ constexpr Vec3 getReflectedRay(Vec3 const& incidenceRay, Vec3 const& normal) noe
 /// \param[in] incidentRay The ray of incidence
 /// \param[in] normal The normal
 /// \param[in] etaIOverEtaT The ratio of the refractive indices of the material and its surrounding medium
-/// \returns A Vec3 instance representing the direction of the refracted ray
-Vec3 getRefractedRay(Vec3 const& incidentRay, Vec3 const& normal, double etaIOverEtaT) noexcept;
+/// \returns A vector representing the direction of the refracted ray
+template <typename T>
+BasicVec3<T> getRefractedRay(BasicVec3<T> const& incidentRay, BasicVec3<T> const& normal,
+                             std::type_identity_t<T> etaIOverEtaT) noexcept;
 
-/// Get a point (Vec3) that lies in a sphere of unit radius
-/// \returns A point (Vec3) that lies in a sphere of unit radius
-Vec3 getRandomVecInUnitSphere();
+/// Get a point that lies in a sphere of unit radius
+/// \returns A point that lies in a sphere of unit radius
+template <typename T = Scalar>
+BasicVec3<T> getRandomVecInUnitSphere();
 
 /// Get a random unit vector in a unit sphere
 /// \returns A random unit vector in a unit sphere
-Vec3 getRandomUnitVector();
+template <typename T = Scalar>
+BasicVec3<T> getRandomUnitVector();
 
 /// Generate a random vector in a unit disk
 /// \returns A random vector in a unit disk
-Vec3 getRandomVecInUnitDisk();
+template <typename T = Scalar>
+BasicVec3<T> getRandomVecInUnitDisk();
 
 }   // namespace rt::vec3
 
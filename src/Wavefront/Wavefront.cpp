@@ -0,0 +1,349 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Wavefront.hpp"
+
+#include "Dielectric.hpp"
+#include "Lambertian.hpp"
+#include "Material.hpp"
+#include "Metal.hpp"
+#include "Ray.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace rt::wavefront {
+
+using colour::Colour;
+using hittable::HitRecord;
+using ray::Ray;
+
+namespace {
+
+/// The number of kinds of material, each of which is shaded in its own queue
+constexpr std::size_t kindCount = 3;
+
+/// The states of the paths of a batch, with an array per component so that each stage only streams through the
+/// components it uses
+struct Paths
+{
+  std::array<std::vector<Scalar>, 3> origins;
+  std::array<std::vector<Scalar>, 3> directions;
+  std::vector<Scalar> times;
+
+  /// The product of the attenuations of the bounces so far
+  std::array<std::vector<Scalar>, 3> throughputs;
+
+  /// The index in the framebuffer of the pixel the path is a sample of
+  std::vector<std::size_t> pixels;
+
+  /// Create the states of a batch of paths
+  /// \param[in] size The number of paths
+  explicit Paths(std::size_t size)
+    : times(size), pixels(size)
+  {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      origins[axis].resize(size);
+      directions[axis].resize(size);
+      throughputs[axis].resize(size);
+    }
+  }
+
+  /// Get the latest ray of a path
+  /// \param[in] path The index of the path
+  /// \returns The ray
+  Ray getRay(std::size_t path) const noexcept
+  {
+    return Ray(ray::Point3(origins[0][path], origins[1][path], origins[2][path]),
+               vec3::Vec3(directions[0][path], directions[1][path], directions[2][path]), times[path]);
+  }
+
+  /// Set the latest ray of a path
+  /// \param[in] path The index of the path
+  /// \param[in] ray The ray
+  void setRay(std::size_t path, Ray const& ray) noexcept
+  {
+    auto const& origin = ray.getOrigin();
+    auto const& direction = ray.getDirection();
+
+    origins[0][path] = origin.x();
+    origins[1][path] = origin.y();
+    origins[2][path] = origin.z();
+    directions[0][path] = direction.x();
+    directions[1][path] = direction.y();
+    directions[2][path] = direction.z();
+    times[path] = ray.getTime();
+  }
+
+  /// Get the product of the attenuations of the bounces of a path so far
+  /// \param[in] path The index of the path
+  /// \returns The throughput
+  Colour getThroughput(std::size_t path) const noexcept
+  {
+    return Colour(throughputs[0][path], throughputs[1][path], throughputs[2][path]);
+  }
+
+  /// Set the product of the attenuations of the bounces of a path so far
+  /// \param[in] path The index of the path
+  /// \param[in] throughput The throughput
+  void setThroughput(std::size_t path, Colour const& throughput) noexcept
+  {
+    throughputs[0][path] = throughput.r();
+    throughputs[1][path] = throughput.g();
+    throughputs[2][path] = throughput.b();
+  }
+};
+
+/// Spread the low 10 bits of a value out to every third bit, so that three spread values interleave into a Morton code
+/// \param[in] value The value
+/// \returns The spread bits
+constexpr std::uint32_t spreadBits(std::uint32_t value) noexcept
+{
+  value &= 0x3ffU;
+  value = (value | (value << 16U)) & 0x030000ffU;
+  value = (value | (value << 8U)) & 0x0300f00fU;
+  value = (value | (value << 4U)) & 0x030c30c3U;
+  value = (value | (value << 2U)) & 0x09249249U;
+
+  return value;
+}
+
+/// Sort the paths that are still going by the Morton keys of their rays
+/// \param[inout] active The indices of the paths, which are put in the order of their keys
+/// \param[in] paths The states of the paths
+/// \param[inout] keys Scratch space for the keys
+/// \details A key interleaves the bits of the cell of a 1024 x 1024 x 1024 grid over the origins of the rays that the
+/// ray starts in, and ends with the octant its direction points into. Rays that start close together and go the same
+/// way are traced one after another, and find the nodes and spheres they visit in the caches
+void sortByMortonKey(std::vector<std::size_t>& active, Paths const& paths,
+                     std::vector<std::pair<std::uint64_t, std::size_t>>& keys)
+{
+  constexpr auto far = std::numeric_limits<Scalar>::infinity();
+  auto lower = std::array<Scalar, 3> {far, far, far};
+  auto upper = std::array<Scalar, 3> {-far, -far, -far};
+
+  for (auto const path : active) {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      lower[axis] = std::min(lower[axis], paths.origins[axis][path]);
+      upper[axis] = std::max(upper[axis], paths.origins[axis][path]);
+    }
+  }
+
+  auto scales = std::array<Scalar, 3> {};
+
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    auto const extent = upper[axis] - lower[axis];
+    scales[axis] = extent > 0 ? Scalar {1023} / extent : Scalar {0};
+  }
+
+  keys.clear();
+
+  for (auto const path : active) {
+    std::uint64_t key = 0;
+    std::uint64_t octant = 0;
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      auto const cell = static_cast<std::uint32_t>((paths.origins[axis][path] - lower[axis]) * scales[axis]);
+      key |= static_cast<std::uint64_t>(spreadBits(cell)) << axis;
+      octant |= static_cast<std::uint64_t>(paths.directions[axis][path] < 0) << axis;
+    }
+
+    keys.emplace_back((key << 3U) | octant, path);
+    RT_COUNT(sortedRays);
+  }
+
+  std::ranges::sort(keys, {}, &std::pair<std::uint64_t, std::size_t>::first);
+  std::ranges::transform(keys, active.begin(), &std::pair<std::uint64_t, std::size_t>::second);
+}
+
+/// Scatter the rays of the paths whose latest hit is on a material of one kind
+/// \param[in] queue The slots in the stream of the paths
+/// \param[in] active The indices of the paths, by slot
+/// \param[in] records The nearest hits of the rays of the paths, by slot
+/// \param[inout] paths The states of the paths. The rays and throughputs of the paths that scatter are updated
+/// \param[inout] survivors Receives the indices of the paths that scatter
+/// \tparam M The class of the material. It is final, so the calls to scatter are direct and not virtual
+template <typename M>
+void scatterQueue(std::span<std::size_t const> queue, std::span<std::size_t const> active,
+                  std::span<HitRecord const> records, Paths& paths, std::vector<std::size_t>& survivors)
+{
+  for (auto const slot : queue) {
+    auto const path = active[slot];
+    auto const& record = records[slot];
+    auto const& material = static_cast<M const&>(*record.materialPtr);
+    auto scattered = Ray();
+    auto attenuation = Colour();
+
+    if (material.scatter(paths.getRay(path), record, attenuation, scattered)) {
+      RT_COUNT(secondaryRays);
+      paths.setRay(path, scattered);
+      paths.setThroughput(path, paths.getThroughput(path) * attenuation);
+      survivors.push_back(path);
+    }
+    else {
+      RT_COUNT(absorptions);
+    }
+  }
+}
+
+/// Trace the paths of a batch to their ends
+/// \param[in] world The objects in the scene
+/// \param[inout] paths The states of the paths, starting with their camera rays
+/// \param[in] count The number of paths of the batch
+/// \param[in] settings The depth and sorting parameters
+/// \param[inout] framebuffer Receives the light every path carries back, added to its pixel
+void traceBatch(hittable::Hittable const& world, Paths& paths, std::size_t count, render::Settings const& settings,
+                std::span<Colour> framebuffer)
+{
+  std::vector<std::size_t> active(count);
+  std::iota(active.begin(), active.end(), std::size_t {0});
+
+  std::array<std::vector<std::size_t>, kindCount> queues;
+
+  for (auto& queue : queues) {
+    queue.reserve(count);
+  }
+
+  std::vector<std::size_t> survivors;
+  survivors.reserve(count);
+
+  std::vector<Ray> rays;
+  std::vector<Scalar> bounds;
+  std::vector<HitRecord> records;
+  std::vector<std::pair<std::uint64_t, std::size_t>> keys;
+
+  for (auto depth = settings.maxDepth; not active.empty(); --depth) {
+    if (depth <= 0) {
+      for ([[maybe_unused]] auto const path : active) {
+        RT_COUNT(depthLimits);
+      }
+
+      break;
+    }
+
+    // The camera rays of a batch are in pixel order, which keeps them together already
+    if (settings.sortRays and depth < settings.maxDepth) {
+      sortByMortonKey(active, paths, keys);
+    }
+
+    for (auto& queue : queues) {
+      queue.clear();
+    }
+
+    // Intersect every path that is still going as one stream. The sky ends the paths that miss, and the rest are
+    // sorted by the kind of material they hit. The queues hold the slots of the paths in the stream
+    rays.resize(active.size());
+    bounds.assign(active.size(), rt::infinity);
+    records.resize(active.size());
+
+    for (std::size_t slot = 0; slot < active.size(); ++slot) {
+      rays[slot] = paths.getRay(active[slot]);
+    }
+
+    world.hitStream(rays, 0.001, bounds, records);
+
+    for (std::size_t slot = 0; slot < active.size(); ++slot) {
+      auto const& record = records[slot];
+
+      if (record.t != rt::infinity) {
+        queues[static_cast<std::size_t>(record.materialPtr->getKind())].push_back(slot);
+      }
+      else {
+        auto const path = active[slot];
+        RT_COUNT(skyMisses);
+        framebuffer[paths.pixels[path]] += paths.getThroughput(path) * render::getSkyColour(rays[slot]);
+      }
+    }
+
+    // Scatter one kind of material at a time. The paths that go on are the next bounce
+    survivors.clear();
+    scatterQueue<material::Lambertian>(queues[static_cast<std::size_t>(material::Kind::lambertian)], active, records,
+                                       paths, survivors);
+    scatterQueue<material::Metal>(queues[static_cast<std::size_t>(material::Kind::metal)], active, records, paths,
+                                  survivors);
+    scatterQueue<material::Dielectric>(queues[static_cast<std::size_t>(material::Kind::dielectric)], active, records,
+                                       paths, survivors);
+    active.swap(survivors);
+  }
+}
+
+}   // namespace
+
+/// Trace the pixels of a tile with the wavefront integrator
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution, sampling and batching parameters
+/// \param[in] tile The tile
+/// \param[inout] framebuffer Receives the sum of the samples of every pixel of the tile
+/// \details The camera paths of the tile are traced in batches. Each bounce intersects every path of the batch that is
+/// still going, sorts the ones that hit something into a queue per kind of material, and scatters each queue in turn,
+/// so that one material's code runs at a time. The secondary rays can be sorted by their Morton keys before they are
+/// intersected. The random numbers are drawn in another order than by the path integrator, so the image is a different
+/// sample of the same picture
+void traceTile(hittable::Hittable const& world, camera::Camera const& camera, render::Settings const& settings,
+               render::Tile const& tile, std::span<Colour> framebuffer)
+{
+  auto const imgWidth = settings.imgWidth;
+  auto const imgHeight = settings.imgHeight;
+  auto const tileWidth = tile.x1 - tile.x0;
+  auto const pathCount = tileWidth * (tile.y1 - tile.y0) * settings.samplesPerPixel;
+
+  for (std::size_t j = tile.y0; j < tile.y1; ++j) {
+    for (std::size_t i = tile.x0; i < tile.x1; ++i) {
+      framebuffer[j * imgWidth + i] = Colour(0, 0, 0);
+    }
+  }
+
+  auto const batchSize = std::max(settings.batchSize, std::size_t {1});
+  auto paths = Paths(std::min(pathCount, batchSize));
+
+  // The camera rays are made in the order the path integrator makes them, every sample of a pixel in turn
+  for (std::size_t first = 0; first < pathCount; first += batchSize) {
+    auto const count = std::min(pathCount - first, batchSize);
+
+    for (std::size_t path = 0; path < count; ++path) {
+      auto const pixel = (first + path) / settings.samplesPerPixel;
+      auto const i = tile.x0 + (pixel % tileWidth);
+      auto const j = tile.y0 + (pixel / tileWidth);
+
+      auto u = (static_cast<double>(i) + getRandomDouble()) / static_cast<double>(imgWidth - 1);
+      auto v = (static_cast<double>(j) + getRandomDouble()) / static_cast<double>(imgHeight - 1);
+      paths.setRay(path, camera.getRay(u, v));
+      paths.setThroughput(path, Colour(1, 1, 1));
+      paths.pixels[path] = j * imgWidth + i;
+      RT_COUNT(cameraRays);
+    }
+
+    traceBatch(world, paths, count, settings, framebuffer);
+  }
+}
+
+}   // namespace rt::wavefront
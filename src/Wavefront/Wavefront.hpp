@@ -0,0 +1,52 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef WAVEFRONT_HPP
+#define WAVEFRONT_HPP
+
+#include "Camera.hpp"
+#include "Colour.hpp"
+#include "Hittable.hpp"
+#include "Render.hpp"
+#include <span>
+
+namespace rt::wavefront {
+
+/// Trace the pixels of a tile with the wavefront integrator
+/// \param[in] world The objects in the scene
+/// \param[in] camera The camera the scene is viewed through
+/// \param[in] settings The resolution, sampling and batching parameters
+/// \param[in] tile The tile
+/// \param[inout] framebuffer Receives the sum of the samples of every pixel of the tile
+/// \details The camera paths of the tile are traced in batches. Each bounce intersects every path of the batch that is
+/// still going, sorts the ones that hit something into a queue per kind of material, and scatters each queue in turn,
+/// so that one material's code runs at a time. The secondary rays can be sorted by their Morton keys before they are
+/// intersected. The random numbers are drawn in another order than by the path integrator, so the image is a different
+/// sample of the same picture
+void traceTile(hittable::Hittable const& world, camera::Camera const& camera, render::Settings const& settings,
+               render::Tile const& tile, std::span<colour::Colour> framebuffer);
+
+}   // namespace rt::wavefront
+
+#endif
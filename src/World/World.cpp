@@ -0,0 +1,229 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "World.hpp"
+
+#include "BvhCache.hpp"
+#include "Instance.hpp"
+#include "Mesh.hpp"
+#include "Trace.hpp"
+#include <exception>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace rt::world {
+
+namespace {
+
+/// Get the bounding volume hierarchy over the spheres of a scene from the cache, or build it and add it to the cache
+/// \param[in] spheres The spheres of the scene
+/// \param[in] cacheDirectory The directory of the cache. The hierarchy is only built when empty
+/// \returns The hierarchy
+bvh::Tree getBvh(std::span<scene::SphereData const> spheres, std::filesystem::path const& cacheDirectory)
+{
+  if (cacheDirectory.empty()) {
+    auto const span = trace::Span("buildBvh", "scene");
+    return bvh::build(spheres);
+  }
+
+  auto const cache = bvhcache::Cache(cacheDirectory);
+  auto const hash = [&spheres] {
+    auto const span = trace::Span("hashGeometry", "scene");
+    return bvhcache::hashGeometry(spheres);
+  }();
+
+  {
+    auto const span = trace::Span("loadBvhCache", "scene");
+
+    if (auto tree = cache.load(hash, spheres.size())) {
+      return *std::move(tree);
+    }
+  }
+
+  auto tree = [&spheres] {
+    auto const span = trace::Span("buildBvh", "scene");
+    return bvh::build(spheres);
+  }();
+
+  // A cache that cannot be written only costs the next run the time to build the hierarchy again
+  try {
+    auto const span = trace::Span("storeBvhCache", "scene");
+    cache.store(hash, spheres.size(), tree);
+  }
+  catch (std::exception const& error) {
+    std::clog << "Cannot cache the BVH: " << error.what() << '\n';
+  }
+
+  return tree;
+}
+
+scene::MaterialTable createMaterials(std::span<scene::MaterialData const> materials)
+{
+  auto const span = trace::Span("createMaterials", "scene");
+  return scene::MaterialTable(materials);
+}
+
+/// Load the scenes the instances of a scene copy and place the copies
+/// \param[in] instances The instances
+/// \param[in] firstIndex The object index of the first instance
+/// \param[out] hashes Receives the hash of the materials and spheres every instance copies, from bvhcache::hashScene
+/// \returns The hierarchy over the instances. Every scene file is loaded once, and its instances share its hierarchy
+/// \throws std::runtime_error if a scene file cannot be read, is not a valid scene or holds more than materials and
+/// spheres
+/// \throws std::out_of_range if a sphere refers to a material that does not exist
+instance::InstanceBvh* loadInstances(std::span<scene::InstanceReference const> instances, std::size_t firstIndex,
+                                     std::vector<std::uint64_t>& hashes)
+{
+  auto const span = trace::Span("loadInstances", "scene");
+  std::map<std::filesystem::path, std::pair<std::shared_ptr<instance::SphereGeometry const>, std::uint64_t>> loaded;
+  std::vector<instance::Instance> placed;
+  placed.reserve(instances.size());
+
+  for (auto const& reference : instances) {
+    auto [entry, isNew] = loaded.try_emplace(reference.path);
+
+    if (isNew) {
+      auto const scene = scene::loadScene(reference.path);
+
+      if (scene.spheres.empty() or not scene.shapes.empty() or not scene.meshes.empty()
+          or not scene.instances.empty()) {
+        throw std::runtime_error(reference.path.string() + ": an instanced scene must hold spheres and nothing else");
+      }
+
+      entry->second = {std::make_shared<instance::SphereGeometry const>(scene),
+                       bvhcache::hashScene(scene.materials, scene.spheres, {}, {}, {})};
+    }
+
+    auto const& [geometry, hash] = entry->second;
+    auto const objectToWorld =
+      instance::Transform::translate(vec3::Vec3(reference.offset[0], reference.offset[1], reference.offset[2]))
+      * instance::Transform::rotate(vec3::Vec3(reference.axis[0], reference.axis[1], reference.axis[2]),
+                                    reference.degrees)
+      * instance::Transform::scale(vec3::Vec3(reference.scale, reference.scale, reference.scale));
+    placed.emplace_back(geometry, geometry->getBounds(), objectToWorld);
+    hashes.push_back(hash);
+  }
+
+  return new instance::InstanceBvh(std::move(placed), firstIndex);
+}
+
+/// Load the meshes and instances of a scene into a list with the hierarchy over its spheres
+/// \param[in] scene The scene
+/// \param[in] spheres The hierarchy over the spheres of the scene. The list holds a copy of it
+/// \param[in] materials The material objects of the scene
+/// \param[in] firstIndex The object index of the first triangle of the first mesh. The triangles of every mesh
+/// follow those of the mesh before it, and the instances follow the triangles
+/// \param[out] meshHashes Receives the hash of the contents of every mesh, from bvhcache::hashMesh
+/// \param[out] instanceHashes Receives the hash of the materials and spheres every instance copies
+/// \returns The list
+/// \throws std::runtime_error if a mesh or instanced scene file cannot be read or is not valid
+/// \throws std::out_of_range if a mesh or sphere refers to a material or vertex that does not exist
+hittable::HittableList loadObjects(scene::Description const& scene, bvh::SphereBvh const& spheres,
+                                   std::span<material::Material* const> materials, std::size_t firstIndex,
+                                   std::vector<std::uint64_t>& meshHashes, std::vector<std::uint64_t>& instanceHashes)
+{
+  auto const span = trace::Span("loadObjects", "scene");
+  hittable::HittableList objects;
+  objects.add(new bvh::SphereBvh(spheres));
+
+  for (auto const& mesh : scene.meshes) {
+    if (mesh.material >= materials.size()) {
+      throw std::out_of_range("a mesh refers to material " + std::to_string(mesh.material) + ", which does not exist");
+    }
+
+    auto data = mesh::loadMesh(mesh.path);
+    auto const triangleCount = data.triangles.size();
+    meshHashes.push_back(bvhcache::hashMesh(data.positions, data.triangles));
+    objects.add(new mesh::TriangleMesh(std::move(data), materials[mesh.material], firstIndex));
+    firstIndex += triangleCount;
+  }
+
+  if (not scene.instances.empty()) {
+    objects.add(loadInstances(scene.instances, firstIndex, instanceHashes));
+  }
+
+  return objects;
+}
+
+}   // namespace
+
+/// Prepare a scene for rendering
+/// \param[in] description The scene
+/// \param[in] cacheDirectory The directory of the BVH cache. Nothing is cached when empty
+/// \throws std::runtime_error if a mesh or instanced scene file cannot be read or is not valid
+/// \throws std::out_of_range if a mesh or sphere refers to a material or vertex that does not exist
+World::World(scene::Description description, std::filesystem::path const& cacheDirectory)
+  : World(nullptr, std::move(description), cacheDirectory)
+{
+}
+
+World::World(std::unique_ptr<binaryscene::MappedScene> mapped, scene::Description description,
+             std::filesystem::path const& cacheDirectory)
+  : m_mapped(std::move(mapped))
+  , m_description(std::move(description))
+  , m_materials(m_mapped ? m_mapped->getMaterials() : std::span<scene::MaterialData const>(m_description.materials))
+  , m_spheres(m_mapped ? m_mapped->getSpheres() : std::span<scene::SphereData const>(m_description.spheres))
+  , m_shapes(m_mapped ? m_mapped->getShapes() : std::span<scene::ShapeData const>(m_description.shapes))
+  , m_tree(m_mapped and not m_mapped->getNodes().empty() ? bvh::Tree() : getBvh(m_spheres, cacheDirectory))
+  , m_nodes(m_mapped and m_tree.nodes.empty() ? m_mapped->getNodes() : std::span<bvh::Node const>(m_tree.nodes))
+  , m_indices(m_mapped and m_tree.nodes.empty() ? m_mapped->getIndices()
+                                                : std::span<std::uint32_t const>(m_tree.indices))
+  , m_materialTable(createMaterials(m_materials))
+  , m_bvh(m_spheres, m_nodes, m_indices, m_materialTable.getMaterials())
+  , m_objects(m_description.meshes.empty() and m_description.instances.empty()
+                ? hittable::HittableList()
+                : loadObjects(m_description, m_bvh, m_materialTable.getMaterials(), m_spheres.size() + m_shapes.size(),
+                              m_meshHashes, m_instanceHashes))
+  , m_shapeList(m_shapes, m_materialTable.getMaterials(), getBounded(), m_spheres.size())
+{
+}
+
+/// Read a scene file in the text or binary format and prepare it for rendering
+/// \param[in] path The path of the scene file
+/// \param[in] cacheDirectory The directory of the BVH cache. Nothing is cached when empty
+/// \returns The world
+/// \throws std::runtime_error if the file cannot be read or is not a valid scene
+std::unique_ptr<World> World::load(std::filesystem::path const& path, std::filesystem::path const& cacheDirectory)
+{
+  if (binaryscene::isBinaryScene(path)) {
+    auto mapped = [&path] {
+      auto const span = trace::Span("mapScene", "scene");
+      return std::make_unique<binaryscene::MappedScene>(path);
+    }();
+    auto description = mapped->getSettings();
+
+    return std::unique_ptr<World>(new World(std::move(mapped), std::move(description), cacheDirectory));
+  }
+
+  auto description = [&path] {
+    auto const span = trace::Span("loadScene", "scene");
+    return scene::loadScene(path);
+  }();
+
+  return std::make_unique<World>(std::move(description), cacheDirectory);
+}
+
+}   // namespace rt::world
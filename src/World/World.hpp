@@ -0,0 +1,165 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include "BinaryScene.hpp"
+#include "Bvh.hpp"
+#include "Hittable.hpp"
+#include "HittableList.hpp"
+#include "Plane.hpp"
+#include "Scene.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace rt::world {
+
+/// A scene that is ready to be rendered: its description, its material objects, the hierarchy over its spheres and
+/// the shapes that are kept out of it
+/// \details A binary scene is used where it lies in the mapped file, and its hierarchy is used as it is. The
+/// hierarchy of any other scene is taken from the BVH cache, or built and added to it. The meshes of a scene are
+/// loaded from their files, each with a hierarchy of its own, and the scenes its instances copy are loaded once each
+/// and placed under a hierarchy over the instances. The object index of a hit is the index of the sphere, the number
+/// of spheres plus the index of the shape, or, for a mesh, the number of spheres and shapes plus the index of the
+/// triangle counted through every mesh in order. The instances are numbered after the last triangle. The objects
+/// refer to each other, so a world can be neither copied nor moved
+class World
+{
+public:
+  /// Prepare a scene for rendering
+  /// \param[in] description The scene
+  /// \param[in] cacheDirectory The directory of the BVH cache. Nothing is cached when empty
+  /// \throws std::runtime_error if a mesh or instanced scene file cannot be read or is not valid
+  /// \throws std::out_of_range if a mesh or sphere refers to a material or vertex that does not exist
+  World(scene::Description description, std::filesystem::path const& cacheDirectory);
+
+  World(World const&) = delete;
+  World& operator=(World const&) = delete;
+
+  /// Read a scene file in the text or binary format and prepare it for rendering
+  /// \param[in] path The path of the scene file
+  /// \param[in] cacheDirectory The directory of the BVH cache. Nothing is cached when empty
+  /// \returns The world
+  /// \throws std::runtime_error if the file cannot be read or is not a valid scene
+  static std::unique_ptr<World> load(std::filesystem::path const& path, std::filesystem::path const& cacheDirectory);
+
+  /// Get the settings and camera of the scene
+  /// \details The materials and spheres of a binary scene are only held by the mapped file, so use getMaterials and
+  /// getSpheres rather than those of the description
+  scene::Description const& getDescription() const noexcept
+  {
+    return m_description;
+  }
+
+  std::span<scene::MaterialData const> getMaterials() const noexcept
+  {
+    return m_materials;
+  }
+
+  std::span<scene::SphereData const> getSpheres() const noexcept
+  {
+    return m_spheres;
+  }
+
+  std::span<scene::ShapeData const> getShapes() const noexcept
+  {
+    return m_shapes;
+  }
+
+  /// Get the hash of the contents of every mesh, in the order of the meshes of the description
+  std::span<std::uint64_t const> getMeshHashes() const noexcept
+  {
+    return m_meshHashes;
+  }
+
+  /// Get the hash of the materials and spheres every instance copies, in the order of the instances of the
+  /// description
+  std::span<std::uint64_t const> getInstanceHashes() const noexcept
+  {
+    return m_instanceHashes;
+  }
+
+  std::span<bvh::Node const> getNodes() const noexcept
+  {
+    return m_nodes;
+  }
+
+  std::span<std::uint32_t const> getIndices() const noexcept
+  {
+    return m_indices;
+  }
+
+  /// Get the objects to trace rays against: the hierarchy over the spheres, a list of it, the meshes and the
+  /// instances when the scene has meshes or instances, and either of those behind the planes, disks and boxes when
+  /// the scene has any
+  hittable::Hittable const& getHittable() const noexcept
+  {
+    if (not m_shapes.empty()) {
+      return m_shapeList;
+    }
+
+    return getBounded();
+  }
+
+private:
+  World(std::unique_ptr<binaryscene::MappedScene> mapped, scene::Description description,
+        std::filesystem::path const& cacheDirectory);
+
+  /// Get the objects that have bounds: the hierarchy over the spheres, or a list of it, the meshes and the instances
+  hittable::Hittable const& getBounded() const noexcept
+  {
+    if (m_description.meshes.empty() and m_description.instances.empty()) {
+      return m_bvh;
+    }
+
+    return m_objects;
+  }
+
+  std::unique_ptr<binaryscene::MappedScene> m_mapped;
+  scene::Description m_description;
+  std::span<scene::MaterialData const> m_materials;
+  std::span<scene::SphereData const> m_spheres;
+  std::span<scene::ShapeData const> m_shapes;
+  bvh::Tree m_tree;
+  std::span<bvh::Node const> m_nodes;
+  std::span<std::uint32_t const> m_indices;
+  scene::MaterialTable m_materialTable;
+  bvh::SphereBvh m_bvh;
+  std::vector<std::uint64_t> m_meshHashes;
+  std::vector<std::uint64_t> m_instanceHashes;
+  hittable::HittableList m_objects;
+  plane::ShapeList m_shapeList;
+};
+
+/// Prepares the scene a render names for rendering
+/// \throws std::exception if the scene cannot be loaded
+using Loader = std::function<std::unique_ptr<World>(std::string const& name)>;
+
+}   // namespace rt::world
+
+#endif
@@ -23,12 +23,35 @@
 // DEALINGS IN THE SOFTWARE.
 
 #include "Main.hpp"
+#include "Options.hpp"
 
 #include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string_view>
+#include <vector>
 
-int main()
+int main(int argc, char* argv[])
 {
-  rt::renderImage();
+  try {
+    std::vector<std::string_view> const args(argv + 1, argv + argc);
+    auto const options = rt::options::parseOptions(args);
+    rt::selectKernels(options);
+
+    if (not options.servePath.empty()) {
+      rt::serve(options);
+    }
+    else if (not options.workerAddress.empty()) {
+      rt::work(options);
+    }
+    else {
+      rt::renderImage(options);
+    }
+  }
+  catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << '\n' << rt::options::getUsage();
+    return EXIT_FAILURE;
+  }
 
   return EXIT_SUCCESS;
 }
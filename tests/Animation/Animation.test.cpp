@@ -0,0 +1,144 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Animation.hpp"
+
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rt::animation {
+
+namespace {
+
+constexpr auto turn = R"(keyframe 0   4 1 0   0 0 0  4
+keyframe 10  0 1 4   0 0 0  4
+keyframe 20  -4 1 0  0 1 0  5
+)";
+
+std::string readFile(std::filesystem::path const& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+}   // namespace
+
+TEST_CASE("getCamera", "[Animation]")
+{
+  auto const keyframes = scene::parseCameraPath(turn);
+  auto base = scene::CameraData();
+  base.verticalFieldOfView = 35;
+
+  SECTION("the camera passes through every keyframe")
+  {
+    for (auto const& keyframe : keyframes) {
+      auto const camera = getCamera(keyframes, base, static_cast<double>(keyframe.frame));
+
+      REQUIRE(camera.lookFrom == keyframe.lookFrom);
+      REQUIRE(camera.lookAt == keyframe.lookAt);
+      REQUIRE(camera.focusDistance == keyframe.focusDistance);
+      REQUIRE(camera.verticalFieldOfView == 35);
+    }
+  }
+
+  SECTION("frames outside the path hold still")
+  {
+    REQUIRE(getCamera(keyframes, base, -3).lookFrom == keyframes.front().lookFrom);
+    REQUIRE(getCamera(keyframes, base, 25).lookFrom == keyframes.back().lookFrom);
+  }
+
+  SECTION("a path of two keyframes is followed at constant speed")
+  {
+    auto const ends = std::vector<scene::Keyframe>(keyframes.begin(), keyframes.begin() + 2);
+    auto const camera = getCamera(ends, base, 2.5);
+
+    REQUIRE(camera.lookFrom.x() == 3);
+    REQUIRE(camera.lookFrom.z() == 1);
+  }
+
+  SECTION("the camera curves through the keyframes rather than turning at them")
+  {
+    auto const camera = getCamera(keyframes, base, 10.5);
+
+    // A straight line from the second keyframe to the third would be at z = 3.8
+    REQUIRE(camera.lookFrom.z() > 3.95);
+    REQUIRE(camera.focusDistance > 4);
+    REQUIRE(camera.focusDistance < 5);
+  }
+}
+
+TEST_CASE("getFramePath", "[Animation]")
+{
+  REQUIRE(getFramePath("out/turn", 7) == "out/turn.0007.ppm");
+  REQUIRE(getFramePath("turn", 12345) == "turn.12345.ppm");
+}
+
+TEST_CASE("renderAnimation", "[Animation]")
+{
+  auto const world = world::World(scene::parseScene(R"(lambertian 0.5 0.5 0.5
+sphere 0 -1000 0 1000 0
+sphere 0 1 0 1 0
+)"),
+                                  {});
+  auto const keyframes = scene::parseCameraPath("keyframe 3  4 1 0  0 1 0  4\nkeyframe 5  0 1 4  0 1 0  4\n");
+  auto const prefix = std::filesystem::temp_directory_path() / "rt-animation-test";
+
+  auto settings = render::Settings();
+  settings.imgWidth = 12;
+  settings.imgHeight = 8;
+  settings.samplesPerPixel = 2;
+  settings.maxDepth = 4;
+  settings.showProgress = false;
+
+  auto pool = threadpool::ThreadPool(2);
+
+  SECTION("every frame is written as it would be rendered on its own")
+  {
+    REQUIRE(renderAnimation(pool, world, keyframes, settings, prefix) == 3);
+
+    for (std::size_t frame = 3; frame <= 5; ++frame) {
+      auto description = scene::getSettings(world.getDescription());
+      description.imgWidth = settings.imgWidth;
+      description.imgHeight = settings.imgHeight;
+      description.camera = getCamera(keyframes, description.camera, static_cast<double>(frame));
+
+      std::ostringstream expected;
+      auto const framebuffer = render::render(world.getHittable(), scene::buildCamera(description), settings);
+      render::writePpm(expected, render::tonemap(framebuffer, settings.samplesPerPixel), 12, 8);
+
+      REQUIRE(readFile(getFramePath(prefix, frame)) == expected.str());
+      std::filesystem::remove(getFramePath(prefix, frame));
+    }
+  }
+}
+
+}   // namespace rt::animation
@@ -0,0 +1,102 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Aov.hpp"
+
+#include "Hittable.hpp"
+#include "Lambertian.hpp"
+#include "Ray.hpp"
+#include "Utilities.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rt::aov {
+
+TEST_CASE("AovBuffers", "[Aov]")
+{
+  auto material = material::Lambertian(colour::Colour(0.2, 0.4, 0.6));
+  auto const ray = ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0, 0, -2));
+
+  hittable::HitRecord hit;
+  hit.t = 1.5;
+  hit.normal = vec3::Vec3(0, 0, 1);
+  hit.materialPtr = &material;
+  hit.objectIndex = 7;
+
+  hittable::HitRecord miss;
+  miss.t = rt::infinity;
+
+  auto buffers = AovBuffers(2, 1);
+
+  SECTION("pixels without samples are empty")
+  {
+    REQUIRE(buffers.getSampleCount(0, 0) == 0);
+    REQUIRE(buffers.getDepth(0, 0) == rt::infinity);
+    REQUIRE(buffers.getObjectId(0, 0) == -1);
+  }
+
+  SECTION("the first hit of a camera path is recorded")
+  {
+    buffers.addSample(1, 0, ray, hit);
+
+    REQUIRE(buffers.getSampleCount(1, 0) == 1);
+    REQUIRE(buffers.getDepth(1, 0) == 3.0);
+    REQUIRE(buffers.getNormal(1, 0) == vec3::Vec3(0, 0, 1));
+    REQUIRE(buffers.getAlbedo(1, 0) == colour::Colour(0.2, 0.4, 0.6));
+    REQUIRE(buffers.getObjectId(1, 0) == 7);
+  }
+
+  SECTION("samples that escape count towards coverage but not depth")
+  {
+    buffers.addSample(0, 0, ray, miss);
+    buffers.addSample(0, 0, ray, hit);
+
+    REQUIRE(buffers.getSampleCount(0, 0) == 2);
+    REQUIRE(buffers.getDepth(0, 0) == 3.0);
+    REQUIRE(buffers.getNormal(0, 0) == vec3::Vec3(0, 0, 0.5));
+    REQUIRE(buffers.getObjectId(0, 0) == -1);
+  }
+}
+
+TEST_CASE("writePfm", "[Aov]")
+{
+  SECTION("it writes a little-endian header followed by the raw samples")
+  {
+    auto ss = std::stringstream {};
+    auto const data = std::vector<float> {1.0F, 2.0F};
+
+    writePfm(ss, 2, 1, 1, data);
+
+    auto const header = std::string("Pf\n2 1\n-1.0\n");
+    auto const output = ss.str();
+
+    REQUIRE(output.substr(0, header.size()) == header);
+    REQUIRE(output.size() == header.size() + 2 * sizeof(float));
+    REQUIRE(output.substr(header.size(), 4) == std::string("\x00\x00\x80\x3f", 4));
+  }
+}
+
+}   // namespace rt::aov
@@ -0,0 +1,156 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "BinaryScene.hpp"
+
+#include "Bvh.hpp"
+#include "Scene.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace rt::binaryscene {
+
+namespace {
+
+constexpr auto text = R"(image 64 48
+samples 3
+depth 7
+camera 1 2 3  0 0 -1  0 1 0  35 0.5 4
+shutter 0 0.5
+lambertian 0.1 0.2 0.3
+metal 0.4 0.5 0.6 0.25
+dielectric 1.33
+sphere 0 -100 0 100 0
+sphere 0 1 -1 0.5 1
+sphere 1 1 -1 0.5 2
+moving -1 1 -1 0.5 2  0 1 0
+disk 0 0 -3  0 0 1  2 1
+)";
+
+/// A file in the temporary directory that is removed again at the end of the test
+class TemporaryFile
+{
+public:
+  explicit TemporaryFile(char const* name) : m_path(std::filesystem::temp_directory_path() / name)
+  {
+  }
+
+  ~TemporaryFile()
+  {
+    std::filesystem::remove(m_path);
+  }
+
+  TemporaryFile(TemporaryFile const&) = delete;
+  TemporaryFile& operator=(TemporaryFile const&) = delete;
+
+  std::filesystem::path const& getPath() const noexcept
+  {
+    return m_path;
+  }
+
+private:
+  std::filesystem::path m_path;
+};
+
+}   // namespace
+
+TEST_CASE("MappedScene", "[BinaryScene]")
+{
+  auto const scene = scene::parseScene(text);
+  auto const tree = bvh::build(scene.spheres);
+  auto const file = TemporaryFile("rt-binary-scene-test.rtscene");
+
+  SECTION("a written scene maps back unchanged")
+  {
+    writeScene(file.getPath(), scene, &tree);
+
+    REQUIRE(isBinaryScene(file.getPath()));
+
+    auto const mapped = MappedScene(file.getPath());
+    auto const settings = mapped.getSettings();
+
+    REQUIRE(settings.imgWidth == 64);
+    REQUIRE(settings.imgHeight == 48);
+    REQUIRE(settings.samplesPerPixel == 3);
+    REQUIRE(settings.maxDepth == 7);
+    REQUIRE(settings.camera.lookAt == scene.camera.lookAt);
+    REQUIRE(settings.camera.focusDistance == 4);
+    REQUIRE(settings.camera.shutterClose == 0.5);
+
+    REQUIRE(mapped.getMaterials().size() == 3);
+    REQUIRE(mapped.getMaterials()[1].parameter == 0.25);
+    REQUIRE(mapped.getSpheres().size() == 4);
+    REQUIRE(mapped.getSpheres()[3].centre == scene.spheres[3].centre);
+    REQUIRE(mapped.getSpheres()[3].material == 2);
+    REQUIRE(mapped.getSpheres()[3].velocity == scene.spheres[3].velocity);
+    REQUIRE(mapped.getNodes().size() == tree.nodes.size());
+    REQUIRE(mapped.getIndices().size() == tree.indices.size());
+    REQUIRE(mapped.getShapes().size() == 1);
+    REQUIRE(mapped.getShapes()[0].radius == 2);
+    REQUIRE(mapped.getShapes()[0].material == 1);
+  }
+
+  SECTION("the hierarchy is optional")
+  {
+    writeScene(file.getPath(), scene, nullptr);
+    auto const mapped = MappedScene(file.getPath());
+
+    REQUIRE(mapped.getNodes().empty());
+    REQUIRE(mapped.getSpheres().size() == 4);
+  }
+
+  SECTION("text scenes are not mistaken for binary ones")
+  {
+    std::ofstream(file.getPath()) << text;
+
+    REQUIRE_FALSE(isBinaryScene(file.getPath()));
+    REQUIRE_THROWS_AS(MappedScene(file.getPath()), std::runtime_error);
+  }
+
+  SECTION("truncated files are rejected")
+  {
+    writeScene(file.getPath(), scene, &tree);
+    std::filesystem::resize_file(file.getPath(), std::filesystem::file_size(file.getPath()) - 8);
+
+    REQUIRE_THROWS_AS(MappedScene(file.getPath()), std::runtime_error);
+  }
+
+  SECTION("spheres and shapes that refer to missing materials are rejected")
+  {
+    auto broken = scene;
+    broken.spheres[2].material = 3;
+    writeScene(file.getPath(), broken, nullptr);
+
+    REQUIRE_THROWS_AS(MappedScene(file.getPath()), std::runtime_error);
+
+    broken = scene;
+    broken.shapes[0].material = 3;
+    writeScene(file.getPath(), broken, nullptr);
+
+    REQUIRE_THROWS_AS(MappedScene(file.getPath()), std::runtime_error);
+  }
+}
+
+}   // namespace rt::binaryscene
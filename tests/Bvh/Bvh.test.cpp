@@ -0,0 +1,385 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Bvh.hpp"
+
+#include "Colour.hpp"
+#include "HittableList.hpp"
+#include "Lambertian.hpp"
+#include "Packet.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace rt::bvh {
+
+namespace {
+
+/// Describe a cube of overlapping spheres of different sizes, with a few large ones thrown in
+scene::Description makeScene(std::size_t sphereCount)
+{
+  scene::Description scene;
+  scene.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+
+  for (std::size_t i = 0; i < sphereCount; ++i) {
+    auto const centre = std::array<double, 3> {
+      getRandomDoubleInRange(-10, 10), getRandomDoubleInRange(-10, 10), getRandomDoubleInRange(-10, 10)};
+    auto const radius = i % 50 == 0 ? getRandomDoubleInRange(2, 5) : getRandomDoubleInRange(0.05, 0.5);
+    scene.spheres.push_back(scene::SphereData {.centre = centre, .radius = radius});
+  }
+
+  return scene;
+}
+
+}   // namespace
+
+TEST_CASE("SphereBvh", "[Bvh]")
+{
+  seedRandom(7);
+
+  auto const scene = makeScene(2000);
+  auto const tree = build(scene.spheres);
+  auto const materials = scene::MaterialTable(scene.materials);
+  auto const bvh = SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials());
+  auto const list = scene::buildWorld(scene);
+
+  SECTION("the hierarchy is valid and covers every sphere once")
+  {
+    REQUIRE(isValid(tree.nodes, tree.indices, scene.spheres.size()));
+
+    auto indices = tree.indices;
+    std::sort(indices.begin(), indices.end());
+
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+      REQUIRE(indices[i] == i);
+    }
+  }
+
+  SECTION("rays hit the same spheres as a linear search")
+  {
+    for (int r = 0; r < 2000; ++r) {
+      auto const origin = vec3::Vec3::createRandomVecInRange(-15, 15);
+      auto const ray = ray::Ray(origin, vec3::Vec3::createRandomVecInRange(-1, 1));
+      hittable::HitRecord expected;
+      hittable::HitRecord actual;
+
+      auto const expectedHit = list.hit(ray, 0.001, rt::infinity, expected);
+
+      REQUIRE(bvh.hit(ray, 0.001, rt::infinity, actual) == expectedHit);
+
+      if (expectedHit) {
+        REQUIRE(actual.objectIndex == expected.objectIndex);
+        REQUIRE(actual.t == expected.t);
+        REQUIRE(actual.materialPtr == materials.getMaterials()[0]);
+      }
+    }
+  }
+
+  SECTION("moving spheres are found at every time")
+  {
+    auto moving = scene;
+
+    for (auto& sphere : moving.spheres) {
+      sphere.velocity = {getRandomDoubleInRange(-2, 2), getRandomDoubleInRange(-2, 2), 0};
+    }
+
+    auto const movingTree = build(moving.spheres);
+    auto const movingBvh = SphereBvh(moving.spheres, movingTree.nodes, movingTree.indices, materials.getMaterials());
+    auto const movingList = scene::buildWorld(moving);
+
+    for (int r = 0; r < 2000; ++r) {
+      auto const origin = vec3::Vec3::createRandomVecInRange(-15, 15);
+      auto const ray = ray::Ray(origin, vec3::Vec3::createRandomVecInRange(-1, 1), getRandomDouble());
+      hittable::HitRecord expected;
+      hittable::HitRecord actual;
+
+      auto const expectedHit = movingList.hit(ray, 0.001, rt::infinity, expected);
+
+      REQUIRE(movingBvh.hit(ray, 0.001, rt::infinity, actual) == expectedHit);
+
+      if (expectedHit) {
+        REQUIRE(actual.objectIndex == expected.objectIndex);
+        REQUIRE(actual.t == expected.t);
+      }
+    }
+  }
+
+  SECTION("packets find the hits of their rays traced alone")
+  {
+    for (std::size_t const size : {4, 8, 16}) {
+      auto packet = packet::RayPacket();
+      packet.size = size;
+
+      for (int p = 0; p < 100; ++p) {
+        // Rays from around one point, as camera rays are, with some lanes left out
+        auto const origin = vec3::Vec3::createRandomVecInRange(-15, 15);
+        packet.active = 0;
+
+        for (std::size_t lane = 0; lane < size; ++lane) {
+          if (getRandomDouble() < 0.8) {
+            auto const direction = -origin + vec3::Vec3::createRandomVecInRange(-3, 3);
+            packet.set(lane, ray::Ray(origin, direction, getRandomDouble()));
+          }
+        }
+
+        std::array<hittable::HitRecord, packet::maxSize> records;
+        auto const hits = bvh.hitPacket(packet, 0.001, rt::infinity, records);
+
+        for (std::size_t lane = 0; lane < size; ++lane) {
+          hittable::HitRecord expected;
+          auto const expectedHit = packet.isActive(lane) and bvh.hit(packet.rays[lane], 0.001, rt::infinity, expected);
+
+          REQUIRE(((hits >> lane) & 1) == (expectedHit ? 1U : 0U));
+
+          if (expectedHit) {
+            REQUIRE(records[lane].objectIndex == expected.objectIndex);
+            REQUIRE(records[lane].t == expected.t);
+            REQUIRE(records[lane].point == expected.point);
+            REQUIRE(records[lane].normal == expected.normal);
+            REQUIRE(records[lane].frontFace == expected.frontFace);
+            REQUIRE(records[lane].materialPtr == expected.materialPtr);
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("streams find the hits of their rays traced alone")
+  {
+    std::vector<ray::Ray> rays;
+
+    for (int r = 0; r < 500; ++r) {
+      auto const origin = vec3::Vec3::createRandomVecInRange(-15, 15);
+      rays.emplace_back(origin, vec3::Vec3::createRandomVecInRange(-1, 1), getRandomDouble());
+    }
+
+    auto const& data = scene.spheres[0];
+    auto const sphere = sphere::Sphere(ray::Point3(data.centre[0], data.centre[1], data.centre[2]), data.radius,
+                                       new material::Lambertian(colour::Colour(0.5, 0.5, 0.5)));
+
+    for (hittable::Hittable const* const world : {static_cast<hittable::Hittable const*>(&bvh),
+                                                  static_cast<hittable::Hittable const*>(&list),
+                                                  static_cast<hittable::Hittable const*>(&sphere)}) {
+      std::vector<hittable::HitRecord> records(rays.size());
+      auto const hits = world->hitStream(rays, 0.001, std::vector<Scalar>(rays.size(), rt::infinity), records);
+      std::size_t expectedHits = 0;
+
+      for (std::size_t r = 0; r < rays.size(); ++r) {
+        hittable::HitRecord expected;
+        auto const expectedHit = world->hit(rays[r], 0.001, rt::infinity, expected);
+
+        if (expectedHit) {
+          ++expectedHits;
+          REQUIRE(records[r].t == expected.t);
+          REQUIRE(records[r].point == expected.point);
+          REQUIRE(records[r].normal == expected.normal);
+          REQUIRE(records[r].materialPtr == expected.materialPtr);
+
+          if (world != &sphere) {
+            REQUIRE(records[r].objectIndex == expected.objectIndex);
+          }
+        }
+        else {
+          REQUIRE(records[r].t == rt::infinity);
+        }
+      }
+
+      REQUIRE(hits == expectedHits);
+    }
+  }
+
+  SECTION("streams through a list are bounded by the nearest hit of every ray, as single rays are")
+  {
+    std::vector<ray::Ray> rays;
+
+    for (int r = 0; r < 300; ++r) {
+      rays.emplace_back(vec3::Vec3::createRandomVecInRange(-15, 15), vec3::Vec3::createRandomVecInRange(-1, 1));
+    }
+
+    // The second hierarchy only has to test the spheres in front of the hit the first one found
+    auto twice = hittable::HittableList();
+    twice.add(new SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials()));
+    twice.add(new SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials()));
+
+    // Bounds below infinity are kept too
+    std::vector<Scalar> bounds(rays.size(), rt::infinity);
+
+    for (std::size_t r = 0; r < rays.size(); r += 3) {
+      bounds[r] = 5;
+    }
+
+    std::vector<hittable::HitRecord> expected(rays.size());
+    auto const before = stats::getThreadTestCount();
+
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+      if (not twice.hit(rays[r], 0.001, bounds[r], expected[r])) {
+        expected[r].t = rt::infinity;
+      }
+    }
+
+    auto const singleTests = stats::getThreadTestCount() - before;
+    std::vector<hittable::HitRecord> records(rays.size());
+    twice.hitStream(rays, 0.001, bounds, records);
+    auto const streamTests = stats::getThreadTestCount() - before - singleTests;
+
+    REQUIRE(singleTests > 0);
+    REQUIRE(streamTests <= singleTests);
+
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+      REQUIRE(records[r].t == expected[r].t);
+    }
+  }
+
+  SECTION("rays parallel to an axis are handled")
+  {
+    auto const ray = ray::Ray(ray::Point3(-20, 0, 0), vec3::Vec3(1, 0, 0));
+    hittable::HitRecord expected;
+    hittable::HitRecord actual;
+
+    REQUIRE(bvh.hit(ray, 0.001, rt::infinity, actual) == list.hit(ray, 0.001, rt::infinity, expected));
+  }
+}
+
+TEST_CASE("build", "[Bvh]")
+{
+  SECTION("no spheres give an empty hierarchy that nothing hits")
+  {
+    auto const tree = build({});
+    auto const bvh = SphereBvh({}, tree.nodes, tree.indices, {});
+    hittable::HitRecord record;
+
+    REQUIRE(tree.nodes.empty());
+    REQUIRE(isValid(tree.nodes, tree.indices, 0));
+    REQUIRE_FALSE(bvh.hit(ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0, 0, 1)), 0.001, rt::infinity, record));
+  }
+
+  SECTION("spheres sharing a centre end up in one leaf")
+  {
+    auto const spheres = std::vector<scene::SphereData>(5, scene::SphereData {.centre = {1, 2, 3}, .radius = 1});
+    auto const tree = build(spheres);
+
+    REQUIRE(tree.nodes.size() == 1);
+    REQUIRE(tree.nodes[0].count == 5);
+  }
+}
+
+TEST_CASE("DynamicTree", "[Bvh]")
+{
+  seedRandom(11);
+
+  auto scene = makeScene(500);
+  auto tree = DynamicTree(scene.spheres);
+  auto const materials = scene::MaterialTable(scene.materials);
+  std::vector<bool> removed(scene.spheres.size());
+
+  SECTION("rays hit the same spheres as a linear search after every kind of edit")
+  {
+    for (int edit = 0; edit < 300; ++edit) {
+      auto const sphere = static_cast<std::uint32_t>(getRandomDoubleInRange(0, 500));
+
+      if (edit % 3 == 0) {
+        scene.spheres.push_back(makeScene(1).spheres[0]);
+        removed.push_back(false);
+        tree.insert(scene.spheres, static_cast<std::uint32_t>(scene.spheres.size() - 1));
+      }
+      else if (removed[sphere]) {
+        REQUIRE_FALSE(tree.contains(sphere));
+      }
+      else if (edit % 3 == 1) {
+        scene.spheres[sphere].centre[1] += getRandomDoubleInRange(-5, 5);
+        tree.update(scene.spheres, sphere);
+      }
+      else {
+        removed[sphere] = true;
+        tree.remove(scene.spheres, sphere);
+      }
+    }
+
+    auto live = scene::Description();
+    std::vector<std::uint32_t> liveIndices;
+    live.materials = scene.materials;
+
+    for (std::uint32_t i = 0; i < scene.spheres.size(); ++i) {
+      REQUIRE(tree.contains(i) == not removed[i]);
+
+      if (not removed[i]) {
+        live.spheres.push_back(scene.spheres[i]);
+        liveIndices.push_back(i);
+      }
+    }
+
+    auto const bvh = SphereBvh(scene.spheres, tree.getTree().nodes, tree.getTree().indices, materials.getMaterials());
+    auto const list = scene::buildWorld(live);
+
+    for (int r = 0; r < 2000; ++r) {
+      auto const ray = ray::Ray(vec3::Vec3::createRandomVecInRange(-15, 15), vec3::Vec3::createRandomVecInRange(-1, 1));
+      hittable::HitRecord expected;
+      hittable::HitRecord actual;
+
+      auto const expectedHit = list.hit(ray, 0.001, rt::infinity, expected);
+
+      REQUIRE(bvh.hit(ray, 0.001, rt::infinity, actual) == expectedHit);
+
+      if (expectedHit) {
+        REQUIRE(actual.objectIndex == liveIndices[expected.objectIndex]);
+        REQUIRE(actual.t == expected.t);
+      }
+    }
+  }
+}
+
+TEST_CASE("isValid", "[Bvh]")
+{
+  seedRandom(3);
+
+  auto const scene = makeScene(100);
+  auto tree = build(scene.spheres);
+
+  SECTION("an index outside of the spheres is rejected")
+  {
+    tree.indices[10] = 100;
+
+    REQUIRE_FALSE(isValid(tree.nodes, tree.indices, scene.spheres.size()));
+  }
+
+  SECTION("a child outside of the nodes is rejected")
+  {
+    tree.nodes[0].offset = static_cast<std::uint32_t>(tree.nodes.size());
+
+    REQUIRE_FALSE(isValid(tree.nodes, tree.indices, scene.spheres.size()));
+  }
+
+  SECTION("a leaf running past the indices is rejected")
+  {
+    tree.nodes.back().count = 200;
+
+    REQUIRE_FALSE(isValid(tree.nodes, tree.indices, scene.spheres.size()));
+  }
+}
+
+}   // namespace rt::bvh
@@ -0,0 +1,226 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "BvhCache.hpp"
+
+#include "Bvh.hpp"
+#include "Scene.hpp"
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace rt::bvhcache {
+
+namespace {
+
+std::vector<scene::SphereData> makeSpheres()
+{
+  std::vector<scene::SphereData> spheres;
+
+  for (int i = 0; i < 50; ++i) {
+    spheres.push_back(scene::SphereData {.centre = {i * 0.5, (i % 7) * 1.0, -i * 0.25}, .radius = 0.3});
+  }
+
+  return spheres;
+}
+
+}   // namespace
+
+TEST_CASE("hashGeometry", "[BvhCache]")
+{
+  auto const spheres = makeSpheres();
+  auto const hash = hashGeometry(spheres);
+
+  SECTION("moving or resizing a sphere changes the hash")
+  {
+    auto moved = spheres;
+    moved[20].centre[1] += 1e-9;
+    auto resized = spheres;
+    resized[49].radius = 0.31;
+
+    REQUIRE(hashGeometry(moved) != hash);
+    REQUIRE(hashGeometry(resized) != hash);
+  }
+
+  SECTION("reordering the spheres changes the hash")
+  {
+    auto reordered = spheres;
+    std::swap(reordered[0], reordered[1]);
+
+    REQUIRE(hashGeometry(reordered) != hash);
+  }
+
+  SECTION("materials are not part of the geometry")
+  {
+    auto recoloured = spheres;
+    recoloured[3].material = 1;
+
+    REQUIRE(hashGeometry(recoloured) == hash);
+  }
+}
+
+TEST_CASE("hashMesh", "[BvhCache]")
+{
+  auto const positions = std::vector<std::array<float, 3>> {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  auto const triangles = std::vector<std::array<std::uint32_t, 3>> {{0, 1, 2}, {0, 2, 3}};
+  auto const hash = hashMesh(positions, triangles);
+
+  SECTION("the positions and the triangles are part of the mesh")
+  {
+    auto moved = positions;
+    moved[3][2] = 1.5F;
+    auto flipped = triangles;
+    std::swap(flipped[1][1], flipped[1][2]);
+
+    REQUIRE(hashMesh(positions, triangles) == hash);
+    REQUIRE(hashMesh(moved, triangles) != hash);
+    REQUIRE(hashMesh(positions, flipped) != hash);
+    REQUIRE(hashMesh(positions, std::span(triangles).first(1)) != hash);
+  }
+}
+
+TEST_CASE("hashScene", "[BvhCache]")
+{
+  auto const materials = std::vector<scene::MaterialData> {
+    {.type = scene::MaterialType::lambertian, .albedo = {0.5, 0.5, 0.5}},
+    {.type = scene::MaterialType::metal, .albedo = {0.7, 0.6, 0.5}, .parameter = 0.25}};
+  auto const spheres = makeSpheres();
+  auto const shapes = std::vector<scene::ShapeData> {
+    {.type = scene::ShapeType::plane, .vector = {0, 1, 0}},
+    {.type = scene::ShapeType::box, .point = {-1, 0, -1}, .vector = {1, 1, 1}}};
+  auto const meshes = std::vector<scene::MeshReference> {{.path = "/scenes/bunny.ply"}};
+  auto const meshHashes = std::vector<std::uint64_t> {42};
+  auto const hash = hashScene(materials, spheres, shapes, meshes, meshHashes);
+
+  SECTION("the materials are part of the scene")
+  {
+    auto fuzzier = materials;
+    fuzzier[1].parameter = 0.5;
+    auto darker = materials;
+    darker[0].albedo[2] = 0.25;
+    auto otherSpheres = spheres;
+    otherSpheres[3].material = 1;
+    auto otherShapes = shapes;
+    otherShapes[0].material = 1;
+    auto otherMeshes = meshes;
+    otherMeshes[0].material = 1;
+
+    REQUIRE(hashScene(fuzzier, spheres, shapes, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(darker, spheres, shapes, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(std::span(materials).first(1), spheres, shapes, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(materials, otherSpheres, shapes, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(materials, spheres, otherShapes, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(materials, spheres, shapes, otherMeshes, meshHashes) != hash);
+  }
+
+  SECTION("the shapes and meshes are part of the scene")
+  {
+    auto moved = shapes;
+    moved[0].point[1] = -1e-9;
+    auto retyped = shapes;
+    retyped[1].type = scene::ShapeType::disk;
+
+    REQUIRE(hashScene(materials, spheres, {}, {}, {}) != hash);
+    REQUIRE(hashScene(materials, spheres, moved, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(materials, spheres, retyped, meshes, meshHashes) != hash);
+    REQUIRE(hashScene(materials, spheres, shapes, meshes, std::vector<std::uint64_t> {43}) != hash);
+  }
+
+  SECTION("instances are hashed by their contents and placement")
+  {
+    auto const instances = std::vector<scene::InstanceReference> {{.path = "/scenes/tree.txt", .degrees = 90}};
+    auto const withInstances = hashScene(materials, spheres, shapes, meshes, meshHashes, instances,
+                                         std::vector<std::uint64_t> {7});
+    auto turned = instances;
+    turned[0].degrees = 45;
+    auto elsewhere = instances;
+    elsewhere[0].path = "/home/a/tree.txt";
+
+    REQUIRE(withInstances != hash);
+    REQUIRE(hashScene(materials, spheres, shapes, meshes, meshHashes, instances, std::vector<std::uint64_t> {8})
+            != withInstances);
+    REQUIRE(hashScene(materials, spheres, shapes, meshes, meshHashes, turned, std::vector<std::uint64_t> {7})
+            != withInstances);
+    REQUIRE(hashScene(materials, spheres, shapes, meshes, meshHashes, elsewhere, std::vector<std::uint64_t> {7})
+            == withInstances);
+  }
+
+  SECTION("meshes are hashed by their contents rather than the path each machine finds them at")
+  {
+    auto const elsewhere = std::vector<scene::MeshReference> {{.path = "/home/a/bunny.ply"}};
+
+    REQUIRE(hashScene(materials, spheres, shapes, elsewhere, meshHashes) == hash);
+  }
+}
+
+TEST_CASE("Cache", "[BvhCache]")
+{
+  auto const directory = std::filesystem::temp_directory_path() / "rt-bvh-cache-test";
+  std::filesystem::remove_all(directory);
+
+  auto const cache = Cache(directory);
+  auto const spheres = makeSpheres();
+  auto const hash = hashGeometry(spheres);
+  auto const tree = bvh::build(spheres);
+
+  SECTION("nothing is found in an empty cache")
+  {
+    REQUIRE_FALSE(cache.load(hash, spheres.size()));
+  }
+
+  SECTION("a stored hierarchy is loaded back unchanged")
+  {
+    cache.store(hash, spheres.size(), tree);
+    auto const loaded = cache.load(hash, spheres.size());
+
+    REQUIRE(loaded);
+    REQUIRE(loaded->indices == tree.indices);
+    REQUIRE(loaded->nodes.size() == tree.nodes.size());
+    REQUIRE(loaded->nodes.back().lower == tree.nodes.back().lower);
+    REQUIRE(loaded->nodes.front().offset == tree.nodes.front().offset);
+  }
+
+  SECTION("a hierarchy over a different number of spheres is not used")
+  {
+    cache.store(hash, spheres.size(), tree);
+
+    REQUIRE_FALSE(cache.load(hash, spheres.size() + 1));
+  }
+
+  SECTION("a damaged entry is a miss")
+  {
+    cache.store(hash, spheres.size(), tree);
+    std::filesystem::resize_file(cache.getPath(hash), sizeof(Header) + 10);
+
+    REQUIRE_FALSE(cache.load(hash, spheres.size()));
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+}   // namespace rt::bvhcache
@@ -0,0 +1,172 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Dispatch.hpp"
+
+#include "Bvh.hpp"
+#include "Colour.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace rt::dispatch {
+
+namespace {
+
+/// The instruction sets the processor running the tests supports
+std::vector<Isa> getSupportedIsas()
+{
+  std::vector<Isa> isas;
+
+  for (auto const isa : {Isa::generic, Isa::avx2, Isa::avx512}) {
+    if (isSupported(isa)) {
+      isas.push_back(isa);
+    }
+  }
+
+  return isas;
+}
+
+/// The results of every dispatched kernel for one instruction set
+struct KernelResults
+{
+  std::vector<double> randoms;
+  std::vector<double> distances;
+  std::vector<colour::Colour> pixels;
+};
+
+/// Run every dispatched kernel with an instruction set
+KernelResults runKernels(Isa isa)
+{
+  selectIsa(isa);
+  seedRandom(5);
+
+  KernelResults results;
+
+  for (int i = 0; i < 1000; ++i) {
+    results.randoms.push_back(getRandomDouble());
+  }
+
+  scene::Description scene;
+  scene.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+
+  for (std::size_t i = 0; i < 500; ++i) {
+    auto const centre = std::array<double, 3> {
+      getRandomDoubleInRange(-10, 10), getRandomDoubleInRange(-10, 10), getRandomDoubleInRange(-10, 10)};
+    scene.spheres.push_back(scene::SphereData {.centre = centre, .radius = getRandomDoubleInRange(0.1, 1)});
+  }
+
+  auto const tree = bvh::build(scene.spheres);
+  auto const materials = scene::MaterialTable(scene.materials);
+  auto const world = bvh::SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials());
+
+  for (int r = 0; r < 500; ++r) {
+    auto const ray = ray::Ray(vec3::Vec3::createRandomVecInRange(-15, 15), vec3::getRandomUnitVector());
+    hittable::HitRecord record;
+    results.distances.push_back(world.hit(ray, 0.001, infinity, record) ? record.t : -1);
+  }
+
+  std::vector<colour::Colour> sums;
+
+  for (int k = 0; k < 100; ++k) {
+    sums.push_back(colour::Colour::getRandomColour(0, 200));
+  }
+
+  results.pixels.resize(sums.size());
+  colour::mapToByteRange(sums, 100, results.pixels);
+
+  selectIsa(Isa::generic);
+
+  return results;
+}
+
+}   // namespace
+
+TEST_CASE("Instruction sets are named, detected and selected", "[Dispatch]")
+{
+  SECTION("names round trip")
+  {
+    for (auto const isa : {Isa::generic, Isa::avx2, Isa::avx512}) {
+      REQUIRE(parseIsa(getIsaName(isa)) == isa);
+    }
+
+    REQUIRE_THROWS_AS(parseIsa("sse9"), std::invalid_argument);
+  }
+
+  SECTION("the detected instruction set is the widest supported one")
+  {
+    REQUIRE(isSupported(Isa::generic));
+    REQUIRE(detectIsa() == getSupportedIsas().back());
+  }
+
+  SECTION("only supported instruction sets can be selected")
+  {
+    for (auto const isa : {Isa::generic, Isa::avx2, Isa::avx512}) {
+      if (isSupported(isa)) {
+        selectIsa(isa);
+        REQUIRE(getIsa() == isa);
+      }
+      else {
+        REQUIRE_THROWS_AS(selectIsa(isa), std::runtime_error);
+      }
+    }
+
+    selectIsa(Isa::generic);
+  }
+}
+
+TEST_CASE("Every kernel variant gives the results of the generic one", "[Dispatch]")
+{
+  auto const reference = runKernels(Isa::generic);
+
+  SECTION("random numbers follow std::uniform_real_distribution")
+  {
+    std::seed_seq sequence {5U, 0U, 0U, 0U};
+    auto generator = std::mt19937(sequence);
+    auto distribution = std::uniform_real_distribution<double>(0.0, 1.0);
+
+    for (auto const value : reference.randoms) {
+      REQUIRE(value == distribution(generator));
+    }
+  }
+
+  SECTION("the variants agree bit for bit")
+  {
+    for (auto const isa : getSupportedIsas()) {
+      auto const results = runKernels(isa);
+
+      REQUIRE(results.randoms == reference.randoms);
+      REQUIRE(results.distances == reference.distances);
+      REQUIRE(results.pixels == reference.pixels);
+    }
+  }
+}
+
+}   // namespace rt::dispatch
@@ -0,0 +1,288 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Distributed.hpp"
+
+#include "BvhCache.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "Socket.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rt::distributed {
+
+namespace {
+
+constexpr auto twoSpheres = R"(image 40 24
+samples 3
+depth 8
+camera 0 1 5  0 0 0  0 1 0  40 0 5
+lambertian 0.5 0.5 0.5
+metal 0.7 0.6 0.5 0.25
+sphere 0 -1000 0 1000 0
+sphere 0 1 0 1 1
+)";
+
+std::unique_ptr<world::World> loadTwoSpheres(std::string const& name)
+{
+  if (name != "two-spheres") {
+    throw std::runtime_error("no scene " + name);
+  }
+
+  return std::make_unique<world::World>(scene::parseScene(twoSpheres), std::filesystem::path());
+}
+
+std::string getSocketPath(char const* name)
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/// A worker served on a thread of its own until the test ends
+class TestWorker
+{
+public:
+  TestWorker(std::string const& address, world::Loader loadScene = loadTwoSpheres)
+    : m_worker(address, 1, std::move(loadScene))
+    , m_thread([this] { m_worker.run(); })
+  {
+  }
+
+  ~TestWorker()
+  {
+    m_worker.stop();
+    m_thread.join();
+  }
+
+  TestWorker(TestWorker const&) = delete;
+  TestWorker& operator=(TestWorker const&) = delete;
+
+  std::string const& getAddress() const noexcept
+  {
+    return m_worker.getAddress();
+  }
+
+private:
+  Worker m_worker;
+  std::jthread m_thread;
+};
+
+/// A worker that accepts a frame and then disconnects when it is asked for tiles
+class FailingWorker
+{
+public:
+  FailingWorker(std::string const& address, std::uint64_t sceneHash)
+    : m_listener(socket::listenAt(address))
+    , m_thread([this, sceneHash] {
+      auto coordinator = socket::accept(m_listener);
+
+      while (coordinator.readLine() != "end") {
+      }
+
+      coordinator.writeAll("ok " + std::to_string(sceneHash) + " 1\n");
+      coordinator.readLine();
+    })
+  {
+  }
+
+  ~FailingWorker()
+  {
+    m_thread.join();
+    std::filesystem::remove(socket::getLocalAddress(m_listener));
+  }
+
+  FailingWorker(FailingWorker const&) = delete;
+  FailingWorker& operator=(FailingWorker const&) = delete;
+
+private:
+  socket::Socket m_listener;
+  std::jthread m_thread;
+};
+
+/// A worker that answers every tile with pixels whose summed samples are 1, 2 and -0.5, written byte by byte
+class ConstantWorker
+{
+public:
+  ConstantWorker(std::string const& address, std::uint64_t sceneHash, std::size_t pixelsPerTile)
+    : m_listener(socket::listenAt(address))
+    , m_thread([this, sceneHash, pixelsPerTile] {
+      auto coordinator = socket::accept(m_listener);
+
+      while (coordinator.readLine() != "end") {
+      }
+
+      coordinator.writeAll("ok " + std::to_string(sceneHash) + " 1\n");
+
+      // 1, 2 and -0.5 as little-endian IEEE 754 doubles
+      auto const pixel = std::string("\0\0\0\0\0\0\xf0\x3f\0\0\0\0\0\0\0\x40\0\0\0\0\0\0\xe0\xbf", 24);
+
+      while (auto const line = coordinator.readLine()) {
+        auto request = std::istringstream(*line);
+        auto keyword = std::string();
+        auto index = std::size_t {0};
+        auto pixels = std::string();
+        request >> keyword;
+
+        while (request >> index) {
+          for (std::size_t i = 0; i < pixelsPerTile; ++i) {
+            pixels += pixel;
+          }
+        }
+
+        coordinator.writeAll("ok " + std::to_string(pixels.size()) + '\n' + pixels);
+      }
+    })
+  {
+  }
+
+  ~ConstantWorker()
+  {
+    m_thread.join();
+    std::filesystem::remove(socket::getLocalAddress(m_listener));
+  }
+
+  ConstantWorker(ConstantWorker const&) = delete;
+  ConstantWorker& operator=(ConstantWorker const&) = delete;
+
+private:
+  socket::Socket m_listener;
+  std::jthread m_thread;
+};
+
+/// Hash a scene the way workers do
+std::uint64_t hashWorld(world::World const& world)
+{
+  return bvhcache::hashScene(world.getMaterials(), world.getSpheres(), world.getShapes(), world.getDescription().meshes,
+                             world.getMeshHashes(), world.getDescription().instances, world.getInstanceHashes());
+}
+
+render::Settings getSettings(world::World const& world)
+{
+  auto settings = render::Settings();
+  settings.imgWidth = world.getDescription().imgWidth;
+  settings.imgHeight = world.getDescription().imgHeight;
+  settings.samplesPerPixel = world.getDescription().samplesPerPixel;
+  settings.maxDepth = world.getDescription().maxDepth;
+  settings.tileSize = 8;
+  settings.threads = 1;
+  settings.showProgress = false;
+
+  return settings;
+}
+
+}   // namespace
+
+TEST_CASE("renderOnWorkers", "[Distributed]")
+{
+  auto const world = loadTwoSpheres("two-spheres");
+  auto const settings = getSettings(*world);
+  auto const expected = render::render(world->getHittable(), scene::buildCamera(world->getDescription()), settings);
+
+  SECTION("workers on Unix domain sockets and TCP render the same image as a local render")
+  {
+    auto const first = TestWorker(getSocketPath("rt-worker-test-1.sock"));
+    auto const second = TestWorker(getSocketPath("rt-worker-test-2.sock"));
+    auto const third = TestWorker("127.0.0.1:0");
+    auto const workers = std::vector<std::string> {first.getAddress(), second.getAddress(), third.getAddress()};
+
+    REQUIRE(third.getAddress().starts_with("127.0.0.1:"));
+    REQUIRE(renderOnWorkers(workers, "two-spheres", *world, settings) == expected);
+  }
+
+  SECTION("the tiles of failed workers are rendered by the others")
+  {
+    auto const good = TestWorker(getSocketPath("rt-worker-test-1.sock"));
+    auto const failing = FailingWorker(getSocketPath("rt-worker-test-2.sock"), hashWorld(*world));
+    auto const otherScene = TestWorker(getSocketPath("rt-worker-test-3.sock"), [](std::string const&) {
+      auto scene = scene::parseScene(twoSpheres);
+      scene.spheres[1].radius = 0.5;
+      return std::make_unique<world::World>(std::move(scene), std::filesystem::path());
+    });
+    auto const workers = std::vector<std::string> {getSocketPath("rt-worker-test-2.sock"),
+                                                   getSocketPath("rt-worker-test-3.sock"),
+                                                   getSocketPath("rt-worker-test-missing.sock"), good.getAddress()};
+
+    REQUIRE(renderOnWorkers(workers, "two-spheres", *world, settings) == expected);
+  }
+
+  SECTION("tiles are read as little-endian doubles whatever the byte order of the coordinator")
+  {
+    // The 40 by 24 image is made of whole 8 by 8 tiles
+    auto const worker = ConstantWorker(getSocketPath("rt-worker-test-1.sock"), hashWorld(*world),
+                                       settings.tileSize * settings.tileSize);
+    auto const workers = std::vector<std::string> {getSocketPath("rt-worker-test-1.sock")};
+    auto const image = renderOnWorkers(workers, "two-spheres", *world, settings);
+
+    REQUIRE(image.size() == expected.size());
+    REQUIRE(std::ranges::all_of(image, [](colour::Colour const& pixel) {
+      return pixel.r() == 1 and pixel.g() == 2 and pixel.b() == -0.5;
+    }));
+  }
+
+  SECTION("a worker whose scene has other shapes is not used")
+  {
+    auto const otherGround = TestWorker(getSocketPath("rt-worker-test-1.sock"), [](std::string const&) {
+      auto scene = scene::parseScene(std::string(twoSpheres) + "plane 0 -0.5 0  0 1 0  0\n");
+      return std::make_unique<world::World>(std::move(scene), std::filesystem::path());
+    });
+    auto const workers = std::vector<std::string> {otherGround.getAddress()};
+
+    REQUIRE_THROWS_AS(renderOnWorkers(workers, "two-spheres", *world, settings), std::runtime_error);
+  }
+
+  SECTION("a worker whose scene has other materials is not used")
+  {
+    auto const otherMetal = TestWorker(getSocketPath("rt-worker-test-1.sock"), [](std::string const&) {
+      auto scene = scene::parseScene(twoSpheres);
+      scene.materials[1].albedo = {0.2, 0.6, 0.5};
+      return std::make_unique<world::World>(std::move(scene), std::filesystem::path());
+    });
+    auto const workers = std::vector<std::string> {otherMetal.getAddress()};
+
+    REQUIRE_THROWS_AS(renderOnWorkers(workers, "two-spheres", *world, settings), std::runtime_error);
+  }
+
+  SECTION("an image that no worker can finish is an error")
+  {
+    auto const noScene = TestWorker(getSocketPath("rt-worker-test-1.sock"), [](std::string const&) {
+      return loadTwoSpheres("none");
+    });
+    auto const workers = std::vector<std::string> {noScene.getAddress(), getSocketPath("rt-worker-test-missing.sock")};
+
+    REQUIRE_THROWS_AS(renderOnWorkers(workers, "two-spheres", *world, settings), std::runtime_error);
+    REQUIRE_THROWS_AS(renderOnWorkers({}, "two-spheres", *world, settings), std::invalid_argument);
+    REQUIRE_THROWS_AS(renderOnWorkers(workers, "two spheres", *world, settings), std::invalid_argument);
+  }
+}
+
+}   // namespace rt::distributed
@@ -0,0 +1,100 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Heatmap.hpp"
+
+#include "Colour.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rt::heatmap {
+
+TEST_CASE("getFalseColour", "[Heatmap]")
+{
+  SECTION("the ends of the scale are nearly black and pale yellow")
+  {
+    REQUIRE(getFalseColour(0.0) == colour::Colour(0, 0, 5));
+    REQUIRE(getFalseColour(1.0) == colour::Colour(252, 255, 163));
+  }
+
+  SECTION("values outside [0, 1] are clamped")
+  {
+    REQUIRE(getFalseColour(-3.0) == getFalseColour(0.0));
+    REQUIRE(getFalseColour(7.0) == getFalseColour(1.0));
+  }
+
+  SECTION("higher values are brighter")
+  {
+    auto const brightness = [](colour::Colour const& c) { return c.r() + c.g() + c.b(); };
+
+    REQUIRE(brightness(getFalseColour(0.25)) < brightness(getFalseColour(0.5)));
+    REQUIRE(brightness(getFalseColour(0.5)) < brightness(getFalseColour(0.75)));
+  }
+}
+
+TEST_CASE("toFalseColour", "[Heatmap]")
+{
+  SECTION("values are scaled by the 99th percentile, so outliers saturate")
+  {
+    auto values = std::vector<double>(200, 1.0);
+    values[0] = 0.0;
+    values[1] = 1000.0;
+
+    auto const colours = toFalseColour(values);
+
+    REQUIRE(colours[0] == getFalseColour(0.0));
+    REQUIRE(colours[1] == getFalseColour(1.0));
+    REQUIRE(colours[2] == getFalseColour(1.0));
+  }
+}
+
+TEST_CASE("CostBuffers", "[Heatmap]")
+{
+  SECTION("costs are stored bottom row first")
+  {
+    auto costs = CostBuffers(2, 2);
+    costs.record(1, 1, 0.5, 42, 3.5);
+
+    REQUIRE(costs.getSeconds()[3] == 0.5);
+    REQUIRE(costs.getIntersectionTests()[3] == 42);
+    REQUIRE(costs.getPathDepths()[3] == 3.5);
+    REQUIRE(costs.getSeconds()[0] == 0.0);
+  }
+
+  SECTION("an image without pixels writes nothing")
+  {
+    auto const prefix = std::filesystem::temp_directory_path() / "rt-heatmap-empty-test";
+    auto summary = std::ostringstream {};
+
+    CostBuffers(0, 0).write(prefix, true, summary);
+
+    REQUIRE_FALSE(std::filesystem::exists(prefix.string() + ".time.ppm"));
+    REQUIRE(summary.str().find("no pixels") != std::string::npos);
+  }
+}
+
+}   // namespace rt::heatmap
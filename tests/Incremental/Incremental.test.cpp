@@ -0,0 +1,257 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Incremental.hpp"
+
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace rt::incremental {
+
+namespace {
+
+constexpr auto row = R"(camera 0 2 10  0 0.5 0  0 1 0  30 0 10
+lambertian 0.5 0.5 0.5
+lambertian 0.8 0.2 0.1
+metal 0.7 0.6 0.5 0
+sphere 0 -1000 0 1000 0
+sphere -4 0.5 0 0.5 1
+sphere -2 0.5 0 0.5 1
+sphere 0 0.5 0 0.5 1
+sphere 2 0.5 0 0.5 1
+sphere 4 0.5 0 0.5 2
+)";
+
+/// The row of spheres standing on a plane rather than a large sphere
+constexpr auto rowOnPlane = R"(camera 0 2 10  0 0.5 0  0 1 0  30 0 10
+lambertian 0.5 0.5 0.5
+lambertian 0.8 0.2 0.1
+metal 0.7 0.6 0.5 0
+plane 0 0 0  0 1 0  0
+sphere -4 0.5 0 0.5 1
+sphere -2 0.5 0 0.5 1
+sphere 0 0.5 0 0.5 1
+sphere 2 0.5 0 0.5 1
+sphere 4 0.5 0 0.5 2
+)";
+
+render::Settings makeSettings()
+{
+  auto settings = render::Settings();
+  settings.imgWidth = 64;
+  settings.imgHeight = 36;
+  settings.samplesPerPixel = 4;
+  settings.maxDepth = 8;
+  settings.tileSize = 8;
+  settings.showProgress = false;
+
+  return settings;
+}
+
+/// Render every pixel of a scene from scratch
+std::vector<colour::Colour> renderAll(threadpool::ThreadPool& pool, scene::Description const& description,
+                                      render::Settings const& settings)
+{
+  auto const world = world::World(description, {});
+  return render::render(pool, world.getHittable(), scene::buildCamera(description), settings);
+}
+
+bool matches(std::span<colour::Colour const> framebuffer, std::vector<colour::Colour> const& expected)
+{
+  return std::equal(framebuffer.begin(), framebuffer.end(), expected.begin(), expected.end());
+}
+
+}   // namespace
+
+TEST_CASE("Session", "[Incremental]")
+{
+  auto pool = threadpool::ThreadPool(2);
+  auto const settings = makeSettings();
+  auto const pixelCount = settings.imgWidth * settings.imgHeight;
+  auto session = Session(scene::parseScene(row), settings);
+
+  REQUIRE(session.render(pool) == pixelCount);
+
+  SECTION("the first render traces every pixel the same as a full render")
+  {
+    REQUIRE(session.getDirtyPixelCount() == pixelCount);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("nothing is traced when nothing changed")
+  {
+    REQUIRE(session.render(pool) == 0);
+    REQUIRE(session.getDirtyPixelCount() == 0);
+  }
+
+  SECTION("a sphere made of another material only traces the pixels that saw it")
+  {
+    session.setMaterial(1, 2);
+    auto const traced = session.render(pool);
+
+    REQUIRE(traced > 0);
+    REQUIRE(traced < pixelCount / 2);
+    REQUIRE(session.getDirtyPixelCount() <= traced);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("a changed material traces the pixels of every sphere made of it")
+  {
+    session.changeMaterial(2, scene::MaterialData {.type = scene::MaterialType::dielectric, .parameter = 1.5});
+    auto const traced = session.render(pool);
+
+    REQUIRE(traced > 0);
+    REQUIRE(traced < pixelCount / 2);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("a removed sphere leaves the image a full render gives")
+  {
+    session.removeSphere(3);
+    auto const traced = session.render(pool);
+
+    REQUIRE(traced < pixelCount / 2);
+    REQUIRE(session.getDescription().spheres.size() == 5);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+    REQUIRE_THROWS_AS(session.removeSphere(3), std::out_of_range);
+  }
+
+  SECTION("an added or moved sphere leaves the image a full render gives")
+  {
+    auto const added = session.addSphere(scene::SphereData {.centre = {0, 1.1, 4}, .radius = 0.25, .material = 2});
+
+    REQUIRE(session.render(pool) == pixelCount);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+
+    session.moveSphere(added, {1, 0.25, 2});
+
+    REQUIRE(session.render(pool) == pixelCount);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+
+    session.moveSphere(2, {-2, 0.5, -3});
+    session.render(pool);
+
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("an approximate session only traces the pixels near an added or moved sphere")
+  {
+    auto approximate = Session(scene::parseScene(row), settings, Appearance::approximate);
+    approximate.render(pool);
+
+    auto const middle = (settings.imgHeight / 2) * settings.imgWidth + settings.imgWidth / 2;
+    auto const before = approximate.getFramebuffer()[middle];
+
+    // In front of the middle sphere, so it covers the middle of the image
+    auto const added = approximate.addSphere(scene::SphereData {.centre = {0, 1.1, 4}, .radius = 0.25, .material = 2});
+    auto const traced = approximate.render(pool);
+    auto const expected = renderAll(pool, approximate.getDescription(), settings);
+
+    REQUIRE(traced > 0);
+    REQUIRE(traced < pixelCount / 2);
+    REQUIRE(approximate.getFramebuffer()[middle] == expected[middle]);
+    REQUIRE_FALSE(approximate.getFramebuffer()[middle] == before);
+
+    approximate.moveSphere(added, {0, 3, 4});
+    approximate.render(pool);
+
+    REQUIRE(approximate.getFramebuffer()[middle] == renderAll(pool, approximate.getDescription(), settings)[middle]);
+  }
+
+  SECTION("edits must refer to spheres and materials that exist")
+  {
+    REQUIRE_THROWS_AS(session.setMaterial(9, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(session.setMaterial(1, 9), std::out_of_range);
+    REQUIRE_THROWS_AS(session.addSphere(scene::SphereData {.radius = 1, .material = 3}), std::out_of_range);
+    REQUIRE_THROWS_AS(session.changeMaterial(3, scene::MaterialData()), std::out_of_range);
+  }
+}
+
+TEST_CASE("Session with shapes", "[Incremental]")
+{
+  auto pool = threadpool::ThreadPool(2);
+  auto const settings = makeSettings();
+  auto const pixelCount = settings.imgWidth * settings.imgHeight;
+  auto session = Session(scene::parseScene(rowOnPlane), settings);
+
+  REQUIRE(session.render(pool) == pixelCount);
+
+  SECTION("the shapes are rendered as a full render renders them")
+  {
+    REQUIRE(session.getDescription().shapes.size() == 1);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("spheres are edited without tracing the pixels that only see the shapes")
+  {
+    session.setMaterial(1, 2);
+    auto const traced = session.render(pool);
+
+    REQUIRE(traced > 0);
+    REQUIRE(traced < pixelCount / 2);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+
+    session.removeSphere(3);
+    session.render(pool);
+
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+
+    session.moveSphere(2, {-1, 0.5, 1});
+    session.addSphere(scene::SphereData {.centre = {1, 0.25, 2}, .radius = 0.25, .material = 2});
+    session.render(pool);
+
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("a changed material traces the pixels of every shape made of it")
+  {
+    session.changeMaterial(0, scene::MaterialData {.type = scene::MaterialType::metal, .albedo = {0.6, 0.6, 0.6}});
+    auto const traced = session.render(pool);
+
+    REQUIRE(traced > pixelCount / 2);
+    REQUIRE(matches(session.getFramebuffer(), renderAll(pool, session.getDescription(), settings)));
+  }
+
+  SECTION("shapes must refer to materials that exist, and meshes and instances cannot be edited")
+  {
+    auto badShape = scene::parseScene(rowOnPlane);
+    badShape.shapes[0].material = 3;
+    auto withMesh = scene::parseScene(rowOnPlane);
+    withMesh.meshes.push_back(scene::MeshReference {.path = "bunny.obj"});
+    auto withInstance = scene::parseScene(rowOnPlane);
+    withInstance.instances.push_back(scene::InstanceReference {.path = "row.txt"});
+
+    REQUIRE_THROWS_AS(Session(badShape, settings), std::out_of_range);
+    REQUIRE_THROWS_AS(Session(withMesh, settings), std::invalid_argument);
+    REQUIRE_THROWS_AS(Session(withInstance, settings), std::invalid_argument);
+  }
+}
+
+}   // namespace rt::incremental
@@ -0,0 +1,309 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Instance.hpp"
+
+#include "Bvh.hpp"
+#include "HittableList.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include "World.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace rt::instance {
+
+namespace {
+
+bool isClose(double actual, double expected)
+{
+  return std::abs(actual - expected) < 1e-6 * (1 + std::abs(expected));
+}
+
+bool isClose(vec3::Vec3 const& actual, vec3::Vec3 const& expected)
+{
+  return isClose(actual.x(), expected.x()) and isClose(actual.y(), expected.y())
+     and isClose(actual.z(), expected.z());
+}
+
+/// Describe a cluster of spheres around the origin
+scene::Description makeCluster()
+{
+  scene::Description cluster;
+  cluster.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+
+  for (int i = 0; i < 20; ++i) {
+    auto const centre = std::array<double, 3> {
+      getRandomDoubleInRange(-1, 1), getRandomDoubleInRange(-1, 1), getRandomDoubleInRange(-1, 1)};
+    cluster.spheres.push_back(scene::SphereData {.centre = centre, .radius = getRandomDoubleInRange(0.05, 0.3)});
+  }
+
+  return cluster;
+}
+
+}   // namespace
+
+TEST_CASE("Transform", "[Instance]")
+{
+  seedRandom(3);
+
+  auto const transform = Transform::translate(vec3::Vec3(1, 2, 3)) * Transform::rotate(vec3::Vec3(1, 1, 0), 40)
+                       * Transform::scale(vec3::Vec3(2, 0.5, 3));
+
+  SECTION("a rotation turns anticlockwise looking down its axis")
+  {
+    auto const rotation = Transform::rotate(vec3::Vec3(0, 2, 0), 90);
+
+    REQUIRE(isClose(rotation.applyToVector(vec3::Vec3(1, 0, 0)), vec3::Vec3(0, 0, -1)));
+    REQUIRE(isClose(rotation.applyToPoint(ray::Point3(0, 0, 1)), ray::Point3(1, 0, 0)));
+  }
+
+  SECTION("the transforms of a product are applied from the right")
+  {
+    auto const point = transform.applyToPoint(ray::Point3(1, 1, 1));
+
+    REQUIRE(isClose(point, Transform::rotate(vec3::Vec3(1, 1, 0), 40).applyToPoint(ray::Point3(2, 0.5, 3))
+                             + vec3::Vec3(1, 2, 3)));
+  }
+
+  SECTION("the inverse takes points back")
+  {
+    auto const inverse = transform.getInverse();
+
+    for (int i = 0; i < 100; ++i) {
+      auto const point = vec3::Vec3::createRandomVecInRange(-10, 10);
+
+      REQUIRE(isClose(inverse.applyToPoint(transform.applyToPoint(point)), point));
+      REQUIRE(isClose(transform.applyToVector(inverse.applyToVector(point)), point));
+    }
+  }
+
+  SECTION("a transformed box holds the transformed corners")
+  {
+    auto const box = transform.applyToBox(bvh::Box {{-1, -2, -3}, {1, 2, 3}});
+
+    for (auto const x : {-1.0, 1.0}) {
+      for (auto const y : {-2.0, 2.0}) {
+        for (auto const z : {-3.0, 3.0}) {
+          auto const p = transform.applyToPoint(ray::Point3(x, y, z));
+
+          REQUIRE(box.lower[0] <= p.x());
+          REQUIRE(box.lower[1] <= p.y());
+          REQUIRE(box.lower[2] <= p.z());
+          REQUIRE(p.x() <= box.upper[0]);
+          REQUIRE(p.y() <= box.upper[1]);
+          REQUIRE(p.z() <= box.upper[2]);
+        }
+      }
+    }
+  }
+
+  SECTION("a singular transform cannot be inverted")
+  {
+    REQUIRE_THROWS_AS(Transform::scale(vec3::Vec3(1, 0, 1)).getInverse(), std::invalid_argument);
+  }
+}
+
+TEST_CASE("InstanceBvh", "[Instance]")
+{
+  seedRandom(5);
+
+  auto const cluster = makeCluster();
+  auto const geometry = std::make_shared<SphereGeometry const>(cluster);
+
+  // A grid of copies of the cluster, each turned and scaled its own way, and the same spheres written out one by one
+  std::vector<Instance> instances;
+  hittable::HittableList list;
+  scene::Description flattened;
+  flattened.materials = cluster.materials;
+
+  for (int a = -4; a < 4; ++a) {
+    for (int b = -4; b < 4; ++b) {
+      auto const scale = getRandomDoubleInRange(0.5, 1.5);
+      auto const rotation = Transform::rotate(vec3::Vec3::createRandomVecInRange(-1, 1), getRandomDouble() * 360);
+      auto const transform = Transform::translate(vec3::Vec3(3 * a, 0, 3 * b)) * rotation
+                           * Transform::scale(vec3::Vec3(scale, scale, scale));
+
+      instances.emplace_back(geometry, geometry->getBounds(), transform);
+      list.add(new Instance(instances.back()));
+
+      for (auto sphere : cluster.spheres) {
+        auto const centre = transform.applyToPoint(ray::Point3(sphere.centre[0], sphere.centre[1], sphere.centre[2]));
+        sphere.centre = {centre.x(), centre.y(), centre.z()};
+        sphere.radius *= scale;
+        flattened.spheres.push_back(sphere);
+      }
+    }
+  }
+
+  auto const bvh = InstanceBvh(instances);
+  auto const spheres = scene::buildWorld(flattened);
+  auto const sphereCount = cluster.spheres.size();
+
+  SECTION("the instances share one geometry")
+  {
+    // Held here, by every instance, and by every copy of them in the list and the hierarchy
+    REQUIRE(geometry.use_count() == static_cast<long>(3 * instances.size() + 1));
+    REQUIRE(bvh::isValid(bvh.getTree().nodes, bvh.getTree().indices, instances.size()));
+  }
+
+  SECTION("rays hit the instances a linear search hits, where the spheres are")
+  {
+    for (int r = 0; r < 2000; ++r) {
+      auto const origin = ray::Point3(getRandomDoubleInRange(-15, 15), 10, getRandomDoubleInRange(-15, 15));
+      auto const target = ray::Point3(getRandomDoubleInRange(-13, 10), 0, getRandomDoubleInRange(-13, 10));
+      auto const ray = ray::Ray(origin, target - origin);
+      hittable::HitRecord expected;
+      hittable::HitRecord actual;
+      hittable::HitRecord sphere;
+
+      auto const expectedHit = list.hit(ray, 0.001, rt::infinity, expected);
+
+      REQUIRE(bvh.hit(ray, 0.001, rt::infinity, actual) == expectedHit);
+      REQUIRE(spheres.hit(ray, 0.001, rt::infinity, sphere) == expectedHit);
+
+      if (expectedHit) {
+        REQUIRE(actual.t == expected.t);
+        REQUIRE(actual.normal == expected.normal);
+        REQUIRE(sphere.objectIndex / sphereCount == actual.objectIndex);
+        REQUIRE(sphere.objectIndex % sphereCount == expected.objectIndex);
+        REQUIRE(isClose(actual.t, sphere.t));
+        REQUIRE(isClose(actual.point, sphere.point));
+        REQUIRE(isClose(actual.normal, sphere.normal));
+        REQUIRE(actual.frontFace == sphere.frontFace);
+      }
+    }
+  }
+
+  SECTION("every instance a ray is tested against is counted")
+  {
+    auto const before = stats::getThreadCount(stats::Counter::instanceTests);
+    hittable::HitRecord record;
+
+    list.hit(ray::Ray(ray::Point3(0, 10, 0), vec3::Vec3(0, -1, 0)), 0.001, rt::infinity, record);
+
+    REQUIRE(stats::getThreadCount(stats::Counter::instanceTests) - before == instances.size());
+    REQUIRE(stats::getThreadTestCount() > stats::getThreadCount(stats::Counter::sphereTests));
+  }
+
+  SECTION("nothing is hit without instances")
+  {
+    auto const empty = InstanceBvh({});
+    hittable::HitRecord record;
+
+    REQUIRE_FALSE(empty.hit(ray::Ray(ray::Point3(0, 10, 0), vec3::Vec3(0, -1, 0)), 0.001, rt::infinity, record));
+  }
+}
+
+TEST_CASE("instances in scene files", "[Instance]")
+{
+  seedRandom(7);
+
+  auto const directory = std::filesystem::temp_directory_path() / "rt-instance-test";
+  std::filesystem::create_directories(directory);
+  auto const cluster = makeCluster();
+  {
+    std::ofstream out(directory / "cluster.txt");
+    scene::writeScene(out, cluster);
+  }
+
+  // A ground sphere and a row of copies of the cluster, and the same spheres written out one by one
+  std::ostringstream text;
+  text << "lambertian 0.5 0.5 0.5\nsphere 0 -100 0 98 0\n";
+  scene::Description flattened;
+  flattened.materials = cluster.materials;
+  flattened.spheres.push_back(scene::SphereData {.centre = {0, -100, 0}, .radius = 98});
+
+  for (int a = -3; a < 3; ++a) {
+    // Written in full, so that the file places the copies exactly where the transforms below do
+    auto const scale = 1 + (0.125 * a);
+    auto const degrees = 50.0 * (a + 3);
+    text << "instance cluster.txt " << 3 * a << " 0 0  1 1 0  " << degrees << ' ' << scale << '\n';
+    auto const transform = Transform::translate(vec3::Vec3(3 * a, 0, 0))
+                         * Transform::rotate(vec3::Vec3(1, 1, 0), degrees)
+                         * Transform::scale(vec3::Vec3(scale, scale, scale));
+
+    for (auto sphere : cluster.spheres) {
+      auto const centre = transform.applyToPoint(ray::Point3(sphere.centre[0], sphere.centre[1], sphere.centre[2]));
+      sphere.centre = {centre.x(), centre.y(), centre.z()};
+      sphere.radius *= scale;
+      flattened.spheres.push_back(sphere);
+    }
+  }
+
+  std::ofstream(directory / "scene.txt") << text.str();
+
+  SECTION("rays hit the instances where the spheres are, and every instance has an object index of its own")
+  {
+    auto const world = world::World::load(directory / "scene.txt", {});
+    auto const spheres = scene::buildWorld(flattened);
+    auto const sphereCount = cluster.spheres.size();
+
+    REQUIRE(world->getInstanceHashes().size() == 6);
+    REQUIRE(world->getInstanceHashes()[0] == world->getInstanceHashes()[5]);
+
+    for (int r = 0; r < 2000; ++r) {
+      auto const origin = ray::Point3(getRandomDoubleInRange(-12, 12), 10, getRandomDoubleInRange(-3, 3));
+      auto const target = ray::Point3(getRandomDoubleInRange(-11, 9), 0, getRandomDoubleInRange(-2, 2));
+      auto const ray = ray::Ray(origin, target - origin);
+      hittable::HitRecord actual;
+      hittable::HitRecord sphere;
+
+      auto const expectedHit = spheres.hit(ray, 0.001, rt::infinity, sphere);
+
+      REQUIRE(world->getHittable().hit(ray, 0.001, rt::infinity, actual) == expectedHit);
+
+      if (expectedHit) {
+        REQUIRE(isClose(actual.t, sphere.t));
+        REQUIRE(isClose(actual.point, sphere.point));
+        REQUIRE(isClose(actual.normal, sphere.normal));
+        REQUIRE(actual.objectIndex == (sphere.objectIndex == 0 ? 0 : 1 + ((sphere.objectIndex - 1) / sphereCount)));
+      }
+    }
+  }
+
+  SECTION("instanced scenes must hold spheres and nothing else")
+  {
+    std::ofstream(directory / "ground.txt") << "lambertian 0.5 0.5 0.5\nplane 0 0 0  0 1 0  0\n";
+    std::ofstream(directory / "planted.txt") << "instance ground.txt 0 0 0  0 1 0  0 1\n";
+    std::ofstream(directory / "missing.txt") << "instance nowhere.txt 0 0 0  0 1 0  0 1\n";
+
+    REQUIRE_THROWS_AS(world::World::load(directory / "planted.txt", {}), std::runtime_error);
+    REQUIRE_THROWS_AS(world::World::load(directory / "missing.txt", {}), std::runtime_error);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+}   // namespace rt::instance
@@ -25,7 +25,10 @@
 #include "Main.hpp"
 
 #include "Ray.hpp"
+#include "Scene.hpp"
+#include "Utilities.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <thread>
 
 namespace rt {
 
@@ -39,4 +42,22 @@ TEST_CASE("rayHasHitSphere")
   REQUIRE(rayHasHitSphere(sphereCentre, radius, ray) == true);
 }
 
+TEST_CASE("describeRandomScene", "[Main]")
+{
+  SECTION("after resetRandom the scene is the one a new thread draws")
+  {
+    auto fresh = scene::Description();
+    std::jthread([&fresh] { fresh = describeRandomScene(); }).join();
+
+    seedRandom(7, 3);
+    getRandomDouble();
+    resetRandom();
+    auto const reset = describeRandomScene();
+
+    REQUIRE(reset.spheres.size() == fresh.spheres.size());
+    REQUIRE(reset.spheres.front().centre == fresh.spheres.front().centre);
+    REQUIRE(reset.materials.back().albedo == fresh.materials.back().albedo);
+  }
+}
+
 }   // namespace rt
@@ -0,0 +1,371 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Mesh.hpp"
+
+#include "Colour.hpp"
+#include "Lambertian.hpp"
+#include "Ray.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include "World.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rt::mesh {
+
+namespace {
+
+constexpr auto square = R"(# A unit square in two triangles and a quad
+o square
+v 0 0 0
+v 1 0 0
+v 1 1 0
+v 0 1 0
+vn 0 0 1
+f 1 2 3
+f 1/1/1 3//1 -1
+f -4 -3 -2 -1
+)";
+
+/// Write a square in the binary PLY format, in either byte order
+std::string makeBinaryPly(bool bigEndian)
+{
+  std::string bytes = std::string("ply\nformat ") + (bigEndian ? "binary_big_endian" : "binary_little_endian")
+                    + " 1.0\nelement vertex 4\nproperty float x\nproperty float y\nproperty float z\n"
+                      "property uchar red\nelement face 1\nproperty list uchar int vertex_indices\nend_header\n";
+
+  auto const append = [&]<typename T>(T value) {
+    auto raw = std::bit_cast<std::array<char, sizeof(T)>>(value);
+
+    if (bigEndian != (std::endian::native == std::endian::big)) {
+      std::ranges::reverse(raw);
+    }
+
+    bytes.append(raw.data(), raw.size());
+  };
+
+  for (auto const& position : {std::array<float, 3> {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}}) {
+    append(position[0]);
+    append(position[1]);
+    append(position[2]);
+    append(std::uint8_t {255});
+  }
+
+  append(std::uint8_t {4});
+
+  for (std::int32_t const index : {0, 1, 2, 3}) {
+    append(index);
+  }
+
+  return bytes;
+}
+
+/// A grid of squares in the plane z = 0, from 0 to size along x and y, each split into two triangles
+MeshData makeGrid(std::uint32_t size)
+{
+  MeshData grid;
+
+  for (std::uint32_t y = 0; y <= size; ++y) {
+    for (std::uint32_t x = 0; x <= size; ++x) {
+      grid.positions.push_back({static_cast<float>(x), static_cast<float>(y), 0});
+    }
+  }
+
+  for (std::uint32_t y = 0; y < size; ++y) {
+    for (std::uint32_t x = 0; x < size; ++x) {
+      auto const corner = (y * (size + 1)) + x;
+      grid.triangles.push_back({corner, corner + 1, corner + size + 2});
+      grid.triangles.push_back({corner, corner + size + 2, corner + size + 1});
+    }
+  }
+
+  return grid;
+}
+
+}   // namespace
+
+TEST_CASE("parseObj", "[Mesh]")
+{
+  SECTION("faces are split into triangles and refer to the vertices they name")
+  {
+    auto const mesh = parseObj(square);
+
+    REQUIRE(mesh.positions.size() == 4);
+    REQUIRE(mesh.positions[2] == std::array<float, 3> {1, 1, 0});
+    REQUIRE(mesh.triangles.size() == 4);
+    REQUIRE(mesh.triangles[1] == std::array<std::uint32_t, 3> {0, 2, 3});
+    REQUIRE(mesh.triangles[2] == std::array<std::uint32_t, 3> {0, 1, 2});
+    REQUIRE(mesh.triangles[3] == std::array<std::uint32_t, 3> {0, 2, 3});
+  }
+
+  SECTION("errors name the offending line")
+  {
+    auto const message = [](std::string_view text) {
+      try {
+        parseObj(text);
+      }
+      catch (std::runtime_error const& error) {
+        return std::string(error.what());
+      }
+
+      return std::string();
+    };
+
+    REQUIRE(message("v 0 0 0\nv 1 0 0\nf 1 2 3\n") == "line 3: vertex 3 has not been declared");
+    REQUIRE(message("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 0\n") == "line 4: vertex 0 has not been declared");
+    REQUIRE(message("v 0 zero 0\n") == "line 1: expected a vertex coordinate");
+    REQUIRE(message("v 0 0 0\nv 1 0 0\n\nf 1 2\n") == "line 4: a face needs at least three vertices");
+    REQUIRE(message("v 0 0 0\nf 1 a 1\n") == "line 2: expected a vertex index, got 'a'");
+  }
+}
+
+TEST_CASE("parsePly", "[Mesh]")
+{
+  auto const expected = parseObj("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n");
+
+  SECTION("every encoding reads the same mesh")
+  {
+    auto const ascii = parsePly("ply\nformat ascii 1.0\ncomment a square\nelement vertex 4\nproperty float x\n"
+                                "property float y\nproperty float z\nelement face 1\n"
+                                "property list uchar uint vertex_indices\nend_header\n"
+                                "0 0 0\n1 0 0\n1 1 0\n0 1 0\n4 0 1 2 3\n");
+
+    for (auto const& mesh : {ascii, parsePly(makeBinaryPly(false)), parsePly(makeBinaryPly(true))}) {
+      REQUIRE(mesh.positions == expected.positions);
+      REQUIRE(mesh.triangles == expected.triangles);
+    }
+  }
+
+  SECTION("files that are not valid are rejected")
+  {
+    auto const truncated = makeBinaryPly(false);
+
+    REQUIRE_THROWS_AS(parsePly(truncated.substr(0, truncated.size() - 2)), std::runtime_error);
+    REQUIRE_THROWS_AS(parsePly("ply\nformat ascii 1.0\nelement vertex 1\nproperty half x\nend_header\n0\n"),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(parsePly("ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nend_header\n0\n"),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(parsePly("solid square\n"), std::runtime_error);
+  }
+
+  SECTION("counts the data cannot hold are rejected before anything is read")
+  {
+    auto const face = [](std::string_view countType, std::string_view indices) {
+      return parsePly("ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\n"
+                      "property float z\nelement face 1\nproperty list "
+                      + std::string(countType) + " uint vertex_indices\nend_header\n0 0 0\n1 0 0\n1 1 0\n"
+                      + std::string(indices) + "\n");
+    };
+
+    REQUIRE(face("uchar", "3 0 1 2").triangles.size() == 1);
+    REQUIRE_THROWS_AS(face("int", "-1 0 1 2"), std::runtime_error);
+    REQUIRE_THROWS_AS(face("float", "2.5 0 1 2"), std::runtime_error);
+    REQUIRE_THROWS_AS(face("float", "nan 0 1 2"), std::runtime_error);
+    REQUIRE_THROWS_AS(face("double", "1e300 0 1 2"), std::runtime_error);
+    REQUIRE_THROWS_AS(parsePly("ply\nformat binary_little_endian 1.0\nelement vertex 4000000000000000\n"
+                               "property float x\nproperty float y\nproperty float z\nend_header\n"),
+                      std::runtime_error);
+  }
+}
+
+TEST_CASE("TriangleMesh", "[Mesh]")
+{
+  auto material = material::Lambertian(colour::Colour(0.5, 0.5, 0.5));
+
+  SECTION("triangles must refer to vertices that exist")
+  {
+    auto data = parseObj(square);
+    data.triangles[1][2] = 4;
+
+    REQUIRE_THROWS_AS(TriangleMesh(data, &material), std::out_of_range);
+  }
+
+  SECTION("rays through the edges and vertices the triangles share hit the mesh")
+  {
+    static constexpr std::uint32_t size = 8;
+    auto const mesh = TriangleMesh(makeGrid(size), &material);
+    hittable::HitRecord record;
+
+    REQUIRE(mesh.getTriangleCount() == 2 * size * size);
+
+    // Every ray passes through a vertex, the middle of an edge or the middle of a diagonal, from straight above and
+    // at a slant
+    for (std::uint32_t y = 1; y < 2 * size; ++y) {
+      for (std::uint32_t x = 1; x < 2 * size; ++x) {
+        auto const target = ray::Point3(0.5 * x, 0.5 * y, 0);
+
+        for (auto const& direction : {vec3::Vec3(0, 0, -1), vec3::Vec3(0.3, -0.2, -1), vec3::Vec3(-0.7, 0.1, 1)}) {
+          auto const ray = ray::Ray(target - (3 * direction), direction);
+
+          REQUIRE(mesh.hit(ray, 0.001, rt::infinity, record));
+          REQUIRE(std::abs(record.t - 3) < 1e-6);
+          REQUIRE(vec3::getDotProduct(record.normal, direction) < 0);
+          REQUIRE(record.materialPtr == &material);
+        }
+      }
+    }
+  }
+
+  SECTION("only the triangles of the leaves a ray reaches are tested and counted")
+  {
+    auto const mesh = TriangleMesh(makeGrid(8), &material);
+    auto const before = stats::getThreadCount(stats::Counter::triangleTests);
+    hittable::HitRecord record;
+
+    REQUIRE_FALSE(mesh.hit(ray::Ray(ray::Point3(20, 20, 1), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity, record));
+    REQUIRE(stats::getThreadCount(stats::Counter::triangleTests) == before);
+
+    REQUIRE(mesh.hit(ray::Ray(ray::Point3(2.2, 3.7, 1), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity, record));
+
+    auto const tests = stats::getThreadCount(stats::Counter::triangleTests) - before;
+    REQUIRE(tests > 0);
+    REQUIRE(tests < mesh.getTriangleCount());
+  }
+
+  SECTION("the hierarchy finds the triangle testing every triangle finds")
+  {
+    seedRandom(7);
+
+    MeshData soup;
+
+    for (std::uint32_t i = 0; i < 500; ++i) {
+      auto const centre = vec3::Vec3::createRandomVecInRange(-5, 5);
+
+      for (int corner = 0; corner < 3; ++corner) {
+        auto const position = centre + (0.5 * vec3::Vec3::createRandomVecInRange(-1, 1));
+        soup.positions.push_back(
+          {static_cast<float>(position.x()), static_cast<float>(position.y()), static_cast<float>(position.z())});
+      }
+
+      soup.triangles.push_back({3 * i, (3 * i) + 1, (3 * i) + 2});
+    }
+
+    auto const mesh = TriangleMesh(soup, &material);
+    std::vector<TriangleMesh> triangles;
+
+    for (auto const& triangle : soup.triangles) {
+      triangles.emplace_back(MeshData {.positions = soup.positions, .triangles = {triangle}}, &material);
+    }
+
+    for (int i = 0; i < 200; ++i) {
+      auto const ray = ray::Ray(vec3::Vec3::createRandomVecInRange(-8, 8), vec3::Vec3::createRandomVecInRange(-1, 1));
+      hittable::HitRecord record;
+      auto nearest = rt::infinity;
+
+      for (auto const& triangle : triangles) {
+        hittable::HitRecord single;
+
+        if (triangle.hit(ray, 0.001, nearest, single)) {
+          nearest = single.t;
+        }
+      }
+
+      REQUIRE(mesh.hit(ray, 0.001, rt::infinity, record) == (nearest != rt::infinity));
+
+      if (nearest != rt::infinity) {
+        REQUIRE(std::abs(record.t - nearest) < 1e-6);
+      }
+    }
+  }
+}
+
+TEST_CASE("loadMesh", "[Mesh]")
+{
+  auto const directory = std::filesystem::temp_directory_path() / "rt-mesh-test";
+  std::filesystem::create_directories(directory);
+  std::ofstream(directory / "square.obj") << square;
+  std::ofstream(directory / "square.ply", std::ios::binary) << makeBinaryPly(true);
+  std::ofstream(directory / "square.stl") << "solid square\n";
+
+  SECTION("files are read by their extension")
+  {
+    REQUIRE(loadMesh(directory / "square.obj").triangles.size() == 4);
+    REQUIRE(loadMesh(directory / "square.ply").triangles.size() == 2);
+    REQUIRE_THROWS_AS(loadMesh(directory / "square.stl"), std::runtime_error);
+    REQUIRE_THROWS_AS(loadMesh(directory / "missing.obj"), std::runtime_error);
+  }
+
+  SECTION("scenes load their meshes relative to the scene file")
+  {
+    std::ofstream(directory / "scene.txt") << "lambertian 0.5 0.5 0.5\nsphere 0 0 -5 1 0\nmesh square.obj 0\n";
+    auto const world = world::World::load(directory / "scene.txt", {});
+    hittable::HitRecord record;
+
+    REQUIRE(world->getHittable().hit(ray::Ray(ray::Point3(0.5, 0.5, 1), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity,
+                                     record));
+    REQUIRE(record.t == 1);
+    REQUIRE(world->getHittable().hit(ray::Ray(ray::Point3(0, 0, -2), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity,
+                                     record));
+    REQUIRE(record.t == 2);
+  }
+
+  SECTION("spheres, shapes and the triangles of every mesh have object indices of their own")
+  {
+    std::ofstream(directory / "near.obj") << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 3 4\n";
+    std::ofstream(directory / "far.obj") << "v 10 0 0\nv 11 0 0\nv 11 1 0\nv 10 1 0\nf 1 2 3\nf 1 3 4\n";
+    std::ofstream(directory / "scene.txt") << "lambertian 0.5 0.5 0.5\n"
+                                              "sphere 0 5 -5 1 0\n"
+                                              "sphere 3 5 -5 1 0\n"
+                                              "box -1 -6 -1  1 -4 1  0\n"
+                                              "mesh near.obj 0\n"
+                                              "mesh far.obj 0\n";
+    auto const world = world::World::load(directory / "scene.txt", {});
+
+    // Straight down onto each sphere, the box, and either triangle of each square
+    auto const targets = std::vector<std::array<double, 2>> {
+      {0, 5}, {3, 5}, {0, -5}, {0.75, 0.25}, {0.25, 0.75}, {10.75, 0.25}, {10.25, 0.75}};
+    std::vector<ray::Ray> rays;
+
+    for (auto const& [x, y] : targets) {
+      rays.emplace_back(ray::Point3(x, y, 5), vec3::Vec3(0, 0, -1));
+    }
+
+    std::vector<hittable::HitRecord> records(rays.size());
+    world->getHittable().hitStream(rays, 0.001, std::vector<Scalar>(rays.size(), rt::infinity), records);
+
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+      hittable::HitRecord record;
+
+      REQUIRE(world->getHittable().hit(rays[r], 0.001, rt::infinity, record));
+      REQUIRE(record.objectIndex == r);
+      REQUIRE(records[r].objectIndex == r);
+    }
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+}   // namespace rt::mesh
@@ -0,0 +1,134 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Options.hpp"
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rt::options {
+
+TEST_CASE("parseOptions", "[Options]")
+{
+  SECTION("AOVs are disabled when no arguments are given")
+  {
+    auto const options = parseOptions({});
+
+    REQUIRE(options.aovPrefix.empty());
+  }
+
+  SECTION("--aov sets the AOV path prefix")
+  {
+    constexpr auto args = std::array<std::string_view, 2> {"--aov", "out/frame"};
+    auto const options = parseOptions(args);
+
+    REQUIRE(options.aovPrefix == "out/frame");
+  }
+
+  SECTION("--perf-counters enables the hardware counters")
+  {
+    constexpr auto args = std::array<std::string_view, 1> {"--perf-counters"};
+
+    REQUIRE_FALSE(parseOptions({}).perfCounters);
+    REQUIRE(parseOptions(args).perfCounters);
+  }
+
+  SECTION("--serve sets the socket path")
+  {
+    constexpr auto args = std::array<std::string_view, 2> {"--serve", "/tmp/rt.sock"};
+
+    REQUIRE(parseOptions({}).servePath.empty());
+    REQUIRE(parseOptions(args).servePath == "/tmp/rt.sock");
+  }
+
+  SECTION("--workers splits the worker addresses")
+  {
+    constexpr auto args = std::array<std::string_view, 2> {"--workers", "/tmp/a.sock,,localhost:7000"};
+    auto const options = parseOptions(args);
+
+    REQUIRE(options.workerAddresses == std::vector<std::string> {"/tmp/a.sock", "localhost:7000"});
+  }
+
+  SECTION("--packet sets the packet size")
+  {
+    constexpr auto args = std::array<std::string_view, 2> {"--packet", "8"};
+    constexpr auto odd = std::array<std::string_view, 2> {"--packet", "6"};
+
+    REQUIRE(parseOptions({}).packetSize == 0);
+    REQUIRE(parseOptions(args).packetSize == 8);
+    REQUIRE_THROWS_AS(parseOptions(odd), std::invalid_argument);
+  }
+
+  SECTION("--integrator selects how paths are traced")
+  {
+    constexpr auto args = std::array<std::string_view, 2> {"--integrator", "wavefront"};
+    constexpr auto bogus = std::array<std::string_view, 2> {"--integrator", "bidirectional"};
+
+    REQUIRE(parseOptions({}).integrator == render::Integrator::path);
+    REQUIRE(parseOptions(args).integrator == render::Integrator::wavefront);
+    REQUIRE_THROWS_AS(parseOptions(bogus), std::invalid_argument);
+  }
+
+  SECTION("--batch and --sort-rays configure the wavefront integrator")
+  {
+    constexpr auto args = std::array<std::string_view, 3> {"--batch", "4096", "--sort-rays"};
+    constexpr auto empty = std::array<std::string_view, 2> {"--batch", "0"};
+
+    REQUIRE_FALSE(parseOptions({}).batchSize.has_value());
+    REQUIRE_FALSE(parseOptions({}).sortRays);
+    REQUIRE(parseOptions(args).batchSize == 4096);
+    REQUIRE(parseOptions(args).sortRays);
+    REQUIRE_THROWS_AS(parseOptions(empty), std::invalid_argument);
+  }
+
+  SECTION("--isa overrides the detected instruction set")
+  {
+    constexpr auto args = std::array<std::string_view, 2> {"--isa", "avx2"};
+    constexpr auto bogus = std::array<std::string_view, 2> {"--isa", "sse9"};
+
+    REQUIRE_FALSE(parseOptions({}).isa.has_value());
+    REQUIRE(parseOptions(args).isa == dispatch::Isa::avx2);
+    REQUIRE_THROWS_AS(parseOptions(bogus), std::invalid_argument);
+  }
+
+  SECTION("a flag without its value is rejected")
+  {
+    constexpr auto args = std::array<std::string_view, 1> {"--aov"};
+
+    REQUIRE_THROWS_AS(parseOptions(args), std::invalid_argument);
+  }
+
+  SECTION("unknown arguments are rejected")
+  {
+    constexpr auto args = std::array<std::string_view, 1> {"--bogus"};
+
+    REQUIRE_THROWS_AS(parseOptions(args), std::invalid_argument);
+  }
+}
+
+}   // namespace rt::options
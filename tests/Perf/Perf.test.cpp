@@ -0,0 +1,130 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Perf.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+
+namespace rt::perf {
+
+namespace {
+
+/// Make counts in which every event is measured
+Counts makeCounts(std::uint64_t cycles, std::uint64_t instructions)
+{
+  Counts counts;
+  counts.measured.fill(true);
+  counts.values[static_cast<std::size_t>(Event::cycles)] = cycles;
+  counts.values[static_cast<std::size_t>(Event::instructions)] = instructions;
+
+  return counts;
+}
+
+}   // namespace
+
+TEST_CASE("Counts", "[Perf]")
+{
+  SECTION("differences and sums are taken per event")
+  {
+    auto const difference = makeCounts(150, 400) - makeCounts(100, 100);
+
+    REQUIRE(difference[Event::cycles] == 50);
+    REQUIRE(difference[Event::instructions] == 300);
+
+    auto sum = difference;
+    sum += makeCounts(10, 20);
+
+    REQUIRE(sum[Event::cycles] == 60);
+    REQUIRE(sum[Event::instructions] == 320);
+  }
+
+  SECTION("an event is only measured if it was measured on both sides")
+  {
+    auto partial = makeCounts(10, 10);
+    partial.measured[static_cast<std::size_t>(Event::llcMisses)] = false;
+
+    REQUIRE_FALSE((makeCounts(20, 20) - partial).isMeasured(Event::llcMisses));
+    REQUIRE((makeCounts(20, 20) - partial).isMeasured(Event::cycles));
+  }
+}
+
+TEST_CASE("ThreadCounters", "[Perf]")
+{
+  SECTION("counters that cannot be opened are reported rather than thrown")
+  {
+    ThreadCounters counters;
+    auto const counts = counters.read();
+
+    if (not counters.isOpen()) {
+      REQUIRE_FALSE(counters.getError().empty());
+      REQUIRE_FALSE(counts.isMeasured(Event::cycles));
+    }
+  }
+}
+
+TEST_CASE("Report", "[Perf]")
+{
+  SECTION("tiles are summed per thread and in total")
+  {
+    Report report;
+    report.addTile(0, 0, makeCounts(100, 200));
+    report.addTile(1, 1, makeCounts(300, 300));
+    report.addTile(2, 0, makeCounts(50, 100));
+
+    auto const threads = report.getThreadTotals();
+
+    REQUIRE(threads.size() == 2);
+    REQUIRE(threads[0][Event::cycles] == 150);
+    REQUIRE(threads[1][Event::cycles] == 300);
+    REQUIRE(report.getTotal()[Event::instructions] == 600);
+  }
+
+  SECTION("the summary explains why nothing was counted")
+  {
+    Report report;
+    report.addError("cycles: No such file or directory");
+    report.addTile(0, 0, Counts());
+
+    std::ostringstream out;
+    report.writeSummary(out);
+
+    REQUIRE(out.str().find("unavailable (cycles: No such file or directory)") != std::string::npos);
+  }
+
+  SECTION("the summary lists the tiles with the most cycles")
+  {
+    Report report;
+    report.addTile(0, 0, makeCounts(100, 200));
+    report.addTile(7, 0, makeCounts(900, 200));
+
+    std::ostringstream out;
+    report.writeSummary(out, 1);
+
+    REQUIRE(out.str().find("tile 7") != std::string::npos);
+    REQUIRE(out.str().find("tile 0") == std::string::npos);
+  }
+}
+
+}   // namespace rt::perf
@@ -0,0 +1,233 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Plane.hpp"
+
+#include "Bvh.hpp"
+#include "Colour.hpp"
+#include "HittableList.hpp"
+#include "Lambertian.hpp"
+#include "Packet.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "Sphere.hpp"
+#include "Stats.hpp"
+#include "Utilities.hpp"
+#include "Vec3.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace rt::plane {
+
+namespace {
+
+bool isClose(vec3::Vec3 const& actual, vec3::Vec3 const& expected)
+{
+  return (actual - expected).length() < 1e-6;
+}
+
+}   // namespace
+
+TEST_CASE("hitShape", "[Plane]")
+{
+  hittable::HitRecord record;
+
+  SECTION("a plane is hit from either side, facing the ray")
+  {
+    auto const ground = scene::ShapeData {.type = scene::ShapeType::plane, .point = {0, 1, 0}, .vector = {0, 1, 0}};
+
+    REQUIRE(hitShape(ground, ray::Ray(ray::Point3(3, 5, -2), vec3::Vec3(1, -2, 0)), 0.001, rt::infinity, record));
+    REQUIRE(std::abs(record.t - 2) < 1e-6);
+    REQUIRE(isClose(record.point, ray::Point3(5, 1, -2)));
+    REQUIRE(record.frontFace);
+    REQUIRE(record.normal == vec3::Vec3(0, 1, 0));
+
+    REQUIRE(hitShape(ground, ray::Ray(ray::Point3(0, -1, 0), vec3::Vec3(0, 1, 0)), 0.001, rt::infinity, record));
+    REQUIRE_FALSE(record.frontFace);
+    REQUIRE(record.normal == vec3::Vec3(0, -1, 0));
+
+    REQUIRE_FALSE(hitShape(ground, ray::Ray(ray::Point3(0, 2, 0), vec3::Vec3(1, 0, 0)), 0.001, rt::infinity, record));
+    REQUIRE_FALSE(hitShape(ground, ray::Ray(ray::Point3(0, 2, 0), vec3::Vec3(0, 1, 0)), 0.001, rt::infinity, record));
+    REQUIRE_FALSE(hitShape(ground, ray::Ray(ray::Point3(0, 2, 0), vec3::Vec3(0, -1, 0)), 0.001, 0.5, record));
+  }
+
+  SECTION("a disk is hit within its radius")
+  {
+    auto const disk = Shape(scene::ShapeData {.type = scene::ShapeType::disk, .vector = {0, 0, 3}, .radius = 1},
+                            new material::Lambertian(colour::Colour(0.5, 0.5, 0.5)));
+
+    REQUIRE(disk.hit(ray::Ray(ray::Point3(0.5, 0.5, 2), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity, record));
+    REQUIRE(record.normal == vec3::Vec3(0, 0, 1));
+    REQUIRE(record.materialPtr != nullptr);
+    REQUIRE_FALSE(disk.hit(ray::Ray(ray::Point3(0.8, 0.8, 2), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity, record));
+  }
+
+  SECTION("a box is entered through the face towards the ray, and left from within")
+  {
+    auto const box = scene::ShapeData {.type = scene::ShapeType::box, .point = {-1, 0, -2}, .vector = {1, 1, 2}};
+
+    REQUIRE(hitShape(box, ray::Ray(ray::Point3(5, 0.5, 0), vec3::Vec3(-1, 0, 0)), 0.001, rt::infinity, record));
+    REQUIRE(std::abs(record.t - 4) < 1e-6);
+    REQUIRE(record.frontFace);
+    REQUIRE(record.normal == vec3::Vec3(1, 0, 0));
+
+    REQUIRE(hitShape(box, ray::Ray(ray::Point3(0.5, 3, 0.5), vec3::Vec3(0, -1, 0)), 0.001, rt::infinity, record));
+    REQUIRE(std::abs(record.t - 2) < 1e-6);
+    REQUIRE(record.normal == vec3::Vec3(0, 1, 0));
+
+    REQUIRE(hitShape(box, ray::Ray(ray::Point3(0, 0.5, 0), vec3::Vec3(0, 0, 1)), 0.001, rt::infinity, record));
+    REQUIRE(std::abs(record.t - 2) < 1e-6);
+    REQUIRE_FALSE(record.frontFace);
+    REQUIRE(record.normal == vec3::Vec3(0, 0, -1));
+
+    REQUIRE_FALSE(hitShape(box, ray::Ray(ray::Point3(5, 2, 0), vec3::Vec3(-1, 0, 0)), 0.001, rt::infinity, record));
+    REQUIRE_FALSE(hitShape(box, ray::Ray(ray::Point3(5, 0.5, 0), vec3::Vec3(1, 0, 0)), 0.001, rt::infinity, record));
+  }
+
+  SECTION("every test is counted, whether it hits or not")
+  {
+    auto const ground = scene::ShapeData {.type = scene::ShapeType::plane, .vector = {0, 1, 0}};
+    auto const before = stats::getThreadCount(stats::Counter::shapeTests);
+
+    hitShape(ground, ray::Ray(ray::Point3(0, 1, 0), vec3::Vec3(0, -1, 0)), 0.001, rt::infinity, record);
+    hitShape(ground, ray::Ray(ray::Point3(0, 1, 0), vec3::Vec3(0, 1, 0)), 0.001, rt::infinity, record);
+
+    REQUIRE(stats::getThreadCount(stats::Counter::shapeTests) - before == 2);
+  }
+}
+
+TEST_CASE("ShapeList", "[Plane]")
+{
+  seedRandom(5);
+
+  scene::Description scene;
+  scene.materials.push_back(scene::MaterialData {.albedo = {0.5, 0.5, 0.5}});
+  scene.materials.push_back(scene::MaterialData {.albedo = {0.9, 0.1, 0.1}});
+
+  for (int i = 0; i < 60; ++i) {
+    auto const centre = std::array<double, 3> {
+      getRandomDoubleInRange(-6, 6), getRandomDoubleInRange(-1, 4), getRandomDoubleInRange(-6, 6)};
+    scene.spheres.push_back(scene::SphereData {.centre = centre, .radius = 0.4, .material = 1});
+  }
+
+  scene.shapes.push_back(scene::ShapeData {.type = scene::ShapeType::plane, .vector = {0, 1, 0}});
+  scene.shapes.push_back(
+    scene::ShapeData {.type = scene::ShapeType::disk, .point = {0, 2, -7}, .vector = {0, 0.5, 1}, .radius = 3});
+  scene.shapes.push_back(
+    scene::ShapeData {.type = scene::ShapeType::box, .material = 1, .point = {2, -1, 2}, .vector = {4, 1.5, 3}});
+
+  auto const tree = bvh::build(scene.spheres);
+  auto const materials = scene::MaterialTable(scene.materials);
+  auto const bvh = bvh::SphereBvh(scene.spheres, tree.nodes, tree.indices, materials.getMaterials());
+  auto const shapes = ShapeList(scene.shapes, materials.getMaterials(), bvh, scene.spheres.size());
+
+  // The same objects one by one, with the indices of the shapes following those of the spheres
+  hittable::HittableList list;
+
+  for (std::size_t i = 0; i < scene.spheres.size(); ++i) {
+    auto const& sphere = scene.spheres[i];
+    list.add(new sphere::Sphere(ray::Point3(sphere.centre[0], sphere.centre[1], sphere.centre[2]), sphere.radius,
+                                new material::Lambertian(colour::Colour(0.5, 0.5, 0.5)), i));
+  }
+
+  for (std::size_t i = 0; i < scene.shapes.size(); ++i) {
+    list.add(new Shape(scene.shapes[i], new material::Lambertian(colour::Colour(0.5, 0.5, 0.5)),
+                       scene.spheres.size() + i));
+  }
+
+  std::vector<ray::Ray> rays;
+
+  for (int r = 0; r < 512; ++r) {
+    rays.emplace_back(vec3::Vec3::createRandomVecInRange(-8, 8), vec3::Vec3::createRandomVecInRange(-1, 1));
+  }
+
+  SECTION("rays find what testing every object finds")
+  {
+    for (auto const& ray : rays) {
+      hittable::HitRecord record;
+      hittable::HitRecord expected;
+      auto const hit = shapes.hit(ray, 0.001, rt::infinity, record);
+
+      REQUIRE(hit == list.hit(ray, 0.001, rt::infinity, expected));
+
+      if (hit) {
+        REQUIRE(record.objectIndex == expected.objectIndex);
+        REQUIRE(std::abs(record.t - expected.t) < 1e-6);
+      }
+    }
+  }
+
+  SECTION("packets and streams find the hits of their rays traced alone")
+  {
+    std::vector<hittable::HitRecord> records(rays.size());
+    auto const hits = shapes.hitStream(rays, 0.001, std::vector<Scalar>(rays.size(), rt::infinity), records);
+    std::size_t expectedHits = 0;
+
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+      hittable::HitRecord expected;
+
+      if (shapes.hit(rays[r], 0.001, rt::infinity, expected)) {
+        ++expectedHits;
+        REQUIRE(records[r].t == expected.t);
+        REQUIRE(records[r].objectIndex == expected.objectIndex);
+        REQUIRE(records[r].materialPtr == expected.materialPtr);
+      }
+      else {
+        REQUIRE(records[r].t == rt::infinity);
+      }
+    }
+
+    REQUIRE(hits == expectedHits);
+
+    auto packet = packet::RayPacket();
+    packet.size = 16;
+    std::array<hittable::HitRecord, packet::maxSize> packetRecords;
+
+    for (std::size_t first = 0; first < rays.size(); first += packet.size) {
+      packet.active = 0;
+
+      for (std::size_t lane = 0; lane < packet.size; ++lane) {
+        packet.set(lane, rays[first + lane]);
+      }
+
+      auto const mask = shapes.hitPacket(packet, 0.001, rt::infinity, packetRecords);
+
+      for (std::size_t lane = 0; lane < packet.size; ++lane) {
+        auto const& expected = records[first + lane];
+
+        REQUIRE(((mask >> lane) & 1) == (expected.t != rt::infinity ? 1U : 0U));
+
+        if (expected.t != rt::infinity) {
+          REQUIRE(packetRecords[lane].t == expected.t);
+          REQUIRE(packetRecords[lane].objectIndex == expected.objectIndex);
+        }
+      }
+    }
+  }
+}
+
+}   // namespace rt::plane
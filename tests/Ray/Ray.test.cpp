@@ -24,8 +24,11 @@
 
 #include "Ray.hpp"
 
+#include "Hittable.hpp"
+#include "Sphere.hpp"
 #include "Vec3.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
 
 namespace rt::ray {
 
@@ -46,5 +49,31 @@ TEST_CASE("at gets the point a given distance from the ray origin", "[Ray]")
 
     REQUIRE((ray.at(2) == vec3::Vec3(9, 12, 15)) == true);
   }
+
+  SECTION("The time of a ray does not move its points")
+  {
+    constexpr auto ray = Ray(Point3(1, 2, 3), vec3::Vec3(4, 5, 6), 0.5);
+
+    REQUIRE(ray.getTime() == 0.5);
+    REQUIRE((ray.at(2) == vec3::Vec3(9, 12, 15)) == true);
+  }
+}
+
+TEST_CASE("Single precision rays hit spheres where double precision ones do", "[Ray]")
+{
+  hittable::BasicHitRecord<float> single;
+  hittable::BasicHitRecord<double> reference;
+
+  auto const singleRay = BasicRay<float>(BasicPoint3<float>(0.1f, 0.2f, 0), vec3::BasicVec3<float>(0, 0, -1));
+  auto const doubleRay = BasicRay<double>(BasicPoint3<double>(0.1f, 0.2f, 0), vec3::BasicVec3<double>(0, 0, -1));
+
+  REQUIRE(sphere::hitSphere(BasicPoint3<float>(0, 0, -3), 0.5, singleRay, 0.001, 100, single));
+  REQUIRE(sphere::hitSphere(BasicPoint3<double>(0, 0, -3), 0.5, doubleRay, 0.001, 100, reference));
+
+  REQUIRE(std::fabs(single.t - reference.t) < 1e-5);
+  REQUIRE(std::fabs(single.normal.x() - reference.normal.x()) < 1e-5);
+  REQUIRE(single.frontFace == reference.frontFace);
+
+  REQUIRE_FALSE(sphere::hitSphere(BasicPoint3<float>(0, 0, -3), 0.5, singleRay, 0.001, 2, single));
 }
 }   // namespace rt::ray
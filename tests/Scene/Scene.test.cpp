@@ -0,0 +1,316 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Scene.hpp"
+
+#include "Hittable.hpp"
+#include "Ray.hpp"
+#include "Utilities.hpp"
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace rt::scene {
+
+namespace {
+
+constexpr auto threeSpheres = R"(# Two materials and three spheres
+image 320 180
+samples 8
+depth 12
+camera 0 1 5  0 0 0  0 1 0  40 0 5
+
+lambertian 0.5 0.5 0.5
+metal 0.7 0.6 0.5 0.25   # a slightly fuzzy metal
+dielectric 1.5
+
+sphere 0 -1000 0 1000 0
+sphere -1 1 0 1 1
+sphere 1.5 0.5 -0.25 0.5 2
+)";
+
+}   // namespace
+
+TEST_CASE("parseScene", "[Scene]")
+{
+  SECTION("every statement is read")
+  {
+    auto const scene = parseScene(threeSpheres);
+
+    REQUIRE(scene.imgWidth == 320);
+    REQUIRE(scene.imgHeight == 180);
+    REQUIRE(scene.samplesPerPixel == 8);
+    REQUIRE(scene.maxDepth == 12);
+    REQUIRE(scene.camera.lookFrom == ray::Point3(0, 1, 5));
+    REQUIRE(scene.camera.verticalFieldOfView == 40);
+    REQUIRE(scene.camera.focusDistance == 5);
+
+    REQUIRE(scene.materials.size() == 3);
+    REQUIRE(scene.materials[1].type == MaterialType::metal);
+    REQUIRE(scene.materials[1].albedo == std::array<double, 3> {0.7, 0.6, 0.5});
+    REQUIRE(scene.materials[1].parameter == 0.25);
+    REQUIRE(scene.materials[2].type == MaterialType::dielectric);
+
+    REQUIRE(scene.spheres.size() == 3);
+    REQUIRE(scene.spheres[2].centre == std::array<double, 3> {1.5, 0.5, -0.25});
+    REQUIRE(scene.spheres[2].radius == 0.5);
+    REQUIRE(scene.spheres[2].material == 2);
+  }
+
+  SECTION("statements that are left out keep their defaults")
+  {
+    auto const scene = parseScene("lambertian 1 1 1\nsphere 0 0 0 1 0");
+
+    REQUIRE(scene.imgWidth == Description().imgWidth);
+    REQUIRE(scene.samplesPerPixel == Description().samplesPerPixel);
+    REQUIRE(scene.spheres.size() == 1);
+  }
+
+  SECTION("errors name the offending line")
+  {
+    auto const message = [](std::string_view text) {
+      try {
+        parseScene(text);
+      }
+      catch (std::runtime_error const& error) {
+        return std::string(error.what());
+      }
+
+      return std::string();
+    };
+
+    REQUIRE(message("lambertian 1 1 1\n\nsphere 0 0 0 1 1\n") == "line 3: material 1 has not been declared");
+    REQUIRE(message("sphere 0 0 zero 1 0") == "line 1: expected a sphere centre, got 'zero'");
+    REQUIRE(message("dielectric") == "line 1: expected a refractive index");
+    REQUIRE(message("depth 4 5") == "line 1: unexpected '5'");
+    REQUIRE(message("# fine\ncone 1") == "line 2: unknown statement 'cone'");
+    REQUIRE(message("shutter 0.5 0.25") == "line 1: the shutter must open and then close at times from 0 to 1");
+    REQUIRE(message("shutter 0 2") == "line 1: the shutter must open and then close at times from 0 to 1");
+    REQUIRE(message("samples 0") == "line 1: there must be at least one sample per pixel");
+    REQUIRE(message("depth 0") == "line 1: the maximum depth must be at least 1");
+    REQUIRE(message("sphere 0 0 0 -1 0") == "line 1: the radius of a sphere must be positive and finite");
+    REQUIRE(message("sphere 0 0 0 nan 0") == "line 1: the radius of a sphere must be positive and finite");
+    REQUIRE(message("disk 0 0 0  0 1 0  inf 0") == "line 1: the radius of a disk must be positive and finite");
+
+    auto const badNormal = "line 2: the normal must be finite and not zero";
+
+    REQUIRE(message("lambertian 1 1 1\nplane 0 0 0  0 0 0  0") == badNormal);
+    REQUIRE(message("lambertian 1 1 1\nplane 0 0 0  0 1e-200 0  0") == badNormal);
+    REQUIRE(message("lambertian 1 1 1\ndisk 0 0 0  nan 1 0  1 0") == "line 2: a normal must be finite");
+
+    // Infinities and NaNs are caught where they are read, before they reach the hierarchy
+    REQUIRE(message("lambertian 1 1 1\nsphere nan 0 0 1 0") == "line 2: a sphere centre must be finite");
+    REQUIRE(message("lambertian 1 1 1\nsphere 0 -inf 0 1 0") == "line 2: a sphere centre must be finite");
+    REQUIRE(message("lambertian 1 1 1\nmoving 0 0 0 1 0  0 inf 0") == "line 2: a sphere velocity must be finite");
+    REQUIRE(message("lambertian 1 1 1\nplane 0 nan 0  0 1 0  0") == "line 2: a point must be finite");
+    REQUIRE(message("lambertian 1 1 1\nbox 0 0 0  1 1 inf  0") == "line 2: an upper corner must be finite");
+    REQUIRE(message("lambertian inf 1 1") == "line 1: an albedo must be finite");
+    REQUIRE(message("metal 1 1 1 nan") == "line 1: a fuzz must be finite");
+    REQUIRE(message("camera 0 0 nan  0 0 -1  0 1 0  40 0 1") == "line 1: a camera position must be finite");
+    REQUIRE(message("camera 0 0 0  0 0 -1  0 1 0  inf 0 1") == "line 1: a vertical field of view must be finite");
+  }
+
+  SECTION("moving spheres and the shutter are read")
+  {
+    auto const scene = parseScene("shutter 0.25 0.75\nlambertian 1 1 1\nmoving 1 2 3 0.5 0  0 0.5 -1\n");
+
+    REQUIRE(scene.camera.shutterOpen == 0.25);
+    REQUIRE(scene.camera.shutterClose == 0.75);
+    REQUIRE(scene.spheres[0].centre == std::array<double, 3> {1, 2, 3});
+    REQUIRE(scene.spheres[0].velocity == std::array<double, 3> {0, 0.5, -1});
+  }
+
+  SECTION("planes, disks and boxes are read and written back")
+  {
+    auto const scene = parseScene("lambertian 1 1 1\nplane 0 0 0  0 1 0  0\ndisk 0 1 -3  0 0 1  2 0\n"
+                                  "box -1 0 -1  1 0.5 1  0\n");
+
+    REQUIRE(scene.shapes.size() == 3);
+    REQUIRE(scene.shapes[0].type == ShapeType::plane);
+    REQUIRE(scene.shapes[0].vector == std::array<double, 3> {0, 1, 0});
+    REQUIRE(scene.shapes[1].type == ShapeType::disk);
+    REQUIRE(scene.shapes[1].point == std::array<double, 3> {0, 1, -3});
+    REQUIRE(scene.shapes[1].radius == 2);
+    REQUIRE(scene.shapes[2].type == ShapeType::box);
+    REQUIRE(scene.shapes[2].vector == std::array<double, 3> {1, 0.5, 1});
+
+    std::ostringstream out;
+    writeScene(out, scene);
+    auto const readBack = parseScene(out.str());
+
+    REQUIRE(readBack.shapes.size() == 3);
+    REQUIRE(readBack.shapes[1].radius == 2);
+    REQUIRE(readBack.shapes[2].point == scene.shapes[2].point);
+
+    REQUIRE_THROWS_AS(parseScene("lambertian 1 1 1\nplane 0 0 0  0 0 0  0\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseScene("lambertian 1 1 1\nbox 0 0 0  1 -1 1  0\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseScene("plane 0 0 0  0 1 0  0\n"), std::runtime_error);
+  }
+
+  SECTION("meshes are read and written back")
+  {
+    auto const scene = parseScene("lambertian 1 1 1\nmetal 1 1 1 0\nmesh models/bunny.ply 1\n");
+
+    REQUIRE(scene.meshes.size() == 1);
+    REQUIRE(scene.meshes[0].path == "models/bunny.ply");
+    REQUIRE(scene.meshes[0].material == 1);
+    REQUIRE_THROWS_AS(parseScene("lambertian 1 1 1\nmesh bunny.ply 1\n"), std::runtime_error);
+    auto settings = Description();
+    REQUIRE_THROWS_AS(parseSettings("mesh bunny.ply 0\n", settings), std::runtime_error);
+    REQUIRE_THROWS_AS(buildWorld(scene), std::invalid_argument);
+
+    std::ostringstream out;
+    writeScene(out, scene);
+
+    REQUIRE(parseScene(out.str()).meshes[0].path == scene.meshes[0].path);
+  }
+
+  SECTION("instances are read and written back")
+  {
+    auto const scene = parseScene("instance models/tree.txt 1 2 3  0 0 1  90  0.5\n"
+                                  "instance tree.txt 0 0 0  1 0 0  0  1\n");
+
+    REQUIRE(scene.instances.size() == 2);
+    REQUIRE(scene.instances[0].path == "models/tree.txt");
+    REQUIRE(scene.instances[0].offset == std::array<double, 3> {1, 2, 3});
+    REQUIRE(scene.instances[0].axis == std::array<double, 3> {0, 0, 1});
+    REQUIRE(scene.instances[0].degrees == 90);
+    REQUIRE(scene.instances[0].scale == 0.5);
+    REQUIRE_THROWS_AS(parseScene("instance tree.txt 0 0 0  0 0 0  90 1\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseScene("instance tree.txt 0 0 0  0 1 0  90 0\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseScene("instance tree.txt 0 0 0  0 1 0  90 -1\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseScene("instance tree.txt 0 0 0  0 1 0  inf 1\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseScene("instance tree.txt 0 0 0  0 1 0  90\n"), std::runtime_error);
+    auto settings = Description();
+    REQUIRE_THROWS_AS(parseSettings("instance tree.txt 0 0 0  0 1 0  0 1\n", settings), std::runtime_error);
+    REQUIRE_THROWS_AS(buildWorld(scene), std::invalid_argument);
+
+    std::ostringstream out;
+    writeScene(out, scene);
+    auto const written = parseScene(out.str());
+
+    REQUIRE(written.instances.size() == 2);
+    REQUIRE(written.instances[0].path == scene.instances[0].path);
+    REQUIRE(written.instances[0].offset == scene.instances[0].offset);
+    REQUIRE(written.instances[0].axis == scene.instances[0].axis);
+    REQUIRE(written.instances[0].degrees == scene.instances[0].degrees);
+    REQUIRE(written.instances[0].scale == scene.instances[0].scale);
+  }
+}
+
+TEST_CASE("parseSettings", "[Scene]")
+{
+  auto scene = parseScene(threeSpheres);
+
+  SECTION("only the given settings change")
+  {
+    parseSettings("samples 2\nimage 16 9\n", scene);
+
+    REQUIRE(scene.samplesPerPixel == 2);
+    REQUIRE(scene.imgWidth == 16);
+    REQUIRE(scene.imgHeight == 9);
+    REQUIRE(scene.maxDepth == 12);
+    REQUIRE(scene.camera.verticalFieldOfView == 40);
+    REQUIRE(scene.spheres.size() == 3);
+  }
+
+  SECTION("objects cannot be added")
+  {
+    REQUIRE_THROWS_AS(parseSettings("samples 2\nlambertian 1 1 1\n", scene), std::runtime_error);
+    REQUIRE(scene.materials.size() == 3);
+  }
+}
+
+TEST_CASE("parseCameraPath", "[Scene]")
+{
+  SECTION("every keyframe is read")
+  {
+    auto const keyframes = parseCameraPath("keyframe 0  13 2 3  0 0 0  10\n# pause\nkeyframe 48  3 2 13  0 0 1  12.5\n");
+
+    REQUIRE(keyframes.size() == 2);
+    REQUIRE(keyframes[1].frame == 48);
+    REQUIRE(keyframes[1].lookFrom == ray::Point3(3, 2, 13));
+    REQUIRE(keyframes[1].lookAt == ray::Point3(0, 0, 1));
+    REQUIRE(keyframes[1].focusDistance == 12.5);
+  }
+
+  SECTION("keyframes must move forward in time")
+  {
+    REQUIRE_THROWS_AS(parseCameraPath("keyframe 5  1 1 1  0 0 0  1\nkeyframe 5  2 2 2  0 0 0  1\n"), std::runtime_error);
+    REQUIRE_THROWS_AS(parseCameraPath("# nothing\n"), std::runtime_error);
+  }
+}
+
+TEST_CASE("writeScene", "[Scene]")
+{
+  SECTION("a written scene reads back exactly")
+  {
+    auto scene = parseScene(threeSpheres);
+    scene.spheres[1].centre[0] = 0.1 + 0.2;
+    scene.spheres[2].velocity = {0, 0.1 + 0.7, 0};
+    scene.camera.shutterClose = 0.5;
+
+    std::ostringstream out;
+    writeScene(out, scene);
+    auto const readBack = parseScene(out.str());
+
+    REQUIRE(readBack.imgWidth == scene.imgWidth);
+    REQUIRE(readBack.camera.lookFrom == scene.camera.lookFrom);
+    REQUIRE(readBack.materials.size() == scene.materials.size());
+    REQUIRE(readBack.spheres.size() == scene.spheres.size());
+    REQUIRE(readBack.spheres[1].centre == scene.spheres[1].centre);
+    REQUIRE(readBack.spheres[1].velocity == std::array<double, 3> {});
+    REQUIRE(readBack.spheres[2].velocity == scene.spheres[2].velocity);
+    REQUIRE(readBack.camera.shutterClose == 0.5);
+    REQUIRE(readBack.materials[1].parameter == scene.materials[1].parameter);
+  }
+}
+
+TEST_CASE("buildWorld", "[Scene]")
+{
+  SECTION("the spheres are created in order")
+  {
+    auto const world = buildWorld(parseScene(threeSpheres));
+    auto const ray = ray::Ray(ray::Point3(-1, 1, 10), vec3::Vec3(0, 0, -1));
+    hittable::HitRecord record;
+
+    REQUIRE(world.hit(ray, 0.001, rt::infinity, record));
+    REQUIRE(record.objectIndex == 1);
+    REQUIRE(record.t == 9);
+  }
+
+  SECTION("moving spheres are hit where they are at the time of the ray")
+  {
+    auto const world = buildWorld(parseScene("lambertian 1 1 1\nmoving 0 0 0 1 0  0 0 4\n"));
+    hittable::HitRecord record;
+
+    REQUIRE(world.hit(ray::Ray(ray::Point3(0, 0, 10), vec3::Vec3(0, 0, -1), 0), 0.001, rt::infinity, record));
+    REQUIRE(record.t == 9);
+    REQUIRE(world.hit(ray::Ray(ray::Point3(0, 0, 10), vec3::Vec3(0, 0, -1), 0.5), 0.001, rt::infinity, record));
+    REQUIRE(record.t == 7);
+  }
+}
+
+}   // namespace rt::scene
@@ -0,0 +1,227 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "Server.hpp"
+
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "World.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace rt::server {
+
+namespace {
+
+constexpr auto twoSpheres = R"(image 24 16
+samples 4
+depth 8
+camera 0 1 5  0 0 0  0 1 0  40 0 5
+lambertian 0.5 0.5 0.5
+metal 0.7 0.6 0.5 0.25
+sphere 0 -1000 0 1000 0
+sphere 0 1 0 1 1
+)";
+
+/// A job that runs long enough to be cancelled while it is rendering
+constexpr auto slowSettings = "image 256 256\nsamples 200\nend\n";
+
+/// A server on a temporary socket, served on a thread of its own until the test ends
+class TestServer
+{
+public:
+  TestServer()
+    : m_path(std::filesystem::temp_directory_path() / "rt-server-test.sock")
+    , m_server(m_path, 2, [](std::string const& name) {
+      if (name != "two-spheres") {
+        throw std::runtime_error("no scene " + name);
+      }
+
+      return std::make_unique<world::World>(scene::parseScene(twoSpheres), std::filesystem::path());
+    })
+    , m_thread([this] { m_server.run(); })
+  {
+  }
+
+  ~TestServer()
+  {
+    m_server.stop();
+    m_thread.join();
+  }
+
+  TestServer(TestServer const&) = delete;
+  TestServer& operator=(TestServer const&) = delete;
+
+  std::string send(std::string_view request) const
+  {
+    return sendRequest(m_path, request);
+  }
+
+  /// Connect without sending anything
+  socket::Socket connect() const
+  {
+    return socket::connectUnix(m_path);
+  }
+
+  /// Send a request without waiting for its answer
+  std::future<std::string> sendLater(std::string request) const
+  {
+    return std::async(std::launch::async, [this, request = std::move(request)] { return send(request); });
+  }
+
+  /// Wait until the server reports the given status
+  bool waitForStatus(std::string const& status) const
+  {
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (send("status\n") == status) {
+        return true;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+  }
+
+private:
+  std::filesystem::path m_path;
+  Server m_server;
+  std::jthread m_thread;
+};
+
+}   // namespace
+
+TEST_CASE("Server", "[Server]")
+{
+  auto const server = TestServer();
+
+  SECTION("a job is answered with the image a direct render makes")
+  {
+    auto const answer = server.send("render a 0 two-spheres\nimage 16 8\n  samples 2 # fewer\nend\n");
+
+    auto const world = world::World(scene::parseScene(twoSpheres), {});
+    auto description = world.getDescription();
+    scene::parseSettings("image 16 8", description);
+
+    auto settings = render::Settings();
+    settings.imgWidth = 16;
+    settings.imgHeight = 8;
+    settings.samplesPerPixel = 2;
+    settings.maxDepth = 8;
+    settings.threads = 1;
+    settings.showProgress = false;
+
+    std::ostringstream expected;
+    expected << "ok a 16 8\n";
+    auto const framebuffer = render::render(world.getHittable(), scene::buildCamera(description), settings);
+    render::writePpm(expected, render::tonemap(framebuffer, 2), 16, 8);
+
+    REQUIRE(answer == expected.str());
+  }
+
+  SECTION("jobs without settings use those of the scene")
+  {
+    REQUIRE(server.send("render a 0 two-spheres\nend\n").starts_with("ok a 24 16\n"));
+  }
+
+  SECTION("bad requests are answered with an error")
+  {
+    REQUIRE(server.send("render a 0 two-spheres\nsphere 0 0 0 1 0\nend\n").starts_with("error line 1: "));
+    REQUIRE(server.send("render a high two-spheres\nend\n") == "error priority 'high' is not an integer\n");
+    REQUIRE(server.send("render a 0 cube\nend\n") == "error no scene cube\n");
+    REQUIRE(server.send("cancel nothing\n") == "error no job nothing\n");
+    REQUIRE(server.send("paint\n") == "error unknown request 'paint'\n");
+    REQUIRE(server.send("load two-spheres\n") == "ok 2\n");
+  }
+
+  SECTION("a client that sends nothing does not hold up other requests")
+  {
+    auto const silent = server.connect();
+    auto const start = std::chrono::steady_clock::now();
+
+    REQUIRE(server.send("status\n") == "ok 0 -\n");
+    REQUIRE(server.send("render a 0 two-spheres\nimage 16 8\nend\n").starts_with("ok a 16 8\n"));
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+  }
+
+  SECTION("queued and running jobs can be cancelled")
+  {
+    auto slow = server.sendLater(std::string("render slow 0 two-spheres\n") + slowSettings);
+    REQUIRE(server.waitForStatus("ok 0 slow\n"));
+
+    auto queued = server.sendLater("render queued 0 two-spheres\nend\n");
+    REQUIRE(server.waitForStatus("ok 1 slow\n"));
+
+    REQUIRE(server.send("cancel queued\n") == "ok\n");
+    REQUIRE(queued.get() == "cancelled queued\n");
+    REQUIRE(server.send("cancel slow\n") == "ok\n");
+    REQUIRE(slow.get() == "cancelled slow\n");
+    REQUIRE(server.waitForStatus("ok 0 -\n"));
+  }
+
+  SECTION("higher priorities run first")
+  {
+    auto slow = server.sendLater(std::string("render slow 0 two-spheres\n") + slowSettings);
+    REQUIRE(server.waitForStatus("ok 0 slow\n"));
+
+    auto low = server.sendLater(std::string("render low 1 two-spheres\n") + slowSettings);
+    REQUIRE(server.waitForStatus("ok 1 slow\n"));
+    auto high = server.sendLater(std::string("render high 2 two-spheres\n") + slowSettings);
+    REQUIRE(server.waitForStatus("ok 2 slow\n"));
+
+    REQUIRE(server.send("render high 0 two-spheres\nend\n") == "error job high already exists\n");
+
+    REQUIRE(server.send("cancel slow\n") == "ok\n");
+    REQUIRE(server.waitForStatus("ok 1 high\n"));
+    REQUIRE(server.send("cancel high\n") == "ok\n");
+    REQUIRE(server.waitForStatus("ok 0 low\n"));
+    REQUIRE(server.send("cancel low\n") == "ok\n");
+
+    REQUIRE(slow.get() == "cancelled slow\n");
+    REQUIRE(high.get() == "cancelled high\n");
+    REQUIRE(low.get() == "cancelled low\n");
+  }
+
+  SECTION("shutdown cancels every job")
+  {
+    auto slow = server.sendLater(std::string("render slow 0 two-spheres\n") + slowSettings);
+    REQUIRE(server.waitForStatus("ok 0 slow\n"));
+    auto queued = server.sendLater("render queued 0 two-spheres\nend\n");
+    REQUIRE(server.waitForStatus("ok 1 slow\n"));
+
+    REQUIRE(server.send("shutdown\n") == "ok\n");
+    REQUIRE(queued.get() == "cancelled queued\n");
+    REQUIRE(slow.get() == "cancelled slow\n");
+  }
+}
+
+}   // namespace rt::server
@@ -0,0 +1,111 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Stats.hpp"
+
+#include "Lambertian.hpp"
+#include "Ray.hpp"
+#include "Sphere.hpp"
+#include "Utilities.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace rt::stats {
+
+TEST_CASE("Counters are merged across threads", "[Stats]")
+{
+  reset();
+
+  SECTION("increments on different threads are summed")
+  {
+    increment(Counter::cameraRays);
+
+    std::jthread([] {
+      increment(Counter::cameraRays);
+      increment(Counter::skyMisses);
+    }).join();
+
+    auto const snapshot = collect();
+
+    REQUIRE(snapshot[static_cast<std::size_t>(Counter::cameraRays)] == 2);
+    REQUIRE(snapshot[static_cast<std::size_t>(Counter::skyMisses)] == 1);
+  }
+
+  SECTION("threads beyond the pool of counters share one set and lose nothing")
+  {
+    static_assert(noexcept(registerThread()));
+
+    for (std::size_t n = 0; n < maxThreads + 8; ++n) {
+      std::jthread([] { increment(Counter::secondaryRays); }).join();
+    }
+
+    auto const snapshot = collect();
+
+    REQUIRE(snapshot[static_cast<std::size_t>(Counter::secondaryRays)] == maxThreads + 8);
+  }
+
+  SECTION("the counters of each thread occupy their own cache lines")
+  {
+    REQUIRE(alignof(ThreadCounters) == cacheLineSize);
+    REQUIRE(sizeof(ThreadCounters) % cacheLineSize == 0);
+  }
+
+  SECTION("sphere intersection tests and hits are counted")
+  {
+    auto const sphere = sphere::Sphere(ray::Point3(0, 0, -1), 0.5, new material::Lambertian(colour::Colour(1, 1, 1)));
+    hittable::HitRecord record;
+
+    sphere.hit(ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0, 0, -1)), 0.001, rt::infinity, record);
+    sphere.hit(ray::Ray(ray::Point3(0, 0, 0), vec3::Vec3(0, 1, 0)), 0.001, rt::infinity, record);
+
+    auto const snapshot = collect();
+
+    REQUIRE(snapshot[static_cast<std::size_t>(Counter::sphereTests)] == 2);
+    REQUIRE(snapshot[static_cast<std::size_t>(Counter::sphereHits)] == 1);
+  }
+}
+
+TEST_CASE("writeJson", "[Stats]")
+{
+  SECTION("it writes every counter and the ray throughput")
+  {
+    auto snapshot = Snapshot {};
+    snapshot[static_cast<std::size_t>(Counter::cameraRays)] = 3;
+    snapshot[static_cast<std::size_t>(Counter::secondaryRays)] = 5;
+
+    auto ss = std::stringstream {};
+    writeJson(ss, snapshot, 2.0);
+
+    auto const json = ss.str();
+
+    REQUIRE(json.find("\"cameraRays\": 3") != std::string::npos);
+    REQUIRE(json.find("\"depthLimits\": 0") != std::string::npos);
+    REQUIRE(json.find("\"rays\": 8") != std::string::npos);
+    REQUIRE(json.find("\"raysPerSecond\": 4") != std::string::npos);
+  }
+}
+
+}   // namespace rt::stats
@@ -0,0 +1,97 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+namespace rt::threadpool {
+
+TEST_CASE("ThreadPool", "[ThreadPool]")
+{
+  auto pool = ThreadPool(4);
+
+  SECTION("every thread runs the task once")
+  {
+    std::vector<std::atomic<int>> runs(pool.getThreadCount());
+
+    pool.run([&runs](std::size_t thread) { ++runs[thread]; });
+
+    REQUIRE(pool.getThreadCount() == 4);
+
+    for (auto const& count : runs) {
+      REQUIRE(count == 1);
+    }
+  }
+
+  SECTION("run returns once every thread has finished")
+  {
+    std::atomic<int> finished = 0;
+
+    for (int task = 0; task < 100; ++task) {
+      pool.run([&finished](std::size_t) { ++finished; });
+
+      REQUIRE(finished == (task + 1) * 4);
+    }
+  }
+
+  SECTION("tasks from several threads do not overlap")
+  {
+    std::atomic<int> running = 0;
+    std::atomic<bool> overlapped = false;
+    auto const task = [&](std::size_t) {
+      if (++running > 4) {
+        overlapped = true;
+      }
+
+      std::this_thread::yield();
+      --running;
+    };
+
+    {
+      auto const first = std::jthread([&] {
+        for (int i = 0; i < 50; ++i) {
+          pool.run(task);
+        }
+      });
+      auto const second = std::jthread([&] {
+        for (int i = 0; i < 50; ++i) {
+          pool.run(task);
+        }
+      });
+    }
+
+    REQUIRE_FALSE(overlapped);
+  }
+
+  SECTION("zero threads selects one per hardware thread")
+  {
+    REQUIRE(ThreadPool(0).getThreadCount() >= 1);
+    REQUIRE(ThreadPool(1).getThreadCount() == 1);
+  }
+}
+
+}   // namespace rt::threadpool
@@ -0,0 +1,89 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Trace.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace rt::trace {
+
+TEST_CASE("Spans are exported as Chrome trace events", "[Trace]")
+{
+  SECTION("spans are only recorded while tracing is on")
+  {
+    {
+      auto const span = Span("ignoredSpan", "test");
+    }
+
+    start();
+
+    std::jthread([] {
+      setThreadName("test worker");
+      auto const span = Span("workerSpan", "test", 42);
+    }).join();
+
+    stop();
+
+    auto ss = std::stringstream {};
+    writeChromeTrace(ss);
+    auto const json = ss.str();
+
+    REQUIRE(json.find("ignoredSpan") == std::string::npos);
+    REQUIRE(json.find(R"("name": "workerSpan", "cat": "test", "ph": "X")") != std::string::npos);
+    REQUIRE(json.find(R"("args": {"id": 42})") != std::string::npos);
+    REQUIRE(json.find(R"("args": {"name": "test worker"})") != std::string::npos);
+  }
+
+  SECTION("spans that start before the origin get negative timestamps")
+  {
+    std::jthread([] { registerThread()->push(Event {"earlySpan", "test", -2'500, 1'200, -1}); }).join();
+
+    auto ss = std::stringstream {};
+    writeChromeTrace(ss);
+
+    REQUIRE(ss.str().find(R"("ts": -2.5, "dur": 1.2)") != std::string::npos);
+  }
+}
+
+TEST_CASE("ThreadBuffer", "[Trace]")
+{
+  SECTION("the oldest events are overwritten once the buffer is full")
+  {
+    auto buffer = std::make_unique<ThreadBuffer>(1);
+
+    for (std::size_t i = 0; i < ThreadBuffer::capacity + 2; ++i) {
+      buffer->push(Event {"event", "test", static_cast<std::int64_t>(i), 0, -1});
+    }
+
+    REQUIRE(buffer->getHead() == ThreadBuffer::capacity + 2);
+    REQUIRE(buffer->getEvent(2).startNs == 2);
+    REQUIRE(buffer->getEvent(ThreadBuffer::capacity + 1).startNs == ThreadBuffer::capacity + 1);
+  }
+}
+
+}   // namespace rt::trace
@@ -242,4 +242,36 @@ TEST_CASE("nearZero determines if a vector is very close to zero in all its dime
   REQUIRE((u.nearZero() == true and v.nearZero() == false));
 }
 
+TEST_CASE("Single precision vectors behave like double precision ones", "[Vec3]")
+{
+  constexpr auto u = BasicVec3<float>(1, 2, 3);
+  constexpr auto v = BasicVec3<float>(4, 5, 6);
+
+  SECTION("Arithmetic is performed in single precision")
+  {
+    REQUIRE(u + v == BasicVec3<float>(5, 7, 9));
+    REQUIRE(2 * u == BasicVec3<float>(2, 4, 6));
+    REQUIRE(getDotProduct(u, v) == 32.0f);
+    REQUIRE(getCrossProduct(u, v) == BasicVec3<float>(-3, 6, -3));
+  }
+
+  SECTION("Derived vectors agree with the double precision results to single precision")
+  {
+    auto const single = getRefractedRay(getUnitVector(u), getUnitVector(v), 0.7);
+    auto const reference = getRefractedRay(getUnitVector(BasicVec3<double>(1, 2, 3)),
+                                         getUnitVector(BasicVec3<double>(4, 5, 6)), 0.7);
+
+    REQUIRE(std::fabs(single.x() - reference.x()) < 1e-6);
+    REQUIRE(std::fabs(single.y() - reference.y()) < 1e-6);
+    REQUIRE(std::fabs(single.z() - reference.z()) < 1e-6);
+  }
+
+  SECTION("Random vectors are generated in single precision")
+  {
+    auto const w = getRandomVecInUnitSphere<float>();
+
+    REQUIRE(w.lengthSquared() < 1);
+  }
+}
+
 }   // namespace rt::vec3
@@ -0,0 +1,166 @@
+// Boost Software License - Version 1.0 - August 17th, 2003
+
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "Wavefront.hpp"
+
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "Stats.hpp"
+#include "World.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace rt::wavefront {
+
+namespace {
+
+constexpr auto sky = R"(camera 0 2 10  0 0.5 0  0 1 0  30 0 10
+lambertian 0.5 0.5 0.5
+)";
+
+constexpr auto materials = R"(camera 0 2 10  0 0.5 0  0 1 0  30 0.1 10
+lambertian 0.5 0.5 0.5
+lambertian 0.8 0.2 0.1
+metal 0.7 0.6 0.5 0.2
+dielectric 1.5
+sphere 0 -1000 0 1000 0
+sphere -2 0.5 0 0.5 1
+sphere 0 0.5 0 0.5 3
+sphere 2 0.5 0 0.5 2
+)";
+
+render::Settings makeSettings(render::Integrator integrator)
+{
+  auto settings = render::Settings();
+  settings.imgWidth = 32;
+  settings.imgHeight = 18;
+  settings.samplesPerPixel = 32;
+  settings.maxDepth = 8;
+  settings.threads = 1;
+  settings.showProgress = false;
+  settings.integrator = integrator;
+
+  return settings;
+}
+
+std::vector<colour::Colour> renderScene(char const* text, render::Settings const& settings)
+{
+  auto const description = scene::parseScene(text);
+  auto const world = world::World(description, {});
+
+  return render::render(world.getHittable(), scene::buildCamera(description), settings);
+}
+
+colour::Colour getMean(std::vector<colour::Colour> const& framebuffer)
+{
+  auto sum = colour::Colour(0, 0, 0);
+
+  for (auto const& pixel : framebuffer) {
+    sum += pixel;
+  }
+
+  return (1.0 / static_cast<double>(framebuffer.size())) * sum;
+}
+
+/// Whether two means differ by less than the noise of their samples
+bool isClose(double actual, double expected)
+{
+  return std::abs(actual - expected) < 0.02 * expected;
+}
+
+}   // namespace
+
+TEST_CASE("traceTile", "[Wavefront]")
+{
+  auto const path = makeSettings(render::Integrator::path);
+  auto const wavefront = makeSettings(render::Integrator::wavefront);
+
+  SECTION("camera rays that all miss sum the same sky as the path integrator")
+  {
+    REQUIRE(renderScene(sky, wavefront) == renderScene(sky, path));
+  }
+
+  SECTION("splitting a tile into small batches keeps the camera rays of every pixel")
+  {
+    auto batched = wavefront;
+    batched.batchSize = 7;
+
+    REQUIRE(renderScene(sky, batched) == renderScene(sky, path));
+  }
+
+  SECTION("it renders the same picture as the path integrator")
+  {
+    auto const expected = getMean(renderScene(materials, path));
+    auto const actual = getMean(renderScene(materials, wavefront));
+
+    REQUIRE(isClose(actual.r(), expected.r()));
+    REQUIRE(isClose(actual.g(), expected.g()));
+    REQUIRE(isClose(actual.b(), expected.b()));
+  }
+
+  SECTION("every path ends exactly once")
+  {
+    auto shallow = wavefront;
+    shallow.maxDepth = 3;
+
+    stats::reset();
+    renderScene(materials, shallow);
+    auto const snapshot = stats::collect();
+
+    auto const count = [&](stats::Counter counter) { return snapshot[static_cast<std::size_t>(counter)]; };
+    auto const cameraRays = count(stats::Counter::cameraRays);
+
+    REQUIRE(cameraRays == shallow.imgWidth * shallow.imgHeight * shallow.samplesPerPixel);
+    REQUIRE(count(stats::Counter::skyMisses) + count(stats::Counter::absorptions)
+              + count(stats::Counter::depthLimits)
+            == cameraRays);
+    REQUIRE(count(stats::Counter::depthLimits) > 0);
+  }
+
+  SECTION("sorting the secondary rays renders the same picture")
+  {
+    auto sorted = wavefront;
+    sorted.sortRays = true;
+    sorted.batchSize = 1000;
+
+    auto const expected = getMean(renderScene(materials, path));
+    stats::reset();
+    auto const actual = getMean(renderScene(materials, sorted));
+    auto const snapshot = stats::collect();
+
+    auto const count = [&](stats::Counter counter) { return snapshot[static_cast<std::size_t>(counter)]; };
+
+    REQUIRE(isClose(actual.r(), expected.r()));
+    REQUIRE(isClose(actual.g(), expected.g()));
+    REQUIRE(isClose(actual.b(), expected.b()));
+
+    // Every secondary ray is sorted once, except the ones whose paths have reached the depth limit
+    REQUIRE(count(stats::Counter::sortedRays)
+            == count(stats::Counter::secondaryRays) - count(stats::Counter::depthLimits));
+  }
+}
+
+}   // namespace rt::wavefront